@@ -0,0 +1,190 @@
+#include "adaptivesampler.h"
+
+#include <algorithm>
+#include <cmath>
+#include <complex>
+#include <limits>
+#include <numeric>
+#include <vector>
+
+namespace AdaptiveSampler {
+
+namespace {
+
+using Complex = std::complex<double>;
+
+// Below this magnitude the phase of a response carries no information.
+constexpr double kPhaseFloor = 1e-9;
+
+struct Interval
+{
+    std::size_t left;
+    std::size_t right;
+    double priority;    // deviation of the parent, for trimming to the budget
+};
+
+double midpoint(double a, double b, bool logarithmic)
+{
+    if (logarithmic && a > 0.0 && b > 0.0)
+        return std::sqrt(a * b);
+    return 0.5 * (a + b);
+}
+
+bool splittable(double a, double b, bool logarithmic)
+{
+    const double m = midpoint(a, b, logarithmic);
+    return m > a && m < b && (b - a) > 1e-12 * std::abs(b);
+}
+
+// Worst deviation over all columns in units of the tolerances; above 1 the
+// interval halves are refined. A non-finite sample (a pole, a singularity at
+// DC) counts as infinitely far off, so the sampler closes in on it.
+double deviation(const Eigen::MatrixXcd& values, std::size_t a, std::size_t m, std::size_t b,
+                 const Settings& settings)
+{
+    const Eigen::Index ra = static_cast<Eigen::Index>(a);
+    const Eigen::Index rm = static_cast<Eigen::Index>(m);
+    const Eigen::Index rb = static_cast<Eigen::Index>(b);
+    const double tolerance = settings.tolerance > 0.0 ? settings.tolerance : std::numeric_limits<double>::min();
+    const double phaseTolerance = settings.phaseTolerance > 0.0 ? settings.phaseTolerance
+                                                                 : std::numeric_limits<double>::min();
+    double worst = 0.0;
+    for (Eigen::Index col = 0; col < values.cols(); ++col) {
+        const Complex sa = values(ra, col);
+        const Complex sm = values(rm, col);
+        const Complex sb = values(rb, col);
+        worst = std::max(worst, std::abs(sm - 0.5 * (sa + sb)) / tolerance);
+        if (std::abs(sa) > kPhaseFloor && std::abs(sm) > kPhaseFloor && std::abs(sb) > kPhaseFloor) {
+            const double first = std::arg(sm / sa);
+            const double second = std::arg(sb / sm);
+            worst = std::max(worst, std::abs(second - first) / phaseTolerance);
+        }
+        if (!std::isfinite(worst))
+            return std::numeric_limits<double>::infinity();
+    }
+    return worst;
+}
+
+double chord(const Eigen::MatrixXcd& values, std::size_t a, std::size_t b)
+{
+    const Eigen::RowVectorXcd step = values.row(static_cast<Eigen::Index>(b)) - values.row(static_cast<Eigen::Index>(a));
+    if (!step.allFinite())
+        return std::numeric_limits<double>::infinity();
+    return step.cwiseAbs().maxCoeff();
+}
+
+} // namespace
+
+Result sample(double fmin, double fmax, const Settings& settings, const Evaluate& evaluate)
+{
+    Result result;
+    const int cap = std::max(settings.maxPoints, 2);
+    const int initial = std::clamp(settings.initialPoints, 2, cap);
+
+    Eigen::VectorXd start = Eigen::VectorXd::LinSpaced(initial, fmin, fmax);
+    if (settings.logarithmic && fmin > 0.0 && fmax > 0.0) {
+        start = Eigen::VectorXd::LinSpaced(initial, std::log10(fmin), std::log10(fmax));
+        for (Eigen::Index i = 0; i < start.size(); ++i)
+            start(i) = std::pow(10.0, start(i));
+        start(0) = fmin;
+        start(initial - 1) = fmax;
+    }
+
+    Eigen::MatrixXcd first = evaluate(start);
+    if (first.rows() != start.size() || first.cols() == 0 || !(fmax > fmin)) {
+        result.freq = std::move(start);
+        result.response = std::move(first);
+        return result;
+    }
+
+    std::vector<double> freq(start.data(), start.data() + start.size());
+    freq.reserve(static_cast<std::size_t>(cap));
+    Eigen::MatrixXcd values(cap, first.cols());
+    values.topRows(initial) = first;
+
+    std::vector<Interval> candidates;
+    for (std::size_t i = 0; i + 1 < freq.size(); ++i) {
+        if (splittable(freq[i], freq[i + 1], settings.logarithmic))
+            candidates.push_back({i, i + 1, chord(values, i, i + 1)});
+    }
+
+    while (!candidates.empty() && freq.size() < static_cast<std::size_t>(cap)) {
+        const std::size_t budget = static_cast<std::size_t>(cap) - freq.size();
+        if (candidates.size() > budget) {
+            std::nth_element(candidates.begin(), candidates.begin() + static_cast<std::ptrdiff_t>(budget),
+                             candidates.end(), [](const Interval& x, const Interval& y) {
+                return x.priority > y.priority;
+            });
+            candidates.resize(budget);
+        }
+        std::sort(candidates.begin(), candidates.end(), [&](const Interval& x, const Interval& y) {
+            return freq[x.left] < freq[y.left];
+        });
+
+        Eigen::VectorXd mids(static_cast<Eigen::Index>(candidates.size()));
+        for (std::size_t k = 0; k < candidates.size(); ++k)
+            mids(static_cast<Eigen::Index>(k)) = midpoint(freq[candidates[k].left], freq[candidates[k].right],
+                                                          settings.logarithmic);
+        const Eigen::MatrixXcd midValues = evaluate(mids);
+        if (midValues.rows() != mids.size() || midValues.cols() != values.cols())
+            break;
+        ++result.rounds;
+
+        std::vector<Interval> next;
+        for (std::size_t k = 0; k < candidates.size(); ++k) {
+            const Interval& interval = candidates[k];
+            const std::size_t m = freq.size();
+            const double f = mids(static_cast<Eigen::Index>(k));
+            freq.push_back(f);
+            values.row(static_cast<Eigen::Index>(m)) = midValues.row(static_cast<Eigen::Index>(k));
+
+            const double worst = deviation(values, interval.left, m, interval.right, settings);
+            if (worst <= 1.0)
+                continue;
+            if (splittable(freq[interval.left], f, settings.logarithmic))
+                next.push_back({interval.left, m, worst});
+            if (splittable(f, freq[interval.right], settings.logarithmic))
+                next.push_back({m, interval.right, worst});
+        }
+        candidates.swap(next);
+    }
+
+    std::vector<std::size_t> order(freq.size());
+    std::iota(order.begin(), order.end(), std::size_t{0});
+    std::sort(order.begin(), order.end(), [&](std::size_t x, std::size_t y) { return freq[x] < freq[y]; });
+    result.freq.resize(static_cast<Eigen::Index>(order.size()));
+    result.response.resize(static_cast<Eigen::Index>(order.size()), values.cols());
+    for (std::size_t i = 0; i < order.size(); ++i) {
+        result.freq(static_cast<Eigen::Index>(i)) = freq[order[i]];
+        result.response.row(static_cast<Eigen::Index>(i)) = values.row(static_cast<Eigen::Index>(order[i]));
+    }
+    return result;
+}
+
+std::shared_ptr<const Result> Memo::get(std::uint64_t version, double fmin, double fmax, const Settings& settings,
+                                        const Evaluate& evaluate)
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    const bool sameSettings = m_settings.initialPoints == settings.initialPoints &&
+                              m_settings.maxPoints == settings.maxPoints &&
+                              m_settings.tolerance == settings.tolerance &&
+                              m_settings.phaseTolerance == settings.phaseTolerance &&
+                              m_settings.logarithmic == settings.logarithmic;
+    if (m_result && m_version == version && m_fmin == fmin && m_fmax == fmax && sameSettings)
+        return m_result;
+
+    m_result = std::make_shared<const Result>(sample(fmin, fmax, settings, evaluate));
+    m_version = version;
+    m_fmin = fmin;
+    m_fmax = fmax;
+    m_settings = settings;
+    return m_result;
+}
+
+void Memo::clear()
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_result.reset();
+}
+
+} // namespace AdaptiveSampler
@@ -0,0 +1,58 @@
+#ifndef ADAPTIVESAMPLER_H
+#define ADAPTIVESAMPLER_H
+
+#include <Eigen/Dense>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <mutex>
+
+// Frequency grids that follow the response: a coarse sweep is refined by
+// bisecting the intervals whose midpoint deviates from the straight line
+// between its neighbours, or across which the phase slope changes, until the
+// point budget is spent. Narrow resonances and notches get dense sampling
+// while smooth stretches stay coarse.
+namespace AdaptiveSampler {
+
+struct Settings
+{
+    int initialPoints = 129;
+    int maxPoints = 2001;           // including the initial points
+    double tolerance = 1e-3;        // |S(mid) - (S(a) + S(b)) / 2|
+    double phaseTolerance = 0.05;   // radians of phase-step change across a midpoint
+    bool logarithmic = false;       // spacing of the initial sweep and of midpoints
+};
+
+struct Result
+{
+    Eigen::VectorXd freq;           // ascending
+    Eigen::MatrixXcd response;      // rows follow freq
+    int rounds = 0;                 // refinement passes, one evaluate() call each
+};
+
+// Returns the response at the frequencies it is given, one row per frequency.
+using Evaluate = std::function<Eigen::MatrixXcd(const Eigen::VectorXd&)>;
+
+Result sample(double fmin, double fmax, const Settings& settings, const Evaluate& evaluate);
+
+// The last sampling of one network, reused until its data version, range or
+// settings change.
+class Memo
+{
+public:
+    std::shared_ptr<const Result> get(std::uint64_t version, double fmin, double fmax, const Settings& settings,
+                                      const Evaluate& evaluate);
+    void clear();
+
+private:
+    std::mutex m_mutex;
+    std::shared_ptr<const Result> m_result;
+    std::uint64_t m_version = 0;
+    double m_fmin = 0.0;
+    double m_fmax = 0.0;
+    Settings m_settings;
+};
+
+} // namespace AdaptiveSampler
+
+#endif // ADAPTIVESAMPLER_H
@@ -143,9 +143,21 @@ fi
 
 MOC_INCLUDES="$(pkg-config --cflags Qt6Widgets Qt6Gui Qt6Core Qt6PrintSupport)"
 
-g++ -std=c++17 -I/usr/include/eigen3 -I. tests/parser_touchstone_tests.cpp parser_touchstone.cpp -o parser_touchstone_tests
+g++ -std=c++17 -pthread -I/usr/include/eigen3 -I. tests/parser_touchstone_tests.cpp parser_touchstone.cpp mappedfile.cpp threadpool.cpp touchstone_cache.cpp -o parser_touchstone_tests
+g++ -std=c++17 -pthread -I/usr/include/eigen3 -I. tests/touchstone_cache_tests.cpp parser_touchstone.cpp mappedfile.cpp threadpool.cpp touchstone_cache.cpp -o touchstone_cache_tests
+g++ -std=c++17 -pthread -I/usr/include/eigen3 -I. tests/touchstone_registry_tests.cpp parser_touchstone.cpp mappedfile.cpp threadpool.cpp touchstone_cache.cpp touchstone_registry.cpp -o touchstone_registry_tests
 
-g++ -std=c++17 -I/usr/include/eigen3 -I. \
+g++ -std=c++17 -O3 -pthread -I/usr/include/eigen3 -I. tests/parser_touchstone_bench.cpp parser_touchstone.cpp mappedfile.cpp threadpool.cpp touchstone_cache.cpp -o parser_touchstone_bench
+
+g++ -std=c++17 -pthread -I. tests/threadpool_tests.cpp threadpool.cpp -o threadpool_tests
+
+g++ -std=c++17 -O2 -I/usr/include/eigen3 -I. tests/plotkernels_tests.cpp plotkernels.cpp -o plotkernels_tests
+
+g++ -std=c++17 -O2 -I/usr/include/eigen3 -I. tests/cascadekernels_tests.cpp cascadekernels.cpp -o cascadekernels_tests
+
+g++ -std=c++17 -O2 -I/usr/include/eigen3 -I. tests/adaptivesampler_tests.cpp adaptivesampler.cpp -o adaptivesampler_tests
+
+g++ -std=c++17 -O2 -pthread -I/usr/include/eigen3 -I. \
     tests/tdrcalculator_tests.cpp tdrcalculator.cpp \
     -o tdrcalculator_tests $(pkg-config --cflags --libs Qt6Core)
 
@@ -160,68 +172,94 @@ $MOC $MOC_INCLUDES mainwindow.h -o moc_mainwindow.cpp
 $MOC $MOC_INCLUDES server.h -o moc_server.cpp
 $MOC $MOC_INCLUDES qcustomplot.h -o moc_qcustomplot.cpp
 $MOC $MOC_INCLUDES parameterstyledialog.h -o moc_parameterstyledialog.cpp
+$MOC $MOC_INCLUDES parametersweepdialog.h -o moc_parametersweepdialog.cpp
 $MOC $MOC_INCLUDES plotsettingsdialog.h -o moc_plotsettingsdialog.cpp
 
 # Build GUI plot test
 g++ -std=c++17 -I/usr/include/eigen3 -I. \
-    tests/gui_plot_tests.cpp plotmanager.cpp plotsettingsdialog.cpp network.cpp networkfile.cpp \
-    networklumped.cpp networkcascade.cpp parser_touchstone.cpp qcustomplot.cpp \
-    tdrcalculator.cpp \
+    tests/gui_plot_tests.cpp plotmanager.cpp plotsettingsdialog.cpp network.cpp networkparameters.cpp plotdatacache.cpp plotkernels.cpp networkfile.cpp \
+    networklumped.cpp networkcascade.cpp networkconnection.cpp cascadekernels.cpp adaptivesampler.cpp parser_touchstone.cpp mappedfile.cpp threadpool.cpp touchstone_cache.cpp touchstone_registry.cpp \
+    qcustomplot.cpp tdrcalculator.cpp \
     moc_plotmanager.cpp moc_plotsettingsdialog.cpp moc_network.cpp moc_networkfile.cpp moc_networklumped.cpp \
     moc_networkcascade.cpp moc_qcustomplot.cpp \
     -o gui_plot_tests $(pkg-config --cflags --libs Qt6Widgets Qt6Gui Qt6Core Qt6PrintSupport)
 
 g++ -std=c++17 -I/usr/include/eigen3 -I. \
-    tests/networkcascade_tests.cpp parser_touchstone.cpp network.cpp networkfile.cpp \
-    networklumped.cpp networkcascade.cpp tdrcalculator.cpp \
+    tests/networkcascade_tests.cpp parser_touchstone.cpp mappedfile.cpp threadpool.cpp touchstone_cache.cpp touchstone_registry.cpp network.cpp networkparameters.cpp plotdatacache.cpp plotkernels.cpp networkfile.cpp \
+    networklumped.cpp networkcascade.cpp networkconnection.cpp cascadekernels.cpp adaptivesampler.cpp tdrcalculator.cpp \
     moc_network.cpp moc_networkfile.cpp moc_networklumped.cpp moc_networkcascade.cpp \
     -o networkcascade_tests $(pkg-config --cflags --libs Qt6Core Qt6Gui)
 
 g++ -std=c++17 -I/usr/include/eigen3 -I. \
-    tests/cascadeio_tests.cpp cascadeio.cpp parser_touchstone.cpp network.cpp networkfile.cpp \
-    networklumped.cpp networkcascade.cpp tdrcalculator.cpp \
+    tests/parametersweep_tests.cpp parametersweep.cpp parser_touchstone.cpp mappedfile.cpp threadpool.cpp touchstone_cache.cpp touchstone_registry.cpp network.cpp networkparameters.cpp plotdatacache.cpp plotkernels.cpp networkfile.cpp \
+    networklumped.cpp networkcascade.cpp networkconnection.cpp cascadekernels.cpp adaptivesampler.cpp tdrcalculator.cpp \
+    moc_network.cpp moc_networkfile.cpp moc_networklumped.cpp moc_networkcascade.cpp \
+    -o parametersweep_tests $(pkg-config --cflags --libs Qt6Core Qt6Gui)
+
+g++ -std=c++17 -I/usr/include/eigen3 -I. \
+    tests/networkconnection_tests.cpp networkconnection.cpp parser_touchstone.cpp mappedfile.cpp threadpool.cpp touchstone_cache.cpp touchstone_registry.cpp network.cpp networkparameters.cpp plotdatacache.cpp plotkernels.cpp networkfile.cpp \
+    networklumped.cpp networkcascade.cpp cascadekernels.cpp adaptivesampler.cpp tdrcalculator.cpp \
+    moc_network.cpp moc_networkfile.cpp moc_networklumped.cpp moc_networkcascade.cpp \
+    -o networkconnection_tests $(pkg-config --cflags --libs Qt6Core Qt6Gui)
+
+g++ -std=c++17 -I/usr/include/eigen3 -I. \
+    tests/networkparameters_tests.cpp parser_touchstone.cpp mappedfile.cpp threadpool.cpp touchstone_cache.cpp touchstone_registry.cpp network.cpp networkparameters.cpp plotdatacache.cpp plotkernels.cpp networkfile.cpp \
+    networklumped.cpp networkcascade.cpp networkconnection.cpp cascadekernels.cpp adaptivesampler.cpp tdrcalculator.cpp \
+    moc_network.cpp moc_networkfile.cpp moc_networklumped.cpp moc_networkcascade.cpp \
+    -o networkparameters_tests $(pkg-config --cflags --libs Qt6Core Qt6Gui)
+
+g++ -std=c++17 -O3 -pthread -I/usr/include/eigen3 -I. \
+    tests/networkcascade_bench.cpp networkconnection.cpp parser_touchstone.cpp mappedfile.cpp threadpool.cpp touchstone_cache.cpp touchstone_registry.cpp network.cpp networkparameters.cpp plotdatacache.cpp plotkernels.cpp networkfile.cpp \
+    networklumped.cpp networkcascade.cpp cascadekernels.cpp adaptivesampler.cpp tdrcalculator.cpp \
+    moc_network.cpp moc_networkfile.cpp moc_networklumped.cpp moc_networkcascade.cpp \
+    -o networkcascade_bench $(pkg-config --cflags --libs Qt6Core Qt6Gui)
+
+g++ -std=c++17 -I/usr/include/eigen3 -I. \
+    tests/cascadeio_tests.cpp cascadeio.cpp parametersweep.cpp parser_touchstone.cpp mappedfile.cpp threadpool.cpp touchstone_cache.cpp touchstone_registry.cpp network.cpp networkparameters.cpp plotdatacache.cpp plotkernels.cpp networkfile.cpp \
+    networklumped.cpp networkcascade.cpp networkconnection.cpp cascadekernels.cpp adaptivesampler.cpp tdrcalculator.cpp \
     moc_network.cpp moc_networkfile.cpp moc_networklumped.cpp moc_networkcascade.cpp \
     -o cascadeio_tests $(pkg-config --cflags --libs Qt6Core Qt6Gui)
 
 g++ -std=c++17 -I/usr/include/eigen3 -I. \
-    tests/network_plot_style_tests.cpp network.cpp \
+    tests/network_plot_style_tests.cpp network.cpp networkparameters.cpp plotdatacache.cpp plotkernels.cpp tdrcalculator.cpp threadpool.cpp \
     moc_network.cpp \
     -o network_plot_style_tests $(pkg-config --cflags --libs Qt6Core Qt6Gui)
 
 g++ -std=c++17 -I/usr/include/eigen3 -I. \
-    tests/parameter_style_dialog_tests.cpp parameterstyledialog.cpp network.cpp \
+    tests/parameter_style_dialog_tests.cpp parameterstyledialog.cpp network.cpp networkparameters.cpp plotdatacache.cpp plotkernels.cpp tdrcalculator.cpp threadpool.cpp \
     moc_parameterstyledialog.cpp moc_network.cpp \
     -o parameter_style_dialog_tests $(pkg-config --cflags --libs Qt6Widgets Qt6Gui Qt6Core)
 
 g++ -std=c++17 -I/usr/include/eigen3 -I. \
-    tests/plotmanager_selection_tests.cpp plotmanager.cpp plotsettingsdialog.cpp network.cpp networklumped.cpp \
-    networkcascade.cpp parser_touchstone.cpp qcustomplot.cpp tdrcalculator.cpp \
+    tests/plotmanager_selection_tests.cpp plotmanager.cpp plotsettingsdialog.cpp network.cpp networkparameters.cpp plotdatacache.cpp plotkernels.cpp networklumped.cpp \
+    networkcascade.cpp networkconnection.cpp cascadekernels.cpp adaptivesampler.cpp parser_touchstone.cpp mappedfile.cpp threadpool.cpp touchstone_cache.cpp qcustomplot.cpp tdrcalculator.cpp \
     moc_plotmanager.cpp moc_plotsettingsdialog.cpp moc_network.cpp moc_networklumped.cpp moc_networkcascade.cpp moc_qcustomplot.cpp \
     -o plotmanager_selection_tests $(pkg-config --cflags --libs Qt6Widgets Qt6Gui Qt6Core Qt6PrintSupport)
 
 g++ -std=c++17 -I/usr/include/eigen3 -I. \
-    tests/plotmanager_mathplot_tests.cpp plotmanager.cpp plotsettingsdialog.cpp network.cpp networklumped.cpp \
-    networkcascade.cpp parser_touchstone.cpp qcustomplot.cpp tdrcalculator.cpp \
+    tests/plotmanager_mathplot_tests.cpp plotmanager.cpp plotsettingsdialog.cpp network.cpp networkparameters.cpp plotdatacache.cpp plotkernels.cpp networklumped.cpp \
+    networkcascade.cpp networkconnection.cpp cascadekernels.cpp adaptivesampler.cpp parser_touchstone.cpp mappedfile.cpp threadpool.cpp touchstone_cache.cpp qcustomplot.cpp tdrcalculator.cpp \
     moc_plotmanager.cpp moc_plotsettingsdialog.cpp moc_network.cpp moc_networklumped.cpp moc_networkcascade.cpp moc_qcustomplot.cpp \
     -o plotmanager_mathplot_tests $(pkg-config --cflags --libs Qt6Widgets Qt6Gui Qt6Core Qt6PrintSupport)
 
 g++ -std=c++17 -I/usr/include/eigen3 -I. \
-    tests/plotmanager_tdr_marker_tests.cpp plotmanager.cpp plotsettingsdialog.cpp network.cpp networklumped.cpp \
-    networkcascade.cpp parser_touchstone.cpp qcustomplot.cpp tdrcalculator.cpp \
+    tests/plotmanager_tdr_marker_tests.cpp plotmanager.cpp plotsettingsdialog.cpp network.cpp networkparameters.cpp plotdatacache.cpp plotkernels.cpp networklumped.cpp \
+    networkcascade.cpp networkconnection.cpp cascadekernels.cpp adaptivesampler.cpp parser_touchstone.cpp mappedfile.cpp threadpool.cpp touchstone_cache.cpp qcustomplot.cpp tdrcalculator.cpp \
     moc_plotmanager.cpp moc_plotsettingsdialog.cpp moc_network.cpp moc_networklumped.cpp moc_networkcascade.cpp moc_qcustomplot.cpp \
     -o plotmanager_tdr_marker_tests $(pkg-config --cflags --libs Qt6Widgets Qt6Gui Qt6Core Qt6PrintSupport)
 
 g++ -std=c++17 -I/usr/include/eigen3 -I. \
     tests/cascade_wheel_tests.cpp mainwindow.cpp networkitemmodel.cpp plotmanager.cpp plotsettingsdialog.cpp \
-    parameterstyledialog.cpp network.cpp networkfile.cpp networklumped.cpp networkcascade.cpp parser_touchstone.cpp \
-    qcustomplot.cpp tdrcalculator.cpp server.cpp cascadeio.cpp \
+    parameterstyledialog.cpp network.cpp networkparameters.cpp plotdatacache.cpp plotkernels.cpp networkfile.cpp networklumped.cpp networkcascade.cpp networkconnection.cpp cascadekernels.cpp adaptivesampler.cpp parser_touchstone.cpp mappedfile.cpp threadpool.cpp touchstone_cache.cpp \
+    touchstone_registry.cpp diagnostics.cpp qcustomplot.cpp tdrcalculator.cpp server.cpp cascadeio.cpp \
+    parametersweep.cpp parametersweepdialog.cpp \
     moc_mainwindow.cpp moc_networkitemmodel.cpp moc_plotmanager.cpp moc_plotsettingsdialog.cpp \
-    moc_parameterstyledialog.cpp moc_network.cpp moc_networkfile.cpp moc_networklumped.cpp moc_networkcascade.cpp \
+    moc_parameterstyledialog.cpp moc_parametersweepdialog.cpp moc_network.cpp moc_networkfile.cpp moc_networklumped.cpp moc_networkcascade.cpp \
     moc_qcustomplot.cpp moc_server.cpp \
     -o cascade_wheel_tests $(pkg-config --cflags --libs Qt6Widgets Qt6Gui Qt6Core Qt6PrintSupport Qt6Network)
 
 g++ -std=c++17 -I/usr/include/eigen3 -I. \
-    tests/plotsettingsdialog_tests.cpp plotmanager.cpp plotsettingsdialog.cpp network.cpp networklumped.cpp \
-    networkcascade.cpp parser_touchstone.cpp qcustomplot.cpp tdrcalculator.cpp \
+    tests/plotsettingsdialog_tests.cpp plotmanager.cpp plotsettingsdialog.cpp network.cpp networkparameters.cpp plotdatacache.cpp plotkernels.cpp networklumped.cpp \
+    networkcascade.cpp networkconnection.cpp cascadekernels.cpp adaptivesampler.cpp parser_touchstone.cpp mappedfile.cpp threadpool.cpp touchstone_cache.cpp qcustomplot.cpp tdrcalculator.cpp \
     moc_plotmanager.cpp moc_plotsettingsdialog.cpp moc_network.cpp moc_networklumped.cpp moc_networkcascade.cpp moc_qcustomplot.cpp \
     -o plotsettingsdialog_tests $(pkg-config --cflags --libs Qt6Widgets Qt6Gui Qt6Core Qt6PrintSupport)
@@ -1,12 +1,15 @@
 #include "cascadeio.h"
 
 #include "networkcascade.h"
+#include "parametersweep.h"
 #include "parser_touchstone.h"
 
 #include <QFile>
 #include <QFileInfo>
 #include <QByteArray>
 
+#include <cmath>
+#include <complex>
 #include <exception>
 
 bool saveCascadeToFile(const NetworkCascade& cascade,
@@ -48,8 +51,10 @@ bool saveCascadeToFile(const NetworkCascade& cascade,
         }
     }
 
-    if (!path.endsWith(QStringLiteral(".s2p"), Qt::CaseInsensitive)) {
-        path += QStringLiteral(".s2p");
+    // A cascade with port connections can have any number of external ports.
+    const QString suffix = QStringLiteral(".s%1p").arg(ports);
+    if (!path.endsWith(suffix, Qt::CaseInsensitive)) {
+        path += suffix;
     }
 
     QFileInfo info(path);
@@ -72,3 +77,78 @@ bool saveCascadeToFile(const NetworkCascade& cascade,
 
     return true;
 }
+
+bool saveCascadeToFile(const NetworkCascade& cascade,
+                       QString path,
+                       QString* savedAbsolutePath,
+                       QString* errorMessage)
+{
+    return saveCascadeToFile(cascade, cascade.frequencyVector(), path, savedAbsolutePath, errorMessage);
+}
+
+bool saveSweepToFile(const ParameterSweep::Result& result,
+                     QString path,
+                     QString* savedAbsolutePath,
+                     QString* errorMessage)
+{
+    if (!result.ok() || result.response.size() == 0) {
+        if (errorMessage)
+            *errorMessage = QStringLiteral("Cannot save sweep: %1").arg(
+                result.ok() ? QStringLiteral("no results available.") : result.error);
+        return false;
+    }
+
+    if (!path.endsWith(QStringLiteral(".csv"), Qt::CaseInsensitive)) {
+        path += QStringLiteral(".csv");
+    }
+
+    QFileInfo info(path);
+    const QString absolutePath = info.absoluteFilePath();
+    QFile file(absolutePath);
+    if (!file.open(QIODevice::WriteOnly | QIODevice::Truncate)) {
+        if (errorMessage)
+            *errorMessage = QStringLiteral("Failed to save sweep: %1").arg(file.errorString());
+        return false;
+    }
+
+    const int target = result.sParameter;
+    QByteArray header;
+    for (const QString& label : result.labels)
+        header += '"' + label.toUtf8() + "\",";
+    header += QStringLiteral("frequency_hz,S%1%2_re,S%1%2_im,S%1%2_db,S%1%2_deg\n")
+                  .arg(target % 2 + 1).arg(target / 2 + 1).toUtf8();
+    file.write(header);
+
+    const Eigen::Index n0 = result.values.at(0).size();
+    QByteArray line;
+    for (Eigen::Index row = 0; row < result.response.rows(); ++row) {
+        QByteArray prefix;
+        prefix += QByteArray::number(result.values.at(0)(row % n0), 'g', 12) + ',';
+        if (result.values.size() > 1)
+            prefix += QByteArray::number(result.values.at(1)(row / n0), 'g', 12) + ',';
+        for (Eigen::Index col = 0; col < result.freq.size(); ++col) {
+            const std::complex<double> s = result.response(row, col);
+            line = prefix;
+            line += QByteArray::number(result.freq(col), 'g', 12) + ',';
+            line += QByteArray::number(s.real(), 'g', 12) + ',';
+            line += QByteArray::number(s.imag(), 'g', 12) + ',';
+            line += QByteArray::number(20.0 * std::log10(std::abs(s)), 'g', 10) + ',';
+            line += QByteArray::number(std::arg(s) * 180.0 / M_PI, 'g', 10) + '\n';
+            file.write(line);
+        }
+    }
+
+    if (!file.flush()) {
+        if (errorMessage)
+            *errorMessage = QStringLiteral("Failed to save sweep: %1").arg(file.errorString());
+        return false;
+    }
+
+    if (savedAbsolutePath)
+        *savedAbsolutePath = absolutePath;
+
+    if (errorMessage)
+        errorMessage->clear();
+
+    return true;
+}
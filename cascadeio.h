@@ -5,6 +5,7 @@
 #include <Eigen/Dense>
 
 class NetworkCascade;
+namespace ParameterSweep { struct Result; }
 
 bool saveCascadeToFile(const NetworkCascade& cascade,
                        const Eigen::VectorXd& freq,
@@ -12,4 +13,17 @@ bool saveCascadeToFile(const NetworkCascade& cascade,
                        QString* savedAbsolutePath = nullptr,
                        QString* errorMessage = nullptr);
 
+// Saves on the grid of the cascade's frequency plan.
+bool saveCascadeToFile(const NetworkCascade& cascade,
+                       QString path,
+                       QString* savedAbsolutePath = nullptr,
+                       QString* errorMessage = nullptr);
+
+// Writes a parameter sweep as CSV, one line per combination and frequency:
+// the swept values, frequency in Hz, real and imaginary part, dB and degrees.
+bool saveSweepToFile(const ParameterSweep::Result& result,
+                     QString path,
+                     QString* savedAbsolutePath = nullptr,
+                     QString* errorMessage = nullptr);
+
 #endif // CASCADEIO_H
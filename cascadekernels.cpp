@@ -0,0 +1,128 @@
+#include "cascadekernels.h"
+
+#include <algorithm>
+#include <complex>
+#include <limits>
+
+namespace CascadeKernels {
+
+namespace {
+
+// Points per pass: the operands and temporaries of one pass stay in L1.
+constexpr Eigen::Index kChunk = 256;
+
+
+using Chunk = Eigen::Array<double, Eigen::Dynamic, 1, Eigen::ColMajor, kChunk, 1>;
+
+struct Split
+{
+    Chunk re;
+    Chunk im;
+};
+
+Split load(const Blocks& blocks, Column column, Eigen::Index first, Eigen::Index count)
+{
+    return {blocks.re.col(column).segment(first, count), blocks.im.col(column).segment(first, count)};
+}
+
+void store(Blocks& blocks, Column column, Eigen::Index first, const Split& value)
+{
+    blocks.re.col(column).segment(first, value.re.size()) = value.re;
+    blocks.im.col(column).segment(first, value.im.size()) = value.im;
+}
+
+Split multiply(const Split& a, const Split& b)
+{
+    return {a.re * b.re - a.im * b.im, a.re * b.im + a.im * b.re};
+}
+
+Split add(const Split& a, const Split& b)
+{
+    return {a.re + b.re, a.im + b.im};
+}
+
+} // namespace
+
+void Blocks::resize(Eigen::Index rows)
+{
+    re.resize(rows, 4);
+    im.resize(rows, 4);
+}
+
+std::size_t Blocks::bytes() const
+{
+    return static_cast<std::size_t>(re.size() + im.size()) * sizeof(double);
+}
+
+Eigen::Matrix2cd star(const Eigen::Matrix2cd& left, const Eigen::Matrix2cd& right)
+{
+    const std::complex<double> s11_left = left(0, 0);
+    const std::complex<double> s12_left = left(0, 1);
+    const std::complex<double> s21_left = left(1, 0);
+    const std::complex<double> s22_left = left(1, 1);
+
+    const std::complex<double> s11_right = right(0, 0);
+    const std::complex<double> s12_right = right(0, 1);
+    const std::complex<double> s21_right = right(1, 0);
+    const std::complex<double> s22_right = right(1, 1);
+
+    std::complex<double> denominator = 1.0 - s22_left * s11_right;
+    if (std::abs(denominator) < kSingularThreshold)
+    {
+        // Regularize near-singular connections to avoid numerical blow-up
+        denominator = std::complex<double>(std::numeric_limits<double>::epsilon(), 0.0);
+    }
+    const std::complex<double> inv = 1.0 / denominator;
+
+    Eigen::Matrix2cd result;
+    result(0, 0) = s11_left + s12_left * s11_right * s21_left * inv;
+    result(0, 1) = s12_left * s12_right * inv;
+    result(1, 0) = s21_left * s21_right * inv;
+    result(1, 1) = s22_right + s21_right * s22_left * s12_right * inv;
+    return result;
+}
+
+void star(const Blocks& left, const Blocks& right, Blocks& out, Eigen::Index begin, Eigen::Index end)
+{
+    for (Eigen::Index first = begin; first < end; first += kChunk) {
+        const Eigen::Index count = std::min(kChunk, end - first);
+        const Split s11Left = load(left, S11, first, count);
+        const Split s12Left = load(left, S12, first, count);
+        const Split s21Left = load(left, S21, first, count);
+        const Split s22Left = load(left, S22, first, count);
+        const Split s11Right = load(right, S11, first, count);
+        const Split s12Right = load(right, S12, first, count);
+        const Split s21Right = load(right, S21, first, count);
+        const Split s22Right = load(right, S22, first, count);
+
+        Split denominator = multiply(s22Left, s11Right);
+        denominator.re = 1.0 - denominator.re;
+        denominator.im = 0.0 - denominator.im;
+        // |d| >= max(|re|, |im|), so only points with a smaller scale need the
+        // exact std::abs test the scalar product uses.
+        Chunk scale = denominator.re.abs().max(denominator.im.abs());
+        for (Eigen::Index i = 0; i < count; ++i) {
+            if (scale(i) >= kSingularThreshold)
+                continue;
+            const std::complex<double> value(denominator.re(i), denominator.im(i));
+            if (std::abs(value) < kSingularThreshold) {
+                denominator.re(i) = std::numeric_limits<double>::epsilon();
+                denominator.im(i) = 0.0;
+                scale(i) = denominator.re(i);
+            }
+        }
+        // 1/d = conj(d/scale) / (|d/scale|^2 * scale): squaring the scaled parts
+        // neither overflows for huge |d| nor underflows for tiny ones.
+        const Chunk re = denominator.re / scale;
+        const Chunk im = denominator.im / scale;
+        const Chunk norm = (re.square() + im.square()) * scale;
+        const Split inv{re / norm, -im / norm};
+
+        store(out, S11, first, add(s11Left, multiply(multiply(multiply(s12Left, s11Right), s21Left), inv)));
+        store(out, S12, first, multiply(multiply(s12Left, s12Right), inv));
+        store(out, S21, first, multiply(multiply(s21Left, s21Right), inv));
+        store(out, S22, first, add(s22Right, multiply(multiply(multiply(s21Right, s22Left), s12Right), inv)));
+    }
+}
+
+} // namespace CascadeKernels
@@ -0,0 +1,38 @@
+#ifndef CASCADEKERNELS_H
+#define CASCADEKERNELS_H
+
+#include <Eigen/Dense>
+
+// Redheffer star products of 2-port chains evaluated for many frequencies at
+// once. Blocks keep real and imaginary parts in separate column arrays so the
+// arithmetic runs on whole packets of points instead of one complex 2x2 at a
+// time.
+namespace CascadeKernels {
+
+// Column order of Blocks and of NetworkCascade::sparameters().
+enum Column : Eigen::Index { S11 = 0, S21 = 1, S12 = 2, S22 = 3 };
+
+struct Blocks
+{
+    Eigen::ArrayXXd re;   // rows x 4
+    Eigen::ArrayXXd im;
+
+    Eigen::Index rows() const { return re.rows(); }
+    void resize(Eigen::Index rows);
+    std::size_t bytes() const;
+};
+
+// Denominators 1 - S22(left) * S11(right) with a magnitude below this are
+// replaced by machine epsilon.
+constexpr double kSingularThreshold = 1e-18;
+
+// The single-frequency product the batched kernel reproduces.
+Eigen::Matrix2cd star(const Eigen::Matrix2cd& left, const Eigen::Matrix2cd& right);
+
+// out rows [begin, end) = left star right; out must already have left's rows
+// and must not alias either operand.
+void star(const Blocks& left, const Blocks& right, Blocks& out, Eigen::Index begin, Eigen::Index end);
+
+} // namespace CascadeKernels
+
+#endif // CASCADEKERNELS_H
@@ -3,6 +3,7 @@
 #include <QLocale>
 #include <QSet>
 #include <QStringList>
+#include <algorithm>
 #include <optional>
 
 namespace {
@@ -239,6 +240,64 @@ bool parseCascadeItems(const QStringList& args, int& index, CommandLineParser::O
     return true;
 }
 
+// "<stage>:<parameter>:<start>:<stop>:<points>[:log]" with a 1-based stage of
+// the cascade and the parameter given by name or 1-based index.
+bool parseSweepAxis(const QString& text, const CommandLineParser::Options& options, ParameterSweep::Axis& axis,
+                    QString& error)
+{
+    const QStringList fields = text.split(QLatin1Char(':'));
+    if (fields.size() != 5 && fields.size() != 6) {
+        error = QStringLiteral("Invalid --vary '%1'; expected stage:parameter:start:stop:points[:log]").arg(text);
+        return false;
+    }
+
+    bool okStage = false;
+    const int stage = fields.at(0).toInt(&okStage);
+    if (!okStage || stage < 1 || stage > options.cascade.size()) {
+        error = QStringLiteral("--vary stage '%1' is not a position in the cascade").arg(fields.at(0));
+        return false;
+    }
+    const CommandLineParser::CascadeEntry& entry = options.cascade.at(stage - 1);
+    const LumpedDefinition* def = entry.type == CommandLineParser::CascadeEntry::Type::Lumped
+                                      ? findLumpedDefinition(entry.identifier)
+                                      : nullptr;
+    if (!def) {
+        error = QStringLiteral("--vary stage %1 is not a lumped network").arg(stage);
+        return false;
+    }
+
+    bool okIndex = false;
+    const int index = fields.at(1).toInt(&okIndex);
+    if (okIndex && index >= 1 && index <= def->parameters.size()) {
+        axis.parameter = def->parameters.at(index - 1).index;
+    } else if (const ParameterDefinition* param = findParameterDefinition(*def, fields.at(1))) {
+        axis.parameter = param->index;
+    } else {
+        error = QStringLiteral("Unknown parameter '%1' for lumped network '%2'").arg(fields.at(1), def->canonicalName);
+        return false;
+    }
+
+    bool okPoints = false;
+    axis.stage = stage - 1;
+    axis.points = fields.at(4).toInt(&okPoints);
+    if (!parseDoubleToken(fields.at(2), axis.start) || !parseDoubleToken(fields.at(3), axis.stop) ||
+        !okPoints || axis.points < 1) {
+        error = QStringLiteral("Invalid range or point count in --vary '%1'").arg(text);
+        return false;
+    }
+    axis.logarithmic = false;
+    if (fields.size() == 6) {
+        const QString spacing = fields.at(5).toLower();
+        if (spacing == QStringLiteral("log") && axis.start > 0.0 && axis.stop > 0.0) {
+            axis.logarithmic = true;
+        } else if (spacing != QStringLiteral("lin")) {
+            error = QStringLiteral("Invalid spacing in --vary '%1'; use lin, or log with positive values").arg(text);
+            return false;
+        }
+    }
+    return true;
+}
+
 } // namespace
 
 CommandLineParser::ParseResult CommandLineParser::parse(int argc, char *argv[]) const
@@ -253,6 +312,7 @@ CommandLineParser::ParseResult CommandLineParser::parse(int argc, char *argv[])
         args.append(QString::fromLocal8Bit(argv[i]));
     }
 
+    QStringList sweepAxes;
     bool treatAsPositional = false;
     for (int i = 0; i < args.size();) {
         const QString arg = args.at(i);
@@ -286,6 +346,55 @@ CommandLineParser::ParseResult CommandLineParser::parse(int argc, char *argv[])
             continue;
         }
 
+        if (!treatAsPositional && arg == QStringLiteral("--stats")) {
+            options.statsRequested = true;
+            ++i;
+            continue;
+        }
+
+        if (!treatAsPositional && arg == QStringLiteral("--threads")) {
+            if (i + 1 >= args.size()) {
+                result.errorMessage = QStringLiteral("Option --threads requires a thread count argument");
+                return result;
+            }
+            bool okThreads = false;
+            const int threads = args.at(i + 1).toInt(&okThreads);
+            if (!okThreads || threads < 0) {
+                result.errorMessage = QStringLiteral("Invalid thread count for --threads option");
+                return result;
+            }
+            options.threads = threads;
+            i += 2;
+            continue;
+        }
+
+        if (!treatAsPositional && arg == QStringLiteral("--cache")) {
+            options.useCache = true;
+            ++i;
+            continue;
+        }
+
+        if (!treatAsPositional && arg == QStringLiteral("--cache-dir")) {
+            if (i + 1 >= args.size()) {
+                result.errorMessage = QStringLiteral("Option --cache-dir requires a directory argument");
+                return result;
+            }
+            options.useCache = true;
+            options.cacheDir = args.at(i + 1);
+            i += 2;
+            continue;
+        }
+
+        if (!treatAsPositional && arg == QStringLiteral("--warm-cache")) {
+            if (i + 1 >= args.size()) {
+                result.errorMessage = QStringLiteral("Option --warm-cache requires a directory argument");
+                return result;
+            }
+            options.warmCacheDir = args.at(i + 1);
+            i += 2;
+            continue;
+        }
+
         if (!treatAsPositional && (arg == QStringLiteral("-f") || arg == QStringLiteral("--freq"))) {
             if (i + 3 >= args.size()) {
                 result.errorMessage = QStringLiteral("Option -f/--freq requires three arguments: fmin fmax points");
@@ -315,6 +424,85 @@ CommandLineParser::ParseResult CommandLineParser::parse(int argc, char *argv[])
             continue;
         }
 
+        if (!treatAsPositional && arg == QStringLiteral("--sweep")) {
+            if (i + 1 >= args.size()) {
+                result.errorMessage = QStringLiteral("Option --sweep requires one of lin, log, native or adaptive");
+                return result;
+            }
+            const QString plan = args.at(i + 1).toLower();
+            if (plan == QStringLiteral("lin")) {
+                options.frequencyPlan = NetworkCascade::FrequencyPlan::Linear;
+            } else if (plan == QStringLiteral("log")) {
+                options.frequencyPlan = NetworkCascade::FrequencyPlan::Logarithmic;
+            } else if (plan == QStringLiteral("native")) {
+                options.frequencyPlan = NetworkCascade::FrequencyPlan::Native;
+            } else if (plan == QStringLiteral("adaptive")) {
+                options.frequencyPlan = NetworkCascade::FrequencyPlan::Adaptive;
+            } else {
+                result.errorMessage = QStringLiteral("Unknown sweep '%1' for --sweep option").arg(args.at(i + 1));
+                return result;
+            }
+            i += 2;
+            continue;
+        }
+
+        if (!treatAsPositional && arg == QStringLiteral("--segments")) {
+            if (i + 1 >= args.size()) {
+                result.errorMessage = QStringLiteral("Option --segments requires a segment list argument");
+                return result;
+            }
+            if (!NetworkCascade::parseFrequencySegments(args.at(i + 1), options.frequencySegments)) {
+                result.errorMessage = QStringLiteral("Invalid segment list for --segments option; expected fmin:fmax:points[:log],...");
+                return result;
+            }
+            options.frequencyPlan = NetworkCascade::FrequencyPlan::Segments;
+            i += 2;
+            continue;
+        }
+
+        if (!treatAsPositional && arg == QStringLiteral("--connect")) {
+            if (i + 1 >= args.size()) {
+                result.errorMessage = QStringLiteral("Option --connect requires a connection list argument");
+                return result;
+            }
+            if (!NetworkCascade::parsePortConnections(args.at(i + 1), options.portConnections)) {
+                result.errorMessage = QStringLiteral("Invalid connection list for --connect option; expected stage:port-stage:port,...");
+                return result;
+            }
+            i += 2;
+            continue;
+        }
+
+        if (!treatAsPositional && arg == QStringLiteral("--vary")) {
+            if (i + 1 >= args.size()) {
+                result.errorMessage = QStringLiteral("Option --vary requires stage:parameter:start:stop:points[:log]");
+                return result;
+            }
+            if (sweepAxes.size() == 2) {
+                result.errorMessage = QStringLiteral("Option --vary can be given at most twice");
+                return result;
+            }
+            // Stages are resolved once the whole cascade has been read.
+            sweepAxes.append(args.at(i + 1));
+            i += 2;
+            continue;
+        }
+
+        if (!treatAsPositional && arg == QStringLiteral("--target")) {
+            const QString target = i + 1 < args.size() ? args.at(i + 1).toUpper() : QString();
+            if (target.size() != 3 || target.at(0) != QLatin1Char('S') ||
+                (target.at(1) != QLatin1Char('1') && target.at(1) != QLatin1Char('2')) ||
+                (target.at(2) != QLatin1Char('1') && target.at(2) != QLatin1Char('2'))) {
+                result.errorMessage = QStringLiteral("Option --target requires one of S11, S21, S12 or S22");
+                return result;
+            }
+            const int outputPort = target.at(1).digitValue() - 1;
+            const int inputPort = target.at(2).digitValue() - 1;
+            options.sweepTarget = inputPort * 2 + outputPort;
+            i += 2;
+            continue;
+        }
+
         if (!treatAsPositional && (arg == QStringLiteral("-c") || arg == QStringLiteral("--cascade"))) {
             ++i;
             if (i >= args.size()) {
@@ -330,6 +518,27 @@ CommandLineParser::ParseResult CommandLineParser::parse(int argc, char *argv[])
         ++i;
     }
 
+    // Stages are resolved once the whole cascade has been read; the ports are
+    // checked against the loaded networks.
+    for (const NetworkCascade::PortConnection& connection : options.portConnections) {
+        if (std::max(connection.stageA, connection.stageB) >= options.cascade.size()) {
+            result.errorMessage = QStringLiteral("--connect stage %1 is not a position in the cascade")
+                                      .arg(std::max(connection.stageA, connection.stageB) + 1);
+            return result;
+        }
+    }
+
+    if (!sweepAxes.isEmpty() && !options.noGui) {
+        result.errorMessage = QStringLiteral("Option --vary requires -n/--nogui");
+        return result;
+    }
+    for (const QString& text : sweepAxes) {
+        ParameterSweep::Axis axis;
+        if (!parseSweepAxis(text, options, axis, result.errorMessage))
+            return result;
+        options.sweepAxes.append(axis);
+    }
+
     result.ok = true;
     return result;
 }
@@ -348,8 +557,36 @@ QString CommandLineParser::helpText() const
         "                           optional parameter/value pairs.\n"
         "  -f, --freq <fmin> <fmax> <points>\n"
         "                           Set frequency range in Hz and number of points.\n"
-        "  -s, --save <file>        Save cascaded result to the specified .s2p file.\n"
+        "      --sweep <lin|log|native|adaptive>\n"
+        "                           Spacing of the cascade grid: linear (default),\n"
+        "                           logarithmic, the union of the files' own grids\n"
+        "                           within the range, or refined around sharp\n"
+        "                           features with <points> as the limit.\n"
+        "      --segments <list>    Sweep explicit segments fmin:fmax:points[:log],\n"
+        "                           separated by commas, instead of the range.\n"
+        "      --connect <list>     Join the cascade's networks port to port instead\n"
+        "                           of chaining them: stage:port-stage:port items\n"
+        "                           (stages from 1), separated by commas. Every\n"
+        "                           other port becomes a port of the result.\n"
+        "  -s, --save <file>        Save the cascaded result as a Touchstone file;\n"
+        "                           .sNp is appended for its port count if missing.\n"
+        "      --vary <stage>:<param>:<start>:<stop>:<points>[:log]\n"
+        "                           With --nogui, sweep a parameter of the lumped\n"
+        "                           network at cascade position <stage> (from 1),\n"
+        "                           named as in the list below or by number. Give it\n"
+        "                           twice for a two-dimensional sweep; --save then\n"
+        "                           writes the result grid as .csv.\n"
+        "      --target <Sij>       S-parameter of a --vary sweep (default S21).\n"
         "  -n, --nogui              Run without launching the GUI.\n"
+        "      --cache              Load files through binary .fsnpcache entries,\n"
+        "                           rebuilding missing or stale ones.\n"
+        "      --cache-dir <dir>    Keep cache entries in <dir> instead of next to\n"
+        "                           the source files (implies --cache).\n"
+        "      --warm-cache <dir>   Build cache entries for every Touchstone file\n"
+        "                           below <dir>, then exit.\n"
+        "      --stats              With --nogui, print cache diagnostics on exit.\n"
+        "      --threads <n>        Use at most <n> threads for parsing and cascade\n"
+        "                           evaluation (0, the default, uses every core).\n"
         "  -h, --help               Show this help message.\n"
         "\n"
         "Available lumped networks (case insensitive):\n"
@@ -367,6 +604,10 @@ QString CommandLineParser::helpText() const
         "\n"
         "Examples:\n"
         "  fsnpview example.s2p -c example.s2p R_series R 75\n"
-        "  fsnpview -n -c input.s2p TL len 2 Z0 75 er_eff 2.9 -f 1e6 1e9 1001 -s result.s2p\n");
+        "  fsnpview -n -c input.s2p TL len 2 Z0 75 er_eff 2.9 -f 1e6 1e9 1001 -s result.s2p\n"
+        "  fsnpview -n -c a.s4p b.s4p --connect 1:3-2:1,1:4-2:2 -s joined.s4p\n"
+        "  fsnpview --warm-cache measurements --cache-dir cache\n"
+        "  fsnpview -n -c input.s2p C_shunt 1 TL 5 -f 1e8 6e9 501 --vary 2:c:0.5:5:10:log\n"
+        "           --vary 3:len:1:20:20 --target S11 -s sweep.csv\n");
 }
 
@@ -5,7 +5,9 @@
 #include <QVector>
 #include <optional>
 
+#include "networkcascade.h"
 #include "networklumped.h"
+#include "parametersweep.h"
 
 class CommandLineParser
 {
@@ -41,8 +43,18 @@ public:
         double fmin = 0.0;
         double fmax = 0.0;
         int freqPoints = 0;
+        NetworkCascade::FrequencyPlan frequencyPlan = NetworkCascade::FrequencyPlan::Linear;
+        QVector<NetworkCascade::FrequencySegment> frequencySegments;
+        QVector<NetworkCascade::PortConnection> portConnections;    // from --connect, in cascade stage indices
         bool saveRequested = false;
         QString savePath;
+        bool useCache = false;
+        QString cacheDir;
+        QString warmCacheDir;
+        bool statsRequested = false;
+        QVector<ParameterSweep::Axis> sweepAxes;    // from --vary, in cascade stage indices
+        int sweepTarget = 1;                        // S-parameter column, S21 by default
+        int threads = 0;
         bool argumentsProvided = false;
     };
 
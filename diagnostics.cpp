@@ -0,0 +1,61 @@
+#include "diagnostics.h"
+#include "networkcascade.h"
+#include "plotdatacache.h"
+#include "tdrcalculator.h"
+#include "touchstone_registry.h"
+
+#include <QStringList>
+
+namespace {
+
+QString formatBytes(std::size_t bytes)
+{
+    if (bytes >= 1024 * 1024)
+        return QStringLiteral("%1 MiB").arg(static_cast<double>(bytes) / (1024.0 * 1024.0), 0, 'f', 1);
+    if (bytes >= 1024)
+        return QStringLiteral("%1 KiB").arg(static_cast<double>(bytes) / 1024.0, 0, 'f', 1);
+    return QStringLiteral("%1 B").arg(bytes);
+}
+
+QString formatHitRate(std::size_t hits, std::size_t misses, double rate)
+{
+    return QStringLiteral("%1 hits, %2 misses (%3% hit rate)")
+        .arg(hits)
+        .arg(misses)
+        .arg(rate * 100.0, 0, 'f', 1);
+}
+
+} // namespace
+
+QString diagnosticsReport()
+{
+    QStringList lines;
+
+    const ts::RegistryStats registry = ts::TouchstoneRegistry::instance().stats();
+    lines << QStringLiteral("Touchstone data registry: %1 shared file(s), %2")
+                 .arg(registry.entries)
+                 .arg(formatBytes(registry.bytes));
+    lines << QStringLiteral("  %1").arg(formatHitRate(registry.hits, registry.misses, registry.hit_rate()));
+
+    const PlotDataCache::Stats plots = PlotDataCache::instance().stats();
+    lines << QStringLiteral("Plot data cache: %1 entries, %2 of %3, %4 evicted")
+                 .arg(plots.entries)
+                 .arg(formatBytes(plots.bytes))
+                 .arg(formatBytes(plots.budget))
+                 .arg(plots.evictions);
+    lines << QStringLiteral("  %1").arg(formatHitRate(plots.hits, plots.misses, plots.hitRate()));
+
+    const NetworkCascade::EvaluationStats cascades = NetworkCascade::evaluationStats();
+    lines << QStringLiteral("Cascade stage responses: %1")
+                 .arg(formatHitRate(cascades.stageHits, cascades.stageMisses, cascades.stageHitRate()));
+    lines << QStringLiteral("Cascade results: %1")
+                 .arg(formatHitRate(cascades.resultHits, cascades.resultMisses, cascades.resultHitRate()));
+
+    const TDRCalculator::WorkspaceStats tdr = TDRCalculator::workspaceStats();
+    lines << QStringLiteral("TDR FFT workspaces: %1 idle, %2")
+                 .arg(tdr.idle)
+                 .arg(formatBytes(tdr.bytes));
+    lines << QStringLiteral("  %1").arg(formatHitRate(tdr.hits, tdr.misses, tdr.hitRate()));
+
+    return lines.join(QLatin1Char('\n'));
+}
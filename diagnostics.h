@@ -0,0 +1,10 @@
+#ifndef DIAGNOSTICS_H
+#define DIAGNOSTICS_H
+
+#include <QString>
+
+// Human-readable summary of the process-wide caches (hit rates, memory held),
+// shown by the GUI's diagnostics shortcut and by --stats.
+QString diagnosticsReport();
+
+#endif // DIAGNOSTICS_H
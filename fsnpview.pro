@@ -31,37 +31,63 @@ SOURCES += \
     main.cpp \
     mainwindow.cpp \
     parser_touchstone.cpp \
+    mappedfile.cpp \
+    threadpool.cpp \
+    touchstone_cache.cpp \
+    touchstone_registry.cpp \
     qcustomplot.cpp \
     server.cpp \
     network.cpp \
+    plotdatacache.cpp \
+    plotkernels.cpp \
     networkfile.cpp \
     networklumped.cpp \
     networkcascade.cpp \
+    cascadekernels.cpp \
+    networkparameters.cpp \
+    adaptivesampler.cpp \
+    networkconnection.cpp \
+    parametersweep.cpp \
     networkitemmodel.cpp \
     plotmanager.cpp \
     tdrcalculator.cpp \
     commandlineparser.cpp \
     parameterstyledialog.cpp \
+    parametersweepdialog.cpp \
     plotsettingsdialog.cpp \
-    cascadeio.cpp
+    cascadeio.cpp \
+    diagnostics.cpp
 
 HEADERS += \
     SmithChartGrid.h \
     mainwindow.h \
     parser_touchstone.h \
+    mappedfile.h \
+    threadpool.h \
+    touchstone_cache.h \
+    touchstone_registry.h \
     qcustomplot.h \
     server.h \
     network.h \
+    plotdatacache.h \
+    plotkernels.h \
     networkfile.h \
     networklumped.h \
     networkcascade.h \
+    cascadekernels.h \
+    networkparameters.h \
+    adaptivesampler.h \
+    networkconnection.h \
+    parametersweep.h \
     networkitemmodel.h \
     plotmanager.h \
     tdrcalculator.h \
     commandlineparser.h \
     parameterstyledialog.h \
+    parametersweepdialog.h \
     plotsettingsdialog.h \
-    cascadeio.h
+    cascadeio.h \
+    diagnostics.h
 
 FORMS += \
     mainwindow.ui
@@ -4,6 +4,9 @@
 #include "networkfile.h"
 #include "networklumped.h"
 #include "cascadeio.h"
+#include "diagnostics.h"
+#include "parametersweep.h"
+#include "touchstone_cache.h"
 
 #include <QApplication>
 #include <QCoreApplication>
@@ -39,9 +42,13 @@ std::unique_ptr<Network> createNetworkForCascade(const CommandLineParser::Cascad
     if (entry.type == CommandLineParser::CascadeEntry::Type::File) {
         const QString resolvedPath = resolvePath(entry.identifier);
         auto network = std::make_unique<NetworkFile>(resolvedPath);
-        if (network->portCount() <= 0) {
+        // The constructor only probes the header; a broken body shows up here.
+        network->load();
+        if (!network->loadError().isEmpty() || network->portCount() <= 0) {
             if (error) {
                 *error = QStringLiteral("Failed to load network file '%1'").arg(resolvedPath);
+                if (!network->loadError().isEmpty())
+                    *error += QStringLiteral(": %1").arg(network->loadError());
             }
             return nullptr;
         }
@@ -65,16 +72,14 @@ std::unique_ptr<Network> createNetworkForCascade(const CommandLineParser::Cascad
 
 Eigen::VectorXd buildFrequencyVector(const CommandLineParser::Options& options, const NetworkCascade& cascade)
 {
-    if (options.freqSpecified) {
-        return Eigen::VectorXd::LinSpaced(options.freqPoints, options.fmin, options.fmax);
-    }
-    const double fmin = cascade.fmin();
-    const double fmax = cascade.fmax();
-    const int points = std::max(cascade.pointCount(), 2);
-    if (fmax <= fmin) {
-        return Eigen::VectorXd::LinSpaced(points, 1e6, 10e9);
+    const NetworkCascade::FrequencyPlan plan = options.frequencyPlan;
+    if (options.freqSpecified && (plan == NetworkCascade::FrequencyPlan::Linear ||
+                                  plan == NetworkCascade::FrequencyPlan::Logarithmic)) {
+        return NetworkCascade::sweepFrequencies(options.fmin, options.fmax, options.freqPoints,
+                                                plan == NetworkCascade::FrequencyPlan::Logarithmic);
     }
-    return Eigen::VectorXd::LinSpaced(points, fmin, fmax);
+    // Native grids and segments are resolved against the cascade's stages.
+    return cascade.frequencyVector();
 }
 
 int runNoGui(const CommandLineParser::Options& options)
@@ -82,8 +87,12 @@ int runNoGui(const CommandLineParser::Options& options)
     for (const QString& file : options.files) {
         const QString resolved = resolvePath(file);
         NetworkFile network(resolved);
-        if (network.portCount() <= 0) {
-            std::cerr << "Failed to load file '" << resolved.toStdString() << "'." << std::endl;
+        network.load();
+        if (!network.loadError().isEmpty() || network.portCount() <= 0) {
+            std::cerr << "Failed to load file '" << resolved.toStdString() << "'";
+            if (!network.loadError().isEmpty())
+                std::cerr << ": " << network.loadError().toStdString();
+            std::cerr << "." << std::endl;
             return 1;
         }
         std::cout << "Loaded file \"" << resolved.toStdString() << "\"." << std::endl;
@@ -102,6 +111,8 @@ int runNoGui(const CommandLineParser::Options& options)
         cascade.setFrequencyRange(options.fmin, options.fmax);
         cascade.setPointCount(options.freqPoints);
     }
+    cascade.setFrequencyPlan(options.frequencyPlan);
+    cascade.setFrequencySegments(options.frequencySegments);
 
     std::vector<std::unique_ptr<Network>> cascadeNetworks;
     cascadeNetworks.reserve(options.cascade.size());
@@ -123,10 +134,36 @@ int runNoGui(const CommandLineParser::Options& options)
         return 1;
     }
 
+    if (!options.portConnections.isEmpty() && !cascade.setPortConnections(options.portConnections)) {
+        std::cerr << "Invalid --connect: a port does not exist or is connected twice." << std::endl;
+        cascade.clearNetworks();
+        return 1;
+    }
+
     Eigen::VectorXd freq = buildFrequencyVector(options, cascade);
 
     int exitCode = 0;
-    if (options.saveRequested) {
+    if (!options.sweepAxes.isEmpty()) {
+        const ParameterSweep::Result sweep = ParameterSweep::run(cascade, options.sweepAxes, options.sweepTarget, freq);
+        if (!sweep.ok()) {
+            std::cerr << sweep.error.toStdString() << std::endl;
+            exitCode = 1;
+        } else if (options.saveRequested) {
+            QString savedPath;
+            QString errorMessage;
+            if (saveSweepToFile(sweep, options.savePath, &savedPath, &errorMessage)) {
+                std::cout << "Sweep of " << sweep.combinationCount() << " combination(s) saved to \""
+                          << savedPath.toStdString() << "\"" << std::endl;
+            } else {
+                if (!errorMessage.isEmpty())
+                    std::cerr << errorMessage.toStdString() << std::endl;
+                exitCode = 1;
+            }
+        } else {
+            std::cout << "Sweep evaluated " << sweep.combinationCount() << " combination(s) at "
+                      << sweep.freq.size() << " frequency point(s)." << std::endl;
+        }
+    } else if (options.saveRequested) {
         QString savedPath;
         QString errorMessage;
         if (saveCascadeToFile(cascade, freq, options.savePath, &savedPath, &errorMessage)) {
@@ -145,6 +182,17 @@ int runNoGui(const CommandLineParser::Options& options)
     return exitCode;
 }
 
+int runWarmCache(const CommandLineParser::Options& options)
+{
+    const std::string directory = resolvePath(options.warmCacheDir).toStdString();
+    const std::string cacheDir = options.cacheDir.isEmpty() ? std::string() : resolvePath(options.cacheDir).toStdString();
+    const ts::CacheWarmStats stats = ts::warm_cache(directory, cacheDir);
+    std::cout << "Cache warm for \"" << directory << "\": " << stats.files << " file(s), "
+              << stats.built << " built, " << stats.up_to_date << " up to date, "
+              << stats.failed << " failed." << std::endl;
+    return stats.failed == 0 ? 0 : 1;
+}
+
 QStringList collectFilesToOpen(const CommandLineParser::Options& options)
 {
     QStringList files = options.files;
@@ -185,6 +233,11 @@ bool configureCascadeForWindow(MainWindow& window, const CommandLineParser::Opti
         window.addNetworkToCascade(raw);
     }
 
+    if (!options.portConnections.isEmpty() && !window.cascade()->setPortConnections(options.portConnections)) {
+        std::cerr << "Invalid --connect: a port does not exist or is connected twice." << std::endl;
+        return false;
+    }
+
     if (options.freqSpecified) {
         window.setCascadeFrequencyRange(options.fmin, options.fmax);
         window.setCascadePointCount(options.freqPoints);
@@ -213,9 +266,30 @@ int main(int argc, char *argv[])
         return 0;
     }
 
+    if (options.useCache) {
+        ts::ParseOptions parseOptions = NetworkFile::parseOptions();
+        parseOptions.use_cache = true;
+        if (!options.cacheDir.isEmpty())
+            parseOptions.cache_dir = resolvePath(options.cacheDir).toStdString();
+        NetworkFile::setParseOptions(parseOptions);
+    }
+
+    if (options.threads > 0) {
+        ts::ParseOptions parseOptions = NetworkFile::parseOptions();
+        parseOptions.threads = static_cast<unsigned>(options.threads);
+        NetworkFile::setParseOptions(parseOptions);
+        NetworkCascade::setThreadCount(static_cast<unsigned>(options.threads));
+    }
+
+    if (!options.warmCacheDir.isEmpty())
+        return runWarmCache(options);
+
     if (options.noGui) {
         QCoreApplication app(argc, argv);
-        return runNoGui(options);
+        const int exitCode = runNoGui(options);
+        if (options.statsRequested)
+            std::cout << diagnosticsReport().toStdString() << std::endl;
+        return exitCode;
     }
 
 #ifdef Q_OS_WIN
@@ -269,6 +343,7 @@ int main(int argc, char *argv[])
                                        options.fmax,
                                        options.freqPoints,
                                        !filesToOpen.isEmpty());
+    window.setCascadeFrequencyPlan(options.frequencyPlan, options.frequencySegments);
 
     if (!configureCascadeForWindow(window, options)) {
 #ifdef Q_OS_WIN
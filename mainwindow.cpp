@@ -7,8 +7,11 @@
 #include "server.h"
 #include "plotmanager.h"
 #include "parameterstyledialog.h"
+#include "parametersweepdialog.h"
 #include "cascadeio.h"
+#include "diagnostics.h"
 #include <QFileDialog>
+#include <QInputDialog>
 #include <QMenuBar>
 #include <QCheckBox>
 #include <QSet>
@@ -44,14 +47,56 @@
 #include <QMessageBox>
 #include <QDir>
 #include <QWidget>
+#include <QDirIterator>
+#include <QFileInfo>
+#include <QMimeData>
+#include <QDragEnterEvent>
+#include <QDropEvent>
+#include <QUrl>
+#include <QRegularExpression>
+#include <QThread>
+#include <QThreadPool>
+#include <QPointer>
+#include <QProgressBar>
+#include <QToolButton>
 
 #include <algorithm>
+#include <atomic>
 #include <cmath>
 #include <limits>
+#include <memory>
 #include <utility>
 
 namespace {
 
+bool isTouchstoneFileName(const QString& fileName)
+{
+    static const QRegularExpression pattern(QStringLiteral("\\.s\\d+p$"), QRegularExpression::CaseInsensitiveOption);
+    return pattern.match(fileName).hasMatch();
+}
+
+// Replaces each directory by the Touchstone files found below it.
+QStringList expandTouchstonePaths(const QStringList& paths)
+{
+    QStringList files;
+    for (const QString& path : paths) {
+        if (!QFileInfo(path).isDir()) {
+            files.append(path);
+            continue;
+        }
+        QStringList found;
+        QDirIterator it(path, QDir::Files, QDirIterator::Subdirectories);
+        while (it.hasNext()) {
+            const QString file = it.next();
+            if (isTouchstoneFileName(file))
+                found.append(file);
+        }
+        found.sort();
+        files.append(found);
+    }
+    return files;
+}
+
 class SelectionBoldDelegate : public QStyledItemDelegate
 {
 public:
@@ -75,9 +120,21 @@ constexpr int ColumnTo = 3;
 constexpr int ColumnFrom = 4;
 constexpr int ColumnFirstParameterDescription = 5;
 constexpr int ColumnFirstParameterValue = 6;
+// The files table: check, color, name, fmin, fmax, pts.
+constexpr int ColumnFilePoints = 5;
 
 } // namespace
 
+// Files handed to one processFiles call, plus any added while it is running.
+// Workers only read `cancelled`; the counters belong to the GUI thread.
+struct MainWindow::FileLoadBatch
+{
+    std::atomic<bool> cancelled{false};
+    int total = 0;
+    int finished = 0;
+    bool autoscale = false;
+};
+
 MainWindow::MainWindow(QWidget *parent)
     : QMainWindow(parent)
     , ui(new Ui::MainWindow)
@@ -95,6 +152,11 @@ MainWindow::MainWindow(QWidget *parent)
     , m_mouseWheelMultiplier(1.1)
     , m_cascadeStatusIconContainer(nullptr)
     , m_cascadeStatusIconLayout(nullptr)
+    , m_loadPool(new QThreadPool(this))
+    , m_loadProgress(nullptr)
+    , m_loadCancelButton(nullptr)
+    , m_updatePlotsTimer(new QTimer(this))
+    , m_detectFrequenciesAfterLoad(false)
 {
     ui->setupUi(this);
     if (QMenuBar* bar = menuBar())
@@ -117,6 +179,23 @@ MainWindow::MainWindow(QWidget *parent)
     m_cascadeStatusIconLayout->setSpacing(0);
     ui->statusbar->addWidget(m_cascadeStatusIconContainer, 0);
 
+    m_loadProgress = new QProgressBar(ui->statusbar);
+    m_loadProgress->setMaximumWidth(200);
+    m_loadProgress->setFormat(tr("Loading %v/%m"));
+    m_loadCancelButton = new QToolButton(ui->statusbar);
+    m_loadCancelButton->setText(tr("Cancel"));
+    connect(m_loadCancelButton, &QToolButton::clicked, this, &MainWindow::cancelFileLoading);
+    ui->statusbar->addPermanentWidget(m_loadProgress);
+    ui->statusbar->addPermanentWidget(m_loadCancelButton);
+    m_loadProgress->setVisible(false);
+    m_loadCancelButton->setVisible(false);
+
+    // Files finish loading in bursts; redraw at most once per interval meanwhile.
+    m_updatePlotsTimer->setSingleShot(true);
+    m_updatePlotsTimer->setInterval(50);
+    connect(m_updatePlotsTimer, &QTimer::timeout, this, &MainWindow::updatePlots);
+    setAcceptDrops(true);
+
     ui->splitter_3->setStretchFactor(0, 0);
     ui->splitter_3->setStretchFactor(1, 1);
     ui->splitter_2->setStretchFactor(0, 0);
@@ -167,7 +246,7 @@ MainWindow::MainWindow(QWidget *parent)
     ui->tableViewNetworkLumped->viewport()->installEventFilter(this);
     ui->tableViewCascade->viewport()->installEventFilter(this);
 
-    m_plot_manager->setNetworks(m_networks);
+    updatePlotNetworks();
     m_plot_manager->setCascade(m_cascade);
 
     connect(ui->widgetGraph, &QCustomPlot::selectionChangedByUser,
@@ -207,6 +286,10 @@ MainWindow::MainWindow(QWidget *parent)
 
 MainWindow::~MainWindow()
 {
+    if (m_loadBatch)
+        m_loadBatch->cancelled = true;
+    m_loadPool->clear();
+    m_loadPool->waitForDone();
     delete ui;
     qDeleteAll(m_networks);
 }
@@ -218,6 +301,33 @@ void MainWindow::setupShortcuts()
 
     auto *saveShortcut = new QShortcut(QKeySequence::Save, this);
     connect(saveShortcut, &QShortcut::activated, this, &MainWindow::onSaveCascadeTriggered);
+
+    auto *diagnosticsShortcut = new QShortcut(QKeySequence(Qt::CTRL | Qt::SHIFT | Qt::Key_D), this);
+    connect(diagnosticsShortcut, &QShortcut::activated, this, &MainWindow::showDiagnostics);
+
+    auto *sweepShortcut = new QShortcut(QKeySequence(Qt::CTRL | Qt::SHIFT | Qt::Key_P), this);
+    connect(sweepShortcut, &QShortcut::activated, this, &MainWindow::showParameterSweep);
+}
+
+void MainWindow::showDiagnostics()
+{
+    QMessageBox::information(this, tr("Diagnostics"), diagnosticsReport());
+}
+
+void MainWindow::showParameterSweep()
+{
+    const QList<Network*>& networks = m_cascade->getNetworks();
+    const bool hasLumped = std::any_of(networks.begin(), networks.end(), [](Network* network) {
+        return dynamic_cast<NetworkLumped*>(network) != nullptr;
+    });
+    if (!hasLumped) {
+        QMessageBox::information(this, tr("Parameter Sweep"),
+                                 tr("Add a lumped network to the cascade to sweep its parameters."));
+        return;
+    }
+
+    ParameterSweepDialog dialog(m_cascade, this);
+    dialog.exec();
 }
 
 void MainWindow::setupModels()
@@ -285,6 +395,26 @@ void MainWindow::resizeEvent(QResizeEvent *event)
     updateNetworkTablesGeometry();
 }
 
+void MainWindow::dragEnterEvent(QDragEnterEvent *event)
+{
+    if (event->mimeData()->hasUrls())
+        event->acceptProposedAction();
+}
+
+void MainWindow::dropEvent(QDropEvent *event)
+{
+    // Folders are expanded recursively by processFiles().
+    QStringList paths;
+    for (const QUrl& url : event->mimeData()->urls()) {
+        if (url.isLocalFile())
+            paths << url.toLocalFile();
+    }
+    if (paths.isEmpty())
+        return;
+    event->acceptProposedAction();
+    processFiles(paths);
+}
+
 void MainWindow::updateNetworkTablesGeometry()
 {
     int filesHeight = adjustTableViewToContents(ui->tableViewNetworkFiles);
@@ -479,45 +609,221 @@ void MainWindow::populateLumpedNetworkTable()
 
 void MainWindow::processFiles(const QStringList &files, bool autoscale)
 {
-    for (const QString &file : files) {
-        Network* network = new NetworkFile(file);
-        network->setColor(m_plot_manager->nextColor());
-        QList<QStandardItem*> row;
-        QStandardItem* checkItem = new QStandardItem();
-        checkItem->setCheckable(true);
-        checkItem->setCheckState(Qt::Checked);
-        checkItem->setData(QVariant::fromValue(reinterpret_cast<quintptr>(network)), Qt::UserRole);
-        row.append(checkItem);
+    const QStringList paths = expandTouchstonePaths(files);
+    if (paths.isEmpty())
+        return;
 
-        QStandardItem* colorItem = new QStandardItem();
-        colorItem->setFlags(Qt::ItemIsEnabled | Qt::ItemIsSelectable);
-        colorItem->setBackground(network->color());
-        row.append(colorItem);
+    // Files dropped while a load is running join that load.
+    if (!m_loadBatch) {
+        m_loadBatch = std::make_shared<FileLoadBatch>();
+        m_loadProgress->setValue(0);
+        m_loadProgress->setVisible(true);
+        m_loadCancelButton->setVisible(true);
+    }
+    const std::shared_ptr<FileLoadBatch> batch = m_loadBatch;
+    batch->total += paths.size();
+    batch->autoscale = batch->autoscale || autoscale;
+    m_loadProgress->setRange(0, batch->total);
+
+    QThread* guiThread = thread();
+    for (const QString& path : paths) {
+        m_loadPool->start([this, batch, path, guiThread] {
+            NetworkFile* network = nullptr;
+            if (!batch->cancelled) {
+                // Only probes the header, so the row does not wait for the parse.
+                network = new NetworkFile(path);
+                network->moveToThread(guiThread);
+            }
+            QMetaObject::invokeMethod(this, [this, batch, network] { onFileProbed(batch, network); }, Qt::QueuedConnection);
+        });
+    }
+}
 
-        QStandardItem* nameItem = new QStandardItem(network->name());
-        nameItem->setFlags(Qt::ItemIsEnabled | Qt::ItemIsSelectable);
-        row.append(nameItem);
+bool MainWindow::isLoadingFiles() const
+{
+    return m_loadBatch != nullptr;
+}
 
-        auto makeInfoItem = [](const QString& text) {
-            QStandardItem* item = new QStandardItem(text);
-            item->setFlags(Qt::ItemIsEnabled | Qt::ItemIsSelectable);
-            return item;
-        };
+void MainWindow::cancelFileLoading()
+{
+    if (!m_loadBatch)
+        return;
+    m_loadBatch->cancelled = true;
+    m_loadPool->clear();
+    // Rows whose parse has not finished go with the load.
+    const QList<Network*> networks = m_networks;
+    for (Network* network : networks) {
+        if (m_pendingLoads.contains(network))
+            removeNetworkFileRow(static_cast<NetworkFile*>(network));
+    }
+    m_pendingLoads.clear();
+    finishFileLoading();
+}
 
-        row.append(makeInfoItem(Network::formatEngineering(network->fmin())));
-        row.append(makeInfoItem(Network::formatEngineering(network->fmax())));
+void MainWindow::onFileProbed(const std::shared_ptr<FileLoadBatch>& batch, NetworkFile* network)
+{
+    if (batch != m_loadBatch) {
+        // Probed after its batch was cancelled.
+        delete network;
+        return;
+    }
+    if (!network || !network->loadError().isEmpty() || network->portCount() <= 0) {
+        if (network)
+            reportFileLoadError(network->filePath(), network->loadError());
+        delete network;
+        fileLoadFinished(batch);
+        return;
+    }
 
-        const QVector<double> freqs = network->frequencies();
-        const int freqCount = freqs.size();
-        row.append(makeInfoItem(QString::number(freqCount)));
+    m_pendingLoads.insert(network);
+    appendNetworkFileRow(network);
+
+    // The parse runs on a NetworkFile of its own, so the row may be removed
+    // meanwhile; while the loader lives, the row's load() is a registry hit.
+    const QPointer<NetworkFile> guarded(network);
+    const QString path = network->filePath();
+    QThread* guiThread = thread();
+    m_loadPool->start([this, batch, guarded, path, guiThread] {
+        std::shared_ptr<NetworkFile> loader;
+        if (!batch->cancelled) {
+            loader = std::make_shared<NetworkFile>(path);
+            loader->load();
+            loader->moveToThread(guiThread);
+        }
+        // Moved, so the loader is destroyed on the GUI thread it now belongs to.
+        QMetaObject::invokeMethod(this, [this, batch, guarded, loader = std::move(loader)] {
+            onFileLoaded(batch, guarded, loader);
+        }, Qt::QueuedConnection);
+    });
+}
 
-        m_network_files_model->appendRow(row);
-        m_networks.append(network);
+void MainWindow::onFileLoaded(const std::shared_ptr<FileLoadBatch>& batch, const QPointer<NetworkFile>& network,
+                              const std::shared_ptr<NetworkFile>& loader)
+{
+    // Without a loader the batch was cancelled, and its rows went with it.
+    if (network && loader) {
+        m_pendingLoads.remove(network.data());
+        if (loader->loadError().isEmpty()) {
+            network->load();
+            // The probe's point count was an estimate.
+            if (QStandardItem* points = m_network_files_model->item(networkFileRow(network), ColumnFilePoints))
+                points->setText(QString::number(network->pointCount()));
+            updatePlotNetworks();
+            scheduleUpdatePlots();
+        } else {
+            reportFileLoadError(network->filePath(), loader->loadError());
+            removeNetworkFileRow(network);
+        }
     }
-    applyPhaseUnwrapSetting(ui->checkBoxPhaseUnwrap->isChecked());
-    m_plot_manager->setNetworks(m_networks);
+    if (batch == m_loadBatch)
+        fileLoadFinished(batch);
+}
+
+void MainWindow::reportFileLoadError(const QString& path, const QString& error)
+{
+    if (QStatusBar* bar = statusBar())
+        bar->showMessage(tr("Failed to load \"%1\": %2").arg(QDir::toNativeSeparators(path), error), 10000);
+}
+
+void MainWindow::fileLoadFinished(const std::shared_ptr<FileLoadBatch>& batch)
+{
+    ++batch->finished;
+    m_loadProgress->setValue(batch->finished);
+    if (batch->finished == batch->total)
+        finishFileLoading();
+}
+
+void MainWindow::appendNetworkFileRow(NetworkFile* network)
+{
+    network->setColor(m_plot_manager->nextColor());
+    network->setUnwrapPhase(ui->checkBoxPhaseUnwrap->isChecked());
+    QList<QStandardItem*> row;
+    QStandardItem* checkItem = new QStandardItem();
+    checkItem->setCheckable(true);
+    checkItem->setCheckState(Qt::Checked);
+    checkItem->setData(QVariant::fromValue(reinterpret_cast<quintptr>(static_cast<Network*>(network))), Qt::UserRole);
+    row.append(checkItem);
+
+    QStandardItem* colorItem = new QStandardItem();
+    colorItem->setFlags(Qt::ItemIsEnabled | Qt::ItemIsSelectable);
+    colorItem->setBackground(network->color());
+    row.append(colorItem);
+
+    QStandardItem* nameItem = new QStandardItem(network->name());
+    nameItem->setFlags(Qt::ItemIsEnabled | Qt::ItemIsSelectable);
+    row.append(nameItem);
+
+    auto makeInfoItem = [](const QString& text) {
+        QStandardItem* item = new QStandardItem(text);
+        item->setFlags(Qt::ItemIsEnabled | Qt::ItemIsSelectable);
+        return item;
+    };
+
+    row.append(makeInfoItem(Network::formatEngineering(network->fmin())));
+    row.append(makeInfoItem(Network::formatEngineering(network->fmax())));
+    row.append(makeInfoItem(QString::number(network->pointCount())));
+
+    m_network_files_model->appendRow(row);
+    m_networks.append(network);
+    updatePlotNetworks();
+    scheduleUpdatePlots();
+}
+
+int MainWindow::networkFileRow(const NetworkFile* network) const
+{
+    const quintptr key = reinterpret_cast<quintptr>(static_cast<const Network*>(network));
+    for (int row = 0; row < m_network_files_model->rowCount(); ++row) {
+        const QStandardItem* item = m_network_files_model->item(row, ColumnCheck);
+        if (item && item->data(Qt::UserRole).value<quintptr>() == key)
+            return row;
+    }
+    return -1;
+}
+
+void MainWindow::updatePlotNetworks()
+{
+    QList<Network*> ready;
+    for (Network* network : qAsConst(m_networks)) {
+        if (!m_pendingLoads.contains(network))
+            ready.append(network);
+    }
+    m_plot_manager->setNetworks(ready);
+}
+
+void MainWindow::removeNetworkFileRow(NetworkFile* network)
+{
+    const int row = networkFileRow(network);
+    if (row >= 0)
+        m_network_files_model->removeRow(row);
+    m_networks.removeOne(network);
+    updatePlotNetworks();
+    delete network;
+    scheduleUpdatePlots();
+}
+
+void MainWindow::finishFileLoading()
+{
+    const bool autoscale = m_loadBatch && m_loadBatch->autoscale;
+    m_loadBatch.reset();
+    m_loadProgress->setVisible(false);
+    m_loadCancelButton->setVisible(false);
+
+    m_updatePlotsTimer->stop();
     updatePlots();
-    if(autoscale) m_plot_manager->autoscale();
+    if (autoscale)
+        m_plot_manager->autoscale();
+
+    if (m_detectFrequenciesAfterLoad) {
+        m_detectFrequenciesAfterLoad = false;
+        applyDetectedNetworkFrequencies();
+        refreshNetworkFrequencyControls();
+    }
+}
+
+void MainWindow::scheduleUpdatePlots()
+{
+    if (!m_updatePlotsTimer->isActive())
+        m_updatePlotsTimer->start();
 }
 
 void MainWindow::clearCascade()
@@ -612,7 +918,17 @@ Eigen::VectorXd MainWindow::cascadeFrequencyVector() const
         }
     }
 
-    return Eigen::VectorXd::LinSpaced(points, fmin, fmax);
+    switch (m_cascade->frequencyPlan()) {
+    case NetworkCascade::FrequencyPlan::Linear:
+    case NetworkCascade::FrequencyPlan::Logarithmic:
+        return NetworkCascade::sweepFrequencies(fmin, fmax, points,
+                                                m_cascade->frequencyPlan() == NetworkCascade::FrequencyPlan::Logarithmic);
+    case NetworkCascade::FrequencyPlan::Native:
+    case NetworkCascade::FrequencyPlan::Segments:
+    case NetworkCascade::FrequencyPlan::Adaptive:
+        break;
+    }
+    return m_cascade->frequencyVector();
 }
 
 void MainWindow::setCascadeFrequencyRange(double fmin, double fmax)
@@ -642,6 +958,25 @@ void MainWindow::setCascadePointCount(int pointCount)
     updatePlots();
 }
 
+void MainWindow::setCascadeFrequencyPlan(NetworkCascade::FrequencyPlan plan,
+                                         const QVector<NetworkCascade::FrequencySegment>& segments)
+{
+    if (!m_cascade)
+        return;
+    m_cascade->setFrequencyPlan(plan);
+    if (!segments.isEmpty())
+        m_cascade->setFrequencySegments(segments);
+
+    // Lumped elements plotted on their own follow the adaptive plan too.
+    const bool adaptive = plan == NetworkCascade::FrequencyPlan::Adaptive;
+    for (Network* network : qAsConst(m_networks)) {
+        if (auto lumped = dynamic_cast<NetworkLumped*>(network))
+            lumped->setAdaptiveSampling(adaptive);
+    }
+    refreshNetworkFrequencyControls();
+    updatePlots();
+}
+
 void MainWindow::initializeFrequencyControls(bool freqSpecified, double fmin, double fmax, int pointCount, bool hasInitialFiles)
 {
     if (m_initialFrequencyConfigured)
@@ -654,41 +989,51 @@ void MainWindow::initializeFrequencyControls(bool freqSpecified, double fmin, do
     } else if (freqSpecified) {
         updateNetworkFrequencySettings(m_cascade->fmin(), m_cascade->fmax(), m_cascade->pointCount(), true);
     } else if (hasInitialFiles) {
-        double detectedMin = std::numeric_limits<double>::max();
-        double detectedMax = std::numeric_limits<double>::lowest();
-        int detectedPoints = 0;
-        bool anyFrequencies = false;
+        // Initial files may still be loading; detect their range once they are in.
+        if (isLoadingFiles())
+            m_detectFrequenciesAfterLoad = true;
+        else
+            applyDetectedNetworkFrequencies();
+    } else {
+        updateNetworkFrequencySettings(m_cascade->fmin(), m_cascade->fmax(), m_cascade->pointCount(), true);
+    }
 
-        for (Network* network : qAsConst(m_networks)) {
-            if (!network)
-                continue;
+    refreshNetworkFrequencyControls();
+    m_initialFrequencyConfigured = true;
+}
 
-            if (!dynamic_cast<NetworkFile*>(network))
-                continue;
+void MainWindow::applyDetectedNetworkFrequencies()
+{
+    double detectedMin = std::numeric_limits<double>::max();
+    double detectedMax = std::numeric_limits<double>::lowest();
+    int detectedPoints = 0;
+    bool anyFrequencies = false;
 
-            const QVector<double> freqs = network->frequencies();
-            if (freqs.isEmpty())
-                continue;
+    for (Network* network : qAsConst(m_networks)) {
+        if (!network)
+            continue;
 
-            anyFrequencies = true;
-            detectedMin = std::min(detectedMin, network->fmin());
-            detectedMax = std::max(detectedMax, network->fmax());
-            detectedPoints = std::max(detectedPoints, static_cast<int>(freqs.size()));
-        }
+        auto* fileNetwork = dynamic_cast<NetworkFile*>(network);
+        if (!fileNetwork)
+            continue;
 
-        if (anyFrequencies && detectedMax > detectedMin) {
-            if (detectedPoints < 2)
-                detectedPoints = 2;
-            updateNetworkFrequencySettings(detectedMin, detectedMax, detectedPoints, true);
-        } else {
-            updateNetworkFrequencySettings(m_cascade->fmin(), m_cascade->fmax(), m_cascade->pointCount(), true);
-        }
+        const int pointCount = fileNetwork->pointCount();
+        if (pointCount <= 0)
+            continue;
+
+        anyFrequencies = true;
+        detectedMin = std::min(detectedMin, network->fmin());
+        detectedMax = std::max(detectedMax, network->fmax());
+        detectedPoints = std::max(detectedPoints, pointCount);
+    }
+
+    if (anyFrequencies && detectedMax > detectedMin) {
+        if (detectedPoints < 2)
+            detectedPoints = 2;
+        updateNetworkFrequencySettings(detectedMin, detectedMax, detectedPoints, true);
     } else {
         updateNetworkFrequencySettings(m_cascade->fmin(), m_cascade->fmax(), m_cascade->pointCount(), true);
     }
-
-    refreshNetworkFrequencyControls();
-    m_initialFrequencyConfigured = true;
 }
 
 NetworkCascade* MainWindow::cascade() const
@@ -814,6 +1159,12 @@ void MainWindow::updatePlots()
         type = PlotType::VSWR;
     else if (ui->checkBoxSmith->isChecked())
         type = PlotType::Smith;
+    else if (ui->checkBoxZ->isChecked())
+        type = PlotType::Impedance;
+    else if (ui->checkBoxY->isChecked())
+        type = PlotType::Admittance;
+    else if (ui->checkBoxRenorm->isChecked())
+        type = PlotType::Renormalized;
 
     m_plot_manager->updatePlots(checked_sparams, type);
 }
@@ -1352,6 +1703,18 @@ void MainWindow::refreshNetworkFrequencyControls()
         QSignalBlocker blocker(ui->lineEditNpointsNetworks);
         ui->lineEditNpointsNetworks->setText(QString::number(std::max(m_networkFrequencyPoints, 2)));
     }
+    if (m_cascade) {
+        QSignalBlocker blocker(ui->comboBoxSweepNetworks);
+        ui->comboBoxSweepNetworks->setCurrentIndex(static_cast<int>(m_cascade->frequencyPlan()));
+        const bool segments = m_cascade->frequencyPlan() == NetworkCascade::FrequencyPlan::Segments;
+        ui->comboBoxSweepNetworks->setToolTip(segments
+            ? NetworkCascade::formatFrequencySegments(m_cascade->frequencySegments())
+            : tr("Spacing of the cascade frequency grid"));
+        // Segments carry their own ranges and point counts.
+        ui->lineEditFminNetworks->setEnabled(!segments);
+        ui->lineEditFmaxNetworks->setEnabled(!segments);
+        ui->lineEditNpointsNetworks->setEnabled(!segments);
+    }
 }
 
 void MainWindow::updateNetworkFrequencySettings(double fmin, double fmax, int pointCount, bool manualOverride)
@@ -1621,6 +1984,7 @@ void MainWindow::keyPressEvent(QKeyEvent *event)
 
                     m_network_files_model->removeRow(index.row());
                     m_networks.removeOne(network);
+                    m_pendingLoads.remove(network);
                     delete network;
                     networksChanged = true;
                 }
@@ -1677,7 +2041,7 @@ void MainWindow::keyPressEvent(QKeyEvent *event)
         }
 
         if (networksChanged) {
-            m_plot_manager->setNetworks(m_networks);
+            updatePlotNetworks();
             plotsNeedUpdate = true;
         }
 
@@ -1749,12 +2113,8 @@ void MainWindow::on_checkBoxS33_checkStateChanged(const Qt::CheckState &arg1)
 void MainWindow::on_checkBoxPhase_checkStateChanged(const Qt::CheckState &arg1)
 {
     Q_UNUSED(arg1);
-    if (ui->checkBoxPhase->isChecked()) {
-        ui->checkBoxVSWR->setChecked(false);
-        ui->checkBoxSmith->setChecked(false);
-        ui->checkBoxTDR->setChecked(false);
-        ui->checkBoxGroupDelay->setChecked(false);
-    }
+    if (ui->checkBoxPhase->isChecked())
+        uncheckOtherViews(ui->checkBoxPhase);
     updatePlots();
 }
 
@@ -1768,36 +2128,24 @@ void MainWindow::on_checkBoxPhaseUnwrap_stateChanged(int state)
 void MainWindow::on_checkBoxGroupDelay_checkStateChanged(const Qt::CheckState &arg1)
 {
     Q_UNUSED(arg1);
-    if (ui->checkBoxGroupDelay->isChecked()) {
-        ui->checkBoxPhase->setChecked(false);
-        ui->checkBoxVSWR->setChecked(false);
-        ui->checkBoxSmith->setChecked(false);
-        ui->checkBoxTDR->setChecked(false);
-    }
+    if (ui->checkBoxGroupDelay->isChecked())
+        uncheckOtherViews(ui->checkBoxGroupDelay);
     updatePlots();
 }
 
 void MainWindow::on_checkBoxVSWR_checkStateChanged(const Qt::CheckState &arg1)
 {
     Q_UNUSED(arg1);
-    if (ui->checkBoxVSWR->isChecked()) {
-        ui->checkBoxPhase->setChecked(false);
-        ui->checkBoxSmith->setChecked(false);
-        ui->checkBoxTDR->setChecked(false);
-        ui->checkBoxGroupDelay->setChecked(false);
-    }
+    if (ui->checkBoxVSWR->isChecked())
+        uncheckOtherViews(ui->checkBoxVSWR);
     updatePlots();
 }
 
 void MainWindow::on_checkBoxSmith_checkStateChanged(const Qt::CheckState &arg1)
 {
     Q_UNUSED(arg1);
-    if (ui->checkBoxSmith->isChecked()) {
-        ui->checkBoxPhase->setChecked(false);
-        ui->checkBoxVSWR->setChecked(false);
-        ui->checkBoxTDR->setChecked(false);
-        ui->checkBoxGroupDelay->setChecked(false);
-    }
+    if (ui->checkBoxSmith->isChecked())
+        uncheckOtherViews(ui->checkBoxSmith);
     updatePlots();
 }
 
@@ -1805,10 +2153,7 @@ void MainWindow::on_checkBoxTDR_checkStateChanged(const Qt::CheckState &arg1)
 {
     Q_UNUSED(arg1);
     if (ui->checkBoxTDR->isChecked()) {
-        ui->checkBoxPhase->setChecked(false);
-        ui->checkBoxVSWR->setChecked(false);
-        ui->checkBoxSmith->setChecked(false);
-        ui->checkBoxGroupDelay->setChecked(false);
+        uncheckOtherViews(ui->checkBoxTDR);
         if (ui->checkBox->isChecked()) {
             ui->checkBox->setChecked(false);
         }
@@ -1816,6 +2161,54 @@ void MainWindow::on_checkBoxTDR_checkStateChanged(const Qt::CheckState &arg1)
     updatePlots();
 }
 
+void MainWindow::on_checkBoxZ_checkStateChanged(const Qt::CheckState &arg1)
+{
+    Q_UNUSED(arg1);
+    if (ui->checkBoxZ->isChecked())
+        uncheckOtherViews(ui->checkBoxZ);
+    updatePlots();
+}
+
+void MainWindow::on_checkBoxY_checkStateChanged(const Qt::CheckState &arg1)
+{
+    Q_UNUSED(arg1);
+    if (ui->checkBoxY->isChecked())
+        uncheckOtherViews(ui->checkBoxY);
+    updatePlots();
+}
+
+void MainWindow::on_checkBoxRenorm_checkStateChanged(const Qt::CheckState &arg1)
+{
+    Q_UNUSED(arg1);
+    if (ui->checkBoxRenorm->isChecked())
+        uncheckOtherViews(ui->checkBoxRenorm);
+    updatePlots();
+}
+
+void MainWindow::on_lineEditRenorm_editingFinished()
+{
+    bool ok = false;
+    const double impedance = ui->lineEditRenorm->text().trimmed().toDouble(&ok);
+    const double previous = Network::renormalizationImpedance();
+    if (ok && impedance > 0.0)
+        Network::setRenormalizationImpedance(impedance);
+    ui->lineEditRenorm->setText(QString::number(Network::renormalizationImpedance(), 'g', 6));
+    if (!nearlyEqual(previous, Network::renormalizationImpedance()) && ui->checkBoxRenorm->isChecked())
+        updatePlots();
+}
+
+// The view checkboxes act as one exclusive group that may also be empty
+// (plain magnitude).
+void MainWindow::uncheckOtherViews(QCheckBox *keep)
+{
+    const QList<QCheckBox*> views = {ui->checkBoxPhase, ui->checkBoxGroupDelay, ui->checkBoxVSWR, ui->checkBoxSmith,
+                                     ui->checkBoxTDR, ui->checkBoxZ, ui->checkBoxY, ui->checkBoxRenorm};
+    for (QCheckBox *view : views) {
+        if (view != keep)
+            view->setChecked(false);
+    }
+}
+
 void MainWindow::on_checkBoxGate_stateChanged(int state)
 {
     Q_UNUSED(state);
@@ -1873,6 +2266,43 @@ void MainWindow::on_lineEditNpointsNetworks_editingFinished()
         updatePlots();
 }
 
+void MainWindow::on_comboBoxSweepNetworks_activated(int index)
+{
+    const auto plan = static_cast<NetworkCascade::FrequencyPlan>(index);
+    if (plan != NetworkCascade::FrequencyPlan::Segments) {
+        setCascadeFrequencyPlan(plan);
+        return;
+    }
+
+    QString text = NetworkCascade::formatFrequencySegments(m_cascade->frequencySegments());
+    if (text.isEmpty()) {
+        NetworkCascade::FrequencySegment current;
+        current.fmin = m_networkFrequencyMin;
+        current.fmax = m_networkFrequencyMax;
+        current.points = std::max(m_networkFrequencyPoints, 2);
+        text = NetworkCascade::formatFrequencySegments({current});
+    }
+
+    bool ok = false;
+    text = QInputDialog::getText(this,
+                                 tr("Frequency Segments"),
+                                 tr("Segments as fmin:fmax:points[:log], separated by commas:"),
+                                 QLineEdit::Normal,
+                                 text,
+                                 &ok);
+    QVector<NetworkCascade::FrequencySegment> segments;
+    if (!ok || !NetworkCascade::parseFrequencySegments(text, segments)) {
+        if (ok) {
+            QMessageBox::warning(this,
+                                 tr("Frequency Segments"),
+                                 tr("Expected segments such as 1e6:1e9:101,1e9:10e9:201:log."));
+        }
+        refreshNetworkFrequencyControls();
+        return;
+    }
+    setCascadeFrequencyPlan(plan, segments);
+}
+
 void MainWindow::on_lineEditMouseWheelMult_editingFinished()
 {
     constexpr double minMultiplier = 1.0001;
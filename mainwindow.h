@@ -3,11 +3,13 @@
 
 #include <QMainWindow>
 #include <QVector>
+#include <QSet>
 #include <QColor>
 #include <QStringList>
 #include <QMouseEvent>
 #include <QKeyEvent>
 #include <QItemSelection>
+#include <QPointer>
 
 QT_BEGIN_NAMESPACE
 namespace Ui {
@@ -28,8 +30,15 @@ class QTableView;
 class QCPAbstractPlottable;
 class QResizeEvent;
 class QLabel;
+class QCheckBox;
 class QWidget;
 class QHBoxLayout;
+class QProgressBar;
+class QToolButton;
+class QThreadPool;
+class QTimer;
+class QDragEnterEvent;
+class QDropEvent;
 
 class MainWindow : public QMainWindow
 {
@@ -38,11 +47,18 @@ class MainWindow : public QMainWindow
 public:
     MainWindow(QWidget *parent = nullptr);
     ~MainWindow();
+    // Loads files (and Touchstone files below any directories) on a worker pool.
+    // A row appears as soon as a file's header is probed; the body is parsed
+    // afterwards, and files that fail to parse are removed again.
     void processFiles(const QStringList &files, bool autoscale = false);
+    bool isLoadingFiles() const;
+    void cancelFileLoading();
     void clearCascade();
     void addNetworkToCascade(Network* network);
     void setCascadeFrequencyRange(double fmin, double fmax);
     void setCascadePointCount(int pointCount);
+    void setCascadeFrequencyPlan(NetworkCascade::FrequencyPlan plan,
+                                 const QVector<NetworkCascade::FrequencySegment>& segments = {});
     void initializeFrequencyControls(bool freqSpecified, double fmin, double fmax, int pointCount, bool hasInitialFiles);
     NetworkCascade* cascade() const;
     QTableView* cascadeTableView() const;
@@ -50,6 +66,8 @@ public:
 private slots:
     void on_actionOpen_triggered();
     void onSaveCascadeTriggered();
+    void showDiagnostics();
+    void showParameterSweep();
     void on_pushButtonAutoscale_clicked();
     void onFilesReceived(const QStringList &files);
 
@@ -73,6 +91,10 @@ private slots:
     void on_checkBoxVSWR_checkStateChanged(const Qt::CheckState &arg1);
     void on_checkBoxSmith_checkStateChanged(const Qt::CheckState &arg1);
     void on_checkBoxTDR_checkStateChanged(const Qt::CheckState &arg1);
+    void on_checkBoxZ_checkStateChanged(const Qt::CheckState &arg1);
+    void on_checkBoxY_checkStateChanged(const Qt::CheckState &arg1);
+    void on_checkBoxRenorm_checkStateChanged(const Qt::CheckState &arg1);
+    void on_lineEditRenorm_editingFinished();
 
     void on_checkBoxGate_stateChanged(int state);
     void on_lineEditGateStart_editingFinished();
@@ -81,6 +103,7 @@ private slots:
     void on_lineEditFminNetworks_editingFinished();
     void on_lineEditFmaxNetworks_editingFinished();
     void on_lineEditNpointsNetworks_editingFinished();
+    void on_comboBoxSweepNetworks_activated(int index);
     void on_lineEditMouseWheelMult_editingFinished();
 
     void onNetworkFilesModelChanged(QStandardItem *item);
@@ -99,9 +122,25 @@ protected:
     void keyPressEvent(QKeyEvent* event) override;
     bool eventFilter(QObject* obj, QEvent* event) override;
     void resizeEvent(QResizeEvent* event) override;
+    void dragEnterEvent(QDragEnterEvent* event) override;
+    void dropEvent(QDropEvent* event) override;
 
 private:
+    struct FileLoadBatch;
+
     void updatePlots();
+    void scheduleUpdatePlots();
+    void onFileProbed(const std::shared_ptr<FileLoadBatch>& batch, NetworkFile* network);
+    void onFileLoaded(const std::shared_ptr<FileLoadBatch>& batch, const QPointer<NetworkFile>& network,
+                      const std::shared_ptr<NetworkFile>& loader);
+    void reportFileLoadError(const QString& path, const QString& error);
+    void fileLoadFinished(const std::shared_ptr<FileLoadBatch>& batch);
+    void appendNetworkFileRow(NetworkFile* network);
+    int networkFileRow(const NetworkFile* network) const;
+    void updatePlotNetworks();
+    void removeNetworkFileRow(NetworkFile* network);
+    void finishFileLoading();
+    void applyDetectedNetworkFrequencies();
     void setupModels();
     void setupViews();
     void setupShortcuts();
@@ -122,6 +161,7 @@ private:
     void updateNetworkFrequencySettings(double fmin, double fmax, int pointCount, bool manualOverride = true);
     static bool nearlyEqual(double lhs, double rhs);
     void applyPhaseUnwrapSetting(bool unwrap);
+    void uncheckOtherViews(QCheckBox *keep);
     void updateCascadeStatusIcons();
     QString iconResourceForNetwork(const Network* network) const;
     void updateCascadeColorColumn();
@@ -133,6 +173,9 @@ private:
     PlotManager* m_plot_manager;
 
     QList<Network*> m_networks;
+    // Files listed from their probe whose parse is still running; they reach
+    // the plot manager once it finishes, so plotting never parses on the GUI thread.
+    QSet<const Network*> m_pendingLoads;
     NetworkCascade* m_cascade;
     NetworkItemModel* m_network_files_model;
     NetworkItemModel* m_network_lumped_model;
@@ -158,5 +201,12 @@ private:
     double m_mouseWheelMultiplier;
     QWidget* m_cascadeStatusIconContainer;
     QHBoxLayout* m_cascadeStatusIconLayout;
+
+    QThreadPool* m_loadPool;
+    std::shared_ptr<FileLoadBatch> m_loadBatch;
+    QProgressBar* m_loadProgress;
+    QToolButton* m_loadCancelButton;
+    QTimer* m_updatePlotsTimer;
+    bool m_detectFrequenciesAfterLoad;
 };
 #endif // MAINWINDOW_H
@@ -0,0 +1,156 @@
+#include "mappedfile.h"
+
+#include <utility>
+
+#ifdef _WIN32
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace ts {
+
+MappedFile::MappedFile(const std::string& path) {
+    open(path);
+}
+
+MappedFile::~MappedFile() {
+    close();
+}
+
+MappedFile::MappedFile(MappedFile&& other) noexcept {
+    swap(other);
+}
+
+MappedFile& MappedFile::operator=(MappedFile&& other) noexcept {
+    if (this != &other) {
+        close();
+        swap(other);
+    }
+    return *this;
+}
+
+void MappedFile::swap(MappedFile& other) noexcept {
+    std::swap(m_data, other.m_data);
+    std::swap(m_size, other.m_size);
+    std::swap(m_open, other.m_open);
+#ifdef _WIN32
+    std::swap(m_file, other.m_file);
+    std::swap(m_mapping, other.m_mapping);
+#endif
+}
+
+#ifdef _WIN32
+
+bool MappedFile::open(const std::string& path) {
+    close();
+
+    HANDLE file = CreateFileA(path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING,
+                              FILE_ATTRIBUTE_NORMAL | FILE_FLAG_SEQUENTIAL_SCAN, nullptr);
+    if (file == INVALID_HANDLE_VALUE) {
+        return false;
+    }
+
+    LARGE_INTEGER file_size;
+    if (!GetFileSizeEx(file, &file_size)) {
+        CloseHandle(file);
+        return false;
+    }
+
+    if (file_size.QuadPart == 0) {
+        CloseHandle(file);
+        m_open = true;
+        return true;
+    }
+
+    HANDLE mapping = CreateFileMappingA(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+    if (!mapping) {
+        CloseHandle(file);
+        return false;
+    }
+
+    const void* view = MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+    if (!view) {
+        CloseHandle(mapping);
+        CloseHandle(file);
+        return false;
+    }
+
+    m_file = file;
+    m_mapping = mapping;
+    m_data = static_cast<const char*>(view);
+    m_size = static_cast<std::size_t>(file_size.QuadPart);
+    m_open = true;
+    return true;
+}
+
+void MappedFile::close() {
+    if (m_data) {
+        UnmapViewOfFile(m_data);
+    }
+    if (m_mapping) {
+        CloseHandle(static_cast<HANDLE>(m_mapping));
+    }
+    if (m_file) {
+        CloseHandle(static_cast<HANDLE>(m_file));
+    }
+    m_data = nullptr;
+    m_size = 0;
+    m_open = false;
+    m_file = nullptr;
+    m_mapping = nullptr;
+}
+
+#else
+
+bool MappedFile::open(const std::string& path) {
+    close();
+
+    const int fd = ::open(path.c_str(), O_RDONLY);
+    if (fd < 0) {
+        return false;
+    }
+
+    struct stat st {};
+    if (::fstat(fd, &st) != 0 || !S_ISREG(st.st_mode)) {
+        ::close(fd);
+        return false;
+    }
+
+    if (st.st_size == 0) {
+        ::close(fd);
+        m_open = true;
+        return true;
+    }
+
+    void* view = ::mmap(nullptr, static_cast<std::size_t>(st.st_size), PROT_READ, MAP_PRIVATE, fd, 0);
+    ::close(fd);
+    if (view == MAP_FAILED) {
+        return false;
+    }
+    ::madvise(view, static_cast<std::size_t>(st.st_size), MADV_SEQUENTIAL);
+
+    m_data = static_cast<const char*>(view);
+    m_size = static_cast<std::size_t>(st.st_size);
+    m_open = true;
+    return true;
+}
+
+void MappedFile::close() {
+    if (m_data) {
+        ::munmap(const_cast<char*>(m_data), m_size);
+    }
+    m_data = nullptr;
+    m_size = 0;
+    m_open = false;
+}
+
+#endif
+
+} // namespace ts
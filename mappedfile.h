@@ -0,0 +1,40 @@
+#pragma once
+
+#include <cstddef>
+#include <string>
+
+namespace ts {
+
+// Read-only memory mapping of a whole file. An empty file is a valid mapping
+// with size() == 0 and a null data() pointer.
+class MappedFile {
+public:
+    MappedFile() = default;
+    explicit MappedFile(const std::string& path);
+    ~MappedFile();
+
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+    MappedFile(MappedFile&& other) noexcept;
+    MappedFile& operator=(MappedFile&& other) noexcept;
+
+    bool open(const std::string& path);
+    void close();
+
+    bool is_open() const { return m_open; }
+    const char* data() const { return m_data; }
+    std::size_t size() const { return m_size; }
+
+private:
+    void swap(MappedFile& other) noexcept;
+
+    const char* m_data = nullptr;
+    std::size_t m_size = 0;
+    bool m_open = false;
+#ifdef _WIN32
+    void* m_file = nullptr;
+    void* m_mapping = nullptr;
+#endif
+};
+
+} // namespace ts
@@ -1,4 +1,9 @@
 #include "network.h"
+#include "networkparameters.h"
+#include "plotdatacache.h"
+#include "plotkernels.h"
+#include "tdrcalculator.h"
+#include <atomic>
 #include <complex>
 #include <cmath>
 #include <limits>
@@ -7,6 +12,8 @@
 
 namespace {
 Network::TimeGateSettings g_timeGateSettings;
+std::atomic<double> g_renormalizationImpedance{50.0};
+std::atomic<quint64> g_nextNetworkId{1};
 }
 
 namespace
@@ -118,6 +125,57 @@ Network::TimeGateSettings Network::timeGateSettings()
     return g_timeGateSettings;
 }
 
+void Network::setRenormalizationImpedance(double impedance)
+{
+    if (impedance > 0.0)
+        g_renormalizationImpedance = impedance;
+}
+
+double Network::renormalizationImpedance()
+{
+    return g_renormalizationImpedance;
+}
+
+double Network::portImpedance() const
+{
+    return 50.0;
+}
+
+bool Network::hasNativeGrid() const
+{
+    return false;
+}
+
+double Network::viewReference(PlotType type) const
+{
+    double reference = 0.0;
+    if (type == PlotType::Renormalized)
+        reference = renormalizationImpedance();
+    else if (type == PlotType::VSWR || type == PlotType::Smith || type == PlotType::TDR)
+        reference = 50.0;
+    return reference == portImpedance() ? 0.0 : reference;
+}
+
+Eigen::ArrayXcd Network::viewColumn(const Eigen::MatrixXcd& sparams, int s_param_idx, PlotType type) const
+{
+    const int ports = portCount();
+    const Eigen::Index entries = static_cast<Eigen::Index>(ports) * ports;
+    const double reference = viewReference(type);
+    if ((type != PlotType::Impedance && type != PlotType::Admittance && reference == 0.0) || ports <= 0 ||
+        sparams.cols() < entries)
+        return sparams.col(s_param_idx).array();
+
+    const Eigen::VectorXd z0 = Eigen::VectorXd::Constant(ports, portImpedance());
+    const Eigen::MatrixXcd matrix = sparams.leftCols(entries);
+    if (type == PlotType::Impedance)
+        return NetworkParameters::sToZ(matrix, z0).col(s_param_idx).array();
+    if (type == PlotType::Admittance)
+        return NetworkParameters::sToY(matrix, z0).col(s_param_idx).array();
+    return NetworkParameters::renormalize(matrix, z0, Eigen::VectorXd::Constant(ports, reference))
+        .col(s_param_idx)
+        .array();
+}
+
 Network::Network(QObject *parent)
     : QObject(parent),
       m_fmin(0),
@@ -125,8 +183,29 @@ Network::Network(QObject *parent)
       m_color(Qt::black),
       m_is_visible(true),
       m_unwrap_phase(true),
-      m_is_active(true)
+      m_is_active(true),
+      m_id(g_nextNetworkId++)
+{
+}
+
+Network::~Network()
+{
+    PlotDataCache::instance().removeNetwork(m_id);
+}
+
+quint64 Network::id() const
+{
+    return m_id;
+}
+
+quint64 Network::dataVersion() const
 {
+    return m_version;
+}
+
+void Network::invalidateData()
+{
+    ++m_version;
 }
 
 double Network::fmin() const
@@ -136,7 +215,10 @@ double Network::fmin() const
 
 void Network::setFmin(double fmin)
 {
+    if (m_fmin == fmin)
+        return;
     m_fmin = fmin;
+    invalidateData();
 }
 
 double Network::fmax() const
@@ -146,7 +228,10 @@ double Network::fmax() const
 
 void Network::setFmax(double fmax)
 {
+    if (m_fmax == fmax)
+        return;
     m_fmax = fmax;
+    invalidateData();
 }
 
 QColor Network::color() const
@@ -186,7 +271,10 @@ bool Network::isActive() const
 
 void Network::setActive(bool active)
 {
+    if (m_is_active == active)
+        return;
     m_is_active = active;
+    invalidateData();
 }
 
 QStringList Network::parameterNames() const
@@ -325,67 +413,169 @@ void Network::copyStyleSettingsFrom(const Network* other)
 
 Eigen::ArrayXd Network::unwrap(const Eigen::ArrayXd& phase)
 {
-    Eigen::ArrayXd unwrapped_phase = phase;
-    for (int i = 1; i < phase.size(); ++i) {
-        double diff = unwrapped_phase(i) - unwrapped_phase(i - 1);
-        if (diff > M_PI) {
-            for (int j = i; j < phase.size(); ++j) {
-                unwrapped_phase(j) -= 2 * M_PI;
-            }
-        } else if (diff < -M_PI) {
-            for (int j = i; j < phase.size(); ++j) {
-                unwrapped_phase(j) += 2 * M_PI;
+    return PlotKernels::unwrapPhase(phase);
+}
+
+Eigen::ArrayXd Network::computeGroupDelay(const Eigen::ArrayXd& phase_rad, const Eigen::ArrayXd& freq_hz)
+{
+    return PlotKernels::groupDelay(phase_rad, freq_hz);
+}
+
+Eigen::ArrayXd Network::wrapToMinusPiPi(const Eigen::ArrayXd& phase_rad)
+{
+    return PlotKernels::wrapPhase(phase_rad);
+}
+
+QPair<QVector<double>, QVector<double>> Network::cachedPlotData(int s_param_idx, PlotType type, const Eigen::ArrayXd& freq,
+                                                                bool isReflection,
+                                                                const std::function<Eigen::ArrayXcd()>& column)
+{
+    PlotDataCache& cache = PlotDataCache::instance();
+    PlotDataCache::Key columnKey;
+    columnKey.network = m_id;
+    columnKey.version = dataVersion();
+    columnKey.sparam = s_param_idx;
+    columnKey.view = PlotDataCache::kColumn;
+    columnKey.parameters = type == PlotType::Impedance    ? static_cast<int>(NetworkParameters::Kind::Z)
+                           : type == PlotType::Admittance ? static_cast<int>(NetworkParameters::Kind::Y)
+                                                          : static_cast<int>(NetworkParameters::Kind::S);
+    columnKey.reference = viewReference(type);
+    columnKey.grid = PlotDataCache::gridHash(freq);
+    // The gate only touches S reflections; leave it out of other keys.
+    const TimeGateSettings gateSettings = timeGateSettings();
+    if (gateSettings.enabled && isReflection && columnKey.parameters == static_cast<int>(NetworkParameters::Kind::S))
+        columnKey.gate = gateSettings;
+
+    PlotDataCache::Key key = columnKey;
+    key.view = static_cast<int>(type);
+    key.unwrap = m_unwrap_phase && (type == PlotType::Phase || type == PlotType::GroupDelay);
+    // The TDR view uses the gate's permittivity even when the gate is off.
+    if (type == PlotType::TDR)
+        key.gate.epsilonR = gateSettings.epsilonR;
+    if (auto view = cache.findView(key))
+        return *view;
+
+    std::optional<PlotDataCache::Column> cached = cache.findColumn(columnKey);
+    if (!cached) {
+        PlotDataCache::Column computed;
+        computed.values = column();
+        if (columnKey.gate.enabled) {
+            TDRCalculator calculator;
+            TDRCalculator::Parameters tdrParams;
+            tdrParams.effectivePermittivity = std::max(gateSettings.epsilonR, 1.0);
+            auto gated = calculator.applyGate(freq, computed.values,
+                                             gateSettings.startDistance,
+                                             gateSettings.stopDistance,
+                                             gateSettings.epsilonR,
+                                             tdrParams);
+            if (gated) {
+                computed.values = std::move(gated->gatedReflection);
+                computed.gatedTdr = qMakePair(std::move(gated->distance), std::move(gated->impedance));
             }
         }
+        cache.insertColumn(columnKey, computed);
+        cached = std::move(computed);
     }
-    return unwrapped_phase;
+
+    QPair<QVector<double>, QVector<double>> view = plotView(freq, cached->values, cached->gatedTdr, type, key.unwrap, isReflection);
+    cache.insertView(key, view);
+    return view;
 }
 
-Eigen::ArrayXd Network::computeGroupDelay(const Eigen::ArrayXd& phase_rad, const Eigen::ArrayXd& freq_hz)
+QPair<QVector<double>, QVector<double>> Network::plotDataOnGrid(int s_param_idx, PlotType type,
+                                                                const Eigen::VectorXd& freq) const
 {
-    const int count = std::min<int>(phase_rad.size(), freq_hz.size());
-    if (count <= 0)
+    const int ports = portCount();
+    if (ports <= 0 || s_param_idx < 0 || freq.size() == 0)
+        return {};
+    const Eigen::MatrixXcd sparams = sparameters(freq);
+    if (sparams.rows() != freq.size() || sparams.cols() <= s_param_idx)
         return {};
 
-    Eigen::ArrayXd delay(count);
-    delay.setZero();
+    const bool isReflection = (s_param_idx % ports) == (s_param_idx / ports);
+    const bool unwrap = m_unwrap_phase && (type == PlotType::Phase || type == PlotType::GroupDelay);
+    return plotView(freq.array(), viewColumn(sparams, s_param_idx, type), {}, type, unwrap, isReflection);
+}
 
-    if (count == 1)
-        return delay;
+QPair<QVector<double>, QVector<double>> Network::tdrOnWindow(int s_param_idx, double startDistance,
+                                                             double stopDistance, int points) const
+{
+    const int ports = portCount();
+    if (ports <= 0 || s_param_idx < 0 || s_param_idx % ports != s_param_idx / ports)
+        return {};
+    const QVector<double> native = frequencies();
+    const Eigen::VectorXd freq = Eigen::Map<const Eigen::VectorXd>(native.constData(), native.size());
+    const Eigen::MatrixXcd sparams = sparameters(freq);
+    if (sparams.rows() != freq.size() || sparams.cols() <= s_param_idx)
+        return {};
 
-    for (int i = 0; i < count; ++i) {
-        const int prevIndex = (i == 0) ? i : i - 1;
-        const int nextIndex = (i == count - 1) ? i : i + 1;
-        const double df = freq_hz(nextIndex) - freq_hz(prevIndex);
-        if (nextIndex == prevIndex || std::abs(df) < std::numeric_limits<double>::epsilon()) {
-            delay(i) = 0.0;
-            continue;
+    TDRCalculator calculator;
+    TDRCalculator::Parameters tdrParams;
+    tdrParams.effectivePermittivity = std::max(timeGateSettings().epsilonR, 1.0);
+    TDRCalculator::DistanceWindow window;
+    window.startDistance = startDistance;
+    window.stopDistance = stopDistance;
+    window.points = points;
+    const auto result = calculator.computeWindow(freq.array(), viewColumn(sparams, s_param_idx, PlotType::TDR),
+                                                 window, tdrParams);
+    return qMakePair(result.distance, result.impedance);
+}
+
+QPair<QVector<double>, QVector<double>> Network::plotView(const Eigen::ArrayXd& freq, const Eigen::ArrayXcd& sparam,
+                                                          const QPair<QVector<double>, QVector<double>>& gatedTdr,
+                                                          PlotType type, bool unwrapPhase, bool isReflection)
+{
+    QVector<double> freqVector(freq.data(), freq.data() + freq.size());
+
+    switch (type) {
+    case PlotType::Magnitude:
+    case PlotType::Renormalized: {
+        const Eigen::ArrayXd magnitude = PlotKernels::magnitudeDb(sparam);
+        QVector<double> values(magnitude.data(), magnitude.data() + magnitude.size());
+        return qMakePair(freqVector, values);
+    }
+    case PlotType::Phase: {
+        const PlotKernels::Views views = PlotKernels::computeViews(freq, sparam, PlotKernels::Phase, unwrapPhase);
+        const Eigen::ArrayXd phase_deg = views.phase * (180.0 / M_PI);
+        QVector<double> values(phase_deg.data(), phase_deg.data() + phase_deg.size());
+        return qMakePair(freqVector, values);
+    }
+    case PlotType::GroupDelay: {
+        const PlotKernels::Views views = PlotKernels::computeViews(freq, sparam, PlotKernels::GroupDelay, unwrapPhase);
+        QVector<double> values(views.groupDelay.data(), views.groupDelay.data() + views.groupDelay.size());
+        return qMakePair(freqVector, values);
+    }
+    case PlotType::VSWR: {
+        const Eigen::ArrayXd vswr = PlotKernels::vswr(sparam);
+        QVector<double> values(vswr.data(), vswr.data() + vswr.size());
+        return qMakePair(freqVector, values);
+    }
+    case PlotType::Impedance:
+    case PlotType::Admittance: {
+        const Eigen::ArrayXd magnitude = sparam.abs();
+        QVector<double> values(magnitude.data(), magnitude.data() + magnitude.size());
+        return qMakePair(freqVector, values);
+    }
+    case PlotType::Smith: {
+        Eigen::ArrayXd realPart = sparam.real();
+        Eigen::ArrayXd imagPart = sparam.imag();
+        QVector<double> xValues(realPart.data(), realPart.data() + realPart.size());
+        QVector<double> yValues(imagPart.data(), imagPart.data() + imagPart.size());
+        return qMakePair(xValues, yValues);
+    }
+    case PlotType::TDR:
+        if (!isReflection)
+            return {};
+        if (!gatedTdr.first.isEmpty())
+            return gatedTdr;
+        {
+            TDRCalculator calculator;
+            TDRCalculator::Parameters tdrParams;
+            tdrParams.effectivePermittivity = std::max(timeGateSettings().epsilonR, 1.0);
+            auto result = calculator.compute(freq, sparam, tdrParams);
+            return qMakePair(result.distance, result.impedance);
         }
-
-        const double dphi = phase_rad(nextIndex) - phase_rad(prevIndex);
-        delay(i) = -(dphi / df) / (2.0 * M_PI);
     }
 
-    return delay;
-}
-
-Eigen::ArrayXd Network::wrapToMinusPiPi(const Eigen::ArrayXd& phase_rad)
-{
-    Eigen::ArrayXd wrapped = phase_rad;
-    const double pi = M_PI;
-    const double twoPi = 2.0 * M_PI;
-    constexpr double tolerance = 1e-12;
-    for (int i = 0; i < wrapped.size(); ++i) {
-        double value = wrapped(i);
-        if (!std::isfinite(value))
-            continue;
-        while (value < -pi - tolerance)
-            value += twoPi;
-        while (value > pi + tolerance)
-            value -= twoPi;
-        if (value >= pi - tolerance)
-            value -= twoPi;
-        wrapped(i) = value;
-    }
-    return wrapped;
+    return {};
 }
@@ -11,16 +11,19 @@
 #include <QHash>
 #include <Eigen/Dense>
 #include <complex>
+#include <functional>
 #include <optional>
 
-enum class PlotType { Magnitude, Phase, GroupDelay, VSWR, Smith, TDR };
+// Impedance and Admittance plot |Z| and |Y|; Renormalized plots S in dB after
+// renormalizing every port to Network::renormalizationImpedance().
+enum class PlotType { Magnitude, Phase, GroupDelay, VSWR, Smith, TDR, Impedance, Admittance, Renormalized };
 
 class Network : public QObject
 {
     Q_OBJECT
 public:
     explicit Network(QObject *parent = nullptr);
-    virtual ~Network() = default;
+    virtual ~Network();
 
     static Eigen::Matrix2cd s2abcd(const std::complex<double>& s11, const std::complex<double>& s12, const std::complex<double>& s21, const std::complex<double>& s22, double z0 = 50.0);
     static Eigen::Vector4cd abcd2s(const Eigen::Matrix2cd& abcd, double z0 = 50.0);
@@ -32,9 +35,23 @@ public:
     virtual QString displayName() const;
     virtual Eigen::MatrixXcd sparameters(const Eigen::VectorXd& freq) const = 0;
     virtual QPair<QVector<double>, QVector<double>> getPlotData(int s_param_idx, PlotType type) = 0;
+    // Plot data on an explicit grid, computed directly instead of through
+    // PlotDataCache and without the time gate, e.g. for a zoomed band.
+    QPair<QVector<double>, QVector<double>> plotDataOnGrid(int s_param_idx, PlotType type,
+                                                           const Eigen::VectorXd& freq) const;
+    // TDR of reflection s_param_idx at `points` distances spanning
+    // [startDistance, stopDistance], evaluated for just that window and
+    // without the time gate, e.g. for a zoomed distance axis.
+    QPair<QVector<double>, QVector<double>> tdrOnWindow(int s_param_idx, double startDistance,
+                                                        double stopDistance, int points) const;
     virtual Network* clone(QObject* parent = nullptr) const = 0;
     virtual QVector<double> frequencies() const = 0;
     virtual int portCount() const = 0;
+    // Reference impedance of every port of sparameters().
+    virtual double portImpedance() const;
+    // True when frequencies() are measured points rather than a sweep that
+    // could be resampled at will, e.g. for a loaded Touchstone file.
+    virtual bool hasNativeGrid() const;
 
     struct TimeGateSettings
     {
@@ -47,6 +64,10 @@ public:
     static void setTimeGateSettings(const TimeGateSettings& settings);
     static TimeGateSettings timeGateSettings();
 
+    // Port impedance of the Renormalized view; 50 Ohm by default.
+    static void setRenormalizationImpedance(double impedance);
+    static double renormalizationImpedance();
+
     double fmin() const;
     void setFmin(double fmin);
 
@@ -78,7 +99,23 @@ public:
 
     QPen parameterPen(const QString& parameter) const;
 
+    // Identifies this network in process-wide caches; never reused.
+    quint64 id() const;
+    // Changes whenever the network's S-parameters may have changed.
+    virtual quint64 dataVersion() const;
+
 protected:
+    void invalidateData();
+    // Plot data for one S-parameter, served from PlotDataCache when possible.
+    // `column` returns viewColumn() on `freq` and only runs on a cache miss.
+    QPair<QVector<double>, QVector<double>> cachedPlotData(int s_param_idx, PlotType type, const Eigen::ArrayXd& freq,
+                                                           bool isReflection,
+                                                           const std::function<Eigen::ArrayXcd()>& column);
+    // Entry s_param_idx of the parameters `type` plots, from S referenced to
+    // portImpedance(): Z, Y, S renormalized to renormalizationImpedance(), or
+    // S itself (at 50 Ohm for VSWR, Smith and TDR).
+    Eigen::ArrayXcd viewColumn(const Eigen::MatrixXcd& sparams, int s_param_idx, PlotType type) const;
+
     Eigen::ArrayXd unwrap(const Eigen::ArrayXd& phase);
     void copyStyleSettingsFrom(const Network* other);
     Qt::PenStyle defaultPenStyleForParameter(const QString& parameter) const;
@@ -99,9 +136,16 @@ private:
     };
 
     static QString normalizedParameterKey(const QString& parameter);
+    // The impedance viewColumn() renormalizes S to for `type`, 0 for none.
+    double viewReference(PlotType type) const;
+    static QPair<QVector<double>, QVector<double>> plotView(const Eigen::ArrayXd& freq, const Eigen::ArrayXcd& sparam,
+                                                            const QPair<QVector<double>, QVector<double>>& gatedTdr,
+                                                            PlotType type, bool unwrapPhase, bool isReflection);
     void updateOrRemovePenSettings(const QString& key, PenSettings&& settings);
 
     QHash<QString, PenSettings> m_parameterPenSettings;
+    quint64 m_id;
+    quint64 m_version = 0;
 };
 
 #endif // NETWORK_H
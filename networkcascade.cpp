@@ -1,12 +1,34 @@
 #include "networkcascade.h"
-#include "tdrcalculator.h"
+#include "cascadekernels.h"
+#include "networkconnection.h"
+#include "networklumped.h"
+#include "plotdatacache.h"
+#include "threadpool.h"
 #include <limits>
 #include <algorithm>
-#include <optional>
+#include <atomic>
+#include <cmath>
 #include <vector>
 
 namespace {
-constexpr double pi = 3.14159265358979323846;
+// Rows per block: both operands and the result stay in L2 while a block runs.
+constexpr Eigen::Index kBlockRows = 1024;
+
+// Grids memoized per cascade, e.g. the plotted grid and the TDR grid; the
+// oldest are dropped first when they exceed the memory budget.
+constexpr std::size_t kMaxEvaluations = 4;
+constexpr std::size_t kEvaluationBudget = 64u * 1024u * 1024u;
+
+// Longest run of consecutive lumped stages multiplied as one chain matrix. An
+// edit re-evaluates its whole run, so runs are capped to keep that cheap.
+constexpr std::size_t kMaxFusedStages = 16;
+
+std::atomic<unsigned> g_threadCount{0};
+
+std::atomic<quint64> g_stageHits{0};
+std::atomic<quint64> g_stageMisses{0};
+std::atomic<quint64> g_resultHits{0};
+std::atomic<quint64> g_resultMisses{0};
 
 int sanitizePort(int requestedPort, int portCount)
 {
@@ -27,39 +49,217 @@ int defaultToPort(int portCount)
     return 1;
 }
 
-Eigen::Matrix2cd redhefferStar(const Eigen::Matrix2cd& left, const Eigen::Matrix2cd& right)
+// Renumbers the stages of `connections` through `map`, which returns -1 for a
+// stage that is gone; connections to such a stage are dropped.
+template <typename Map>
+void remapConnections(QVector<NetworkCascade::PortConnection>& connections, Map map)
 {
-    const std::complex<double> s11_left = left(0, 0);
-    const std::complex<double> s12_left = left(0, 1);
-    const std::complex<double> s21_left = left(1, 0);
-    const std::complex<double> s22_left = left(1, 1);
+    QVector<NetworkCascade::PortConnection> kept;
+    for (NetworkCascade::PortConnection connection : connections) {
+        connection.stageA = map(connection.stageA);
+        connection.stageB = map(connection.stageB);
+        if (connection.stageA >= 0 && connection.stageB >= 0)
+            kept.append(connection);
+    }
+    connections = kept;
+}
 
-    const std::complex<double> s11_right = right(0, 0);
-    const std::complex<double> s12_right = right(0, 1);
-    const std::complex<double> s21_right = right(1, 0);
-    const std::complex<double> s22_right = right(1, 1);
+void starBlocks(const CascadeKernels::Blocks& left, const CascadeKernels::Blocks& right,
+                CascadeKernels::Blocks& out, unsigned threads)
+{
+    const Eigen::Index rows = left.rows();
+    out.resize(rows);
+    const std::size_t blocks = static_cast<std::size_t>((rows + kBlockRows - 1) / kBlockRows);
+    ThreadPool::global().parallelFor(blocks, [&](std::size_t block) {
+        const Eigen::Index begin = static_cast<Eigen::Index>(block) * kBlockRows;
+        CascadeKernels::star(left, right, out, begin, std::min(rows, begin + kBlockRows));
+    }, threads);
+}
 
-    std::complex<double> denominator = 1.0 - s22_left * s11_right;
-    if (std::abs(denominator) < 1e-18)
-    {
-        // Regularize near-singular connections to avoid numerical blow-up
-        denominator = std::complex<double>(std::numeric_limits<double>::epsilon(), 0.0);
-    }
-    const std::complex<double> inv = 1.0 / denominator;
+struct FusedStage
+{
+    const NetworkLumped* network;
+    bool reversed;
+};
 
-    Eigen::Matrix2cd result;
-    result(0, 0) = s11_left + s12_left * s11_right * s21_left * inv;
-    result(0, 1) = s12_left * s12_right * inv;
-    result(1, 0) = s21_left * s21_right * inv;
-    result(1, 1) = s22_right + s21_right * s22_left * s12_right * inv;
+// The run at one frequency as the unfused path computes it: each stage's
+// closed-form S, star-combined in order.
+Eigen::Vector4cd starRun(const std::vector<FusedStage>& run, double frequency)
+{
+    const Eigen::VectorXd point = Eigen::VectorXd::Constant(1, frequency);
+    Eigen::Matrix2cd combined;
+    for (std::size_t i = 0; i < run.size(); ++i) {
+        const Eigen::MatrixXcd s = run[i].network->sparameters(point);
+        Eigen::Matrix2cd stage;
+        if (run[i].reversed)
+            stage << s(0, 3), s(0, 1), s(0, 2), s(0, 0);
+        else
+            stage << s(0, 0), s(0, 2), s(0, 1), s(0, 3);
+        combined = i == 0 ? stage : CascadeKernels::star(combined, stage);
+    }
+    Eigen::Vector4cd result;
+    result << combined(0, 0), combined(0, 1), combined(1, 0), combined(1, 1);
     return result;
 }
+
+// Multiplies the chain matrices of a run of lumped stages per frequency and
+// converts only the product to S, instead of star-combining every stage.
+// Where a chain matrix does not exist (a series C at DC, a shorting shunt) or
+// a reversed stage's cannot be inverted, that frequency falls back to starRun().
+void evaluateFused(const std::vector<FusedStage>& run, const Eigen::VectorXd& freq, CascadeKernels::Blocks& blocks,
+                   unsigned threads)
+{
+    using namespace CascadeKernels;
+    const Eigen::Index rows = freq.size();
+    blocks.resize(rows);
+    const std::size_t count = static_cast<std::size_t>((rows + kBlockRows - 1) / kBlockRows);
+    ThreadPool::global().parallelFor(count, [&](std::size_t block) {
+        const Eigen::Index begin = static_cast<Eigen::Index>(block) * kBlockRows;
+        const Eigen::Index end = std::min(rows, begin + kBlockRows);
+        for (Eigen::Index row = begin; row < end; ++row) {
+            Eigen::Matrix2cd chain = Eigen::Matrix2cd::Identity();
+            bool regular = true;
+            for (const FusedStage& stage : run) {
+                Eigen::Matrix2cd abcd = stage.network->abcdParameters(freq(row));
+                if (stage.reversed) {
+                    const std::complex<double> det = abcd.determinant();
+                    if (!(std::abs(det) >= kSingularThreshold)) {
+                        regular = false;
+                        break;
+                    }
+                    Eigen::Matrix2cd flipped;
+                    flipped << abcd(1, 1), abcd(0, 1),
+                               abcd(1, 0), abcd(0, 0);
+                    abcd = flipped / det;
+                }
+                if (!abcd.allFinite()) {
+                    regular = false;
+                    break;
+                }
+                chain = chain * abcd;
+            }
+            Eigen::Vector4cd s;
+            if (regular)
+                s = Network::abcd2s(chain);
+            if (!regular || !s.allFinite())
+                s = starRun(run, freq(row));
+            blocks.re(row, S11) = s(0).real();
+            blocks.im(row, S11) = s(0).imag();
+            blocks.re(row, S12) = s(1).real();
+            blocks.im(row, S12) = s(1).imag();
+            blocks.re(row, S21) = s(2).real();
+            blocks.im(row, S21) = s(2).imag();
+            blocks.re(row, S22) = s(3).real();
+            blocks.im(row, S22) = s(3).imag();
+        }
+    }, threads);
+}
+
+// Copies the selected ports of a stage response into blocks; false when the
+// response does not cover the grid or the selection.
+bool extractBlocks(const Eigen::MatrixXcd& response, Eigen::Index rows, int ports, int inputPort, int outputPort,
+                   CascadeKernels::Blocks& blocks)
+{
+    if (response.rows() != rows)
+        return false;
+
+    const Eigen::Index requiredCols = static_cast<Eigen::Index>(ports) * static_cast<Eigen::Index>(ports);
+    if (response.cols() < requiredCols)
+        return false;
+
+    const Eigen::Index s11Index = static_cast<Eigen::Index>(inputPort * ports + inputPort);
+    const Eigen::Index s12Index = static_cast<Eigen::Index>(outputPort * ports + inputPort);
+    const Eigen::Index s21Index = static_cast<Eigen::Index>(inputPort * ports + outputPort);
+    const Eigen::Index s22Index = static_cast<Eigen::Index>(outputPort * ports + outputPort);
+
+    if (s11Index >= response.cols() || s12Index >= response.cols() ||
+        s21Index >= response.cols() || s22Index >= response.cols()) {
+        return false;
+    }
+
+    using namespace CascadeKernels;
+    blocks.resize(rows);
+    blocks.re.col(S11) = response.col(s11Index).real();
+    blocks.im.col(S11) = response.col(s11Index).imag();
+    blocks.re.col(S21) = response.col(s21Index).real();
+    blocks.im.col(S21) = response.col(s21Index).imag();
+    blocks.re.col(S12) = response.col(s12Index).real();
+    blocks.im.col(S12) = response.col(s12Index).imag();
+    blocks.re.col(S22) = response.col(s22Index).real();
+    blocks.im.col(S22) = response.col(s22Index).imag();
+    return true;
+}
 }
 
+// The last evaluated grid with every active stage's blocks and a segment tree
+// of star products over the usable ones, so that editing one stage costs one
+// stage evaluation and O(log stages) products per frequency.
+struct NetworkCascade::Evaluation
+{
+    struct Member
+    {
+        quint64 id = 0;
+        quint64 version = 0;
+        int ports = 0;
+        int inputPort = 0;
+        int outputPort = 0;
+
+        bool operator==(const Member& other) const
+        {
+            return id == other.id && version == other.version && ports == other.ports &&
+                   inputPort == other.inputPort && outputPort == other.outputPort;
+        }
+    };
+
+    // One network, or a run of lumped two-ports evaluated as one chain matrix.
+    struct Stage
+    {
+        std::vector<Member> members;
+        bool fusable = false;
+        bool usable = false;
+        CascadeKernels::Blocks blocks;
+
+        bool sameAs(const Stage& other) const { return members == other.members; }
+    };
+
+    Eigen::VectorXd grid;
+    std::uint64_t gridHash = 0;
+    std::vector<Stage> stages;
+    std::vector<std::size_t> leaves;        // indices of usable stages, in cascade order
+    std::vector<CascadeKernels::Blocks> nodes; // node 1 is the root; leaves are not stored
+
+    // dirty[k] counts changed leaves before position k.
+    const CascadeKernels::Blocks& product(std::size_t node, std::size_t lo, std::size_t hi,
+                                    const std::vector<std::size_t>& dirty, bool rebuild, unsigned threads)
+    {
+        if (hi - lo == 1)
+            return stages[leaves[lo]].blocks;
+        if (!rebuild && dirty[hi] == dirty[lo])
+            return nodes[node];
+
+        const std::size_t mid = lo + (hi - lo) / 2;
+        const CascadeKernels::Blocks& left = product(2 * node, lo, mid, dirty, rebuild, threads);
+        const CascadeKernels::Blocks& right = product(2 * node + 1, mid, hi, dirty, rebuild, threads);
+        starBlocks(left, right, nodes[node], threads);
+        return nodes[node];
+    }
+
+    std::size_t bytes() const
+    {
+        std::size_t total = 0;
+        for (const Stage& stage : stages)
+            total += stage.blocks.bytes();
+        for (const CascadeKernels::Blocks& node : nodes)
+            total += node.bytes();
+        return total;
+    }
+};
+
 NetworkCascade::NetworkCascade(QObject *parent)
     : Network(parent)
     , m_pointCount(2001)
     , m_manualFrequencyRange(false)
+    , m_frequencyPlan(FrequencyPlan::Linear)
 {
     m_fmin = 1e6;
     m_fmax = 10e9;
@@ -84,6 +284,7 @@ void NetworkCascade::insertNetwork(int index, Network* network)
     if (index < 0 || index > m_networks.size())
         index = m_networks.size();
     m_networks.insert(index, network);
+    remapConnections(m_portConnections, [index](int stage) { return stage >= index ? stage + 1 : stage; });
     const int portCount = network ? network->portCount() : 0;
     const int toPort = defaultToPort(portCount);
     const int fromPort = defaultFromPort(portCount);
@@ -91,6 +292,7 @@ void NetworkCascade::insertNetwork(int index, Network* network)
     m_fromPorts.insert(index, fromPort);
     setNetworkPortSelection(index, toPort, fromPort);
     updateFrequencyRange();
+    invalidateData();
 }
 
 void NetworkCascade::moveNetwork(int from, int to)
@@ -102,7 +304,17 @@ void NetworkCascade::moveNetwork(int from, int to)
     m_networks.insert(to, m_networks.takeAt(from));
     m_toPorts.insert(to, m_toPorts.takeAt(from));
     m_fromPorts.insert(to, m_fromPorts.takeAt(from));
+    remapConnections(m_portConnections, [from, to](int stage) {
+        if (stage == from)
+            return to;
+        if (from < to && stage > from && stage <= to)
+            return stage - 1;
+        if (to < from && stage >= to && stage < from)
+            return stage + 1;
+        return stage;
+    });
     updateFrequencyRange();
+    invalidateData();
 }
 
 void NetworkCascade::removeNetwork(int index)
@@ -111,16 +323,26 @@ void NetworkCascade::removeNetwork(int index)
         m_networks.removeAt(index);
         m_toPorts.removeAt(index);
         m_fromPorts.removeAt(index);
+        remapConnections(m_portConnections, [index](int stage) {
+            return stage == index ? -1 : (stage > index ? stage - 1 : stage);
+        });
         updateFrequencyRange();
+        invalidateData();
     }
 }
 
 void NetworkCascade::clearNetworks()
 {
+    {
+        std::lock_guard<std::mutex> lock(m_evaluationMutex);
+        m_evaluations.clear();
+    }
     m_networks.clear();
     m_toPorts.clear();
     m_fromPorts.clear();
+    m_portConnections.clear();
     updateFrequencyRange();
+    invalidateData();
 }
 
 const QList<Network*>& NetworkCascade::getNetworks() const
@@ -153,6 +375,19 @@ void NetworkCascade::updateFrequencyRange()
     }
 }
 
+quint64 NetworkCascade::dataVersion() const
+{
+    // Editing a member network changes the cascade's response too.
+    quint64 version = Network::dataVersion();
+    for (const Network* network : m_networks) {
+        if (!network)
+            continue;
+        version = version * 1000003u ^ network->id();
+        version = version * 1000003u ^ network->dataVersion();
+    }
+    return version;
+}
+
 QString NetworkCascade::name() const
 {
     return "Cascade";
@@ -160,23 +395,43 @@ QString NetworkCascade::name() const
 
 int NetworkCascade::portCount() const
 {
-    return 2;
+    if (m_portConnections.isEmpty())
+        return 2;
+    NetworkConnection connection;
+    connectStages(connection);
+    return connection.portCount();
+}
+
+void NetworkCascade::connectStages(NetworkConnection& connection) const
+{
+    QVector<int> index(m_networks.size(), -1);
+    for (int i = 0; i < m_networks.size(); ++i) {
+        const Network* network = m_networks.at(i);
+        if (network && network->isActive())
+            index[i] = connection.addNetwork(network);
+    }
+    // Connections to an inactive stage go with its ports.
+    for (const PortConnection& c : m_portConnections) {
+        if (index.at(c.stageA) >= 0 && index.at(c.stageB) >= 0)
+            connection.connect(index.at(c.stageA), c.portA, index.at(c.stageB), c.portB);
+    }
 }
 
 Eigen::MatrixXcd NetworkCascade::sparameters(const Eigen::VectorXd& freq) const
 {
     if (freq.size() == 0)
         return {};
+    if (!m_portConnections.isEmpty()) {
+        NetworkConnection connection;
+        connectStages(connection);
+        return connection.sparameters(freq);
+    }
 
-    struct StageData
-    {
-        Eigen::MatrixXcd response;
-        int ports = 0;
-        int inputPort = 0;
-        int outputPort = 0;
-    };
-
-    std::vector<StageData> stages;
+    // Port selections may be repaired in place, so they are resolved here
+    // before any worker runs.
+    std::vector<std::vector<const Network*>> networks;
+    std::vector<Evaluation::Stage> stages;
+    networks.reserve(m_networks.size());
     stages.reserve(m_networks.size());
 
     for (int idx = 0; idx < m_networks.size(); ++idx) {
@@ -184,61 +439,181 @@ Eigen::MatrixXcd NetworkCascade::sparameters(const Eigen::VectorXd& freq) const
         if (!network || !network->isActive())
             continue;
 
-        StageData stage;
-        stage.response = network->sparameters(freq);
-        stage.ports = std::max(network->portCount(), 1);
+        Evaluation::Member member;
+        member.id = network->id();
+        member.version = network->dataVersion();
+        member.ports = std::max(network->portCount(), 1);
 
         const auto selection = networkPortSelection(idx);
-        stage.outputPort = sanitizePort(selection.first, stage.ports) - 1;
-        stage.inputPort = sanitizePort(selection.second, stage.ports) - 1;
-        if (stage.outputPort < 0)
-            stage.outputPort = 0;
-        if (stage.inputPort < 0)
-            stage.inputPort = 0;
+        member.outputPort = sanitizePort(selection.first, member.ports) - 1;
+        member.inputPort = sanitizePort(selection.second, member.ports) - 1;
+        if (member.outputPort < 0)
+            member.outputPort = 0;
+        if (member.inputPort < 0)
+            member.inputPort = 0;
+
+        const bool fusable = member.ports == 2 && member.inputPort != member.outputPort &&
+                             dynamic_cast<const NetworkLumped*>(network) != nullptr;
+        if (fusable && !stages.empty() && stages.back().fusable && stages.back().members.size() < kMaxFusedStages) {
+            stages.back().members.push_back(member);
+            networks.back().push_back(network);
+            continue;
+        }
 
+        Evaluation::Stage stage;
+        stage.members.push_back(member);
+        stage.fusable = fusable;
+        networks.push_back({network});
         stages.push_back(std::move(stage));
     }
 
-    Eigen::MatrixXcd total(freq.size(), 4);
-    for (int row = 0; row < freq.size(); ++row) {
-        Eigen::Matrix2cd accumulated;
-        accumulated << 0.0, 1.0,
-                        1.0, 0.0;
-
-        for (const auto& stage : stages) {
-            const Eigen::MatrixXcd& response = stage.response;
-            const int ports = stage.ports;
-            if (response.rows() != freq.size())
-                continue;
-
-            const Eigen::Index requiredCols = static_cast<Eigen::Index>(ports) * static_cast<Eigen::Index>(ports);
-            if (response.cols() < requiredCols)
-                continue;
-
-            const Eigen::Index s11Index = static_cast<Eigen::Index>(stage.inputPort * ports + stage.inputPort);
-            const Eigen::Index s12Index = static_cast<Eigen::Index>(stage.outputPort * ports + stage.inputPort);
-            const Eigen::Index s21Index = static_cast<Eigen::Index>(stage.inputPort * ports + stage.outputPort);
-            const Eigen::Index s22Index = static_cast<Eigen::Index>(stage.outputPort * ports + stage.outputPort);
+    const std::uint64_t gridHash = PlotDataCache::gridHash(freq.array());
+    std::lock_guard<std::mutex> lock(m_evaluationMutex);
+    std::unique_ptr<Evaluation> previous;
+    for (auto it = m_evaluations.begin(); it != m_evaluations.end(); ++it) {
+        if ((*it)->gridHash == gridHash && (*it)->grid.size() == freq.size() && (*it)->grid == freq) {
+            previous = std::move(*it);
+            m_evaluations.erase(it);
+            break;
+        }
+    }
 
-            if (s11Index >= response.cols() || s12Index >= response.cols() ||
-                s21Index >= response.cols() || s22Index >= response.cols()) {
-                continue;
+    // Unchanged stages keep their blocks wherever they moved to; only new or
+    // edited ones are evaluated.
+    std::vector<std::ptrdiff_t> origin(stages.size(), -1);
+    std::vector<std::size_t> pending;
+    if (previous) {
+        std::vector<bool> taken(previous->stages.size(), false);
+        for (std::size_t i = 0; i < stages.size(); ++i) {
+            for (std::size_t j = 0; j < previous->stages.size(); ++j) {
+                Evaluation::Stage& old = previous->stages[j];
+                if (taken[j] || !old.sameAs(stages[i]))
+                    continue;
+                taken[j] = true;
+                stages[i].usable = old.usable;
+                stages[i].blocks = std::move(old.blocks);
+                origin[i] = static_cast<std::ptrdiff_t>(j);
+                break;
             }
+            if (origin[i] < 0)
+                pending.push_back(i);
+        }
+    } else {
+        for (std::size_t i = 0; i < stages.size(); ++i)
+            pending.push_back(i);
+    }
 
-            Eigen::Matrix2cd s_matrix;
-            s_matrix << response(row, s11Index), response(row, s12Index),
-                         response(row, s21Index), response(row, s22Index);
-
-            accumulated = redhefferStar(accumulated, s_matrix);
+    g_stageHits += stages.size() - pending.size();
+    g_stageMisses += pending.size();
+
+    const unsigned threads = threadCount();
+    ThreadPool::global().parallelFor(pending.size(), [&](std::size_t k) {
+        Evaluation::Stage& stage = stages[pending[k]];
+        const std::vector<const Network*>& members = networks[pending[k]];
+        if (members.size() > 1) {
+            std::vector<FusedStage> run;
+            run.reserve(members.size());
+            for (std::size_t m = 0; m < members.size(); ++m)
+                run.push_back({static_cast<const NetworkLumped*>(members[m]), stage.members[m].inputPort == 1});
+            evaluateFused(run, freq, stage.blocks, threads);
+            stage.usable = true;
+            return;
         }
 
-        total.row(row) << accumulated(0, 0), accumulated(1, 0),
-                           accumulated(0, 1), accumulated(1, 1);
+        const Evaluation::Member& member = stage.members.front();
+        stage.usable = extractBlocks(members.front()->sparameters(freq), freq.size(), member.ports,
+                                     member.inputPort, member.outputPort, stage.blocks);
+        if (!stage.usable)
+            stage.blocks.resize(0);
+    }, threads);
+
+    auto evaluation = std::make_unique<Evaluation>();
+    evaluation->grid = freq;
+    evaluation->gridHash = gridHash;
+    evaluation->stages = std::move(stages);
+    for (std::size_t i = 0; i < evaluation->stages.size(); ++i) {
+        if (evaluation->stages[i].usable)
+            evaluation->leaves.push_back(i);
     }
 
+    // A product only needs recomputing if one of its leaves changed; when the
+    // number of leaves changes the tree's ranges do too, so it is rebuilt.
+    const std::size_t leafCount = evaluation->leaves.size();
+    const bool rebuild = !previous || previous->leaves.size() != leafCount;
+    std::vector<std::size_t> dirty(leafCount + 1, 0);
+    if (!rebuild) {
+        std::vector<std::ptrdiff_t> previousLeaf(previous->stages.size(), -1);
+        for (std::size_t k = 0; k < previous->leaves.size(); ++k)
+            previousLeaf[previous->leaves[k]] = static_cast<std::ptrdiff_t>(k);
+        for (std::size_t k = 0; k < leafCount; ++k) {
+            const std::ptrdiff_t from = origin[evaluation->leaves[k]];
+            const bool changed = from < 0 || previousLeaf[from] != static_cast<std::ptrdiff_t>(k);
+            dirty[k + 1] = dirty[k] + (changed ? 1 : 0);
+        }
+        evaluation->nodes = std::move(previous->nodes);
+    } else {
+        evaluation->nodes.resize(4 * std::max<std::size_t>(leafCount, 1));
+    }
+    previous.reset();
+    if (!rebuild && dirty[leafCount] == 0)
+        ++g_resultHits;
+    else
+        ++g_resultMisses;
+
+    Eigen::MatrixXcd total;
+    if (leafCount == 0) {
+        total.resize(freq.size(), 4);
+        total.col(0).setZero();
+        total.col(1).setOnes();
+        total.col(2).setOnes();
+        total.col(3).setZero();
+    } else {
+        const CascadeKernels::Blocks& product = evaluation->product(1, 0, leafCount, dirty, rebuild, threads);
+        total.resize(freq.size(), 4);
+        total.real() = product.re.matrix();
+        total.imag() = product.im.matrix();
+    }
+
+    m_evaluations.push_front(std::move(evaluation));
+    std::size_t bytes = 0;
+    for (std::size_t i = 0; i < m_evaluations.size(); ++i) {
+        bytes += m_evaluations[i]->bytes();
+        if (i >= kMaxEvaluations || bytes > kEvaluationBudget) {
+            m_evaluations.resize(i);
+            break;
+        }
+    }
     return total;
 }
 
+NetworkCascade::EvaluationStats NetworkCascade::evaluationStats()
+{
+    EvaluationStats stats;
+    stats.stageHits = g_stageHits;
+    stats.stageMisses = g_stageMisses;
+    stats.resultHits = g_resultHits;
+    stats.resultMisses = g_resultMisses;
+    return stats;
+}
+
+void NetworkCascade::resetEvaluationStats()
+{
+    g_stageHits = 0;
+    g_stageMisses = 0;
+    g_resultHits = 0;
+    g_resultMisses = 0;
+}
+
+void NetworkCascade::setThreadCount(unsigned threads)
+{
+    g_threadCount = threads;
+}
+
+unsigned NetworkCascade::threadCount()
+{
+    return g_threadCount;
+}
+
 void NetworkCascade::setNetworkPortSelection(int index, int toPort, int fromPort)
 {
     if (index < 0 || index >= m_networks.size())
@@ -260,6 +635,7 @@ void NetworkCascade::setNetworkPortSelection(int index, int toPort, int fromPort
 
     m_fromPorts[index] = sanitizedFrom;
     m_toPorts[index] = sanitizedTo;
+    invalidateData();
 }
 
 int NetworkCascade::toPort(int index) const
@@ -297,89 +673,79 @@ QPair<int, int> NetworkCascade::networkPortSelection(int index) const
     return qMakePair(sanitizedTo, sanitizedFrom);
 }
 
-QPair<QVector<double>, QVector<double>> NetworkCascade::getPlotData(int s_param_idx, PlotType type)
+bool NetworkCascade::setPortConnections(const QVector<PortConnection>& connections)
 {
-    updateFrequencyRange();
-    const int points = std::max(m_pointCount, 2);
-    Eigen::VectorXd freq = Eigen::VectorXd::LinSpaced(points, m_fmin, m_fmax);
-    Eigen::MatrixXcd s_matrix = sparameters(freq);
+    NetworkConnection check;
+    for (const Network* network : m_networks)
+        check.addNetwork(network);
+    for (const PortConnection& c : connections) {
+        if (!check.connect(c.stageA, c.portA, c.stageB, c.portB))
+            return false;
+    }
+    if (connections != m_portConnections) {
+        m_portConnections = connections;
+        invalidateData();
+    }
+    return true;
+}
+
+const QVector<NetworkCascade::PortConnection>& NetworkCascade::portConnections() const
+{
+    return m_portConnections;
+}
 
-    Eigen::ArrayXcd sparam(freq.size());
-    for (int i = 0; i < freq.size(); ++i) {
-        sparam(i) = s_matrix(i, s_param_idx);
+bool NetworkCascade::parsePortConnections(const QString& text, QVector<PortConnection>& connections)
+{
+    QVector<PortConnection> parsed;
+    const auto items = text.split(QLatin1Char(','), Qt::SkipEmptyParts);
+    for (const QString& item : items) {
+        const auto ends = item.trimmed().split(QLatin1Char('-'));
+        if (ends.size() != 2)
+            return false;
+        int values[4] = {0, 0, 0, 0};
+        for (int e = 0; e < 2; ++e) {
+            const auto fields = ends.at(e).trimmed().split(QLatin1Char(':'));
+            if (fields.size() != 2)
+                return false;
+            for (int f = 0; f < 2; ++f) {
+                bool ok = false;
+                values[2 * e + f] = fields.at(f).trimmed().toInt(&ok);
+                if (!ok || values[2 * e + f] < 1)
+                    return false;
+            }
+        }
+        parsed.append({values[0] - 1, values[1], values[2] - 1, values[3]});
     }
+    if (parsed.isEmpty())
+        return false;
+    connections = parsed;
+    return true;
+}
 
+QPair<QVector<double>, QVector<double>> NetworkCascade::getPlotData(int s_param_idx, PlotType type)
+{
     const int ports = portCount();
+    if (ports <= 0 || s_param_idx < 0 || s_param_idx >= ports * ports)
+        return {};
     const int outputPort = s_param_idx % ports;
     const int inputPort = s_param_idx / ports;
     const bool isReflectionParam = (outputPort == inputPort);
 
-    Network::TimeGateSettings gateSettings = Network::timeGateSettings();
-    TDRCalculator calculator;
-    TDRCalculator::Parameters tdrParams;
-    tdrParams.effectivePermittivity = std::max(gateSettings.epsilonR, 1.0);
-
-    std::optional<TDRCalculator::GateResult> gateResult;
-    if (gateSettings.enabled && isReflectionParam) {
-        auto gated = calculator.applyGate(freq.array(), sparam,
-                                         gateSettings.startDistance,
-                                         gateSettings.stopDistance,
-                                         gateSettings.epsilonR,
-                                         tdrParams);
-        if (gated) {
-            sparam = gated->gatedReflection;
-            gateResult = std::move(*gated);
+    if (m_frequencyPlan == FrequencyPlan::Adaptive) {
+        // The sampler already evaluated the cascade on its grid.
+        const std::shared_ptr<const AdaptiveSampler::Result> sampled = adaptiveResult();
+        if (sampled->response.cols() > s_param_idx) {
+            return cachedPlotData(s_param_idx, type, sampled->freq.array(), isReflectionParam, [&]() {
+                return viewColumn(sampled->response, s_param_idx, type);
+            });
         }
     }
 
-    QVector<double> freqVector(freq.data(), freq.data() + freq.size());
-
-    switch (type) {
-    case PlotType::Magnitude: {
-        Eigen::ArrayXd magnitude = 20 * sparam.abs().log10();
-        QVector<double> values(magnitude.data(), magnitude.data() + magnitude.size());
-        return qMakePair(freqVector, values);
-    }
-    case PlotType::Phase: {
-        Eigen::ArrayXd phase_rad = Network::wrapToMinusPiPi(sparam.arg());
-        if (m_unwrap_phase)
-            phase_rad = unwrap(phase_rad);
-        Eigen::ArrayXd phase_deg = phase_rad * (180.0 / pi);
-        QVector<double> values(phase_deg.data(), phase_deg.data() + phase_deg.size());
-        return qMakePair(freqVector, values);
-    }
-    case PlotType::GroupDelay: {
-        Eigen::ArrayXd phase_rad = Network::wrapToMinusPiPi(sparam.arg());
-        if (m_unwrap_phase)
-            phase_rad = unwrap(phase_rad);
-        Eigen::ArrayXd delay = Network::computeGroupDelay(phase_rad, freq.array());
-        QVector<double> values(delay.data(), delay.data() + delay.size());
-        return qMakePair(freqVector, values);
-    }
-    case PlotType::VSWR: {
-        Eigen::ArrayXd vswr = (1 + sparam.abs()) / (1 - sparam.abs());
-        QVector<double> values(vswr.data(), vswr.data() + vswr.size());
-        return qMakePair(freqVector, values);
-    }
-    case PlotType::Smith: {
-        Eigen::ArrayXd realPart = sparam.real();
-        Eigen::ArrayXd imagPart = sparam.imag();
-        QVector<double> xValues(realPart.data(), realPart.data() + realPart.size());
-        QVector<double> yValues(imagPart.data(), imagPart.data() + imagPart.size());
-        return qMakePair(xValues, yValues);
-    }
-    case PlotType::TDR:
-        if (!isReflectionParam)
-            return {};
-        if (gateResult)
-            return qMakePair(gateResult->distance, gateResult->impedance);
-        {
-            auto result = calculator.compute(freq.array(), sparam, tdrParams);
-            return qMakePair(result.distance, result.impedance);
-        }
-    }
+    const Eigen::ArrayXd freq = frequencyVector().array();
 
-    return {};
+    return cachedPlotData(s_param_idx, type, freq, isReflectionParam, [&]() {
+        return viewColumn(sparameters(freq.matrix()), s_param_idx, type);
+    });
 }
 
 Network* NetworkCascade::clone(QObject* parent) const
@@ -391,6 +757,8 @@ Network* NetworkCascade::clone(QObject* parent) const
     copy->setActive(m_is_active);
     copy->setFrequencyRange(m_fmin, m_fmax, m_manualFrequencyRange);
     copy->setPointCount(m_pointCount);
+    copy->setFrequencyPlan(m_frequencyPlan);
+    copy->setFrequencySegments(m_frequencySegments);
     copy->copyStyleSettingsFrom(this);
     for (int i = 0; i < m_networks.size(); ++i) {
         Network* net = m_networks.at(i);
@@ -402,14 +770,13 @@ Network* NetworkCascade::clone(QObject* parent) const
         const int insertedIndex = copy->getNetworks().size() - 1;
         copy->setNetworkPortSelection(insertedIndex, selection.first, selection.second);
     }
+    copy->setPortConnections(m_portConnections);
     return copy;
 }
 
 QVector<double> NetworkCascade::frequencies() const
 {
-    const_cast<NetworkCascade*>(this)->updateFrequencyRange();
-    const int points = std::max(m_pointCount, 2);
-    Eigen::VectorXd freq = Eigen::VectorXd::LinSpaced(points, m_fmin, m_fmax);
+    const Eigen::VectorXd freq = frequencyVector();
     return QVector<double>(freq.data(), freq.data() + freq.size());
 }
 
@@ -452,3 +819,175 @@ int NetworkCascade::pointCount() const
     return m_pointCount;
 }
 
+void NetworkCascade::setFrequencyPlan(FrequencyPlan plan)
+{
+    m_frequencyPlan = plan;
+}
+
+NetworkCascade::FrequencyPlan NetworkCascade::frequencyPlan() const
+{
+    return m_frequencyPlan;
+}
+
+void NetworkCascade::setFrequencySegments(const QVector<FrequencySegment>& segments)
+{
+    m_frequencySegments = segments;
+}
+
+const QVector<NetworkCascade::FrequencySegment>& NetworkCascade::frequencySegments() const
+{
+    return m_frequencySegments;
+}
+
+Eigen::VectorXd NetworkCascade::frequencyVector() const
+{
+    const_cast<NetworkCascade*>(this)->updateFrequencyRange();
+    double fmin = m_fmin;
+    double fmax = m_fmax;
+    if (!(fmax > fmin)) {
+        fmin = 1e6;
+        fmax = 10e9;
+    }
+
+    switch (m_frequencyPlan) {
+    case FrequencyPlan::Logarithmic:
+        return sweepFrequencies(fmin, fmax, m_pointCount, true);
+    case FrequencyPlan::Native: {
+        Eigen::VectorXd freq = nativeFrequencies();
+        // A native grid needs at least one file stage; lumped stages alone
+        // have none and are swept like the linear plan.
+        if (freq.size() > 0)
+            return freq;
+        break;
+    }
+    case FrequencyPlan::Segments: {
+        Eigen::VectorXd freq = segmentFrequencies(m_frequencySegments);
+        if (freq.size() > 0)
+            return freq;
+        break;
+    }
+    case FrequencyPlan::Adaptive:
+        return adaptiveResult()->freq;
+    case FrequencyPlan::Linear:
+        break;
+    }
+    return sweepFrequencies(fmin, fmax, m_pointCount, false);
+}
+
+Eigen::VectorXd NetworkCascade::nativeFrequencies() const
+{
+    std::vector<double> merged;
+    for (int i = 0; i < m_networks.size(); ++i) {
+        const Network* network = m_networks.at(i);
+        if (!network->hasNativeGrid() || !network->isActive())
+            continue;
+        const QVector<double> grid = network->frequencies();
+        for (double f : grid) {
+            if (f >= m_fmin && f <= m_fmax)
+                merged.push_back(f);
+        }
+    }
+    std::sort(merged.begin(), merged.end());
+    // Points that only differ by the rounding of another file's text are one.
+    merged.erase(std::unique(merged.begin(), merged.end(), [](double a, double b) {
+        return b - a <= 1e-12 * std::abs(b);
+    }), merged.end());
+    return Eigen::Map<const Eigen::VectorXd>(merged.data(), static_cast<Eigen::Index>(merged.size()));
+}
+
+std::shared_ptr<const AdaptiveSampler::Result> NetworkCascade::adaptiveResult() const
+{
+    const_cast<NetworkCascade*>(this)->updateFrequencyRange();
+    double fmin = m_fmin;
+    double fmax = m_fmax;
+    if (!(fmax > fmin)) {
+        fmin = 1e6;
+        fmax = 10e9;
+    }
+    AdaptiveSampler::Settings settings;
+    settings.maxPoints = std::max(m_pointCount, 2);
+    return m_adaptiveMemo.get(dataVersion(), fmin, fmax, settings, [this](const Eigen::VectorXd& freq) {
+        return sparameters(freq);
+    });
+}
+
+Eigen::VectorXd NetworkCascade::sweepFrequencies(double fmin, double fmax, int points, bool logarithmic)
+{
+    points = std::max(points, 2);
+    if (!logarithmic || !(fmin > 0.0) || !(fmax > 0.0))
+        return Eigen::VectorXd::LinSpaced(points, fmin, fmax);
+    Eigen::VectorXd freq = Eigen::VectorXd::LinSpaced(points, std::log10(fmin), std::log10(fmax));
+    for (Eigen::Index i = 0; i < freq.size(); ++i)
+        freq(i) = std::pow(10.0, freq(i));
+    // Keep the end points exact; pow(10, log10(x)) may be off by an ulp.
+    freq(0) = fmin;
+    freq(freq.size() - 1) = fmax;
+    return freq;
+}
+
+Eigen::VectorXd NetworkCascade::segmentFrequencies(const QVector<FrequencySegment>& segments)
+{
+    std::vector<double> merged;
+    for (const FrequencySegment& segment : segments) {
+        if (!(segment.fmax >= segment.fmin))
+            continue;
+        const Eigen::VectorXd sweep = sweepFrequencies(segment.fmin, segment.fmax, segment.points, segment.logarithmic);
+        merged.insert(merged.end(), sweep.data(), sweep.data() + sweep.size());
+    }
+    // Adjacent segments usually share their boundary point.
+    std::sort(merged.begin(), merged.end());
+    merged.erase(std::unique(merged.begin(), merged.end()), merged.end());
+    return Eigen::Map<const Eigen::VectorXd>(merged.data(), static_cast<Eigen::Index>(merged.size()));
+}
+
+bool NetworkCascade::parseFrequencySegments(const QString& text, QVector<FrequencySegment>& segments)
+{
+    QVector<FrequencySegment> parsed;
+    const auto items = text.split(QLatin1Char(','), Qt::SkipEmptyParts);
+    for (const QString& item : items) {
+        const auto fields = item.trimmed().split(QLatin1Char(':'));
+        if (fields.size() != 3 && fields.size() != 4)
+            return false;
+        FrequencySegment segment;
+        bool okMin = false;
+        bool okMax = false;
+        bool okPoints = false;
+        segment.fmin = fields.at(0).trimmed().toDouble(&okMin);
+        segment.fmax = fields.at(1).trimmed().toDouble(&okMax);
+        segment.points = fields.at(2).trimmed().toInt(&okPoints);
+        if (!okMin || !okMax || !okPoints || segment.points < 2 || !(segment.fmin >= 0.0) || !(segment.fmax > segment.fmin))
+            return false;
+        if (fields.size() == 4) {
+            const QString spacing = fields.at(3).trimmed();
+            if (spacing.compare(QStringLiteral("log"), Qt::CaseInsensitive) == 0)
+                segment.logarithmic = true;
+            else if (spacing.compare(QStringLiteral("lin"), Qt::CaseInsensitive) != 0)
+                return false;
+        }
+        if (segment.logarithmic && segment.fmin == 0.0)
+            return false;
+        parsed.append(segment);
+    }
+    if (parsed.isEmpty())
+        return false;
+    segments = parsed;
+    return true;
+}
+
+QString NetworkCascade::formatFrequencySegments(const QVector<FrequencySegment>& segments)
+{
+    QString text;
+    for (const FrequencySegment& segment : segments) {
+        if (!text.isEmpty())
+            text.append(QLatin1Char(','));
+        text.append(QString::number(segment.fmin, 'g', 12));
+        text.append(QLatin1Char(':'));
+        text.append(QString::number(segment.fmax, 'g', 12));
+        text.append(QLatin1Char(':'));
+        text.append(QString::number(segment.points));
+        if (segment.logarithmic)
+            text.append(QStringLiteral(":log"));
+    }
+    return text;
+}
+
@@ -1,9 +1,15 @@
 #ifndef NETWORKCASCADE_H
 #define NETWORKCASCADE_H
 
+#include "adaptivesampler.h"
 #include "network.h"
 #include <QList>
+#include <QVector>
+#include <deque>
 #include <memory>
+#include <mutex>
+
+class NetworkConnection;
 
 class NetworkCascade : public Network
 {
@@ -26,27 +32,133 @@ public:
 
     QVector<double> frequencies() const override;
     int portCount() const override;
+    quint64 dataVersion() const override;
 
     void setNetworkPortSelection(int index, int toPort, int fromPort);
     int toPort(int index) const;
     int fromPort(int index) const;
     QPair<int, int> networkPortSelection(int index) const;
 
+    // A connection between two stages' ports, by the stages' index in
+    // getNetworks() and 1-based port numbers.
+    struct PortConnection
+    {
+        int stageA = 0;
+        int portA = 1;
+        int stageB = 0;
+        int portB = 1;
+
+        bool operator==(const PortConnection& other) const
+        {
+            return stageA == other.stageA && portA == other.portA && stageB == other.stageB && portB == other.portB;
+        }
+    };
+
+    // Without connections the stages form the 2-port chain picked by the port
+    // selections. With any, the active stages' full matrices are joined by
+    // NetworkConnection instead: the listed ports are connected and every
+    // other port becomes an external port of the result, numbered by stage and
+    // then port. Connections follow their stages when stages move, and go
+    // with a removed stage. Returns false, keeping the current connections,
+    // when one names a missing stage or port or a port already in use.
+    bool setPortConnections(const QVector<PortConnection>& connections);
+    const QVector<PortConnection>& portConnections() const;
+    // "stage:port-stage:port" items with 1-based stages, separated by commas.
+    static bool parsePortConnections(const QString& text, QVector<PortConnection>& connections);
+
     void setFrequencyRange(double fmin, double fmax, bool manualOverride = true);
     void clearManualFrequencyRange();
     bool hasManualFrequencyRange() const;
     void setPointCount(int pointCount);
     int pointCount() const;
 
+    // How the grid of getPlotData(), frequencies() and saved results is laid
+    // out. Linear and Logarithmic spread pointCount() points over the range;
+    // Native takes the union of the file stages' own grids within the range,
+    // so no stage is interpolated when they all share one grid; Segments
+    // concatenates explicit sub-sweeps and ignores range and point count;
+    // Adaptive refines the range where the response changes fastest, using at
+    // most pointCount() points.
+    enum class FrequencyPlan
+    {
+        Linear,
+        Logarithmic,
+        Native,
+        Segments,
+        Adaptive
+    };
+
+    struct FrequencySegment
+    {
+        double fmin = 0.0;
+        double fmax = 0.0;
+        int points = 2;
+        bool logarithmic = false;
+
+        bool operator==(const FrequencySegment& other) const
+        {
+            return fmin == other.fmin && fmax == other.fmax && points == other.points && logarithmic == other.logarithmic;
+        }
+    };
+
+    void setFrequencyPlan(FrequencyPlan plan);
+    FrequencyPlan frequencyPlan() const;
+    void setFrequencySegments(const QVector<FrequencySegment>& segments);
+    const QVector<FrequencySegment>& frequencySegments() const;
+    // The grid the current plan yields, ascending and without duplicates.
+    Eigen::VectorXd frequencyVector() const;
+
+    // Evenly spaced from fmin to fmax; logarithmic spacing needs fmin > 0
+    // and falls back to linear otherwise.
+    static Eigen::VectorXd sweepFrequencies(double fmin, double fmax, int points, bool logarithmic);
+    static Eigen::VectorXd segmentFrequencies(const QVector<FrequencySegment>& segments);
+    // Segments written as "fmin:fmax:points[:log]", separated by commas.
+    static bool parseFrequencySegments(const QString& text, QVector<FrequencySegment>& segments);
+    static QString formatFrequencySegments(const QVector<FrequencySegment>& segments);
+
+    // Threads used to evaluate stages and frequency blocks; 0 uses the whole pool.
+    static void setThreadCount(unsigned threads);
+    static unsigned threadCount();
+
+    // Reuse of memoized stage responses and whole cascade results, summed
+    // over every cascade in the process.
+    struct EvaluationStats
+    {
+        quint64 stageHits = 0;
+        quint64 stageMisses = 0;
+        quint64 resultHits = 0;
+        quint64 resultMisses = 0;
+
+        double stageHitRate() const { return stageHits + stageMisses == 0 ? 0.0 : static_cast<double>(stageHits) / static_cast<double>(stageHits + stageMisses); }
+        double resultHitRate() const { return resultHits + resultMisses == 0 ? 0.0 : static_cast<double>(resultHits) / static_cast<double>(resultHits + resultMisses); }
+    };
+    static EvaluationStats evaluationStats();
+    static void resetEvaluationStats();
 
 private:
+    struct Evaluation;
+
+    // Adds the active stages and their connections to `connection`.
+    void connectStages(NetworkConnection& connection) const;
+
     void updateFrequencyRange();
+    Eigen::VectorXd nativeFrequencies() const;
+    std::shared_ptr<const AdaptiveSampler::Result> adaptiveResult() const;
 
     QList<Network*> m_networks;
     QList<int> m_toPorts;
     QList<int> m_fromPorts;
+    QVector<PortConnection> m_portConnections;
     int m_pointCount;
     bool m_manualFrequencyRange;
+    FrequencyPlan m_frequencyPlan;
+    QVector<FrequencySegment> m_frequencySegments;
+    mutable AdaptiveSampler::Memo m_adaptiveMemo;
+
+    // Stage blocks and partial star products of the most recently evaluated
+    // grids, newest first.
+    mutable std::mutex m_evaluationMutex;
+    mutable std::deque<std::unique_ptr<Evaluation>> m_evaluations;
 };
 
 #endif // NETWORKCASCADE_H
@@ -0,0 +1,221 @@
+#include "networkconnection.h"
+#include "networkcascade.h"
+#include "threadpool.h"
+
+#include <Eigen/LU>
+#include <algorithm>
+#include <complex>
+#include <vector>
+
+namespace {
+
+using Complex = std::complex<double>;
+
+// Rows per parallel block; each worker keeps its solver workspace for a block.
+constexpr Eigen::Index kBlockRows = 256;
+
+// The ports of all networks form one block-diagonal scattering matrix. With
+// the connected (internal) ports i and the external ports e, and C the
+// permutation pairing each internal port with its peer (a_i = C b_i), the
+// external response is
+//     S = See + Sei (C - Sii)^-1 Sie,
+// one linear solve per frequency.
+struct Layout
+{
+    struct Location
+    {
+        int network;
+        int port;       // 0-based within the network
+        int ports;      // of that network
+    };
+
+    std::vector<Location> internal;
+    std::vector<Location> external;
+    std::vector<int> peer;      // internal index of each internal port's peer
+};
+
+Complex entry(const std::vector<Eigen::MatrixXcd>& responses, Eigen::Index row,
+              const Layout::Location& to, const Layout::Location& from)
+{
+    if (to.network != from.network)
+        return Complex(0.0, 0.0);
+    return responses[to.network](row, static_cast<Eigen::Index>(from.port) * to.ports + to.port);
+}
+
+template <int Internal>
+void solveRows(const std::vector<Eigen::MatrixXcd>& responses, const Layout& layout, Eigen::Index begin,
+               Eigen::Index end, Eigen::MatrixXcd& result)
+{
+    using Square = Eigen::Matrix<Complex, Internal, Internal>;
+    using Tall = Eigen::Matrix<Complex, Internal, Eigen::Dynamic>;
+
+    const int internal = static_cast<int>(layout.internal.size());
+    const int external = static_cast<int>(layout.external.size());
+    Square system(internal, internal);
+    Tall rhs(internal, external);
+    Tall incident(internal, external);
+    Eigen::PartialPivLU<Square> lu(internal);
+
+    for (Eigen::Index row = begin; row < end; ++row) {
+        if (internal > 0) {
+            for (int k = 0; k < internal; ++k) {
+                for (int l = 0; l < internal; ++l)
+                    system(k, l) = -entry(responses, row, layout.internal[k], layout.internal[l]);
+                system(k, layout.peer[k]) += 1.0;
+                for (int e = 0; e < external; ++e)
+                    rhs(k, e) = entry(responses, row, layout.internal[k], layout.external[e]);
+            }
+            lu.compute(system);
+            incident = lu.solve(rhs);
+        }
+
+        for (int j = 0; j < external; ++j) {
+            for (int i = 0; i < external; ++i) {
+                Complex value = entry(responses, row, layout.external[i], layout.external[j]);
+                for (int k = 0; k < internal; ++k)
+                    value += entry(responses, row, layout.external[i], layout.internal[k]) * incident(k, j);
+                result(row, static_cast<Eigen::Index>(j) * external + i) = value;
+            }
+        }
+    }
+}
+
+void solveBlock(const std::vector<Eigen::MatrixXcd>& responses, const Layout& layout, Eigen::Index begin,
+                Eigen::Index end, Eigen::MatrixXcd& result)
+{
+    // Fixed sizes keep the small systems of typical connections on the stack.
+    switch (layout.internal.size()) {
+    case 2:
+        solveRows<2>(responses, layout, begin, end, result);
+        break;
+    case 4:
+        solveRows<4>(responses, layout, begin, end, result);
+        break;
+    case 6:
+        solveRows<6>(responses, layout, begin, end, result);
+        break;
+    case 8:
+        solveRows<8>(responses, layout, begin, end, result);
+        break;
+    default:
+        solveRows<Eigen::Dynamic>(responses, layout, begin, end, result);
+        break;
+    }
+}
+
+} // namespace
+
+int NetworkConnection::addNetwork(const Network* network)
+{
+    const int ports = network ? std::max(network->portCount(), 0) : 0;
+    m_firstPort.append(m_peer.size());
+    m_peer.resize(m_peer.size() + ports, -1);
+    m_networks.append(network);
+    return m_networks.size() - 1;
+}
+
+bool NetworkConnection::connect(int networkA, int portA, int networkB, int portB)
+{
+    const int a = globalPort(networkA, portA);
+    const int b = globalPort(networkB, portB);
+    if (a < 0 || b < 0 || a == b || m_peer.at(a) >= 0 || m_peer.at(b) >= 0)
+        return false;
+    m_peer[a] = b;
+    m_peer[b] = a;
+    return true;
+}
+
+void NetworkConnection::clear()
+{
+    m_networks.clear();
+    m_firstPort.clear();
+    m_peer.clear();
+}
+
+const QList<const Network*>& NetworkConnection::networks() const
+{
+    return m_networks;
+}
+
+QVector<NetworkConnection::Port> NetworkConnection::externalPorts() const
+{
+    QVector<Port> ports;
+    for (int n = 0; n < m_networks.size(); ++n) {
+        for (int g = m_firstPort.at(n); g < m_firstPort.at(n) + portsOf(n); ++g) {
+            if (m_peer.at(g) < 0)
+                ports.append({n, g - m_firstPort.at(n) + 1});
+        }
+    }
+    return ports;
+}
+
+int NetworkConnection::portCount() const
+{
+    return static_cast<int>(std::count(m_peer.cbegin(), m_peer.cend(), -1));
+}
+
+int NetworkConnection::portsOf(int network) const
+{
+    const int end = (network + 1 < m_firstPort.size()) ? m_firstPort.at(network + 1) : m_peer.size();
+    return end - m_firstPort.at(network);
+}
+
+int NetworkConnection::globalPort(int network, int port) const
+{
+    if (network < 0 || network >= m_networks.size() || !m_networks.at(network))
+        return -1;
+    if (port < 1 || port > portsOf(network))
+        return -1;
+    return m_firstPort.at(network) + port - 1;
+}
+
+Eigen::MatrixXcd NetworkConnection::sparameters(const Eigen::VectorXd& freq) const
+{
+    const int external = portCount();
+    if (freq.size() == 0 || external == 0)
+        return {};
+
+    const unsigned threads = NetworkCascade::threadCount();
+    ThreadPool& pool = ThreadPool::global();
+
+    std::vector<Eigen::MatrixXcd> responses(m_networks.size());
+    pool.parallelFor(responses.size(), [&](std::size_t n) {
+        if (m_networks.at(static_cast<int>(n)))
+            responses[n] = m_networks.at(static_cast<int>(n))->sparameters(freq);
+    }, threads);
+
+    Layout layout;
+    std::vector<int> internalIndex(m_peer.size(), -1);
+    for (int n = 0; n < m_networks.size(); ++n) {
+        const int ports = portsOf(n);
+        const Eigen::MatrixXcd& response = responses[n];
+        const bool usable = response.rows() == freq.size() &&
+                            response.cols() >= static_cast<Eigen::Index>(ports) * ports;
+        for (int p = 0; p < ports; ++p) {
+            const int g = m_firstPort.at(n) + p;
+            if (m_peer.at(g) < 0) {
+                layout.external.push_back({n, p, ports});
+            } else {
+                internalIndex[g] = static_cast<int>(layout.internal.size());
+                layout.internal.push_back({n, p, ports});
+            }
+        }
+        if (!usable && ports > 0) {
+            // A network without data behaves as if nothing came out of it.
+            responses[n] = Eigen::MatrixXcd::Zero(freq.size(), static_cast<Eigen::Index>(ports) * ports);
+        }
+    }
+    for (int g = 0; g < m_peer.size(); ++g) {
+        if (m_peer.at(g) >= 0)
+            layout.peer.push_back(internalIndex[m_peer.at(g)]);
+    }
+
+    const Eigen::Index rows = freq.size();
+    Eigen::MatrixXcd result(rows, static_cast<Eigen::Index>(external) * external);
+    const std::size_t blocks = static_cast<std::size_t>((rows + kBlockRows - 1) / kBlockRows);
+    pool.parallelFor(blocks, [&](std::size_t block) {
+        const Eigen::Index begin = static_cast<Eigen::Index>(block) * kBlockRows;
+        solveBlock(responses, layout, begin, std::min(rows, begin + kBlockRows), result);
+    }, threads);
+    return result;
+}
@@ -0,0 +1,45 @@
+#ifndef NETWORKCONNECTION_H
+#define NETWORKCONNECTION_H
+
+#include "network.h"
+#include <QList>
+#include <QVector>
+
+// Connects arbitrary ports of N-port networks with each other. Every port left
+// unconnected becomes an external port of the result, numbered in the order
+// the networks and their ports were added. Unlike NetworkCascade, which keeps
+// a 2x2 sub-matrix per stage, the full matrices of all networks take part.
+class NetworkConnection
+{
+public:
+    struct Port
+    {
+        int network = 0;    // index returned by addNetwork()
+        int port = 0;       // 1-based, as in the port selectors
+    };
+
+    // The networks are not owned and must outlive their use here.
+    int addNetwork(const Network* network);
+    // False when either port does not exist, is already connected, or both
+    // name the same port.
+    bool connect(int networkA, int portA, int networkB, int portB);
+    void clear();
+
+    const QList<const Network*>& networks() const;
+    QVector<Port> externalPorts() const;
+    int portCount() const;
+
+    // Rows are frequencies; column j * portCount() + i holds S(i, j) between
+    // external ports i and j, the layout Network::sparameters() uses.
+    Eigen::MatrixXcd sparameters(const Eigen::VectorXd& freq) const;
+
+private:
+    int portsOf(int network) const;
+    int globalPort(int network, int port) const;
+
+    QList<const Network*> m_networks;
+    QVector<int> m_firstPort;   // global index of each network's port 1, fixed when added
+    QVector<int> m_peer;        // connected global port, or -1
+};
+
+#endif // NETWORKCONNECTION_H
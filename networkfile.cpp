@@ -1,26 +1,88 @@
 #include "networkfile.h"
-#include "tdrcalculator.h"
+#include "touchstone_cache.h"
+#include "touchstone_registry.h"
 #include <QFileInfo>
 #include <iostream>
 #include <numeric>
 #include <algorithm>
-#include <optional>
+
+namespace {
+ts::ParseOptions g_parseOptions;
+}
 
 NetworkFile::NetworkFile(const QString &filePath, QObject *parent)
     : Network(parent), m_file_path(filePath)
 {
     try {
-        m_data = std::make_unique<ts::TouchstoneData>(ts::parse_touchstone(filePath.toStdString()));
-        if (m_data->freq.size() > 0) {
-            m_fmin = m_data->freq.minCoeff();
-            m_fmax = m_data->freq.maxCoeff();
-        }
+        const ts::TouchstoneProbe probe = ts::probe_touchstone(filePath.toStdString());
+        m_probedPorts = probe.ports;
+        m_probedPoints = static_cast<int>(probe.estimated_points);
+        m_fmin = probe.fmin;
+        m_fmax = probe.fmax;
     } catch (const std::exception& e) {
         std::cerr << "Error processing file " << filePath.toStdString() << ": " << e.what() << std::endl;
-        m_data = nullptr;
+        std::call_once(m_loadOnce, [this, &e] {
+            m_loadError = QString::fromStdString(e.what());
+            m_loaded = true;
+        });
     }
 }
 
+NetworkFile::NetworkFile(const NetworkFile& source, QObject* parent)
+    : Network(parent),
+      m_file_path(source.m_file_path),
+      m_probedPorts(source.m_probedPorts),
+      m_probedPoints(source.m_probedPoints)
+{
+    if (source.m_loaded) {
+        std::call_once(m_loadOnce, [this, &source] {
+            m_data = source.m_data;
+            m_loadError = source.m_loadError;
+            m_loaded = true;
+        });
+    }
+}
+
+void NetworkFile::load() const
+{
+    std::call_once(m_loadOnce, [this] {
+        try {
+            m_data = ts::TouchstoneRegistry::instance().load(m_file_path.toStdString(), g_parseOptions);
+        } catch (const std::exception& e) {
+            std::cerr << "Error processing file " << m_file_path.toStdString() << ": " << e.what() << std::endl;
+            m_loadError = QString::fromStdString(e.what());
+        }
+        m_loaded = true;
+    });
+}
+
+bool NetworkFile::isLoaded() const
+{
+    return m_loaded;
+}
+
+QString NetworkFile::loadError() const
+{
+    return m_loaded ? m_loadError : QString();
+}
+
+int NetworkFile::pointCount() const
+{
+    if (!m_loaded)
+        return m_probedPoints;
+    return m_data ? static_cast<int>(m_data->freq.size()) : 0;
+}
+
+void NetworkFile::setParseOptions(const ts::ParseOptions& options)
+{
+    g_parseOptions = options;
+}
+
+ts::ParseOptions NetworkFile::parseOptions()
+{
+    return g_parseOptions;
+}
+
 QString NetworkFile::name() const
 {
     return QFileInfo(m_file_path).fileName();
@@ -33,7 +95,7 @@ QString NetworkFile::filePath() const
 
 Network* NetworkFile::clone(QObject* parent) const
 {
-    NetworkFile* copy = new NetworkFile(m_file_path, parent);
+    NetworkFile* copy = new NetworkFile(*this, parent);
     copy->setColor(m_color);
     copy->setVisible(m_is_visible);
     copy->setUnwrapPhase(m_unwrap_phase);
@@ -46,6 +108,7 @@ Network* NetworkFile::clone(QObject* parent) const
 
 QPair<QVector<double>, QVector<double>> NetworkFile::getPlotData(int s_param_idx, PlotType type)
 {
+    load();
     if (!m_data || s_param_idx < 0 || s_param_idx >= m_data->sparams.cols()) {
         return {};
     }
@@ -59,146 +122,107 @@ QPair<QVector<double>, QVector<double>> NetworkFile::getPlotData(int s_param_idx
     const int inputPortIndex = s_param_idx / ports;
     const bool isReflection = (outputPortIndex == inputPortIndex);
 
-    Eigen::ArrayXd xValues;
-    Eigen::ArrayXd yValues;
-
-    Eigen::ArrayXcd s_param_col = m_data->sparams.col(s_param_idx);
+    return cachedPlotData(s_param_idx, type, m_data->freq, isReflection, [&]() {
+        return viewColumn(m_data->sparams, s_param_idx, type);
+    });
+}
 
-    // Renormalize to 50 Ohm when needed
-    if (type == PlotType::VSWR || type == PlotType::Smith || type == PlotType::TDR) {
-        double R = m_data->R;
-        Eigen::ArrayXcd z = R * (1.0 + s_param_col) / (1.0 - s_param_col);
-        s_param_col = (z - 50.0) / (z + 50.0);
+std::shared_ptr<const NetworkFile::InterpolationPlan> NetworkFile::buildInterpolationPlan(const Eigen::VectorXd& freq, std::uint64_t hash) const
+{
+    auto plan = std::make_shared<InterpolationPlan>();
+    plan->grid = freq;
+    plan->gridHash = hash;
+
+    const Eigen::VectorXd& freqs = m_data->freq;
+    const Eigen::Index count = freqs.size();
+    if (freq.size() == count && (freq.array() == freqs.array()).all()) {
+        plan->identity = true;
+        return plan;
     }
 
-    Network::TimeGateSettings gateSettings = Network::timeGateSettings();
-    const bool isReflectionParam = isReflection;
-    TDRCalculator calculator;
-    TDRCalculator::Parameters tdrParams;
-    tdrParams.effectivePermittivity = std::max(gateSettings.epsilonR, 1.0);
-
-    std::optional<TDRCalculator::GateResult> gateResult;
-    if (gateSettings.enabled && isReflectionParam) {
-        auto gated = calculator.applyGate(m_data->freq, s_param_col,
-                                         gateSettings.startDistance,
-                                         gateSettings.stopDistance,
-                                         gateSettings.epsilonR,
-                                         tdrParams);
-        if (gated) {
-            s_param_col = gated->gatedReflection;
-            gateResult = std::move(*gated);
+    // A non-decreasing grid is bracketed in one merge walk; anything else
+    // (including NaN) falls back to a binary search per point.
+    bool sorted = true;
+    for (Eigen::Index i = 1; i < freq.size() && sorted; ++i)
+        sorted = freq(i) >= freq(i - 1);
+
+    const double* begin = freqs.data();
+    const double* end = begin + count;
+    Eigen::Index upper = 1;
+    for (Eigen::Index i = 0; i < freq.size(); ++i) {
+        const double f = freq(i);
+        if (count == 1 || f <= freqs(0)) {
+            plan->copyTarget.push_back(i);
+            plan->copySource.push_back(0);
+            continue;
+        }
+        if (f >= freqs(count - 1)) {
+            plan->copyTarget.push_back(i);
+            plan->copySource.push_back(count - 1);
+            continue;
         }
-    }
 
-    switch (type) {
-    case PlotType::Magnitude:
-        xValues = m_data->freq;
-        yValues = 20 * s_param_col.abs().log10();
-        break;
-    case PlotType::Phase:
-    {
-        xValues = m_data->freq;
-        Eigen::ArrayXd phase_rad = Network::wrapToMinusPiPi(s_param_col.arg());
-        Eigen::ArrayXd unwrapped_phase_rad = m_unwrap_phase ? unwrap(phase_rad) : phase_rad;
-        yValues = unwrapped_phase_rad * (180.0 / M_PI);
-        break;
-    }
-    case PlotType::GroupDelay:
-    {
-        xValues = m_data->freq;
-        Eigen::ArrayXd phase_rad = Network::wrapToMinusPiPi(s_param_col.arg());
-        Eigen::ArrayXd unwrapped_phase_rad = m_unwrap_phase ? unwrap(phase_rad) : phase_rad;
-        yValues = Network::computeGroupDelay(unwrapped_phase_rad, xValues);
-        break;
-    }
-    case PlotType::VSWR:
-        xValues = m_data->freq;
-        yValues = (1 + s_param_col.abs()) / (1 - s_param_col.abs());
-        break;
-    case PlotType::Smith:
-        xValues = s_param_col.real();
-        yValues = s_param_col.imag();
-        break;
-    case PlotType::TDR:
-        if (!isReflectionParam)
-            return {};
-        if (gateResult)
-            return qMakePair(gateResult->distance, gateResult->impedance);
-        {
-            auto result = calculator.compute(m_data->freq, s_param_col, tdrParams);
-            return qMakePair(result.distance, result.impedance);
+        if (sorted) {
+            while (freqs(upper) < f)
+                ++upper;
+        } else {
+            upper = std::max<Eigen::Index>(std::lower_bound(begin, end, f) - begin, 1);
+        }
+        const Eigen::Index lower = upper - 1;
+        const double f1 = freqs(lower);
+        const double f2 = freqs(upper);
+        if (f2 == f1) {
+            plan->copyTarget.push_back(i);
+            plan->copySource.push_back(lower);
+            continue;
         }
+        plan->interpTarget.push_back(i);
+        plan->lower.push_back(lower);
+        plan->weight.push_back((f - f1) / (f2 - f1));
     }
-
-    QVector<double> xValuesQVector = QVector<double>(xValues.data(), xValues.data() + xValues.size());
-    QVector<double> yValuesQVector = QVector<double>(yValues.data(), yValues.data() + yValues.size());
-
-    return qMakePair(xValuesQVector, yValuesQVector);
+    return plan;
 }
 
-std::complex<double> NetworkFile::interpolate_s_param(double freq, int s_param_idx) const
+std::shared_ptr<const NetworkFile::InterpolationPlan> NetworkFile::interpolationPlan(const Eigen::VectorXd& freq) const
 {
-    if (!m_data) {
-        return {0, 0};
-    }
-
-    if (s_param_idx < 0 || s_param_idx >= m_data->sparams.cols()) {
-        return {0, 0};
-    }
-
-    const auto& freqs = m_data->freq;
-    if (freqs.size() == 0) {
-        return {0, 0};
-    }
-
-    const auto& sparams = m_data->sparams.col(s_param_idx);
-
-    const auto last_idx = freqs.size() - 1;
-    if (freq <= freqs[0]) {
-        return sparams[0];
-    }
-    if (freq >= freqs[last_idx]) {
-        return sparams[last_idx];
-    }
-
-    auto it = std::lower_bound(freqs.data(), freqs.data() + freqs.size(), freq);
-    if (it == freqs.data()) {
-        it++;
-    }
-    int upper_idx = std::distance(freqs.data(), it);
-    int lower_idx = upper_idx - 1;
-
-    double f1 = freqs[lower_idx];
-    double f2 = freqs[upper_idx];
-
-    if (f2 == f1) {
-        return sparams[lower_idx];
+    constexpr std::size_t kMaxPlans = 4;
+    const std::uint64_t hash = ts::content_hash(reinterpret_cast<const char*>(freq.data()),
+                                                static_cast<std::size_t>(freq.size()) * sizeof(double));
+    {
+        std::lock_guard<std::mutex> lock(m_planMutex);
+        for (auto it = m_plans.begin(); it != m_plans.end(); ++it) {
+            const InterpolationPlan& cached = **it;
+            if (cached.gridHash == hash && cached.grid.size() == freq.size() && (cached.grid.array() == freq.array()).all()) {
+                auto plan = *it;
+                m_plans.erase(it);
+                m_plans.push_front(plan);
+                return plan;
+            }
+        }
     }
 
-    std::complex<double> s1 = sparams[lower_idx];
-    std::complex<double> s2 = sparams[upper_idx];
-
-    double mag1 = std::abs(s1);
-    double mag2 = std::abs(s2);
-    double phase1 = std::arg(s1);
-    double phase2 = std::arg(s2);
-
-    // unwrap phase
-    if (phase2 - phase1 > M_PI) {
-        phase2 -= 2 * M_PI;
-    } else if (phase1 - phase2 > M_PI) {
-        phase1 -= 2 * M_PI;
+    auto plan = buildInterpolationPlan(freq, hash);
+    std::lock_guard<std::mutex> lock(m_planMutex);
+    m_plans.push_front(plan);
+    if (m_plans.size() > kMaxPlans)
+        m_plans.pop_back();
+    if (!plan->interpTarget.empty() && m_magnitude.size() == 0) {
+        const Eigen::ArrayXXcd& sparams = m_data->sparams;
+        m_magnitude.resize(sparams.rows(), sparams.cols());
+        m_phase.resize(sparams.rows(), sparams.cols());
+        for (Eigen::Index col = 0; col < sparams.cols(); ++col) {
+            for (Eigen::Index row = 0; row < sparams.rows(); ++row) {
+                m_magnitude(row, col) = std::abs(sparams(row, col));
+                m_phase(row, col) = std::arg(sparams(row, col));
+            }
+        }
     }
-
-    double t = (freq - f1) / (f2 - f1);
-    double interpolated_mag = mag1 + t * (mag2 - mag1);
-    double interpolated_phase = phase1 + t * (phase2 - phase1);
-
-    return std::polar(interpolated_mag, interpolated_phase);
+    return plan;
 }
 
 QVector<double> NetworkFile::frequencies() const
 {
+    load();
     if (!m_data)
         return {};
     return QVector<double>(m_data->freq.data(), m_data->freq.data() + m_data->freq.size());
@@ -206,13 +230,27 @@ QVector<double> NetworkFile::frequencies() const
 
 int NetworkFile::portCount() const
 {
+    if (!m_loaded)
+        return m_probedPorts;
     if (!m_data)
         return 0;
     return m_data->ports;
 }
 
+double NetworkFile::portImpedance() const
+{
+    load();
+    return m_data ? m_data->R : Network::portImpedance();
+}
+
+bool NetworkFile::hasNativeGrid() const
+{
+    return true;
+}
+
 Eigen::MatrixXcd NetworkFile::sparameters(const Eigen::VectorXd& freq) const
 {
+    load();
     if (!m_data || freq.size() == 0) {
         return {};
     }
@@ -227,10 +265,42 @@ Eigen::MatrixXcd NetworkFile::sparameters(const Eigen::VectorXd& freq) const
         return {};
     }
 
+    if (m_data->freq.size() == 0) {
+        return Eigen::MatrixXcd::Zero(freq.size(), expectedCols);
+    }
+
+    const std::shared_ptr<const InterpolationPlan> plan = interpolationPlan(freq);
+    if (plan->identity) {
+        return m_data->sparams.leftCols(expectedCols).matrix();
+    }
+
+    // Magnitude and phase are interpolated linearly, taking the shorter way
+    // around the circle between the two bracketing samples.
     Eigen::MatrixXcd s_matrix(freq.size(), expectedCols);
-    for (int i = 0; i < freq.size(); ++i) {
-        for (Eigen::Index col = 0; col < expectedCols; ++col) {
-            s_matrix(i, col) = interpolate_s_param(freq(i), static_cast<int>(col));
+    const std::size_t copies = plan->copyTarget.size();
+    const std::size_t interpolated = plan->interpTarget.size();
+    for (Eigen::Index col = 0; col < expectedCols; ++col) {
+        const std::complex<double>* source = m_data->sparams.col(col).data();
+        const double* magnitude = interpolated ? m_magnitude.col(col).data() : nullptr;
+        const double* phase = interpolated ? m_phase.col(col).data() : nullptr;
+        std::complex<double>* target = s_matrix.col(col).data();
+
+        for (std::size_t k = 0; k < copies; ++k)
+            target[plan->copyTarget[k]] = source[plan->copySource[k]];
+
+        for (std::size_t k = 0; k < interpolated; ++k) {
+            const Eigen::Index lower = plan->lower[k];
+            const double mag1 = magnitude[lower];
+            const double mag2 = magnitude[lower + 1];
+            double phase1 = phase[lower];
+            double phase2 = phase[lower + 1];
+            if (phase2 - phase1 > M_PI) {
+                phase2 -= 2 * M_PI;
+            } else if (phase1 - phase2 > M_PI) {
+                phase1 -= 2 * M_PI;
+            }
+            const double t = plan->weight[k];
+            target[plan->interpTarget[k]] = std::polar(mag1 + t * (mag2 - mag1), phase1 + t * (phase2 - phase1));
         }
     }
 
@@ -3,8 +3,15 @@
 
 #include "network.h"
 #include "parser_touchstone.h"
+#include <atomic>
+#include <cstdint>
+#include <deque>
 #include <memory>
+#include <mutex>
+#include <vector>
 
+// Construction only probes the file (ports, frequency extent, point estimate);
+// the full parse runs on first access to the data.
 class NetworkFile : public Network
 {
     Q_OBJECT
@@ -18,15 +25,62 @@ public:
 
     QVector<double> frequencies() const override;
     int portCount() const override;
+    // The file's reference resistance (the R of its option line).
+    double portImpedance() const override;
+    bool hasNativeGrid() const override;
 
 
     QString filePath() const;
+    // Exact once the data is loaded, otherwise the probe's estimate.
+    int pointCount() const;
+    // True once load() has run, whether or not it succeeded.
+    bool isLoaded() const;
+    // Parses the file unless that already happened; safe to call from any thread.
+    void load() const;
+    // Why the probe or load() failed; empty before load() and after a
+    // successful one. A header that probes fine can still hide a broken body.
+    QString loadError() const;
+
+    // Parse settings shared by every NetworkFile, e.g. whether the binary cache is used.
+    static void setParseOptions(const ts::ParseOptions& options);
+    static ts::ParseOptions parseOptions();
 
 private:
-    std::complex<double> interpolate_s_param(double freq, int s_param_idx) const;
+    // Used by clone(): takes over the probe results and, once loaded, shares the data.
+    NetworkFile(const NetworkFile& source, QObject* parent);
+
+    // Where each point of a target grid falls on the file's grid. Points outside
+    // the file's range, or on a zero-width interval, copy a sample; the others
+    // interpolate magnitude and phase between `lower` and `lower + 1`.
+    struct InterpolationPlan {
+        Eigen::VectorXd grid;
+        std::uint64_t gridHash = 0;
+        bool identity = false;
+        std::vector<Eigen::Index> copyTarget;
+        std::vector<Eigen::Index> copySource;
+        std::vector<Eigen::Index> interpTarget;
+        std::vector<Eigen::Index> lower;
+        std::vector<double> weight;
+    };
+
+    std::shared_ptr<const InterpolationPlan> interpolationPlan(const Eigen::VectorXd& freq) const;
+    std::shared_ptr<const InterpolationPlan> buildInterpolationPlan(const Eigen::VectorXd& freq, std::uint64_t hash) const;
 
     QString m_file_path;
-    std::unique_ptr<ts::TouchstoneData> m_data;
+    int m_probedPorts = 0;
+    int m_probedPoints = 0;
+    mutable std::once_flag m_loadOnce;
+    mutable std::atomic<bool> m_loaded{false};
+    mutable QString m_loadError;
+    // Immutable and shared with every other open of the same unchanged file.
+    mutable std::shared_ptr<const ts::TouchstoneData> m_data;
+
+    // Most recently used plans first; magnitude and phase of every sample are
+    // computed with the first plan that interpolates.
+    mutable std::mutex m_planMutex;
+    mutable std::deque<std::shared_ptr<const InterpolationPlan>> m_plans;
+    mutable Eigen::ArrayXXd m_magnitude;
+    mutable Eigen::ArrayXXd m_phase;
 };
 
 #endif // NETWORKFILE_H
@@ -1,11 +1,10 @@
 #include "networklumped.h"
-#include "tdrcalculator.h"
 #include <complex>
 #include <cmath>
 #include <QStringList>
 #include <algorithm>
-#include <optional>
 #include <limits>
+#include <array>
 
 namespace {
 constexpr double pi = 3.14159265358979323846;
@@ -22,13 +21,201 @@ QVector<double> toVector(std::initializer_list<double> list)
     return values;
 }
 
-Eigen::Matrix2cd abcdToSParameterMatrix(const Eigen::Matrix2cd& abcd)
+constexpr double referenceImpedance = 50.0; // as in Network::abcd2s()
+constexpr double speedOfLight = 299792458.0;
+
+using Type = NetworkLumped::NetworkType;
+
+// Parameter values in SI units, read once per sparameters() call.
+using Parameters = std::array<double, 6>;
+
+// Every lumped element is reciprocal and symmetric: S22 = S11, S12 = S21.
+struct Response
+{
+    Eigen::ArrayXcd s11;
+    Eigen::ArrayXcd s21;
+};
+
+Eigen::ArrayXcd complexArray(double re, const Eigen::ArrayXd& im)
+{
+    Eigen::ArrayXcd out(im.size());
+    out.real().setConstant(re);
+    out.imag() = im;
+    return out;
+}
+
+void seriesImpedance(const Eigen::ArrayXcd& z, Response& out)
+{
+    const Eigen::ArrayXcd inverse = (z + 2.0 * referenceImpedance).inverse();
+    out.s11 = z * inverse;
+    out.s21 = (2.0 * referenceImpedance) * inverse;
+}
+
+void seriesAdmittance(const Eigen::ArrayXcd& y, Response& out)
+{
+    const Eigen::ArrayXcd inverse = (1.0 + (2.0 * referenceImpedance) * y).inverse();
+    out.s11 = inverse;
+    out.s21 = (2.0 * referenceImpedance) * y * inverse;
+}
+
+void shuntImpedance(const Eigen::ArrayXcd& z, Response& out)
+{
+    const Eigen::ArrayXcd inverse = (2.0 * z + referenceImpedance).inverse();
+    out.s11 = -referenceImpedance * inverse;
+    out.s21 = 2.0 * z * inverse;
+}
+
+void shuntAdmittance(const Eigen::ArrayXcd& y, Response& out)
+{
+    const Eigen::ArrayXcd inverse = (2.0 + referenceImpedance * y).inverse();
+    out.s11 = -referenceImpedance * y * inverse;
+    out.s21 = 2.0 * inverse;
+}
+
+// Points where the element degenerates to a plain thru.
+void setThru(Response& out, const Eigen::Array<bool, Eigen::Dynamic, 1>& where)
+{
+    out.s11 = where.select(std::complex<double>(0.0, 0.0), out.s11);
+    out.s21 = where.select(std::complex<double>(1.0, 0.0), out.s21);
+}
+
+// Closed-form S-parameters of a line of impedance zc, with cosh/sinh of
+// gamma*length expanded into real array operations on (alpha*l, beta*l).
+template <bool Lossy>
+void transmissionLine(const Parameters& p, const Eigen::ArrayXd& f, Response& out)
+{
+    const double length = p[0];
+    const double zc = p[1] == 0.0 ? defaultTransmissionLineImpedance : p[1];
+    const double sqrtErEff = std::sqrt(std::max(p[2], 0.0));
+    const Eigen::ArrayXd betaL = f * (2.0 * pi * sqrtErEff * length / speedOfLight);
+
+    Eigen::ArrayXcd ch(f.size());
+    Eigen::ArrayXcd sh(f.size());
+    if constexpr (Lossy) {
+        const double a = p[3];
+        const double aD = p[4];
+        const double fa = p[5];
+        Eigen::ArrayXd alphaDb;
+        if (fa > 0.0) {
+            const Eigen::ArrayXd ratio = (f / fa).max(0.0);
+            alphaDb = a * ratio.sqrt() + aD * ratio;
+        } else {
+            alphaDb = Eigen::ArrayXd::Constant(f.size(), a + aD);
+        }
+        const Eigen::ArrayXd alphaL = alphaDb * (dbToNepers * length);
+        const Eigen::ArrayXd cosB = betaL.cos();
+        const Eigen::ArrayXd sinB = betaL.sin();
+        const Eigen::ArrayXd coshA = alphaL.cosh();
+        const Eigen::ArrayXd sinhA = alphaL.sinh();
+        ch.real() = coshA * cosB;
+        ch.imag() = sinhA * sinB;
+        sh.real() = sinhA * cosB;
+        sh.imag() = coshA * sinB;
+    } else {
+        ch.real() = betaL.cos();
+        ch.imag().setZero();
+        sh.real().setZero();
+        sh.imag() = betaL.sin();
+    }
+
+    const double sum = zc / referenceImpedance + referenceImpedance / zc;
+    const double difference = zc / referenceImpedance - referenceImpedance / zc;
+    const Eigen::ArrayXcd inverse = (2.0 * ch + sum * sh).inverse();
+    out.s11 = difference * sh * inverse;
+    out.s21 = 2.0 * inverse;
+}
+
+template <Type T>
+void evaluate(const Parameters& p, const Eigen::ArrayXd& f, Response& out);
+
+// Resistors do not depend on frequency: one point is broadcast over the grid.
+template <>
+void evaluate<Type::R_series>(const Parameters& p, const Eigen::ArrayXd& f, Response& out)
 {
-    Eigen::Vector4cd s = Network::abcd2s(abcd);
-    Eigen::Matrix2cd scattering;
-    scattering << s(0), s(1),
-                  s(2), s(3);
-    return scattering;
+    seriesImpedance(Eigen::ArrayXcd::Constant(1, p[0]), out);
+    out.s11 = Eigen::ArrayXcd::Constant(f.size(), out.s11(0));
+    out.s21 = Eigen::ArrayXcd::Constant(f.size(), out.s21(0));
+}
+
+template <>
+void evaluate<Type::R_shunt>(const Parameters& p, const Eigen::ArrayXd& f, Response& out)
+{
+    shuntImpedance(Eigen::ArrayXcd::Constant(1, p[0]), out);
+    out.s11 = Eigen::ArrayXcd::Constant(f.size(), out.s11(0));
+    out.s21 = Eigen::ArrayXcd::Constant(f.size(), out.s21(0));
+}
+
+template <>
+void evaluate<Type::C_series>(const Parameters& p, const Eigen::ArrayXd& f, Response& out)
+{
+    seriesAdmittance(complexArray(0.0, f * (2.0 * pi * p[0])), out);
+}
+
+template <>
+void evaluate<Type::C_shunt>(const Parameters& p, const Eigen::ArrayXd& f, Response& out)
+{
+    shuntAdmittance(complexArray(0.0, f * (2.0 * pi * p[0])), out);
+}
+
+template <>
+void evaluate<Type::L_series>(const Parameters& p, const Eigen::ArrayXd& f, Response& out)
+{
+    seriesImpedance(complexArray(p[1], f * (2.0 * pi * p[0])), out);
+}
+
+template <>
+void evaluate<Type::L_shunt>(const Parameters& p, const Eigen::ArrayXd& f, Response& out)
+{
+    shuntImpedance(complexArray(p[1], f * (2.0 * pi * p[0])), out);
+}
+
+template <>
+void evaluate<Type::TransmissionLine>(const Parameters& p, const Eigen::ArrayXd& f, Response& out)
+{
+    transmissionLine<false>(p, f, out);
+}
+
+template <>
+void evaluate<Type::TransmissionLineLossy>(const Parameters& p, const Eigen::ArrayXd& f, Response& out)
+{
+    transmissionLine<true>(p, f, out);
+}
+
+template <>
+void evaluate<Type::RLC_series_shunt>(const Parameters& p, const Eigen::ArrayXd& f, Response& out)
+{
+    const double resistance = p[0];
+    const double inductance = p[1];
+    const double capacitance = p[2];
+    const Eigen::ArrayXd w = f * (2.0 * pi);
+    Eigen::ArrayXd reactance = w * inductance;
+    if (capacitance > 0.0)
+        reactance -= (w * capacitance).inverse();
+    shuntImpedance(complexArray(resistance, reactance), out);
+    // The capacitor is open at DC, which leaves the shunt branch unconnected.
+    if (capacitance > 0.0)
+        setThru(out, w == 0.0);
+}
+
+template <>
+void evaluate<Type::RLC_parallel_series>(const Parameters& p, const Eigen::ArrayXd& f, Response& out)
+{
+    const double resistance = p[0];
+    const double inductance = p[1];
+    const double capacitance = p[2];
+    // A zero resistance or inductance shorts the series branch.
+    if (resistance == 0.0 || inductance == 0.0) {
+        out.s11 = Eigen::ArrayXcd::Zero(f.size());
+        out.s21 = Eigen::ArrayXcd::Ones(f.size());
+        return;
+    }
+    const Eigen::ArrayXd w = f * (2.0 * pi);
+    Eigen::ArrayXd susceptance = -(w * inductance).inverse();
+    if (capacitance > 0.0)
+        susceptance += w * capacitance;
+    seriesAdmittance(complexArray(1.0 / resistance, susceptance), out);
+    // The inductor shorts the branch at DC.
+    setThru(out, w == 0.0);
 }
 }
 
@@ -38,7 +225,7 @@ NetworkLumped::NetworkLumped(NetworkType type, QObject *parent)
 }
 
 NetworkLumped::NetworkLumped(NetworkType type, const QVector<double>& values, QObject *parent)
-    : Network(parent), m_type(type), m_pointCount(1001)
+    : Network(parent), m_type(type), m_pointCount(1001), m_adaptiveSampling(false)
 {
     initializeParameters(values);
     m_fmin = 1e6;
@@ -72,6 +259,7 @@ Network* NetworkLumped::clone(QObject* parent) const
     copy->setFmin(m_fmin);
     copy->setFmax(m_fmax);
     copy->setPointCount(m_pointCount);
+    copy->setAdaptiveSampling(m_adaptiveSampling);
     copy->copyStyleSettingsFrom(this);
     return copy;
 }
@@ -114,147 +302,168 @@ QString NetworkLumped::name() const
     return name;
 }
 
-Eigen::MatrixXcd NetworkLumped::sparameters(const Eigen::VectorXd& freq) const
+Eigen::Matrix2cd NetworkLumped::abcdParameters(double frequency) const
 {
-    Eigen::MatrixXcd scattering_matrix(freq.size(), 4);
-    std::complex<double> j(0, 1);
+    const std::complex<double> j(0, 1);
     constexpr double c0 = 299792458.0; // Speed of light in vacuum (m/s)
+    const double w = 2.0 * pi * frequency;
+    Eigen::Matrix2cd abcd_point;
+    abcd_point.setIdentity();
 
-    for (int i = 0; i < freq.size(); ++i) {
-        double w = 2.0 * pi * freq(i);
-        Eigen::Matrix2cd abcd_point;
-        abcd_point.setIdentity();
-
-        switch (m_type) {
-        case NetworkType::R_series:
-            abcd_point(0, 1) = parameterValueSI(0);
-            break;
-        case NetworkType::R_shunt:
-            abcd_point(1, 0) = 1.0 / parameterValueSI(0);
-            break;
-        case NetworkType::C_series: {
-            std::complex<double> impedance = 1.0 / (j * w * parameterValueSI(0));
-            abcd_point(0, 1) = impedance;
-            break;
-        }
-        case NetworkType::C_shunt:
-            abcd_point(1, 0) = j * w * parameterValueSI(0);
-            break;
-        case NetworkType::L_series: {
-            std::complex<double> impedance = parameterValueSI(1) + j * w * parameterValueSI(0);
-            abcd_point(0, 1) = impedance;
-            break;
-        }
-        case NetworkType::L_shunt: {
-            std::complex<double> impedance = parameterValueSI(1) + j * w * parameterValueSI(0);
-            abcd_point(1, 0) = 1.0 / impedance;
-            break;
-        }
-        case NetworkType::TransmissionLine:
-        case NetworkType::TransmissionLineLossy: {
-            const double length = parameterValueSI(0);
-            double z0_value = parameterValueSI(1);
-            if (z0_value == 0.0)
-                z0_value = defaultTransmissionLineImpedance;
-            const double er_eff = std::max(parameterValueSI(2), 0.0);
-            const double sqrt_er_eff = er_eff > 0.0 ? std::sqrt(er_eff) : 0.0;
-            const double beta = (sqrt_er_eff * w) / c0;
-            std::complex<double> gamma_line(0.0, beta);
-
-            if (m_type == NetworkType::TransmissionLineLossy) {
-                const double a = parameterValueSI(3);
-                const double a_d = parameterValueSI(4);
-                const double fa = parameterValueSI(5);
-                const double freq_hz = freq(i);
-                double conductorLoss = a;
-                double dielectricLoss = a_d;
-                if (fa > 0.0) {
-                    const double ratio = std::max(freq_hz / fa, 0.0);
-                    conductorLoss = a * std::sqrt(ratio);
-                    dielectricLoss = a_d * ratio;
-                }
-                const double alpha_db_per_m = conductorLoss + dielectricLoss;
-                const double alpha_nepers_per_m = alpha_db_per_m * dbToNepers;
-                gamma_line = {alpha_nepers_per_m, beta};
+    switch (m_type) {
+    case NetworkType::R_series:
+        abcd_point(0, 1) = parameterValueSI(0);
+        break;
+    case NetworkType::R_shunt:
+        abcd_point(1, 0) = 1.0 / parameterValueSI(0);
+        break;
+    case NetworkType::C_series: {
+        std::complex<double> impedance = 1.0 / (j * w * parameterValueSI(0));
+        abcd_point(0, 1) = impedance;
+        break;
+    }
+    case NetworkType::C_shunt:
+        abcd_point(1, 0) = j * w * parameterValueSI(0);
+        break;
+    case NetworkType::L_series: {
+        std::complex<double> impedance = parameterValueSI(1) + j * w * parameterValueSI(0);
+        abcd_point(0, 1) = impedance;
+        break;
+    }
+    case NetworkType::L_shunt: {
+        std::complex<double> impedance = parameterValueSI(1) + j * w * parameterValueSI(0);
+        abcd_point(1, 0) = 1.0 / impedance;
+        break;
+    }
+    case NetworkType::TransmissionLine:
+    case NetworkType::TransmissionLineLossy: {
+        const double length = parameterValueSI(0);
+        double z0_value = parameterValueSI(1);
+        if (z0_value == 0.0)
+            z0_value = defaultTransmissionLineImpedance;
+        const double er_eff = std::max(parameterValueSI(2), 0.0);
+        const double sqrt_er_eff = er_eff > 0.0 ? std::sqrt(er_eff) : 0.0;
+        const double beta = (sqrt_er_eff * w) / c0;
+        std::complex<double> gamma_line(0.0, beta);
+
+        if (m_type == NetworkType::TransmissionLineLossy) {
+            const double a = parameterValueSI(3);
+            const double a_d = parameterValueSI(4);
+            const double fa = parameterValueSI(5);
+            const double freq_hz = frequency;
+            double conductorLoss = a;
+            double dielectricLoss = a_d;
+            if (fa > 0.0) {
+                const double ratio = std::max(freq_hz / fa, 0.0);
+                conductorLoss = a * std::sqrt(ratio);
+                dielectricLoss = a_d * ratio;
             }
-
-            const std::complex<double> zc(z0_value, 0.0);
-            const std::complex<double> cosh_term = std::cosh(gamma_line * length);
-            const std::complex<double> sinh_term = std::sinh(gamma_line * length);
-            abcd_point(0, 0) = cosh_term;
-            abcd_point(0, 1) = zc * sinh_term;
-            abcd_point(1, 0) = sinh_term / zc;
-            abcd_point(1, 1) = cosh_term;
-            break;
+            const double alpha_db_per_m = conductorLoss + dielectricLoss;
+            const double alpha_nepers_per_m = alpha_db_per_m * dbToNepers;
+            gamma_line = {alpha_nepers_per_m, beta};
         }
-        case NetworkType::RLC_series_shunt: {
-            const double resistance = parameterValueSI(0);
-            const double inductance = parameterValueSI(1);
-            const double capacitance = parameterValueSI(2);
-            std::complex<double> impedance = resistance;
-            impedance += j * w * inductance;
-            bool infiniteImpedance = false;
-            if (capacitance > 0.0) {
-                if (w == 0.0) {
-                    infiniteImpedance = true;
-                } else {
-                    impedance += 1.0 / (j * w * capacitance);
-                }
-            }
-            if (infiniteImpedance) {
-                abcd_point(1, 0) = 0.0;
-            } else if (std::abs(impedance) > 0.0) {
-                abcd_point(1, 0) = 1.0 / impedance;
+
+        const std::complex<double> zc(z0_value, 0.0);
+        const std::complex<double> cosh_term = std::cosh(gamma_line * length);
+        const std::complex<double> sinh_term = std::sinh(gamma_line * length);
+        abcd_point(0, 0) = cosh_term;
+        abcd_point(0, 1) = zc * sinh_term;
+        abcd_point(1, 0) = sinh_term / zc;
+        abcd_point(1, 1) = cosh_term;
+        break;
+    }
+    case NetworkType::RLC_series_shunt: {
+        const double resistance = parameterValueSI(0);
+        const double inductance = parameterValueSI(1);
+        const double capacitance = parameterValueSI(2);
+        std::complex<double> impedance = resistance;
+        impedance += j * w * inductance;
+        bool infiniteImpedance = false;
+        if (capacitance > 0.0) {
+            if (w == 0.0) {
+                infiniteImpedance = true;
             } else {
-                abcd_point(1, 0) = std::numeric_limits<double>::infinity();
+                impedance += 1.0 / (j * w * capacitance);
             }
-            break;
         }
-        case NetworkType::RLC_parallel_series: {
-            const double resistance = parameterValueSI(0);
-            const double inductance = parameterValueSI(1);
-            const double capacitance = parameterValueSI(2);
-            std::complex<double> admittance = 0.0;
-            bool infiniteAdmittance = false;
-
-            if (resistance == 0.0) {
-                infiniteAdmittance = true;
-            } else if (resistance != 0.0) {
-                admittance += 1.0 / resistance;
-            }
+        if (infiniteImpedance) {
+            abcd_point(1, 0) = 0.0;
+        } else if (std::abs(impedance) > 0.0) {
+            abcd_point(1, 0) = 1.0 / impedance;
+        } else {
+            abcd_point(1, 0) = std::numeric_limits<double>::infinity();
+        }
+        break;
+    }
+    case NetworkType::RLC_parallel_series: {
+        const double resistance = parameterValueSI(0);
+        const double inductance = parameterValueSI(1);
+        const double capacitance = parameterValueSI(2);
+        std::complex<double> admittance = 0.0;
+        bool infiniteAdmittance = false;
+
+        if (resistance == 0.0) {
+            infiniteAdmittance = true;
+        } else if (resistance != 0.0) {
+            admittance += 1.0 / resistance;
+        }
 
-            if (!infiniteAdmittance) {
-                if (inductance == 0.0) {
+        if (!infiniteAdmittance) {
+            if (inductance == 0.0) {
+                infiniteAdmittance = true;
+            } else {
+                if (w == 0.0) {
                     infiniteAdmittance = true;
                 } else {
-                    if (w == 0.0) {
-                        infiniteAdmittance = true;
-                    } else {
-                        admittance += 1.0 / (j * w * inductance);
-                    }
+                    admittance += 1.0 / (j * w * inductance);
                 }
             }
+        }
 
-            if (!infiniteAdmittance && capacitance > 0.0) {
-                admittance += j * w * capacitance;
-            }
-
-            if (infiniteAdmittance) {
-                abcd_point(0, 1) = 0.0;
-            } else if (std::abs(admittance) > 0.0) {
-                abcd_point(0, 1) = 1.0 / admittance;
-            } else {
-                abcd_point(0, 1) = std::numeric_limits<double>::infinity();
-            }
-            break;
+        if (!infiniteAdmittance && capacitance > 0.0) {
+            admittance += j * w * capacitance;
         }
+
+        if (infiniteAdmittance) {
+            abcd_point(0, 1) = 0.0;
+        } else if (std::abs(admittance) > 0.0) {
+            abcd_point(0, 1) = 1.0 / admittance;
+        } else {
+            abcd_point(0, 1) = std::numeric_limits<double>::infinity();
         }
+        break;
+    }
+    }
+
+    return abcd_point;
+}
 
-        Eigen::Matrix2cd scattering = abcdToSParameterMatrix(abcd_point);
-        scattering_matrix.row(i) << scattering(0, 0), scattering(1, 0),
-                                    scattering(0, 1), scattering(1, 1);
+Eigen::MatrixXcd NetworkLumped::sparameters(const Eigen::VectorXd& freq) const
+{
+    Parameters parameters{};
+    for (int i = 0; i < m_parameters.size() && i < static_cast<int>(parameters.size()); ++i)
+        parameters[i] = parameterValueSI(i);
+
+    const Eigen::ArrayXd f = freq.array();
+    Response response;
+    switch (m_type) {
+    case NetworkType::R_series: evaluate<NetworkType::R_series>(parameters, f, response); break;
+    case NetworkType::R_shunt: evaluate<NetworkType::R_shunt>(parameters, f, response); break;
+    case NetworkType::C_series: evaluate<NetworkType::C_series>(parameters, f, response); break;
+    case NetworkType::C_shunt: evaluate<NetworkType::C_shunt>(parameters, f, response); break;
+    case NetworkType::L_series: evaluate<NetworkType::L_series>(parameters, f, response); break;
+    case NetworkType::L_shunt: evaluate<NetworkType::L_shunt>(parameters, f, response); break;
+    case NetworkType::TransmissionLine: evaluate<NetworkType::TransmissionLine>(parameters, f, response); break;
+    case NetworkType::TransmissionLineLossy: evaluate<NetworkType::TransmissionLineLossy>(parameters, f, response); break;
+    case NetworkType::RLC_series_shunt: evaluate<NetworkType::RLC_series_shunt>(parameters, f, response); break;
+    case NetworkType::RLC_parallel_series: evaluate<NetworkType::RLC_parallel_series>(parameters, f, response); break;
     }
 
+    Eigen::MatrixXcd scattering_matrix(freq.size(), 4);
+    scattering_matrix.col(0) = response.s11.matrix();
+    scattering_matrix.col(1) = response.s21.matrix();
+    scattering_matrix.col(2) = response.s21.matrix();
+    scattering_matrix.col(3) = response.s11.matrix();
     return scattering_matrix;
 }
 
@@ -264,90 +473,31 @@ QPair<QVector<double>, QVector<double>> NetworkLumped::getPlotData(int s_param_i
         return {};
     }
 
-    const int points = std::max(m_pointCount, 2);
-    Eigen::VectorXd freq = Eigen::VectorXd::LinSpaced(points, m_fmin, m_fmax);
-    Eigen::MatrixXcd s_matrix = sparameters(freq);
-
-    Eigen::ArrayXcd sparam(freq.size());
-    for (int i = 0; i < freq.size(); ++i) {
-        sparam(i) = s_matrix(i, s_param_idx);
-    }
-
     const int ports = portCount();
     const int outputPort = s_param_idx % ports;
     const int inputPort = s_param_idx / ports;
     const bool isReflectionParam = (outputPort == inputPort);
 
-    Network::TimeGateSettings gateSettings = Network::timeGateSettings();
-    TDRCalculator calculator;
-    TDRCalculator::Parameters tdrParams;
-    tdrParams.effectivePermittivity = std::max(gateSettings.epsilonR, 1.0);
-
-    std::optional<TDRCalculator::GateResult> gateResult;
-    if (gateSettings.enabled && isReflectionParam) {
-        auto gated = calculator.applyGate(freq.array(), sparam,
-                                         gateSettings.startDistance,
-                                         gateSettings.stopDistance,
-                                         gateSettings.epsilonR,
-                                         tdrParams);
-        if (gated) {
-            sparam = gated->gatedReflection;
-            gateResult = std::move(*gated);
-        }
+    if (m_adaptiveSampling) {
+        const std::shared_ptr<const AdaptiveSampler::Result> sampled = adaptiveResult();
+        return cachedPlotData(s_param_idx, type, sampled->freq.array(), isReflectionParam, [&]() {
+            return viewColumn(sampled->response, s_param_idx, type);
+        });
     }
 
-    QVector<double> freqVector(freq.data(), freq.data() + freq.size());
-
-    switch (type) {
-    case PlotType::Magnitude: {
-        Eigen::ArrayXd magnitude = 20 * sparam.abs().log10();
-        QVector<double> values(magnitude.data(), magnitude.data() + magnitude.size());
-        return qMakePair(freqVector, values);
-    }
-    case PlotType::Phase: {
-        Eigen::ArrayXd phase_rad = Network::wrapToMinusPiPi(sparam.arg());
-        if (m_unwrap_phase)
-            phase_rad = unwrap(phase_rad);
-        Eigen::ArrayXd phase_deg = phase_rad * (180.0 / pi);
-        QVector<double> values(phase_deg.data(), phase_deg.data() + phase_deg.size());
-        return qMakePair(freqVector, values);
-    }
-    case PlotType::GroupDelay: {
-        Eigen::ArrayXd phase_rad = Network::wrapToMinusPiPi(sparam.arg());
-        if (m_unwrap_phase)
-            phase_rad = unwrap(phase_rad);
-        Eigen::ArrayXd delay = Network::computeGroupDelay(phase_rad, freq.array());
-        QVector<double> values(delay.data(), delay.data() + delay.size());
-        return qMakePair(freqVector, values);
-    }
-    case PlotType::VSWR: {
-        Eigen::ArrayXd vswr = (1 + sparam.abs()) / (1 - sparam.abs());
-        QVector<double> values(vswr.data(), vswr.data() + vswr.size());
-        return qMakePair(freqVector, values);
-    }
-    case PlotType::Smith: {
-        Eigen::ArrayXd realPart = sparam.real();
-        Eigen::ArrayXd imagPart = sparam.imag();
-        QVector<double> xValues(realPart.data(), realPart.data() + realPart.size());
-        QVector<double> yValues(imagPart.data(), imagPart.data() + imagPart.size());
-        return qMakePair(xValues, yValues);
-    }
-    case PlotType::TDR:
-        if (!isReflectionParam)
-            return {};
-        if (gateResult)
-            return qMakePair(gateResult->distance, gateResult->impedance);
-        {
-            auto result = calculator.compute(freq.array(), sparam, tdrParams);
-            return qMakePair(result.distance, result.impedance);
-        }
-    }
-
-    return {};
+    const int points = std::max(m_pointCount, 2);
+    const Eigen::ArrayXd freq = Eigen::ArrayXd::LinSpaced(points, m_fmin, m_fmax);
+    return cachedPlotData(s_param_idx, type, freq, isReflectionParam, [&]() {
+        return viewColumn(sparameters(freq.matrix()), s_param_idx, type);
+    });
 }
 
 QVector<double> NetworkLumped::frequencies() const
 {
+    if (m_adaptiveSampling) {
+        const Eigen::VectorXd& freq = adaptiveResult()->freq;
+        return QVector<double>(freq.data(), freq.data() + freq.size());
+    }
     const int points = std::max(m_pointCount, 2);
     Eigen::VectorXd freq = Eigen::VectorXd::LinSpaced(points, m_fmin, m_fmax);
     return QVector<double>(freq.data(), freq.data() + freq.size());
@@ -365,6 +515,25 @@ int NetworkLumped::pointCount() const
     return m_pointCount;
 }
 
+void NetworkLumped::setAdaptiveSampling(bool enabled)
+{
+    m_adaptiveSampling = enabled;
+}
+
+bool NetworkLumped::adaptiveSampling() const
+{
+    return m_adaptiveSampling;
+}
+
+std::shared_ptr<const AdaptiveSampler::Result> NetworkLumped::adaptiveResult() const
+{
+    AdaptiveSampler::Settings settings;
+    settings.maxPoints = std::max(m_pointCount, 2);
+    return m_adaptiveMemo.get(dataVersion(), m_fmin, m_fmax, settings, [this](const Eigen::VectorXd& freq) {
+        return sparameters(freq);
+    });
+}
+
 int NetworkLumped::portCount() const
 {
     return 2;
@@ -405,7 +574,10 @@ void NetworkLumped::setParameterValue(int index, double value)
 {
     if (index < 0 || index >= m_parameters.size())
         return;
+    if (m_parameters[index].value == value)
+        return;
     m_parameters[index].value = value;
+    invalidateData();
 }
 
 void NetworkLumped::initializeParameters(const QVector<double>& values)
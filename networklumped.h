@@ -1,6 +1,7 @@
 #ifndef NETWORKLUMPED_H
 #define NETWORKLUMPED_H
 
+#include "adaptivesampler.h"
 #include "network.h"
 #include <initializer_list>
 #include <QVector>
@@ -31,6 +32,9 @@ public:
     QString name() const override;
     QString displayName() const override;
     Eigen::MatrixXcd sparameters(const Eigen::VectorXd& freq) const override;
+    // Chain (ABCD) matrix at one frequency. sparameters() uses closed-form
+    // expressions over the whole grid instead.
+    Eigen::Matrix2cd abcdParameters(double frequency) const;
     QPair<QVector<double>, QVector<double>> getPlotData(int s_param_idx, PlotType type) override;
     Network* clone(QObject* parent = nullptr) const override;
     QVector<double> frequencies() const override;
@@ -38,6 +42,10 @@ public:
 
     void setPointCount(int pointCount);
     int pointCount() const;
+    // Plots on an adaptively refined grid of at most pointCount() points
+    // instead of a uniform one.
+    void setAdaptiveSampling(bool enabled);
+    bool adaptiveSampling() const;
 
     int parameterCount() const;
     QString parameterDescription(int index) const;
@@ -58,9 +66,12 @@ private:
     QVector<Parameter> m_parameters;
 
     int m_pointCount;
+    bool m_adaptiveSampling;
+    mutable AdaptiveSampler::Memo m_adaptiveMemo;
 
     void initializeParameters(const QVector<double>& values);
     double parameterValueSI(int index) const;
+    std::shared_ptr<const AdaptiveSampler::Result> adaptiveResult() const;
     QString typeName() const;
 };
 
@@ -0,0 +1,342 @@
+#include "networkparameters.h"
+#include "threadpool.h"
+
+#include <algorithm>
+#include <cmath>
+#include <complex>
+#include <type_traits>
+
+namespace NetworkParameters {
+
+namespace {
+
+using Complex = std::complex<double>;
+
+// Rows handed to one pool task.
+constexpr Eigen::Index kBlockRows = 256;
+
+template <int N>
+using Square = Eigen::Matrix<Complex, N, N>;
+
+template <int N>
+constexpr int halfOf = N == Eigen::Dynamic ? Eigen::Dynamic : N / 2;
+
+template <typename M>
+M identityLike(const M& m)
+{
+    return M::Identity(m.rows(), m.cols());
+}
+
+// numerator * denominator^-1: closed-form inverses for the fixed sizes, a
+// partial-pivot LU solve otherwise.
+template <typename M>
+M rightDivide(const M& numerator, const M& denominator)
+{
+    if constexpr (M::RowsAtCompileTime == Eigen::Dynamic)
+        return denominator.transpose().partialPivLu().solve(numerator.transpose()).transpose();
+    else
+        return numerator * denominator.inverse();
+}
+
+template <typename M>
+M inverse(const M& m)
+{
+    if constexpr (M::RowsAtCompileTime == Eigen::Dynamic)
+        return m.partialPivLu().inverse();
+    else
+        return m.inverse();
+}
+
+// Replaces every row of `in` by op applied to it as an N x N matrix.
+template <int N, typename Op>
+Eigen::MatrixXcd mapRows(const Eigen::MatrixXcd& in, int ports, const Op& op)
+{
+    const Eigen::Index rows = in.rows();
+    const Eigen::Index cols = in.cols();
+    Eigen::MatrixXcd out(rows, cols);
+    const std::size_t blocks = static_cast<std::size_t>((rows + kBlockRows - 1) / kBlockRows);
+    ThreadPool::global().parallelFor(blocks, [&](std::size_t block) {
+        const Eigen::Index begin = static_cast<Eigen::Index>(block) * kBlockRows;
+        const Eigen::Index end = std::min(rows, begin + kBlockRows);
+        Square<N> x;
+        if constexpr (N == Eigen::Dynamic)
+            x.resize(ports, ports);
+        for (Eigen::Index row = begin; row < end; ++row) {
+            for (Eigen::Index c = 0; c < cols; ++c)
+                x.data()[c] = in(row, c);
+            const Square<N> y = op(x);
+            for (Eigen::Index c = 0; c < cols; ++c)
+                out(row, c) = y.data()[c];
+        }
+    });
+    return out;
+}
+
+template <typename Op>
+Eigen::MatrixXcd forEachPoint(const Eigen::MatrixXcd& in, int ports, const Op& op)
+{
+    switch (ports) {
+    case 1: return mapRows<1>(in, ports, op);
+    case 2: return mapRows<2>(in, ports, op);
+    case 3: return mapRows<3>(in, ports, op);
+    case 4: return mapRows<4>(in, ports, op);
+    default: return mapRows<Eigen::Dynamic>(in, ports, op);
+    }
+}
+
+// forEachPoint for the conversions that split the ports into two sides.
+template <typename Op>
+Eigen::MatrixXcd forEachPairedPoint(const Eigen::MatrixXcd& in, int ports, const Op& op)
+{
+    switch (ports) {
+    case 2: return mapRows<2>(in, ports, op);
+    case 4: return mapRows<4>(in, ports, op);
+    default: return mapRows<Eigen::Dynamic>(in, ports, op);
+    }
+}
+
+bool validReference(int ports, const Eigen::VectorXd& z0)
+{
+    return ports > 0 && z0.size() == ports;
+}
+
+} // namespace
+
+int portCount(const Eigen::MatrixXcd& parameters)
+{
+    const Eigen::Index cols = parameters.cols();
+    const auto ports = static_cast<Eigen::Index>(std::llround(std::sqrt(static_cast<double>(cols))));
+    return ports > 0 && ports * ports == cols ? static_cast<int>(ports) : -1;
+}
+
+Eigen::MatrixXcd sToZ(const Eigen::MatrixXcd& s, const Eigen::VectorXd& z0)
+{
+    const int ports = portCount(s);
+    if (!validReference(ports, z0))
+        return {};
+    const Eigen::VectorXd g = z0.cwiseSqrt();
+    return forEachPoint(s, ports, [&](const auto& x) {
+        using M = std::decay_t<decltype(x)>;
+        const M identity = identityLike(x);
+        const M normalized = rightDivide<M>(identity + x, identity - x);
+        return M(g.asDiagonal() * normalized * g.asDiagonal());
+    });
+}
+
+Eigen::MatrixXcd zToS(const Eigen::MatrixXcd& z, const Eigen::VectorXd& z0)
+{
+    const int ports = portCount(z);
+    if (!validReference(ports, z0))
+        return {};
+    const Eigen::VectorXd gInverse = z0.cwiseSqrt().cwiseInverse();
+    return forEachPoint(z, ports, [&](const auto& x) {
+        using M = std::decay_t<decltype(x)>;
+        const M identity = identityLike(x);
+        const M normalized = gInverse.asDiagonal() * x * gInverse.asDiagonal();
+        return rightDivide<M>(normalized - identity, normalized + identity);
+    });
+}
+
+Eigen::MatrixXcd sToY(const Eigen::MatrixXcd& s, const Eigen::VectorXd& z0)
+{
+    const int ports = portCount(s);
+    if (!validReference(ports, z0))
+        return {};
+    const Eigen::VectorXd gInverse = z0.cwiseSqrt().cwiseInverse();
+    return forEachPoint(s, ports, [&](const auto& x) {
+        using M = std::decay_t<decltype(x)>;
+        const M identity = identityLike(x);
+        const M normalized = rightDivide<M>(identity - x, identity + x);
+        return M(gInverse.asDiagonal() * normalized * gInverse.asDiagonal());
+    });
+}
+
+Eigen::MatrixXcd yToS(const Eigen::MatrixXcd& y, const Eigen::VectorXd& z0)
+{
+    const int ports = portCount(y);
+    if (!validReference(ports, z0))
+        return {};
+    const Eigen::VectorXd g = z0.cwiseSqrt();
+    return forEachPoint(y, ports, [&](const auto& x) {
+        using M = std::decay_t<decltype(x)>;
+        const M identity = identityLike(x);
+        const M normalized = g.asDiagonal() * x * g.asDiagonal();
+        return rightDivide<M>(identity - normalized, identity + normalized);
+    });
+}
+
+Eigen::MatrixXcd zToY(const Eigen::MatrixXcd& z)
+{
+    const int ports = portCount(z);
+    if (ports <= 0)
+        return {};
+    return forEachPoint(z, ports, [](const auto& x) { return inverse(x); });
+}
+
+Eigen::MatrixXcd yToZ(const Eigen::MatrixXcd& y)
+{
+    return zToY(y);
+}
+
+Eigen::MatrixXcd sToT(const Eigen::MatrixXcd& s)
+{
+    const int ports = portCount(s);
+    if (ports <= 0 || ports % 2 != 0)
+        return {};
+    const int h = ports / 2;
+    return forEachPairedPoint(s, ports, [h](const auto& x) {
+        using M = std::decay_t<decltype(x)>;
+        using Half = Square<halfOf<M::RowsAtCompileTime>>;
+        const Half s11 = x.topLeftCorner(h, h);
+        const Half s12 = x.topRightCorner(h, h);
+        const Half s21 = x.bottomLeftCorner(h, h);
+        const Half s22 = x.bottomRightCorner(h, h);
+        const Half s21Inverse = inverse(s21);
+        M t(x.rows(), x.cols());
+        t.topLeftCorner(h, h) = s12 - s11 * s21Inverse * s22;
+        t.topRightCorner(h, h) = s11 * s21Inverse;
+        t.bottomLeftCorner(h, h) = -s21Inverse * s22;
+        t.bottomRightCorner(h, h) = s21Inverse;
+        return t;
+    });
+}
+
+Eigen::MatrixXcd tToS(const Eigen::MatrixXcd& t)
+{
+    const int ports = portCount(t);
+    if (ports <= 0 || ports % 2 != 0)
+        return {};
+    const int h = ports / 2;
+    return forEachPairedPoint(t, ports, [h](const auto& x) {
+        using M = std::decay_t<decltype(x)>;
+        using Half = Square<halfOf<M::RowsAtCompileTime>>;
+        const Half t11 = x.topLeftCorner(h, h);
+        const Half t12 = x.topRightCorner(h, h);
+        const Half t21 = x.bottomLeftCorner(h, h);
+        const Half s21 = inverse(Half(x.bottomRightCorner(h, h)));
+        M s(x.rows(), x.cols());
+        s.topLeftCorner(h, h) = t12 * s21;
+        s.topRightCorner(h, h) = t11 - t12 * s21 * t21;
+        s.bottomLeftCorner(h, h) = s21;
+        s.bottomRightCorner(h, h) = -s21 * t21;
+        return s;
+    });
+}
+
+// [V1; I1] = ABCD [V2; -I2] with V = G (a + b) and I = G^-1 (a - b) on each
+// side, which makes ABCD = L1 T L2^-1 for L = [[G, G], [-G^-1, G^-1]]. G is
+// diagonal, so the products reduce to row and column scalings of T's blocks.
+Eigen::MatrixXcd sToAbcd(const Eigen::MatrixXcd& s, const Eigen::VectorXd& z0)
+{
+    const int ports = portCount(s);
+    if (!validReference(ports, z0) || ports % 2 != 0)
+        return {};
+    const int h = ports / 2;
+    const Eigen::VectorXd g1 = z0.head(h).cwiseSqrt();
+    const Eigen::VectorXd g2 = z0.tail(h).cwiseSqrt();
+    const Eigen::VectorXd g1Inverse = g1.cwiseInverse();
+    const Eigen::VectorXd g2Inverse = g2.cwiseInverse();
+    return forEachPairedPoint(sToT(s), ports, [&](const auto& t) {
+        using M = std::decay_t<decltype(t)>;
+        using Half = Square<halfOf<M::RowsAtCompileTime>>;
+        const Half t11 = t.topLeftCorner(h, h);
+        const Half t12 = t.topRightCorner(h, h);
+        const Half t21 = t.bottomLeftCorner(h, h);
+        const Half t22 = t.bottomRightCorner(h, h);
+        const Half p = g1.asDiagonal() * (t11 + t21);
+        const Half q = g1.asDiagonal() * (t12 + t22);
+        const Half r = g1Inverse.asDiagonal() * (t21 - t11);
+        const Half u = g1Inverse.asDiagonal() * (t22 - t12);
+        M abcd(t.rows(), t.cols());
+        abcd.topLeftCorner(h, h) = 0.5 * (p + q) * g2Inverse.asDiagonal();
+        abcd.topRightCorner(h, h) = 0.5 * (q - p) * g2.asDiagonal();
+        abcd.bottomLeftCorner(h, h) = 0.5 * (r + u) * g2Inverse.asDiagonal();
+        abcd.bottomRightCorner(h, h) = 0.5 * (u - r) * g2.asDiagonal();
+        return abcd;
+    });
+}
+
+Eigen::MatrixXcd abcdToS(const Eigen::MatrixXcd& abcd, const Eigen::VectorXd& z0)
+{
+    const int ports = portCount(abcd);
+    if (!validReference(ports, z0) || ports % 2 != 0)
+        return {};
+    const int h = ports / 2;
+    const Eigen::VectorXd g1 = z0.head(h).cwiseSqrt();
+    const Eigen::VectorXd g2 = z0.tail(h).cwiseSqrt();
+    const Eigen::VectorXd g1Inverse = g1.cwiseInverse();
+    const Eigen::VectorXd g2Inverse = g2.cwiseInverse();
+    // T = L1^-1 ABCD L2.
+    const Eigen::MatrixXcd t = forEachPairedPoint(abcd, ports, [&](const auto& x) {
+        using M = std::decay_t<decltype(x)>;
+        using Half = Square<halfOf<M::RowsAtCompileTime>>;
+        const Half a = x.topLeftCorner(h, h);
+        const Half b = x.topRightCorner(h, h);
+        const Half c = x.bottomLeftCorner(h, h);
+        const Half d = x.bottomRightCorner(h, h);
+        const Half p = g1Inverse.asDiagonal() * a - g1.asDiagonal() * c;
+        const Half q = g1Inverse.asDiagonal() * b - g1.asDiagonal() * d;
+        const Half r = g1Inverse.asDiagonal() * a + g1.asDiagonal() * c;
+        const Half u = g1Inverse.asDiagonal() * b + g1.asDiagonal() * d;
+        M out(x.rows(), x.cols());
+        out.topLeftCorner(h, h) = 0.5 * (p * g2.asDiagonal() - q * g2Inverse.asDiagonal());
+        out.topRightCorner(h, h) = 0.5 * (p * g2.asDiagonal() + q * g2Inverse.asDiagonal());
+        out.bottomLeftCorner(h, h) = 0.5 * (r * g2.asDiagonal() - u * g2Inverse.asDiagonal());
+        out.bottomRightCorner(h, h) = 0.5 * (r * g2.asDiagonal() + u * g2Inverse.asDiagonal());
+        return out;
+    });
+    return tToS(t);
+}
+
+// With k = (z + z') / (2 sqrt(z z')) and gamma = (z' - z) / (z' + z) per port,
+// the new waves are a' = k (a - gamma b) and b' = k (b - gamma a), so
+// S' = K (S - Gamma) (I - Gamma S)^-1 K^-1.
+Eigen::MatrixXcd renormalize(const Eigen::MatrixXcd& s, const Eigen::VectorXd& from, const Eigen::VectorXd& to)
+{
+    const int ports = portCount(s);
+    if (!validReference(ports, from) || !validReference(ports, to))
+        return {};
+    const Eigen::VectorXd k = (from + to).array() / (2.0 * (from.array() * to.array()).sqrt());
+    const Eigen::VectorXd kInverse = k.cwiseInverse();
+    const Eigen::VectorXd gamma = (to - from).array() / (to + from).array();
+    return forEachPoint(s, ports, [&](const auto& x) {
+        using M = std::decay_t<decltype(x)>;
+        const M identity = identityLike(x);
+        M shifted = x;
+        shifted.diagonal() -= gamma.cast<Complex>();
+        const M denominator = identity - gamma.asDiagonal() * x;
+        return M(k.asDiagonal() * rightDivide<M>(shifted, denominator) * kInverse.asDiagonal());
+    });
+}
+
+Eigen::MatrixXcd convert(const Eigen::MatrixXcd& parameters, Kind from, Kind to, const Eigen::VectorXd& z0)
+{
+    if (from == to)
+        return parameters;
+    if (from == Kind::Z && to == Kind::Y)
+        return zToY(parameters);
+    if (from == Kind::Y && to == Kind::Z)
+        return yToZ(parameters);
+
+    Eigen::MatrixXcd s;
+    switch (from) {
+    case Kind::S: s = parameters; break;
+    case Kind::Z: s = zToS(parameters, z0); break;
+    case Kind::Y: s = yToS(parameters, z0); break;
+    case Kind::ABCD: s = abcdToS(parameters, z0); break;
+    case Kind::T: s = tToS(parameters); break;
+    }
+    if (s.size() == 0 && parameters.size() != 0)
+        return {};
+
+    switch (to) {
+    case Kind::S: return s;
+    case Kind::Z: return sToZ(s, z0);
+    case Kind::Y: return sToY(s, z0);
+    case Kind::ABCD: return sToAbcd(s, z0);
+    case Kind::T: return sToT(s);
+    }
+    return {};
+}
+
+} // namespace NetworkParameters
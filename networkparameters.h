@@ -0,0 +1,45 @@
+#ifndef NETWORKPARAMETERS_H
+#define NETWORKPARAMETERS_H
+
+#include <Eigen/Dense>
+
+// Conversions between network parameter sets for whole frequency grids. A
+// matrix holds one N-port per row in the layout of Network::sparameters():
+// column j*N+i is entry (i, j). Reference impedances are real, one per port.
+// Up to four ports use fixed-size Eigen matrices; larger networks go through
+// a partial-pivot LU. Rows are split across ThreadPool::global().
+//
+// ABCD and T group ports 1..N/2 as the input side and N/2+1..N as the output
+// side, so they need an even port count; for a 2-port they are the usual
+// chain and scattering-transfer matrices, with T defined by
+// [b1; a1] = T [a2; b2] so that cascades multiply.
+//
+// Malformed input (columns that are not N*N, a reference vector of the wrong
+// length, an odd port count for ABCD/T) gives an empty matrix.
+namespace NetworkParameters {
+
+enum class Kind { S, Z, Y, ABCD, T };
+
+// N for a matrix with N*N columns, -1 otherwise.
+int portCount(const Eigen::MatrixXcd& parameters);
+
+Eigen::MatrixXcd sToZ(const Eigen::MatrixXcd& s, const Eigen::VectorXd& z0);
+Eigen::MatrixXcd zToS(const Eigen::MatrixXcd& z, const Eigen::VectorXd& z0);
+Eigen::MatrixXcd sToY(const Eigen::MatrixXcd& s, const Eigen::VectorXd& z0);
+Eigen::MatrixXcd yToS(const Eigen::MatrixXcd& y, const Eigen::VectorXd& z0);
+Eigen::MatrixXcd zToY(const Eigen::MatrixXcd& z);
+Eigen::MatrixXcd yToZ(const Eigen::MatrixXcd& y);
+Eigen::MatrixXcd sToAbcd(const Eigen::MatrixXcd& s, const Eigen::VectorXd& z0);
+Eigen::MatrixXcd abcdToS(const Eigen::MatrixXcd& abcd, const Eigen::VectorXd& z0);
+Eigen::MatrixXcd sToT(const Eigen::MatrixXcd& s);
+Eigen::MatrixXcd tToS(const Eigen::MatrixXcd& t);
+
+// S referenced to `from` re-expressed for the references `to`.
+Eigen::MatrixXcd renormalize(const Eigen::MatrixXcd& s, const Eigen::VectorXd& from, const Eigen::VectorXd& to);
+
+// Any set to any other, through S; z0 is ignored when neither side needs it.
+Eigen::MatrixXcd convert(const Eigen::MatrixXcd& parameters, Kind from, Kind to, const Eigen::VectorXd& z0);
+
+} // namespace NetworkParameters
+
+#endif // NETWORKPARAMETERS_H
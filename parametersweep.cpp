@@ -0,0 +1,204 @@
+#include "parametersweep.h"
+#include "cascadekernels.h"
+#include "networkcascade.h"
+#include "networklumped.h"
+#include "threadpool.h"
+
+#include <algorithm>
+#include <memory>
+#include <vector>
+
+namespace ParameterSweep {
+
+namespace {
+
+// A 2-port result of NetworkCascade::sparameters() already has the column
+// order of CascadeKernels::Column.
+void toBlocks(const Eigen::MatrixXcd& s, CascadeKernels::Blocks& blocks)
+{
+    blocks.resize(s.rows());
+    blocks.re = s.leftCols(4).real().array();
+    blocks.im = s.leftCols(4).imag().array();
+}
+
+// The unswept stages in [begin, end) as one 2-port; empty when none of them
+// is active.
+void evaluateRun(const NetworkCascade& cascade, int begin, int end, const Eigen::VectorXd& freq,
+                 CascadeKernels::Blocks& blocks)
+{
+    const QList<Network*>& networks = cascade.getNetworks();
+    NetworkCascade run;
+    bool active = false;
+    for (int i = begin; i < end; ++i) {
+        Network* network = networks.at(i);
+        if (!network)
+            continue;
+        active = active || network->isActive();
+        run.addNetwork(network);
+        run.setNetworkPortSelection(run.getNetworks().size() - 1, cascade.toPort(i), cascade.fromPort(i));
+    }
+    if (active)
+        toBlocks(run.sparameters(freq), blocks);
+    else
+        blocks.resize(0);
+    run.clearNetworks();
+}
+
+// Private copies of the swept stages for one slice of the combinations. Each
+// copy sits alone in a cascade that applies the original port selection.
+struct Worker
+{
+    std::vector<std::unique_ptr<Network>> clones;
+    std::vector<std::unique_ptr<NetworkCascade>> stages;
+};
+
+} // namespace
+
+Eigen::VectorXd Axis::values() const
+{
+    if (points <= 1)
+        return Eigen::VectorXd::Constant(1, start);
+    return NetworkCascade::sweepFrequencies(start, stop, points, logarithmic);
+}
+
+Result run(const NetworkCascade& cascade, const QVector<Axis>& axes, int sParameter, const Eigen::VectorXd& freq,
+           unsigned threads, const std::atomic<bool>* cancel)
+{
+    Result result;
+    result.freq = freq;
+    result.axes = axes;
+    result.sParameter = sParameter;
+
+    if (axes.isEmpty() || axes.size() > 2) {
+        result.error = QStringLiteral("A sweep needs one or two parameter axes.");
+        return result;
+    }
+    if (sParameter < 0 || sParameter >= 4) {
+        result.error = QStringLiteral("S-parameter index %1 does not exist in a 2-port cascade.").arg(sParameter);
+        return result;
+    }
+    if (freq.size() == 0) {
+        result.error = QStringLiteral("No frequency points to sweep.");
+        return result;
+    }
+    if (!cascade.portConnections().isEmpty()) {
+        // Runs and swept stages are star-combined as 2-port blocks.
+        result.error = QStringLiteral("Sweeps need a 2-port chain; the cascade has port connections.");
+        return result;
+    }
+
+    const QList<Network*>& networks = cascade.getNetworks();
+    std::vector<int> swept;
+    for (const Axis& axis : axes) {
+        const auto* lumped = axis.stage >= 0 && axis.stage < networks.size()
+                                 ? dynamic_cast<const NetworkLumped*>(networks.at(axis.stage))
+                                 : nullptr;
+        if (!lumped) {
+            result.error = QStringLiteral("Cascade stage %1 is not a lumped network.").arg(axis.stage + 1);
+            return result;
+        }
+        if (!lumped->isActive()) {
+            result.error = QStringLiteral("Cascade stage %1 is inactive.").arg(axis.stage + 1);
+            return result;
+        }
+        if (axis.parameter < 0 || axis.parameter >= lumped->parameterCount()) {
+            result.error = QStringLiteral("%1 has no parameter %2.").arg(lumped->displayName()).arg(axis.parameter + 1);
+            return result;
+        }
+        result.values.append(axis.values());
+        result.labels.append(QStringLiteral("%1: %2").arg(axis.stage + 1).arg(lumped->parameterDescription(axis.parameter)));
+        if (std::find(swept.begin(), swept.end(), axis.stage) == swept.end())
+            swept.push_back(axis.stage);
+    }
+    std::sort(swept.begin(), swept.end());
+
+    // runs[k] lies before swept[k]; the last one follows the last swept stage.
+    std::vector<CascadeKernels::Blocks> runs(swept.size() + 1);
+    int begin = 0;
+    for (std::size_t k = 0; k < swept.size(); ++k) {
+        evaluateRun(cascade, begin, swept[k], freq, runs[k]);
+        begin = swept[k] + 1;
+    }
+    evaluateRun(cascade, begin, static_cast<int>(networks.size()), freq, runs.back());
+
+    const Eigen::Index n0 = result.values.at(0).size();
+    const Eigen::Index n1 = axes.size() > 1 ? result.values.at(1).size() : 1;
+    const std::size_t combinations = static_cast<std::size_t>(n0 * n1);
+    result.response.resize(static_cast<Eigen::Index>(combinations), freq.size());
+
+    const unsigned limit = threads != 0 ? threads : NetworkCascade::threadCount();
+    const unsigned available = limit == 0 ? ThreadPool::global().threadCount()
+                                          : std::min(limit, ThreadPool::global().threadCount());
+    const std::size_t chunks = std::min<std::size_t>(combinations, std::max(available, 1u));
+
+    // QObjects are created here rather than on the pool's threads.
+    std::vector<Worker> workers(chunks);
+    for (Worker& worker : workers) {
+        for (int stage : swept) {
+            worker.clones.emplace_back(networks.at(stage)->clone());
+            auto single = std::make_unique<NetworkCascade>();
+            single->addNetwork(worker.clones.back().get());
+            single->setNetworkPortSelection(0, cascade.toPort(stage), cascade.fromPort(stage));
+            worker.stages.push_back(std::move(single));
+        }
+    }
+
+    std::atomic<bool> cancelled{false};
+    ThreadPool::global().parallelFor(chunks, [&](std::size_t chunk) {
+        Worker& worker = workers[chunk];
+        CascadeKernels::Blocks stage;
+        CascadeKernels::Blocks chain;
+        CascadeKernels::Blocks next;
+        const std::size_t first = chunk * combinations / chunks;
+        const std::size_t last = (chunk + 1) * combinations / chunks;
+        for (std::size_t k = first; k < last; ++k) {
+            if (cancel && cancel->load()) {
+                cancelled = true;
+                return;
+            }
+            const Eigen::Index index[2] = {static_cast<Eigen::Index>(k) % n0, static_cast<Eigen::Index>(k) / n0};
+            for (int a = 0; a < axes.size(); ++a) {
+                const std::size_t slot = static_cast<std::size_t>(
+                    std::find(swept.begin(), swept.end(), axes.at(a).stage) - swept.begin());
+                static_cast<NetworkLumped*>(worker.clones[slot].get())
+                    ->setParameterValue(axes.at(a).parameter, result.values.at(a)(index[a]));
+            }
+
+            chain.resize(0);
+            auto append = [&](const CascadeKernels::Blocks& right) {
+                if (right.rows() == 0)
+                    return;
+                if (chain.rows() == 0) {
+                    chain = right;
+                    return;
+                }
+                next.resize(right.rows());
+                CascadeKernels::star(chain, right, next, 0, right.rows());
+                std::swap(chain, next);
+            };
+            for (std::size_t s = 0; s < swept.size(); ++s) {
+                append(runs[s]);
+                toBlocks(worker.stages[s]->sparameters(freq), stage);
+                append(stage);
+            }
+            append(runs.back());
+
+            const Eigen::Index row = static_cast<Eigen::Index>(k);
+            result.response.row(row).real() = chain.re.col(sParameter).matrix().transpose();
+            result.response.row(row).imag() = chain.im.col(sParameter).matrix().transpose();
+        }
+    }, limit);
+
+    for (Worker& worker : workers) {
+        for (auto& single : worker.stages)
+            single->clearNetworks();
+    }
+
+    if (cancelled) {
+        result.response.resize(0, 0);
+        result.error = QStringLiteral("Sweep cancelled.");
+    }
+    return result;
+}
+
+} // namespace ParameterSweep
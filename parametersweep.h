@@ -0,0 +1,53 @@
+#ifndef PARAMETERSWEEP_H
+#define PARAMETERSWEEP_H
+
+#include <Eigen/Dense>
+#include <QString>
+#include <QStringList>
+#include <QVector>
+#include <atomic>
+
+class NetworkCascade;
+
+// Evaluates a cascade for every combination of values of one or two lumped
+// stage parameters. The stages that are not swept are combined once into the
+// runs before, between and after the swept ones, so each combination costs
+// only the swept stages and a few star products per frequency.
+namespace ParameterSweep {
+
+struct Axis
+{
+    int stage = 0;              // index in NetworkCascade::getNetworks(); must be a NetworkLumped
+    int parameter = 0;          // NetworkLumped parameter index
+    double start = 0.0;         // in the parameter's display units, e.g. pF
+    double stop = 0.0;
+    int points = 2;
+    bool logarithmic = false;
+
+    Eigen::VectorXd values() const;
+};
+
+struct Result
+{
+    Eigen::VectorXd freq;
+    QVector<Axis> axes;
+    QVector<Eigen::VectorXd> values;    // one per axis
+    QStringList labels;                 // "<stage>: <parameter description>" per axis
+    int sParameter = 0;                 // column of the cascade's sparameters()
+    // Row k holds the combination values[0](k % n0), values[1](k / n0);
+    // columns follow freq.
+    Eigen::MatrixXcd response;
+    QString error;                      // empty on success
+
+    bool ok() const { return error.isEmpty(); }
+    Eigen::Index combinationCount() const { return response.rows(); }
+};
+
+// threads limits the parallelism (0 = NetworkCascade::threadCount()). Setting
+// cancel stops the remaining combinations and returns an error.
+Result run(const NetworkCascade& cascade, const QVector<Axis>& axes, int sParameter, const Eigen::VectorXd& freq,
+           unsigned threads = 0, const std::atomic<bool>* cancel = nullptr);
+
+} // namespace ParameterSweep
+
+#endif // PARAMETERSWEEP_H
@@ -0,0 +1,401 @@
+#include "parametersweepdialog.h"
+
+#include "cascadeio.h"
+#include "networkcascade.h"
+#include "networklumped.h"
+#include "qcustomplot.h"
+
+#include <QCheckBox>
+#include <QComboBox>
+#include <QDir>
+#include <QFileDialog>
+#include <QGridLayout>
+#include <QHBoxLayout>
+#include <QLabel>
+#include <QLineEdit>
+#include <QMessageBox>
+#include <QPushButton>
+#include <QSignalBlocker>
+#include <QSpinBox>
+#include <QThreadPool>
+#include <QVBoxLayout>
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+namespace {
+
+// More curves than this are thinned out evenly; the heatmap shows all of them.
+constexpr Eigen::Index kMaxCurves = 64;
+constexpr Eigen::Index kMaxLegendEntries = 12;
+
+// The clone's members are its children, but ~NetworkCascade detaches them,
+// so they are released separately after it.
+void releaseSnapshot(NetworkCascade* cascade)
+{
+    const QList<Network*> members = cascade->getNetworks();
+    cascade->deleteLater();
+    for (Network* member : members)
+        member->deleteLater();
+}
+
+QString sParameterName(int column)
+{
+    return QStringLiteral("S%1%2").arg(column % 2 + 1).arg(column / 2 + 1);
+}
+
+// Heatmap cells are uniform in plot coordinates, so logarithmic sweeps are
+// drawn over log10 of their values.
+bool isLogarithmic(const Eigen::VectorXd& values)
+{
+    if (values.size() < 3 || !(values(0) > 0.0))
+        return false;
+    const double first = values(1) - values(0);
+    const double last = values(values.size() - 1) - values(values.size() - 2);
+    return std::abs(last - first) > 1e-6 * std::abs(last);
+}
+
+QCPRange cellRange(const Eigen::VectorXd& values, bool logarithmic)
+{
+    const auto coordinate = [logarithmic](double value) { return logarithmic ? std::log10(value) : value; };
+    QCPRange range(coordinate(values(0)), coordinate(values(values.size() - 1)));
+    if (range.lower == range.upper) {
+        range.lower -= 0.5;
+        range.upper += 0.5;
+    }
+    return range;
+}
+
+} // namespace
+
+ParameterSweepDialog::ParameterSweepDialog(NetworkCascade* cascade, QWidget* parent)
+    : QDialog(parent)
+    , m_cascade(cascade)
+    , m_colorScale(nullptr)
+    , m_pool(new QThreadPool(this))
+    , m_generation(0)
+    , m_running(false)
+{
+    setWindowTitle(tr("Parameter Sweep"));
+    setModal(true);
+    m_pool->setMaxThreadCount(1);
+
+    auto axesLayout = new QGridLayout;
+    const QStringList headers = {QString(), tr("Stage"), tr("Parameter"), tr("From"), tr("To"), tr("Points"), tr("Log")};
+    for (int column = 0; column < headers.size(); ++column)
+        axesLayout->addWidget(new QLabel(headers.at(column), this), 0, column);
+    setupAxis(m_axes[0], axesLayout, 1, false);
+    setupAxis(m_axes[1], axesLayout, 2, true);
+
+    m_targetCombo = new QComboBox(this);
+    for (int column : {0, 1, 2, 3})
+        m_targetCombo->addItem(sParameterName(column), column);
+    m_targetCombo->setCurrentIndex(1);
+    m_metricCombo = new QComboBox(this);
+    m_metricCombo->addItems({tr("Magnitude (dB)"), tr("Phase (deg)")});
+    m_viewCombo = new QComboBox(this);
+    m_viewCombo->addItems({tr("Curves"), tr("Heatmap")});
+    m_sliceCombo = new QComboBox(this);
+    m_sliceCombo->setEnabled(false);
+    m_sliceCombo->setToolTip(tr("Value of the second axis shown"));
+    connect(m_metricCombo, qOverload<int>(&QComboBox::currentIndexChanged), this, &ParameterSweepDialog::updatePlot);
+    connect(m_viewCombo, qOverload<int>(&QComboBox::currentIndexChanged), this, &ParameterSweepDialog::updatePlot);
+    connect(m_sliceCombo, qOverload<int>(&QComboBox::currentIndexChanged), this, &ParameterSweepDialog::updatePlot);
+
+    m_runButton = new QPushButton(tr("Run"), this);
+    m_runButton->setDefault(true);
+    m_saveButton = new QPushButton(tr("Save..."), this);
+    m_saveButton->setEnabled(false);
+    m_statusLabel = new QLabel(this);
+    connect(m_runButton, &QPushButton::clicked, this, &ParameterSweepDialog::runOrCancel);
+    connect(m_saveButton, &QPushButton::clicked, this, &ParameterSweepDialog::saveResult);
+
+    auto controlsLayout = new QHBoxLayout;
+    controlsLayout->addWidget(new QLabel(tr("Target"), this));
+    controlsLayout->addWidget(m_targetCombo);
+    controlsLayout->addWidget(m_metricCombo);
+    controlsLayout->addWidget(m_viewCombo);
+    controlsLayout->addWidget(new QLabel(tr("Axis 2 at"), this));
+    controlsLayout->addWidget(m_sliceCombo);
+    controlsLayout->addStretch(1);
+    controlsLayout->addWidget(m_statusLabel);
+    controlsLayout->addWidget(m_runButton);
+    controlsLayout->addWidget(m_saveButton);
+
+    m_plot = new QCustomPlot(this);
+    m_plot->setMinimumSize(720, 420);
+    m_plot->setInteractions(QCP::iRangeDrag | QCP::iRangeZoom);
+
+    auto layout = new QVBoxLayout(this);
+    layout->addLayout(axesLayout);
+    layout->addLayout(controlsLayout);
+    layout->addWidget(m_plot, 1);
+}
+
+ParameterSweepDialog::~ParameterSweepDialog()
+{
+    if (m_cancel)
+        m_cancel->store(true);
+    m_pool->clear();
+    m_pool->waitForDone();
+}
+
+void ParameterSweepDialog::setupAxis(AxisControls& axis, QGridLayout* layout, int row, bool optional)
+{
+    axis.enabled = new QCheckBox(optional ? tr("Axis 2") : tr("Axis 1"), this);
+    axis.enabled->setChecked(!optional);
+    axis.enabled->setEnabled(optional);
+    axis.stage = new QComboBox(this);
+    axis.parameter = new QComboBox(this);
+    axis.start = new QLineEdit(this);
+    axis.stop = new QLineEdit(this);
+    axis.points = new QSpinBox(this);
+    axis.points->setRange(1, 1000);
+    axis.points->setValue(optional ? 5 : 11);
+    axis.logarithmic = new QCheckBox(this);
+
+    const QList<Network*>& networks = m_cascade->getNetworks();
+    for (int i = 0; i < networks.size(); ++i) {
+        if (auto* lumped = dynamic_cast<NetworkLumped*>(networks.at(i)))
+            axis.stage->addItem(QStringLiteral("%1: %2").arg(i + 1).arg(lumped->displayName()), i);
+    }
+
+    connect(axis.stage, qOverload<int>(&QComboBox::currentIndexChanged), this, [this, &axis] {
+        populateParameters(axis);
+    });
+    // Each new parameter starts from half to twice its present value.
+    connect(axis.parameter, qOverload<int>(&QComboBox::currentIndexChanged), this, [this, &axis] {
+        const auto* lumped = dynamic_cast<const NetworkLumped*>(
+            m_cascade->getNetworks().value(axis.stage->currentData().toInt()));
+        if (!lumped || axis.parameter->currentIndex() < 0)
+            return;
+        const double value = lumped->parameterValue(axis.parameter->currentData().toInt());
+        const bool positive = value > 0.0;
+        axis.start->setText(QString::number(positive ? value / 2.0 : value - 1.0, 'g', 6));
+        axis.stop->setText(QString::number(positive ? value * 2.0 : value + 1.0, 'g', 6));
+        axis.logarithmic->setChecked(positive);
+    });
+    if (optional) {
+        auto enable = [&axis](bool enabled) {
+            for (QWidget* widget : {static_cast<QWidget*>(axis.stage), static_cast<QWidget*>(axis.parameter),
+                                    static_cast<QWidget*>(axis.start), static_cast<QWidget*>(axis.stop),
+                                    static_cast<QWidget*>(axis.points), static_cast<QWidget*>(axis.logarithmic)})
+                widget->setEnabled(enabled);
+        };
+        connect(axis.enabled, &QCheckBox::toggled, this, enable);
+        enable(false);
+    }
+
+    layout->addWidget(axis.enabled, row, 0);
+    layout->addWidget(axis.stage, row, 1);
+    layout->addWidget(axis.parameter, row, 2);
+    layout->addWidget(axis.start, row, 3);
+    layout->addWidget(axis.stop, row, 4);
+    layout->addWidget(axis.points, row, 5);
+    layout->addWidget(axis.logarithmic, row, 6);
+    populateParameters(axis);
+}
+
+void ParameterSweepDialog::populateParameters(AxisControls& axis)
+{
+    axis.parameter->clear();
+    const auto* lumped = dynamic_cast<const NetworkLumped*>(
+        m_cascade->getNetworks().value(axis.stage->currentData().toInt()));
+    if (!lumped)
+        return;
+    for (int i = 0; i < lumped->parameterCount(); ++i)
+        axis.parameter->addItem(lumped->parameterDescription(i), i);
+}
+
+bool ParameterSweepDialog::readAxis(const AxisControls& axis, ParameterSweep::Axis& out, QString& error) const
+{
+    if (axis.stage->currentIndex() < 0 || axis.parameter->currentIndex() < 0) {
+        error = tr("The cascade has no lumped stage to sweep.");
+        return false;
+    }
+    bool okStart = false;
+    bool okStop = false;
+    out.start = axis.start->text().trimmed().toDouble(&okStart);
+    out.stop = axis.stop->text().trimmed().toDouble(&okStop);
+    if (!okStart || !okStop) {
+        error = tr("Enter numeric start and stop values.");
+        return false;
+    }
+    out.stage = axis.stage->currentData().toInt();
+    out.parameter = axis.parameter->currentData().toInt();
+    out.points = axis.points->value();
+    out.logarithmic = axis.logarithmic->isChecked();
+    if (out.logarithmic && !(out.start > 0.0 && out.stop > 0.0)) {
+        error = tr("Logarithmic steps need positive start and stop values.");
+        return false;
+    }
+    return true;
+}
+
+void ParameterSweepDialog::runOrCancel()
+{
+    if (m_running) {
+        m_cancel->store(true);
+        return;
+    }
+
+    QVector<ParameterSweep::Axis> axes;
+    for (const AxisControls& controls : m_axes) {
+        if (!controls.enabled->isChecked())
+            continue;
+        ParameterSweep::Axis axis;
+        QString error;
+        if (!readAxis(controls, axis, error)) {
+            m_statusLabel->setText(error);
+            return;
+        }
+        axes.append(axis);
+    }
+
+    // The cascade's range and point count, spaced uniformly so that the
+    // heatmap cells line up with the samples.
+    double fmin = m_cascade->fmin();
+    double fmax = m_cascade->fmax();
+    if (!(fmax > fmin)) {
+        fmin = 1e6;
+        fmax = 10e9;
+    }
+    const bool logarithmic = m_cascade->frequencyPlan() == NetworkCascade::FrequencyPlan::Logarithmic;
+    const Eigen::VectorXd freq = NetworkCascade::sweepFrequencies(fmin, fmax, m_cascade->pointCount(), logarithmic);
+    const int target = m_targetCombo->currentData().toInt();
+
+    std::shared_ptr<NetworkCascade> snapshot(static_cast<NetworkCascade*>(m_cascade->clone()), releaseSnapshot);
+    auto cancel = std::make_shared<std::atomic<bool>>(false);
+    m_cancel = cancel;
+    const quint64 generation = ++m_generation;
+    m_running = true;
+    m_runButton->setText(tr("Cancel"));
+    m_saveButton->setEnabled(false);
+    m_statusLabel->setText(tr("Sweeping..."));
+
+    m_pool->start([this, snapshot, axes, target, freq, cancel, generation] {
+        const ParameterSweep::Result result = ParameterSweep::run(*snapshot, axes, target, freq, 0, cancel.get());
+        QMetaObject::invokeMethod(this, [this, generation, result] { finishRun(generation, result); },
+                                  Qt::QueuedConnection);
+    });
+}
+
+void ParameterSweepDialog::finishRun(quint64 generation, const ParameterSweep::Result& result)
+{
+    if (generation != m_generation)
+        return;
+    m_running = false;
+    m_runButton->setText(tr("Run"));
+    if (!result.ok()) {
+        m_statusLabel->setText(result.error);
+        m_saveButton->setEnabled(m_result.response.size() > 0);
+        return;
+    }
+
+    m_result = result;
+    m_saveButton->setEnabled(true);
+    m_statusLabel->setText(tr("%1 combinations, %2 points").arg(result.combinationCount()).arg(result.freq.size()));
+    updateSliceChoices();
+    updatePlot();
+}
+
+void ParameterSweepDialog::updateSliceChoices()
+{
+    const QSignalBlocker blocker(m_sliceCombo);
+    m_sliceCombo->clear();
+    const bool twoAxes = m_result.values.size() > 1;
+    m_sliceCombo->setEnabled(twoAxes);
+    if (!twoAxes)
+        return;
+    const Eigen::VectorXd& values = m_result.values.at(1);
+    for (Eigen::Index i = 0; i < values.size(); ++i)
+        m_sliceCombo->addItem(QString::number(values(i), 'g', 6));
+}
+
+Eigen::ArrayXd ParameterSweepDialog::metric(const Eigen::VectorXcd& values) const
+{
+    if (m_metricCombo->currentIndex() == 1)
+        return values.array().arg() * (180.0 / M_PI);
+    return 20.0 * values.array().abs().max(std::numeric_limits<double>::min()).log10();
+}
+
+void ParameterSweepDialog::updatePlot()
+{
+    m_plot->clearPlottables();
+    if (m_colorScale) {
+        m_plot->plotLayout()->remove(m_colorScale);
+        m_plot->plotLayout()->simplify();
+        m_colorScale = nullptr;
+    }
+    m_plot->legend->setVisible(false);
+    if (m_result.response.size() == 0) {
+        m_plot->replot();
+        return;
+    }
+
+    const Eigen::VectorXd& freq = m_result.freq;
+    const Eigen::VectorXd& values = m_result.values.at(0);
+    const Eigen::Index n0 = values.size();
+    const Eigen::Index slice = m_result.values.size() > 1 ? std::max(0, m_sliceCombo->currentIndex()) : 0;
+    const QString metricLabel = QStringLiteral("%1 %2").arg(sParameterName(m_result.sParameter), m_metricCombo->currentText());
+    const bool logFrequency = isLogarithmic(freq);
+
+    if (m_viewCombo->currentIndex() == 0) {
+        QCPColorGradient gradient(QCPColorGradient::gpSpectrum);
+        const QVector<double> x(freq.data(), freq.data() + freq.size());
+        const Eigen::Index count = std::min(n0, kMaxCurves);
+        const QCPRange colorRange(0.0, std::max<double>(static_cast<double>(count - 1), 1.0));
+        for (Eigen::Index i = 0; i < count; ++i) {
+            const Eigen::Index curve = count == n0 ? i : i * (n0 - 1) / (count - 1);
+            const Eigen::ArrayXd y = metric(m_result.response.row(slice * n0 + curve).transpose());
+            QCPGraph* graph = m_plot->addGraph();
+            graph->setData(x, QVector<double>(y.data(), y.data() + y.size()), true);
+            graph->setPen(QPen(QColor::fromRgb(gradient.color(static_cast<double>(i), colorRange)), 1.5));
+            graph->setName(QStringLiteral("%1 = %2").arg(m_result.labels.at(0), QString::number(values(curve), 'g', 6)));
+        }
+        m_plot->legend->setVisible(count <= kMaxLegendEntries);
+        m_plot->xAxis->setScaleType(logFrequency ? QCPAxis::stLogarithmic : QCPAxis::stLinear);
+        m_plot->xAxis->setLabel(tr("Frequency (Hz)"));
+        m_plot->yAxis->setLabel(metricLabel);
+    } else {
+        const bool logValues = isLogarithmic(values);
+        auto* map = new QCPColorMap(m_plot->xAxis, m_plot->yAxis);
+        map->data()->setSize(static_cast<int>(freq.size()), static_cast<int>(n0));
+        map->data()->setRange(cellRange(freq, logFrequency), cellRange(values, logValues));
+        for (Eigen::Index row = 0; row < n0; ++row) {
+            const Eigen::ArrayXd y = metric(m_result.response.row(slice * n0 + row).transpose());
+            for (Eigen::Index col = 0; col < y.size(); ++col)
+                map->data()->setCell(static_cast<int>(col), static_cast<int>(row), y(col));
+        }
+        m_colorScale = new QCPColorScale(m_plot);
+        m_plot->plotLayout()->addElement(0, 1, m_colorScale);
+        m_colorScale->axis()->setLabel(metricLabel);
+        map->setColorScale(m_colorScale);
+        map->setGradient(QCPColorGradient::gpJet);
+        map->rescaleDataRange(true);
+        m_plot->xAxis->setScaleType(QCPAxis::stLinear);
+        m_plot->xAxis->setLabel(logFrequency ? tr("log10(Frequency / Hz)") : tr("Frequency (Hz)"));
+        m_plot->yAxis->setLabel(logValues ? QStringLiteral("log10(%1)").arg(m_result.labels.at(0)) : m_result.labels.at(0));
+    }
+    m_plot->yAxis->setScaleType(QCPAxis::stLinear);
+    m_plot->rescaleAxes();
+    m_plot->replot();
+}
+
+void ParameterSweepDialog::saveResult()
+{
+    const QString path = QFileDialog::getSaveFileName(this, tr("Save Parameter Sweep"), QString(),
+                                                      tr("CSV files (*.csv);;All files (*.*)"));
+    if (path.isEmpty())
+        return;
+
+    QString savedPath;
+    QString errorMessage;
+    if (!saveSweepToFile(m_result, path, &savedPath, &errorMessage)) {
+        QMessageBox::critical(this, tr("Save Parameter Sweep"),
+                              errorMessage.isEmpty() ? tr("Failed to save sweep.") : errorMessage);
+        return;
+    }
+    m_statusLabel->setText(tr("Saved to %1").arg(QDir::toNativeSeparators(savedPath)));
+}
@@ -0,0 +1,75 @@
+#ifndef PARAMETERSWEEPDIALOG_H
+#define PARAMETERSWEEPDIALOG_H
+
+#include "parametersweep.h"
+
+#include <QDialog>
+#include <atomic>
+#include <memory>
+
+class NetworkCascade;
+class QCheckBox;
+class QComboBox;
+class QCPColorScale;
+class QCustomPlot;
+class QGridLayout;
+class QLabel;
+class QLineEdit;
+class QPushButton;
+class QSpinBox;
+class QThreadPool;
+
+// Sweeps one or two parameters of the cascade's lumped stages in the
+// background and shows the chosen S-parameter as a family of curves or as a
+// heatmap over parameter value and frequency.
+class ParameterSweepDialog : public QDialog
+{
+    Q_OBJECT
+public:
+    explicit ParameterSweepDialog(NetworkCascade* cascade, QWidget* parent = nullptr);
+    ~ParameterSweepDialog() override;
+
+private slots:
+    void runOrCancel();
+    void saveResult();
+    void updatePlot();
+
+private:
+    struct AxisControls
+    {
+        QCheckBox* enabled = nullptr;
+        QComboBox* stage = nullptr;
+        QComboBox* parameter = nullptr;
+        QLineEdit* start = nullptr;
+        QLineEdit* stop = nullptr;
+        QSpinBox* points = nullptr;
+        QCheckBox* logarithmic = nullptr;
+    };
+
+    void setupAxis(AxisControls& axis, QGridLayout* layout, int row, bool optional);
+    void populateParameters(AxisControls& axis);
+    bool readAxis(const AxisControls& axis, ParameterSweep::Axis& out, QString& error) const;
+    void finishRun(quint64 generation, const ParameterSweep::Result& result);
+    void updateSliceChoices();
+    Eigen::ArrayXd metric(const Eigen::VectorXcd& values) const;
+
+    NetworkCascade* m_cascade;
+    AxisControls m_axes[2];
+    QComboBox* m_targetCombo;
+    QComboBox* m_metricCombo;
+    QComboBox* m_viewCombo;
+    QComboBox* m_sliceCombo;
+    QPushButton* m_runButton;
+    QPushButton* m_saveButton;
+    QLabel* m_statusLabel;
+    QCustomPlot* m_plot;
+    QCPColorScale* m_colorScale;
+
+    QThreadPool* m_pool;
+    std::shared_ptr<std::atomic<bool>> m_cancel;
+    quint64 m_generation;
+    bool m_running;
+    ParameterSweep::Result m_result;
+};
+
+#endif // PARAMETERSWEEPDIALOG_H
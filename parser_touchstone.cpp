@@ -1,18 +1,26 @@
 #include "parser_touchstone.h"
+#include "mappedfile.h"
+#include "threadpool.h"
+#include "touchstone_cache.h"
 
 #include <Eigen/Dense>
 
 #include <algorithm>
 #include <cerrno>
 #include <cctype>
+#include <charconv>
 #include <cmath>
 #include <complex>
+#include <cstdint>
 #include <cstdlib>
+#include <cstring>
 #include <fstream>
 #include <iomanip>
+#include <limits>
 #include <optional>
 #include <sstream>
 #include <stdexcept>
+#include <streambuf>
 #include <string>
 #include <utility>
 #include <vector>
@@ -185,36 +193,688 @@ std::vector<double> tokenize_numbers(const std::string& s) {
     return out;
 }
 
-std::complex<double> pair_to_complex(double a, double b, const std::string& fmt_upper) {
-    if (fmt_upper == "RI") {
-        return {a, b};
+// Read-only streambuf over an existing buffer, used to hand mapped files to the
+// stream parser without copying them.
+class MemoryStreamBuf : public std::streambuf {
+public:
+    MemoryStreamBuf(const char* data, std::size_t size) {
+        char* begin = const_cast<char*>(data);
+        setg(begin, begin, begin + size);
     }
-    if (fmt_upper == "MA") {
-        return std::polar(a, b * kDegToRad);
+};
+
+inline bool is_blank(char c) {
+    return c == ' ' || c == '\t' || c == '\r' || c == '\n' || c == '\v' || c == '\f';
+}
+
+// Parses one number starting at `begin`, accepting the same spellings as strtod
+// (leading '+', hexadecimal) so both parsers agree on every token.
+std::from_chars_result parse_number(const char* begin, const char* end, double& value) {
+    const char* digits = begin;
+    if (digits < end && *digits == '+' && digits + 1 < end && digits[1] != '+' && digits[1] != '-') {
+        ++digits;
     }
-    if (fmt_upper == "DB") {
-        const double mag = std::pow(10.0, a / 20.0);
-        return std::polar(mag, b * kDegToRad);
+    const char* mantissa = digits < end && *digits == '-' ? digits + 1 : digits;
+    if (end - mantissa > 1 && mantissa[0] == '0' && (mantissa[1] == 'x' || mantissa[1] == 'X')) {
+        const char* token_end = mantissa;
+        while (token_end < end && !is_blank(*token_end)) {
+            ++token_end;
+        }
+        const std::string token(begin, token_end);
+        char* parsed_end = nullptr;
+        errno = 0;
+        value = std::strtod(token.c_str(), &parsed_end);
+        const char* ptr = begin + (parsed_end - token.c_str());
+        if (ptr == begin) {
+            return {begin, std::errc::invalid_argument};
+        }
+        return {ptr, errno == ERANGE ? std::errc::result_out_of_range : std::errc()};
     }
-    throw std::runtime_error("Unsupported format: " + fmt_upper);
+    std::from_chars_result result = std::from_chars(digits, end, value);
+    if (result.ptr == digits) {
+        return {begin, std::errc::invalid_argument};
+    }
+    return result;
 }
 
-std::pair<double, double> complex_to_pair(const std::complex<double>& value, const std::string& fmt_upper) {
+enum class ValueFormat { RI, MA, DB };
+
+ValueFormat value_format(const std::string& fmt_upper) {
     if (fmt_upper == "RI") {
-        return {std::real(value), std::imag(value)};
+        return ValueFormat::RI;
     }
-    const double magnitude = std::abs(value);
-    const double angle_deg = std::arg(value) * kRadToDeg;
     if (fmt_upper == "MA") {
-        return {magnitude, angle_deg};
+        return ValueFormat::MA;
     }
     if (fmt_upper == "DB") {
-        const double magnitude_db = 20.0 * std::log10(magnitude);
-        return {magnitude_db, angle_deg};
+        return ValueFormat::DB;
     }
     throw std::runtime_error("Unsupported format: " + fmt_upper);
 }
 
+// The batch kernels work through fixed-size chunks: they stay in L1, and as
+// the chunk is a whole number of packets every value takes the same packet
+// path whatever the batch length (Eigen would finish a partial packet with
+// the scalar libm call). A short final chunk is zero-padded.
+constexpr Eigen::Index kConvertChunk = 256;
+using ConvertChunk = Eigen::Array<double, kConvertChunk, 1>;
+
+// Adding and subtracting 1.5 * 2^52 rounds a double of magnitude below 2^51
+// to the nearest integer in two packet adds.
+constexpr double kRoundBias = 6755399441055744.0;
+// Angles beyond this many degrees are left to std::polar; below it the
+// quarter-turn count stays far inside kRoundBias's range.
+constexpr double kMaxReducedDegrees = 1e12;
+
+// cos and sin of angles in degrees, as array expressions that Eigen
+// vectorizes (its own cos and sin are scalar for double). The angle is split
+// into a multiple of 90 degrees, which is exact, and a remainder within +-45
+// degrees where short polynomials reach double precision; the quarter turn
+// then swaps and signs the two results.
+void sincos_degrees(const ConvertChunk& degrees, ConvertChunk& cos_out, ConvertChunk& sin_out) {
+    const ConvertChunk turns = (degrees * (1.0 / 90.0) + kRoundBias) - kRoundBias;
+    const ConvertChunk x = (degrees - 90.0 * turns) * kDegToRad;
+    const ConvertChunk x2 = x.square();
+    // fdlibm's __kernel_sin / __kernel_cos minimax polynomials for |x| <= pi/4.
+    const ConvertChunk sin_x =
+        x + x * x2 * (-1.66666666666666324348e-01 + x2 * (8.33333333332248946124e-03 +
+        x2 * (-1.98412698298579493134e-04 + x2 * (2.75573137070700676789e-06 +
+        x2 * (-2.50507602534068634195e-08 + x2 * 1.58969099521155010221e-10)))));
+    const ConvertChunk cos_x =
+        1.0 - 0.5 * x2 + x2 * x2 * (4.16666666666666019037e-02 + x2 * (-1.38888888888741095749e-03 +
+        x2 * (2.48015872894767294178e-05 + x2 * (-2.75573143513906633035e-07 +
+        x2 * (2.08757232129817482790e-09 + x2 * -1.13596475577881948265e-11)))));
+    // Quarter turns modulo 4, q in [-2, 2]; -2 and 2 are both a half turn.
+    // The swap and the signs are exact small-integer arithmetic rather than
+    // comparisons, which Eigen does not vectorize: `odd` is 1 for q = +-1 and
+    // 0 otherwise, `even` is 1, 0, -1 for q = 0, +-1, +-2.
+    const ConvertChunk quadrant = turns - 4.0 * ((turns * 0.25 + kRoundBias) - kRoundBias);
+    const ConvertChunk q2 = quadrant.square();
+    const ConvertChunk odd = q2 * (4.0 - q2) / 3.0;
+    const ConvertChunk even = (1.0 - odd) * (1.0 - 0.5 * q2);
+    const ConvertChunk odd_sign = quadrant * odd;
+    sin_out = even * sin_x + odd_sign * cos_x;
+    cos_out = even * cos_x - odd_sign * sin_x;
+}
+
+// Converts `count` interleaved (a, b) pairs. Each chunk is split into
+// magnitude and angle columns so the exp and sincos run as Eigen packet math;
+// results agree with std::polar / std::pow to a few ULP of |s|.
+void pairs_to_complex(const double* pairs, std::size_t count, ValueFormat format, std::complex<double>* out) {
+    const Eigen::Index n = static_cast<Eigen::Index>(count);
+    const Eigen::Map<const Eigen::Array2Xd> in(pairs, 2, n);
+    Eigen::Map<Eigen::Array2Xd> result(reinterpret_cast<double*>(out), 2, n);
+    if (format == ValueFormat::RI) {
+        result = in;
+        return;
+    }
+
+    ConvertChunk magnitude;
+    ConvertChunk degrees;
+    ConvertChunk cos_angle;
+    ConvertChunk sin_angle;
+    for (Eigen::Index begin = 0; begin < n; begin += kConvertChunk) {
+        const Eigen::Index size = std::min(kConvertChunk, n - begin);
+        magnitude.setZero();
+        degrees.setZero();
+        magnitude.head(size) = in.row(0).segment(begin, size).transpose();
+        degrees.head(size) = in.row(1).segment(begin, size).transpose();
+        if (format == ValueFormat::DB) {
+            // 10^(a/20) as one exp over the chunk.
+            magnitude = (magnitude * (std::log(10.0) / 20.0)).exp();
+        }
+        sincos_degrees(degrees, cos_angle, sin_angle);
+        result.row(0).segment(begin, size) = (magnitude * cos_angle).head(size).transpose();
+        result.row(1).segment(begin, size) = (magnitude * sin_angle).head(size).transpose();
+        for (Eigen::Index i = 0; i < size; ++i) {
+            if (!(std::abs(degrees(i)) <= kMaxReducedDegrees)) {
+                out[begin + i] = std::polar(magnitude(i), degrees(i) * kDegToRad);
+            }
+        }
+    }
+}
+
+// The inverse of pairs_to_complex. Magnitudes come from |s|^2 as a packet
+// sqrt or log10; where |s|^2 underflows or overflows, std::abs keeps the
+// finite value.
+void complex_to_pairs(const std::complex<double>* values, std::size_t count, ValueFormat format, double* out) {
+    const Eigen::Index n = static_cast<Eigen::Index>(count);
+    const Eigen::Map<const Eigen::Array2Xd> in(reinterpret_cast<const double*>(values), 2, n);
+    Eigen::Map<Eigen::Array2Xd> result(out, 2, n);
+    if (format == ValueFormat::RI) {
+        result = in;
+        return;
+    }
+
+    ConvertChunk power;
+    ConvertChunk first;
+    for (Eigen::Index begin = 0; begin < n; begin += kConvertChunk) {
+        const Eigen::Index size = std::min(kConvertChunk, n - begin);
+        power.setOnes();
+        power.head(size) = in.middleCols(begin, size).colwise().squaredNorm().transpose();
+        if (format == ValueFormat::DB) {
+            first = 10.0 * power.log10();
+        } else {
+            first = power.sqrt();
+        }
+        for (Eigen::Index i = 0; i < size; ++i) {
+            if (!(power(i) >= std::numeric_limits<double>::min() && power(i) <= std::numeric_limits<double>::max())) {
+                const double magnitude = std::abs(values[begin + i]);
+                first(i) = format == ValueFormat::DB ? 20.0 * std::log10(magnitude) : magnitude;
+            }
+        }
+        result.row(0).segment(begin, size) = first.head(size).transpose();
+    }
+    for (Eigen::Index i = 0; i < n; ++i) {
+        result(1, i) = std::arg(values[i]) * kRadToDeg;
+    }
+}
+
+// Converts the value pairs of `rows` consecutive data rows into rows
+// [first_row, first_row + rows) of the column-major S-parameter array. `raw`
+// points at the first pair of the first row and consecutive rows are `stride`
+// doubles apart. Each column is gathered and converted in one call so the
+// kernel writes a contiguous stretch of output.
+void convert_rows(const double* raw, std::size_t rows, std::size_t stride, ValueFormat format,
+                  Eigen::ArrayXXcd& sparams, Eigen::Index first_row, std::vector<double>& scratch) {
+    scratch.resize(2 * rows);
+    for (Eigen::Index col = 0; col < sparams.cols(); ++col) {
+        const double* src = raw + 2 * static_cast<std::size_t>(col);
+        for (std::size_t r = 0; r < rows; ++r) {
+            scratch[2 * r] = src[r * stride];
+            scratch[2 * r + 1] = src[r * stride + 1];
+        }
+        pairs_to_complex(scratch.data(), rows, format, &sparams(first_row, col));
+    }
+}
+
+// Trimmed content of one physical line with any '!' comment removed; `next`
+// points at the start of the following line.
+struct LineSpan {
+    const char* begin;
+    const char* end;
+    const char* next;
+};
+
+inline LineSpan scan_line(const char* line, const char* end) {
+    const char* newline = static_cast<const char*>(std::memchr(line, '\n', static_cast<std::size_t>(end - line)));
+    const char* line_end = newline ? newline : end;
+    const char* excl = static_cast<const char*>(std::memchr(line, '!', static_cast<std::size_t>(line_end - line)));
+    LineSpan span{line, excl ? excl : line_end, newline ? newline + 1 : end};
+    while (span.begin < span.end && is_blank(*span.begin)) {
+        ++span.begin;
+    }
+    while (span.end > span.begin && is_blank(span.end[-1])) {
+        --span.end;
+    }
+    return span;
+}
+
+inline void skip_continuation_marker(LineSpan& span) {
+    if (*span.begin == '+' && span.end - span.begin > 1 && is_blank(span.begin[1])) {
+        ++span.begin;
+        while (span.begin < span.end && is_blank(*span.begin)) {
+            ++span.begin;
+        }
+    }
+}
+
+// Calls fn(value) for every number on a data line. Throws the same messages as
+// tokenize_numbers for malformed or out-of-range tokens.
+template <typename Fn>
+void for_each_number(const LineSpan& span, Fn&& fn) {
+    const char* cursor = span.begin;
+    while (cursor < span.end) {
+        while (cursor < span.end && is_blank(*cursor)) {
+            ++cursor;
+        }
+        if (cursor == span.end) {
+            break;
+        }
+        double value = 0.0;
+        const std::from_chars_result parsed = parse_number(cursor, span.end, value);
+        if (parsed.ec == std::errc::invalid_argument) {
+            throw std::runtime_error("Invalid numeric token in Touchstone data row: '" + std::string(span.begin, span.end) + "'");
+        }
+        if (parsed.ec == std::errc::result_out_of_range) {
+            throw std::runtime_error("Numeric value out of range in Touchstone data row: '" + std::string(span.begin, span.end) + "'");
+        }
+        cursor = parsed.ptr;
+        fn(value);
+    }
+}
+
+std::runtime_error too_many_values(std::size_t line_number, const std::string& source_name) {
+    return std::runtime_error("Row starting near line " + std::to_string(line_number) + " in " + source_name +
+                              " has too many values");
+}
+
+std::runtime_error incomplete_row(std::size_t line_number, const std::string& source_name) {
+    return std::runtime_error("Row starting near line " + std::to_string(line_number) + " in " + source_name +
+                              " is incomplete");
+}
+
+void apply_options(TouchstoneData& out, const OptionsLine& opts) {
+    out.parameter = opts.parameter;
+    out.format = opts.format;
+    out.freq_unit = opts.freq_unit;
+    out.R = opts.R;
+}
+
+TouchstoneData parse_buffer_serial(const char* data, std::size_t size, const std::string& source_name, int ports) {
+    OptionsLine opts;
+    double freq_scale = unit_scale_to_hz(opts.freq_unit);
+
+    const std::size_t values_per_row = static_cast<std::size_t>(ports) * static_cast<std::size_t>(ports);
+    const std::size_t expected_cols = 1 + 2ull * values_per_row;
+    const Eigen::Index col_count = static_cast<Eigen::Index>(values_per_row);
+
+    TouchstoneData out;
+    Eigen::Index row_count = 0;
+    Eigen::Index capacity = 0;
+
+    std::vector<double> row(expected_cols);
+    std::size_t row_fill = 0;
+
+    // Value pairs of rows read but not yet converted. They are flushed in blocks,
+    // and before every options line so rows keep the format they were read under.
+    constexpr std::size_t kBlockRows = 256;
+    const std::size_t pairs_stride = 2 * values_per_row;
+    ValueFormat format = value_format(opts.format);
+    std::vector<double> pending;
+    pending.reserve(kBlockRows * pairs_stride);
+    std::vector<double> scratch;
+    Eigen::Index pending_first_row = 0;
+    const auto flush_pending = [&]() {
+        const std::size_t rows = pending.size() / pairs_stride;
+        if (rows != 0) {
+            convert_rows(pending.data(), rows, pairs_stride, format, out.sparams, pending_first_row, scratch);
+        }
+        pending.clear();
+        pending_first_row = row_count;
+    };
+    std::size_t row_start_line = 0;
+    const char* first_row_start = nullptr;
+
+    const char* const end = data + size;
+    const char* line = data;
+    std::size_t line_number = 0;
+
+    while (line < end) {
+        LineSpan span = scan_line(line, end);
+        ++line_number;
+        if (span.begin == span.end) {
+            line = span.next;
+            continue;
+        }
+
+        if (*span.begin == '#') {
+            if (row_fill != 0) {
+                throw std::runtime_error("Dangling data before options line near line " + std::to_string(row_start_line) + " in " + source_name);
+            }
+            flush_pending();
+            opts = parse_options_line(std::string(span.begin, span.end));
+            freq_scale = unit_scale_to_hz(opts.freq_unit);
+            format = value_format(opts.format);
+            line = span.next;
+            continue;
+        }
+
+        skip_continuation_marker(span);
+
+        // A row may span several lines, but a new row may only begin at the first
+        // number of a line. Overflow is reported after the whole line has been
+        // tokenized so invalid tokens take precedence, as in the stream parser.
+        bool overflow = false;
+        bool first_on_line = true;
+        for_each_number(span, [&](double value) {
+            if (overflow) {
+                return;
+            }
+            if (row_fill == 0) {
+                if (!first_on_line) {
+                    overflow = true;
+                    return;
+                }
+                row_start_line = line_number;
+                if (!first_row_start) {
+                    first_row_start = line;
+                }
+            }
+            first_on_line = false;
+
+            row[row_fill++] = value;
+            if (row_fill < expected_cols) {
+                return;
+            }
+
+            if (row_count == capacity) {
+                // Size the output from the byte length of the rows seen so far; for
+                // fixed-width VNA exports this hits the exact row count.
+                const std::size_t consumed = static_cast<std::size_t>(span.next - first_row_start);
+                const std::size_t remaining = static_cast<std::size_t>(end - span.next);
+                const std::size_t bytes_per_row = std::max<std::size_t>(1, consumed / static_cast<std::size_t>(row_count + 1));
+                const Eigen::Index estimate = row_count + 1 + static_cast<Eigen::Index>((remaining + bytes_per_row - 1) / bytes_per_row);
+                capacity = std::max(estimate, row_count + 1 + row_count / 2);
+                out.freq.conservativeResize(capacity);
+                out.sparams.conservativeResize(capacity, col_count);
+            }
+
+            out.freq[row_count] = row[0] * freq_scale;
+            pending.insert(pending.end(), row.begin() + 1, row.end());
+            ++row_count;
+            row_fill = 0;
+            if (pending.size() == kBlockRows * pairs_stride) {
+                flush_pending();
+            }
+        });
+
+        if (overflow) {
+            throw too_many_values(line_number, source_name);
+        }
+
+        line = span.next;
+    }
+
+    if (row_fill != 0) {
+        throw incomplete_row(row_start_line, source_name);
+    }
+
+    if (row_count == 0) {
+        throw std::runtime_error("No numeric data rows found in: " + source_name);
+    }
+
+    flush_pending();
+    if (row_count != capacity) {
+        out.freq.conservativeResize(row_count);
+        out.sparams.conservativeResize(row_count, col_count);
+    }
+
+    out.ports = ports;
+    apply_options(out, opts);
+    return out;
+}
+
+// Numbers tokenized from one line-aligned slice of the data section. Line
+// indices are relative to the chunk; absolute numbers are assigned afterwards.
+struct ChunkResult {
+    struct DataLine {
+        std::uint32_t line;
+        std::uint32_t numbers;
+    };
+
+    std::vector<double> values;
+    std::vector<DataLine> data_lines;
+    std::size_t line_count = 0;
+    bool has_options_line = false;
+    bool failed = false;
+    std::string error;
+};
+
+void tokenize_chunk(const char* begin, const char* end, ChunkResult& chunk) {
+    chunk.values.reserve(static_cast<std::size_t>(end - begin) / 12);
+    const char* line = begin;
+    while (line < end) {
+        LineSpan span = scan_line(line, end);
+        const std::size_t relative_line = chunk.line_count++;
+        line = span.next;
+        if (span.begin == span.end) {
+            continue;
+        }
+        if (*span.begin == '#') {
+            chunk.has_options_line = true;
+            return;
+        }
+        skip_continuation_marker(span);
+
+        const std::size_t first_value = chunk.values.size();
+        try {
+            for_each_number(span, [&](double value) { chunk.values.push_back(value); });
+        } catch (const std::runtime_error& e) {
+            chunk.values.resize(first_value);
+            chunk.failed = true;
+            chunk.error = e.what();
+            return;
+        }
+        const std::size_t numbers = chunk.values.size() - first_value;
+        if (numbers > 0) {
+            chunk.data_lines.push_back({static_cast<std::uint32_t>(relative_line), static_cast<std::uint32_t>(numbers)});
+        }
+    }
+}
+
+// Splits the data section at line boundaries, tokenizes the chunks on the pool,
+// validates the row layout serially from per-line number counts and finally
+// converts the rows in parallel. Returns nullopt when the file needs the serial
+// parser (an options line after the first data row).
+std::optional<TouchstoneData> parse_buffer_parallel(const char* data, std::size_t size, const std::string& source_name,
+                                                    int ports, unsigned threads) {
+    const char* const end = data + size;
+
+    OptionsLine opts;
+    const char* data_begin = data;
+    std::size_t lines_before_data = 0;
+    while (data_begin < end) {
+        const LineSpan span = scan_line(data_begin, end);
+        if (span.begin != span.end && *span.begin != '#') {
+            break;
+        }
+        if (span.begin != span.end) {
+            opts = parse_options_line(std::string(span.begin, span.end));
+        }
+        ++lines_before_data;
+        data_begin = span.next;
+    }
+    if (data_begin == end) {
+        return std::nullopt;
+    }
+
+    const std::size_t chunk_target = static_cast<std::size_t>(threads) * 4;
+    const std::size_t chunk_bytes = std::max<std::size_t>(1, static_cast<std::size_t>(end - data_begin) / chunk_target);
+    std::vector<const char*> bounds{data_begin};
+    while (bounds.back() < end) {
+        const char* split = bounds.back() + std::min<std::size_t>(chunk_bytes, static_cast<std::size_t>(end - bounds.back()));
+        if (split < end) {
+            const char* newline = static_cast<const char*>(std::memchr(split, '\n', static_cast<std::size_t>(end - split)));
+            split = newline ? newline + 1 : end;
+        }
+        bounds.push_back(split);
+    }
+
+    std::vector<ChunkResult> chunks(bounds.size() - 1);
+    ThreadPool::global().parallelFor(chunks.size(), [&](std::size_t i) {
+        tokenize_chunk(bounds[i], bounds[i + 1], chunks[i]);
+    }, threads);
+
+    for (const ChunkResult& chunk : chunks) {
+        if (chunk.has_options_line) {
+            return std::nullopt;
+        }
+    }
+
+    const std::size_t values_per_row = static_cast<std::size_t>(ports) * static_cast<std::size_t>(ports);
+    const std::size_t expected_cols = 1 + 2ull * values_per_row;
+
+    std::size_t base_line = lines_before_data + 1;
+    std::size_t row_fill = 0;
+    std::size_t row_start_line = 0;
+    std::size_t total_values = 0;
+    std::vector<std::size_t> value_offsets;
+    value_offsets.reserve(chunks.size());
+    for (const ChunkResult& chunk : chunks) {
+        for (const ChunkResult::DataLine& data_line : chunk.data_lines) {
+            const std::size_t line_number = base_line + data_line.line;
+            if (row_fill == 0) {
+                row_start_line = line_number;
+            }
+            if (row_fill + data_line.numbers > expected_cols) {
+                throw too_many_values(line_number, source_name);
+            }
+            row_fill = (row_fill + data_line.numbers) % expected_cols;
+        }
+        if (chunk.failed) {
+            throw std::runtime_error(chunk.error);
+        }
+        value_offsets.push_back(total_values);
+        total_values += chunk.values.size();
+        base_line += chunk.line_count;
+    }
+
+    if (row_fill != 0) {
+        throw incomplete_row(row_start_line, source_name);
+    }
+
+    const std::size_t row_count = total_values / expected_cols;
+    if (row_count == 0) {
+        throw std::runtime_error("No numeric data rows found in: " + source_name);
+    }
+
+    TouchstoneData out;
+    out.ports = ports;
+    apply_options(out, opts);
+    out.freq.resize(static_cast<Eigen::Index>(row_count));
+    out.sparams.resize(static_cast<Eigen::Index>(row_count), static_cast<Eigen::Index>(values_per_row));
+
+    const double freq_scale = unit_scale_to_hz(opts.freq_unit);
+    const ValueFormat format = value_format(opts.format);
+    constexpr std::size_t kRowsPerBlock = 1024;
+    const std::size_t block_count = (row_count + kRowsPerBlock - 1) / kRowsPerBlock;
+    ThreadPool::global().parallelFor(block_count, [&](std::size_t block) {
+        const std::size_t first_row = block * kRowsPerBlock;
+        const std::size_t last_row = std::min(row_count, first_row + kRowsPerBlock);
+
+        const std::size_t first_value = first_row * expected_cols;
+        std::size_t chunk_index = static_cast<std::size_t>(
+            std::upper_bound(value_offsets.begin(), value_offsets.end(), first_value) - value_offsets.begin()) - 1;
+        std::size_t offset = first_value - value_offsets[chunk_index];
+        const auto next_value = [&]() {
+            while (offset >= chunks[chunk_index].values.size()) {
+                ++chunk_index;
+                offset = 0;
+            }
+            return chunks[chunk_index].values[offset++];
+        };
+
+        std::vector<double> rows((last_row - first_row) * expected_cols);
+        for (double& value : rows) {
+            value = next_value();
+        }
+        for (std::size_t r = first_row; r < last_row; ++r) {
+            out.freq[static_cast<Eigen::Index>(r)] = rows[(r - first_row) * expected_cols] * freq_scale;
+        }
+        std::vector<double> scratch;
+        convert_rows(rows.data() + 1, last_row - first_row, expected_cols, format, out.sparams,
+                     static_cast<Eigen::Index>(first_row), scratch);
+    }, threads);
+
+    return out;
+}
+
+// Fills a probe from the options line, the first data row and the last data
+// row, walking backwards from the end of the buffer for the latter. Returns
+// std::nullopt when either row cannot be delimited; callers then parse in full.
+std::optional<TouchstoneProbe> probe_buffer(const char* data, std::size_t size, int ports) {
+    const std::size_t expected_cols = 1 + 2ull * static_cast<std::size_t>(ports) * static_cast<std::size_t>(ports);
+    const char* const end = data + size;
+
+    OptionsLine opts;
+    const char* first_row_start = nullptr;
+    const char* first_row_end = nullptr;
+    double first_freq = 0.0;
+    std::size_t count = 0;
+    try {
+        for (const char* line = data; line < end && !first_row_end;) {
+            LineSpan span = scan_line(line, end);
+            if (span.begin != span.end) {
+                if (*span.begin == '#') {
+                    if (count != 0) {
+                        return std::nullopt;
+                    }
+                    opts = parse_options_line(std::string(span.begin, span.end));
+                } else {
+                    skip_continuation_marker(span);
+                    for_each_number(span, [&](double value) {
+                        if (count++ == 0) {
+                            first_freq = value;
+                            first_row_start = line;
+                        }
+                    });
+                    if (count > expected_cols) {
+                        return std::nullopt;
+                    }
+                    if (count == expected_cols) {
+                        first_row_end = span.next;
+                    }
+                }
+            }
+            line = span.next;
+        }
+        if (!first_row_end) {
+            return std::nullopt;
+        }
+
+        // The last row is made of the trailing data lines whose value counts add
+        // up to exactly one row.
+        const char* last_row_start = nullptr;
+        double last_freq = 0.0;
+        std::size_t tail_count = 0;
+        for (const char* cursor = end; cursor > first_row_start && !last_row_start;) {
+            const char* line = cursor;
+            if (line[-1] == '\n') {
+                --line;
+            }
+            while (line > data && line[-1] != '\n') {
+                --line;
+            }
+            cursor = line;
+
+            LineSpan span = scan_line(line, end);
+            if (span.begin == span.end) {
+                continue;
+            }
+            if (*span.begin == '#') {
+                return std::nullopt;
+            }
+            skip_continuation_marker(span);
+            double line_first = 0.0;
+            std::size_t line_count = 0;
+            for_each_number(span, [&](double value) {
+                if (line_count++ == 0) {
+                    line_first = value;
+                }
+            });
+            tail_count += line_count;
+            if (tail_count > expected_cols) {
+                return std::nullopt;
+            }
+            if (tail_count == expected_cols) {
+                last_row_start = line;
+                last_freq = line_first;
+            }
+        }
+        if (!last_row_start) {
+            return std::nullopt;
+        }
+
+        const double freq_scale = unit_scale_to_hz(opts.freq_unit);
+        const std::size_t row_bytes = static_cast<std::size_t>(first_row_end - first_row_start);
+        const std::size_t span_bytes = static_cast<std::size_t>(last_row_start - first_row_start);
+
+        TouchstoneProbe probe;
+        probe.ports = ports;
+        probe.parameter = opts.parameter;
+        probe.format = opts.format;
+        probe.freq_unit = opts.freq_unit;
+        probe.R = opts.R;
+        probe.fmin = std::min(first_freq, last_freq) * freq_scale;
+        probe.fmax = std::max(first_freq, last_freq) * freq_scale;
+        probe.estimated_points = 1 + (span_bytes + row_bytes / 2) / row_bytes;
+        return probe;
+    } catch (const std::exception&) {
+        return std::nullopt;
+    }
+}
+
 } // namespace detail
 
 TouchstoneData parse_touchstone_stream(std::istream& in, const std::string& source_name, std::optional<int> ports_hint) {
@@ -229,6 +889,15 @@ TouchstoneData parse_touchstone_stream(std::istream& in, const std::string& sour
 
     std::vector<double> frequencies_hz;
     std::vector<std::complex<double>> sparams_values;
+    // Value pairs are kept raw and converted in bulk whenever the format may
+    // change (at an options line) and at the end of input.
+    std::vector<double> raw_pairs;
+    const auto convert_raw_pairs = [&]() {
+        const std::size_t converted = sparams_values.size();
+        const std::size_t count = raw_pairs.size() / 2 - converted;
+        sparams_values.resize(converted + count);
+        pairs_to_complex(raw_pairs.data() + 2 * converted, count, value_format(opts.format), sparams_values.data() + converted);
+    };
 
     std::deque<double> pending_numbers;
     std::size_t pending_line_number = 0;
@@ -319,11 +988,7 @@ TouchstoneData parse_touchstone_stream(std::istream& in, const std::string& sour
 
             if (expected_cols > 0 && current_row_numbers.size() == expected_cols) {
                 frequencies_hz.push_back(current_row_numbers[0] * freq_scale);
-                for (std::size_t idx = 0; idx < values_per_row; ++idx) {
-                    const double a = current_row_numbers[1 + idx * 2];
-                    const double b = current_row_numbers[1 + idx * 2 + 1];
-                    sparams_values.push_back(pair_to_complex(a, b, opts.format));
-                }
+                raw_pairs.insert(raw_pairs.end(), current_row_numbers.begin() + 1, current_row_numbers.end());
                 current_row_numbers.clear();
                 current_row_start_line = 0;
                 pending_line_number = pending_numbers.empty() ? 0 : line_number;
@@ -371,6 +1036,7 @@ TouchstoneData parse_touchstone_stream(std::istream& in, const std::string& sour
                                              (current_row_start_line != 0 ? current_row_start_line : physical_line_number);
                 throw std::runtime_error("Dangling data before options line near line " + std::to_string(line_ref) + " in " + source_name);
             }
+            convert_raw_pairs();
             opts = parse_options_line(trimmed);
             freq_scale = unit_scale_to_hz(opts.freq_unit);
             continue;
@@ -398,6 +1064,7 @@ TouchstoneData parse_touchstone_stream(std::istream& in, const std::string& sour
     }
 
     flush_pending_numbers(physical_line_number, true);
+    convert_raw_pairs();
 
     if (frequencies_hz.empty()) {
         throw std::runtime_error("No numeric data rows found in: " + source_name);
@@ -436,19 +1103,91 @@ TouchstoneData parse_touchstone_stream(std::istream& in, const std::string& sour
     return out;
 }
 
-TouchstoneData parse_touchstone(const std::string& path) {
+TouchstoneData parse_touchstone_buffer(const char* data, std::size_t size, const std::string& source_name,
+                                       std::optional<int> ports_hint, const ParseOptions& options) {
+    using namespace detail;
+
+    if (!ports_hint || *ports_hint <= 0) {
+        MemoryStreamBuf buffer(data, size);
+        std::istream in(&buffer);
+        return parse_touchstone_stream(in, source_name, ports_hint);
+    }
+
+    const unsigned threads = options.threads == 0 ? ThreadPool::global().threadCount() : options.threads;
+    if (threads > 1 && size >= options.parallel_min_bytes) {
+        if (std::optional<TouchstoneData> parsed = parse_buffer_parallel(data, size, source_name, *ports_hint, threads)) {
+            return std::move(*parsed);
+        }
+    }
+    return parse_buffer_serial(data, size, source_name, *ports_hint);
+}
+
+TouchstoneData parse_touchstone(const std::string& path, const ParseOptions& options) {
+    const std::optional<int> hint = detail::infer_ports_from_extension(path);
+
+    MappedFile mapped;
+    if (mapped.open(path)) {
+        if (!options.use_cache) {
+            return parse_touchstone_buffer(mapped.data(), mapped.size(), path, hint, options);
+        }
+        // The key is hashed from the same mapping that gets parsed, so an entry
+        // can never pair one version of the file with data from another.
+        const std::optional<CacheKey> key = make_cache_key(path, mapped.data(), mapped.size());
+        if (!key) {
+            return parse_touchstone_buffer(mapped.data(), mapped.size(), path, hint, options);
+        }
+        const std::string entry = cache_path_for(path, options.cache_dir);
+        if (std::optional<TouchstoneData> cached = read_cache(entry, *key)) {
+            return std::move(*cached);
+        }
+        TouchstoneData data = parse_touchstone_buffer(mapped.data(), mapped.size(), path, hint, options);
+        write_cache(entry, *key, data);
+        return data;
+    }
+
     std::ifstream fin(path);
     if (!fin) {
         throw std::runtime_error("Failed to open Touchstone file: " + path);
     }
-    const std::optional<int> hint = detail::infer_ports_from_extension(path);
     return parse_touchstone_stream(fin, path, hint);
 }
 
+TouchstoneProbe probe_touchstone(const std::string& path) {
+    const std::optional<int> hint = detail::infer_ports_from_extension(path);
+    if (hint && *hint > 0) {
+        MappedFile mapped;
+        if (mapped.open(path)) {
+            if (std::optional<TouchstoneProbe> probe = detail::probe_buffer(mapped.data(), mapped.size(), *hint)) {
+                return std::move(*probe);
+            }
+        }
+    }
+
+    const TouchstoneData data = parse_touchstone(path);
+    TouchstoneProbe probe;
+    probe.ports = data.ports;
+    probe.parameter = data.parameter;
+    probe.format = data.format;
+    probe.freq_unit = data.freq_unit;
+    probe.R = data.R;
+    probe.fmin = data.freq.minCoeff();
+    probe.fmax = data.freq.maxCoeff();
+    probe.estimated_points = static_cast<std::size_t>(data.freq.size());
+    return probe;
+}
+
 std::complex<double> get_sparam(const TouchstoneData& data, Eigen::Index k, int i, int j) {
     return data.sparams(k, j * data.ports + i);
 }
 
+void pairs_to_complex(const double* pairs, std::size_t count, const std::string& format, std::complex<double>* out) {
+    detail::pairs_to_complex(pairs, count, detail::value_format(detail::to_upper(format)), out);
+}
+
+void complex_to_pairs(const std::complex<double>* values, std::size_t count, const std::string& format, double* out) {
+    detail::complex_to_pairs(values, count, detail::value_format(detail::to_upper(format)), out);
+}
+
 void write_touchstone_stream(const TouchstoneData& data, std::ostream& out) {
     using namespace detail;
 
@@ -478,14 +1217,28 @@ void write_touchstone_stream(const TouchstoneData& data, std::ostream& out) {
     out.setf(std::ios::uppercase);
     out << std::setprecision(15);
 
+    // Rows are converted a block at a time, one contiguous column segment per
+    // kernel call, then printed row by row.
+    constexpr Eigen::Index kBlockRows = 256;
     const Eigen::Index rows = data.sparams.rows();
-    for (Eigen::Index row = 0; row < rows; ++row) {
-        out << data.freq[row] * freq_scale;
+    const ValueFormat format = rows > 0 ? value_format(format_upper) : ValueFormat::RI;
+    std::vector<double> pairs;
+    for (Eigen::Index first_row = 0; first_row < rows; first_row += kBlockRows) {
+        const Eigen::Index block_rows = std::min(kBlockRows, rows - first_row);
+        const std::size_t column_stride = 2 * static_cast<std::size_t>(block_rows);
+        pairs.resize(column_stride * static_cast<std::size_t>(expected_cols));
         for (Eigen::Index col = 0; col < expected_cols; ++col) {
-            const auto pair = complex_to_pair(data.sparams(row, col), format_upper);
-            out << ' ' << pair.first << ' ' << pair.second;
+            complex_to_pairs(&data.sparams(first_row, col), static_cast<std::size_t>(block_rows), format,
+                             pairs.data() + static_cast<std::size_t>(col) * column_stride);
+        }
+        for (Eigen::Index r = 0; r < block_rows; ++r) {
+            out << data.freq[first_row + r] * freq_scale;
+            for (Eigen::Index col = 0; col < expected_cols; ++col) {
+                const double* pair = pairs.data() + static_cast<std::size_t>(col) * column_stride + 2 * static_cast<std::size_t>(r);
+                out << ' ' << pair[0] << ' ' << pair[1];
+            }
+            out << '\n';
         }
-        out << '\n';
     }
 
     out.precision(original_precision);
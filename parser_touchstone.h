@@ -2,6 +2,7 @@
 
 #include <Eigen/Dense>
 #include <complex>
+#include <cstddef>
 #include <istream>
 #include <optional>
 #include <ostream>
@@ -22,10 +23,56 @@ struct TouchstoneData {
 
 TouchstoneData parse_touchstone_stream(std::istream& in, const std::string& source_name = "<istream>", std::optional<int> ports_hint = std::nullopt);
 
-TouchstoneData parse_touchstone(const std::string& path);
+struct ParseOptions {
+    // Threads used to parse a single file: 0 uses every pool thread, 1 parses serially.
+    unsigned threads = 0;
+    // Inputs smaller than this are parsed serially; splitting them costs more than it saves.
+    std::size_t parallel_min_bytes = std::size_t(4) << 20;
+    // Load parse_touchstone results from a binary cache entry and rebuild stale ones.
+    bool use_cache = false;
+    // Directory for cache entries; empty keeps them next to the source file.
+    std::string cache_dir;
+};
+
+// Parses an in-memory Touchstone image without copying it. Requires a port count
+// (from the hint); without one it defers to parse_touchstone_stream for inference.
+// Large inputs are split at line boundaries and tokenized on the thread pool.
+TouchstoneData parse_touchstone_buffer(const char* data, std::size_t size, const std::string& source_name = "<buffer>",
+                                       std::optional<int> ports_hint = std::nullopt, const ParseOptions& options = ParseOptions());
+
+// Memory-maps the file and parses it with parse_touchstone_buffer, falling back
+// to the stream parser when the file cannot be mapped. With use_cache set, a
+// valid cache entry (touchstone_cache.h) is returned instead of parsing.
+TouchstoneData parse_touchstone(const std::string& path, const ParseOptions& options = ParseOptions());
+
+// Summary of a Touchstone file; frequencies are in Hz.
+struct TouchstoneProbe {
+    int ports = 0;
+    std::string parameter;
+    std::string format;
+    std::string freq_unit;
+    double R = 50.0;
+    double fmin = 0.0;
+    double fmax = 0.0;
+    // Exact for fixed-width rows, otherwise extrapolated from the first row's length.
+    std::size_t estimated_points = 0;
+};
+
+// Reads only the options line, the first data row and the last data row, so
+// the cost does not depend on the file size. Options lines after the first row
+// are not seen. Files that cannot be probed this way (no .sNp extension, a
+// malformed first or last row) are parsed in full, so parse errors surface here
+// as exceptions just as from parse_touchstone.
+TouchstoneProbe probe_touchstone(const std::string& path);
 
 std::complex<double> get_sparam(const TouchstoneData& data, Eigen::Index k, int i, int j);
 
+// Batch conversions between `count` interleaved (a, b) value pairs in a
+// Touchstone format ("RI", "MA" or "DB", angles in degrees) and complex values,
+// as the parsers and the writer apply them. Throws on an unknown format.
+void pairs_to_complex(const double* pairs, std::size_t count, const std::string& format, std::complex<double>* out);
+void complex_to_pairs(const std::complex<double>* values, std::size_t count, const std::string& format, double* out);
+
 void write_touchstone_stream(const TouchstoneData& data, std::ostream& out);
 
 void write_touchstone(const TouchstoneData& data, const std::string& path);
@@ -0,0 +1,183 @@
+#include "plotdatacache.h"
+
+#include <complex>
+#include <cstring>
+
+namespace {
+
+std::uint64_t mix(std::uint64_t hash, std::uint64_t value)
+{
+    hash ^= value + 0x9e3779b97f4a7c15ull + (hash << 6) + (hash >> 2);
+    return hash;
+}
+
+std::uint64_t bitsOf(double value)
+{
+    std::uint64_t bits;
+    std::memcpy(&bits, &value, sizeof(bits));
+    return bits;
+}
+
+std::size_t plotDataBytes(const PlotDataCache::PlotData& data)
+{
+    return static_cast<std::size_t>(data.first.size() + data.second.size()) * sizeof(double);
+}
+
+} // namespace
+
+bool PlotDataCache::Key::operator==(const Key& other) const
+{
+    return network == other.network && version == other.version && sparam == other.sparam && view == other.view &&
+           unwrap == other.unwrap && parameters == other.parameters && reference == other.reference && gate.enabled == other.gate.enabled &&
+           gate.startDistance == other.gate.startDistance && gate.stopDistance == other.gate.stopDistance &&
+           gate.epsilonR == other.gate.epsilonR && grid == other.grid;
+}
+
+std::size_t PlotDataCache::KeyHash::operator()(const Key& key) const
+{
+    std::uint64_t hash = key.network;
+    hash = mix(hash, key.version);
+    hash = mix(hash, static_cast<std::uint64_t>(key.sparam) << 8 | static_cast<std::uint64_t>(key.view + 1) << 2 |
+                         static_cast<std::uint64_t>(key.unwrap) << 1);
+    hash = mix(hash, static_cast<std::uint64_t>(key.parameters) ^ bitsOf(key.reference));
+    hash = mix(hash, key.gate.enabled ? bitsOf(key.gate.startDistance) ^ bitsOf(key.gate.stopDistance) ^ bitsOf(key.gate.epsilonR) : 0);
+    hash = mix(hash, key.grid);
+    return static_cast<std::size_t>(hash);
+}
+
+PlotDataCache& PlotDataCache::instance()
+{
+    static PlotDataCache cache;
+    return cache;
+}
+
+std::uint64_t PlotDataCache::gridHash(const Eigen::ArrayXd& freq)
+{
+    std::uint64_t hash = static_cast<std::uint64_t>(freq.size());
+    for (Eigen::Index i = 0; i < freq.size(); ++i)
+        hash = mix(hash, bitsOf(freq(i)));
+    return hash;
+}
+
+PlotDataCache::EntryList::iterator PlotDataCache::lookup(const Key& key)
+{
+    const auto it = m_index.find(key);
+    if (it == m_index.end()) {
+        ++m_misses;
+        return m_entries.end();
+    }
+    ++m_hits;
+    m_entries.splice(m_entries.begin(), m_entries, it->second);
+    return it->second;
+}
+
+std::optional<PlotDataCache::PlotData> PlotDataCache::findView(const Key& key)
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    const auto it = lookup(key);
+    if (it == m_entries.end())
+        return std::nullopt;
+    return it->view;
+}
+
+std::optional<PlotDataCache::Column> PlotDataCache::findColumn(const Key& key)
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    const auto it = lookup(key);
+    if (it == m_entries.end())
+        return std::nullopt;
+    return it->column;
+}
+
+void PlotDataCache::insertView(const Key& key, const PlotData& data)
+{
+    Entry entry;
+    entry.key = key;
+    entry.view = data;
+    entry.bytes = plotDataBytes(data);
+    std::lock_guard<std::mutex> lock(m_mutex);
+    insert(std::move(entry));
+}
+
+void PlotDataCache::insertColumn(const Key& key, const Column& column)
+{
+    Entry entry;
+    entry.key = key;
+    entry.column = column;
+    entry.bytes = static_cast<std::size_t>(column.values.size()) * sizeof(std::complex<double>) + plotDataBytes(column.gatedTdr);
+    std::lock_guard<std::mutex> lock(m_mutex);
+    insert(std::move(entry));
+}
+
+void PlotDataCache::insert(Entry&& entry)
+{
+    const auto existing = m_index.find(entry.key);
+    if (existing != m_index.end()) {
+        m_bytes -= existing->second->bytes;
+        m_entries.erase(existing->second);
+        m_index.erase(existing);
+    }
+    // Larger than the whole budget: computing it again is cheaper than keeping it.
+    if (entry.bytes > m_budget)
+        return;
+    m_bytes += entry.bytes;
+    m_entries.push_front(std::move(entry));
+    m_index.emplace(m_entries.front().key, m_entries.begin());
+    evictToBudget();
+}
+
+void PlotDataCache::evictToBudget()
+{
+    while (m_bytes > m_budget && !m_entries.empty()) {
+        const Entry& last = m_entries.back();
+        m_bytes -= last.bytes;
+        m_index.erase(last.key);
+        m_entries.pop_back();
+        ++m_evictions;
+    }
+}
+
+void PlotDataCache::removeNetwork(quint64 network)
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    for (auto it = m_entries.begin(); it != m_entries.end();) {
+        if (it->key.network == network) {
+            m_bytes -= it->bytes;
+            m_index.erase(it->key);
+            it = m_entries.erase(it);
+        } else {
+            ++it;
+        }
+    }
+}
+
+void PlotDataCache::clear()
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_entries.clear();
+    m_index.clear();
+    m_bytes = 0;
+    m_hits = 0;
+    m_misses = 0;
+    m_evictions = 0;
+}
+
+void PlotDataCache::setBudget(std::size_t bytes)
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_budget = bytes;
+    evictToBudget();
+}
+
+PlotDataCache::Stats PlotDataCache::stats() const
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    Stats stats;
+    stats.hits = m_hits;
+    stats.misses = m_misses;
+    stats.evictions = m_evictions;
+    stats.entries = m_entries.size();
+    stats.bytes = m_bytes;
+    stats.budget = m_budget;
+    return stats;
+}
@@ -0,0 +1,109 @@
+#ifndef PLOTDATACACHE_H
+#define PLOTDATACACHE_H
+
+#include "network.h"
+
+#include <QPair>
+#include <QVector>
+#include <Eigen/Dense>
+#include <cstddef>
+#include <cstdint>
+#include <list>
+#include <mutex>
+#include <optional>
+#include <unordered_map>
+
+// Process-wide LRU of plot data derived from a network's S-parameters. Each
+// network stores the complex column it plots (converted and gated) and the
+// views derived from it. Entries are keyed by the network's id and data version,
+// so editing a network makes its old entries unreachable until they age out.
+class PlotDataCache
+{
+public:
+    using PlotData = QPair<QVector<double>, QVector<double>>;
+
+    struct Key
+    {
+        quint64 network = 0;
+        quint64 version = 0;
+        int sparam = 0;
+        // A PlotType, or kColumn for the column the views are derived from.
+        int view = 0;
+        bool unwrap = false;
+        // The column's parameter set (a NetworkParameters::Kind) and, for S,
+        // the impedance it was renormalized to (0 when it was not).
+        int parameters = 0;
+        double reference = 0.0;
+        Network::TimeGateSettings gate;
+        std::uint64_t grid = 0;
+
+        bool operator==(const Key& other) const;
+    };
+
+    static constexpr int kColumn = -1;
+
+    struct Column
+    {
+        Eigen::ArrayXcd values;
+        // Distance/impedance from the time gate, when one was applied.
+        PlotData gatedTdr;
+    };
+
+    struct Stats
+    {
+        std::size_t hits = 0;
+        std::size_t misses = 0;
+        std::size_t evictions = 0;
+        std::size_t entries = 0;
+        std::size_t bytes = 0;
+        std::size_t budget = 0;
+
+        double hitRate() const { return hits + misses == 0 ? 0.0 : static_cast<double>(hits) / static_cast<double>(hits + misses); }
+    };
+
+    static PlotDataCache& instance();
+    static std::uint64_t gridHash(const Eigen::ArrayXd& freq);
+
+    std::optional<PlotData> findView(const Key& key);
+    std::optional<Column> findColumn(const Key& key);
+    void insertView(const Key& key, const PlotData& data);
+    void insertColumn(const Key& key, const Column& column);
+
+    // Drops every entry of a network, e.g. when it is destroyed.
+    void removeNetwork(quint64 network);
+    void clear();
+
+    void setBudget(std::size_t bytes);
+    Stats stats() const;
+
+private:
+    struct KeyHash
+    {
+        std::size_t operator()(const Key& key) const;
+    };
+
+    struct Entry
+    {
+        Key key;
+        PlotData view;
+        Column column;
+        std::size_t bytes = 0;
+    };
+
+    using EntryList = std::list<Entry>;
+
+    EntryList::iterator lookup(const Key& key);
+    void insert(Entry&& entry);
+    void evictToBudget();
+
+    mutable std::mutex m_mutex;
+    EntryList m_entries; // most recently used first
+    std::unordered_map<Key, EntryList::iterator, KeyHash> m_index;
+    std::size_t m_bytes = 0;
+    std::size_t m_budget = 64 * 1024 * 1024;
+    std::size_t m_hits = 0;
+    std::size_t m_misses = 0;
+    std::size_t m_evictions = 0;
+};
+
+#endif // PLOTDATACACHE_H
@@ -0,0 +1,154 @@
+#include "plotkernels.h"
+
+#include <cmath>
+#include <complex>
+#include <limits>
+
+namespace PlotKernels {
+
+namespace {
+
+constexpr double kPi = 3.14159265358979323846;
+constexpr double kTwoPi = 2.0 * kPi;
+constexpr double kWrapTolerance = 1e-12;
+
+double delayBetween(double phasePrev, double phaseNext, double freqPrev, double freqNext)
+{
+    const double df = freqNext - freqPrev;
+    if (std::abs(df) < std::numeric_limits<double>::epsilon())
+        return 0.0;
+    return -((phaseNext - phasePrev) / df) / kTwoPi;
+}
+
+// 10*log10(|s|^2), except where |s|^2 underflows (|s| below ~1e-154): there
+// 20*log10(|s|) keeps the finite value instead of -inf.
+Eigen::ArrayXd powerDb(const Eigen::ArrayXd& power, const Eigen::ArrayXcd& sparam)
+{
+    Eigen::ArrayXd db = 10.0 * power.log10();
+    for (Eigen::Index i = 0; i < power.size(); ++i) {
+        if (power(i) < std::numeric_limits<double>::min())
+            db(i) = 20.0 * std::log10(std::abs(sparam(i)));
+    }
+    return db;
+}
+
+} // namespace
+
+double wrapPhase(double phase)
+{
+    if (!std::isfinite(phase))
+        return phase;
+    if (phase < -kPi - kWrapTolerance || phase > kPi + kWrapTolerance)
+        phase = std::remainder(phase, kTwoPi);
+    if (phase >= kPi - kWrapTolerance)
+        phase -= kTwoPi;
+    return phase;
+}
+
+Eigen::ArrayXd wrapPhase(const Eigen::ArrayXd& phase)
+{
+    Eigen::ArrayXd wrapped(phase.size());
+    for (Eigen::Index i = 0; i < phase.size(); ++i)
+        wrapped(i) = wrapPhase(phase(i));
+    return wrapped;
+}
+
+Eigen::ArrayXd unwrapPhase(const Eigen::ArrayXd& phase)
+{
+    // Each jump of more than pi shifts every later sample by one turn; keep the
+    // accumulated shift instead of applying it to the tail at every jump. Jumps
+    // are judged on the input samples, so the shift's rounding cannot flip them.
+    Eigen::ArrayXd unwrapped(phase.size());
+    double offset = 0.0;
+    for (Eigen::Index i = 0; i < phase.size(); ++i) {
+        if (i > 0) {
+            const double diff = phase(i) - phase(i - 1);
+            if (diff > kPi)
+                offset -= kTwoPi;
+            else if (diff < -kPi)
+                offset += kTwoPi;
+        }
+        unwrapped(i) = phase(i) + offset;
+    }
+    return unwrapped;
+}
+
+Eigen::ArrayXd groupDelay(const Eigen::ArrayXd& phase, const Eigen::ArrayXd& freq)
+{
+    const Eigen::Index count = std::min(phase.size(), freq.size());
+    Eigen::ArrayXd delay = Eigen::ArrayXd::Zero(count);
+    if (count <= 1)
+        return delay;
+
+    for (Eigen::Index i = 0; i < count; ++i) {
+        const Eigen::Index prev = (i == 0) ? i : i - 1;
+        const Eigen::Index next = (i == count - 1) ? i : i + 1;
+        delay(i) = delayBetween(phase(prev), phase(next), freq(prev), freq(next));
+    }
+    return delay;
+}
+
+Eigen::ArrayXd magnitudeDb(const Eigen::ArrayXcd& sparam)
+{
+    return powerDb(sparam.abs2(), sparam);
+}
+
+Eigen::ArrayXd vswr(const Eigen::ArrayXcd& sparam)
+{
+    const Eigen::ArrayXd magnitude = sparam.abs2().sqrt();
+    return (1.0 + magnitude) / (1.0 - magnitude);
+}
+
+Views computeViews(const Eigen::ArrayXd& freq, const Eigen::ArrayXcd& sparam, unsigned views, bool unwrap)
+{
+    Views result;
+    const Eigen::Index count = sparam.size();
+
+    if (views & (MagnitudeDb | Vswr)) {
+        const Eigen::ArrayXd power = sparam.abs2();
+        if (views & MagnitudeDb)
+            result.magnitudeDb = powerDb(power, sparam);
+        if (views & Vswr) {
+            const Eigen::ArrayXd magnitude = power.sqrt();
+            result.vswr = (1.0 + magnitude) / (1.0 - magnitude);
+        }
+    }
+
+    if (!(views & (Phase | GroupDelay)))
+        return result;
+
+    // One pass: wrap, unwrap, and the delay of the previous sample once the
+    // next phase is known.
+    const bool wantDelay = (views & GroupDelay) && freq.size() >= count;
+    result.phase.resize(count);
+    if (wantDelay)
+        result.groupDelay = Eigen::ArrayXd::Zero(count);
+    double offset = 0.0;
+    double previous = 0.0;
+    for (Eigen::Index i = 0; i < count; ++i) {
+        const double wrapped = wrapPhase(std::arg(sparam(i)));
+        if (unwrap && i > 0) {
+            const double diff = wrapped - previous;
+            if (diff > kPi)
+                offset -= kTwoPi;
+            else if (diff < -kPi)
+                offset += kTwoPi;
+        }
+        previous = wrapped;
+        const double value = wrapped + offset;
+        result.phase(i) = value;
+
+        if (wantDelay && i >= 1) {
+            const Eigen::Index prev = (i >= 2) ? i - 2 : 0;
+            result.groupDelay(i - 1) = delayBetween(result.phase(prev), value, freq(prev), freq(i));
+        }
+    }
+    if (wantDelay && count >= 2)
+        result.groupDelay(count - 1) = delayBetween(result.phase(count - 2), result.phase(count - 1),
+                                                    freq(count - 2), freq(count - 1));
+    if (!(views & Phase))
+        result.phase = Eigen::ArrayXd();
+    return result;
+}
+
+} // namespace PlotKernels
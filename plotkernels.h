@@ -0,0 +1,41 @@
+#ifndef PLOTKERNELS_H
+#define PLOTKERNELS_H
+
+#include <Eigen/Dense>
+
+// Linear-time kernels that turn one complex S-parameter column into the values
+// the plots show. Magnitude views are Eigen array expressions; the phase views
+// share a single sequential pass because unwrapping is a running sum.
+namespace PlotKernels {
+
+enum View : unsigned {
+    MagnitudeDb = 1u << 0,
+    Vswr = 1u << 1,
+    Phase = 1u << 2,        // radians, wrapped or unwrapped as requested
+    GroupDelay = 1u << 3,   // seconds
+};
+
+struct Views
+{
+    Eigen::ArrayXd magnitudeDb;
+    Eigen::ArrayXd vswr;
+    Eigen::ArrayXd phase;
+    Eigen::ArrayXd groupDelay;
+};
+
+// Computes the views selected in `views`; the others are left empty.
+Views computeViews(const Eigen::ArrayXd& freq, const Eigen::ArrayXcd& sparam, unsigned views, bool unwrap);
+
+Eigen::ArrayXd magnitudeDb(const Eigen::ArrayXcd& sparam);
+Eigen::ArrayXd vswr(const Eigen::ArrayXcd& sparam);
+
+// Maps finite angles to [-pi, pi), treating values within 1e-12 of +pi as -pi.
+double wrapPhase(double phase);
+Eigen::ArrayXd wrapPhase(const Eigen::ArrayXd& phase);
+Eigen::ArrayXd unwrapPhase(const Eigen::ArrayXd& phase);
+// Central differences inside, one-sided at the ends; zero across repeated frequencies.
+Eigen::ArrayXd groupDelay(const Eigen::ArrayXd& phase, const Eigen::ArrayXd& freq);
+
+} // namespace PlotKernels
+
+#endif // PLOTKERNELS_H
@@ -2,6 +2,7 @@
 #include "qcustomplot.h"
 #include "network.h"
 #include "networkcascade.h"
+#include "networklumped.h"
 #include "plotsettingsdialog.h"
 #include "SmithChartGrid.h"
 #include <QDebug>
@@ -18,10 +19,30 @@
 #include <QColor>
 #include <QPen>
 #include <QSignalBlocker>
+#include <QThreadPool>
+#include <QTimer>
 #include <QVector>
+#include <functional>
+#include <memory>
 
 namespace
 {
+// Deletes a clone made for a background job on the GUI thread. A cascade
+// leaves its members alone when destroyed, so they are queued after it.
+void releaseSnapshot(Network *copy)
+{
+    QList<Network*> members;
+    if (auto *cascade = dynamic_cast<NetworkCascade*>(copy)) {
+        for (Network *member : cascade->getNetworks()) {
+            if (member && member->parent() == cascade)
+                members.append(member);
+        }
+    }
+    copy->deleteLater();
+    for (Network *member : members)
+        member->deleteLater();
+}
+
 class EngineeringAxisTicker : public QCPAxisTicker
 {
 protected:
@@ -76,6 +97,9 @@ PlotManager::PlotManager(QCustomPlot* plot, QObject *parent)
     , m_gridColor(QColor(200, 200, 200))
     , m_subGridPenStyle(Qt::NoPen)
     , m_subGridColor(QColor(220, 220, 220))
+    , m_zoomTimer(new QTimer(this))
+    , m_zoomPool(new QThreadPool(this))
+    , m_zoomGeneration(0)
     , m_xTickAuto(true)
     , m_xTickSpacing(0.0)
     , m_yTickAuto(true)
@@ -91,6 +115,13 @@ PlotManager::PlotManager(QCustomPlot* plot, QObject *parent)
     connect(m_plot->yAxis, SIGNAL(rangeChanged(QCPRange)), this, SLOT(handleAxisRangeChanged(QCPRange)));
     connect(m_plot, &QCustomPlot::beforeReplot, this, &PlotManager::handleBeforeReplot);
 
+    // Waits for the x range to settle, e.g. after a wheel zoom.
+    m_zoomTimer->setSingleShot(true);
+    m_zoomTimer->setInterval(150);
+    connect(m_zoomTimer, &QTimer::timeout, this, &PlotManager::refineVisibleRange);
+    // One job at a time so a newer range never waits behind stale ones.
+    m_zoomPool->setMaxThreadCount(1);
+
     m_plot->setSelectionRectMode(QCP::srmZoom);
     m_plot->setRangeDragButton(Qt::RightButton);
 
@@ -177,6 +208,14 @@ PlotManager::PlotManager(QCustomPlot* plot, QObject *parent)
     }
 }
 
+PlotManager::~PlotManager()
+{
+    // Running jobs use this object; let them finish before it goes away.
+    ++m_zoomGeneration;
+    m_zoomPool->clear();
+    m_zoomPool->waitForDone();
+}
+
 void PlotManager::setNetworks(const QList<Network*>& networks)
 {
     m_networks = networks;
@@ -586,6 +625,12 @@ void PlotManager::updatePlots(const QStringList& sparams, PlotType type)
             return QStringLiteral("_smith");
         case PlotType::TDR:
             return QStringLiteral("_tdr");
+        case PlotType::Impedance:
+            return QStringLiteral("_z");
+        case PlotType::Admittance:
+            return QStringLiteral("_y");
+        case PlotType::Renormalized:
+            return QStringLiteral("_renorm");
         }
         return QString();
     };
@@ -694,6 +739,19 @@ void PlotManager::updatePlots(const QStringList& sparams, PlotType type)
         m_plot->xAxis2->setScaleType(QCPAxis::stLinear);
         updateAxisTickers();
         break;
+    case PlotType::Impedance:
+        m_plot->yAxis->setLabel(QString::fromUtf8("|Z| (Ω)"));
+        m_plot->xAxis->setLabel("Frequency (Hz)");
+        break;
+    case PlotType::Admittance:
+        m_plot->yAxis->setLabel("|Y| (S)");
+        m_plot->xAxis->setLabel("Frequency (Hz)");
+        break;
+    case PlotType::Renormalized:
+        m_plot->yAxis->setLabel(QString::fromUtf8("Magnitude (dB, %1 Ω)")
+                                    .arg(Network::formatEngineering(Network::renormalizationImpedance(), false)));
+        m_plot->xAxis->setLabel("Frequency (Hz)");
+        break;
     }
 
     suffix = suffixForType(type);
@@ -864,6 +922,8 @@ void PlotManager::updatePlots(const QStringList& sparams, PlotType type)
             if (pl) {
                 pl->setProperty("network_ptr", QVariant::fromValue(reinterpret_cast<quintptr>(network)));
                 pl->setProperty("sparam_key", sparam);
+                pl->setProperty("sparam_index", sparam_idx_to_plot);
+                pl->setProperty("zoomed", false);
                 if (type == PlotType::Smith) {
                     if (QCPCurve *curve = qobject_cast<QCPCurve*>(pl)) {
                         curve->setData(plotData.first, plotData.second);
@@ -881,6 +941,7 @@ void PlotManager::updatePlots(const QStringList& sparams, PlotType type)
                               pen, graph_name, network, type, sparam);
                 if (pl) {
                     pl->setProperty("sparam_key", sparam);
+                    pl->setProperty("sparam_index", sparam_idx_to_plot);
                 }
                 if (type == PlotType::Smith)
                     if (QCPCurve *curve = qobject_cast<QCPCurve*>(pl))
@@ -931,6 +992,8 @@ void PlotManager::updatePlots(const QStringList& sparams, PlotType type)
             if (pl) {
                 pl->setProperty("network_ptr", QVariant::fromValue(reinterpret_cast<quintptr>(m_cascade)));
                 pl->setProperty("sparam_key", sparam);
+                pl->setProperty("sparam_index", sparam_idx_to_plot);
+                pl->setProperty("zoomed", false);
                 if (type == PlotType::Smith) {
                     if (QCPCurve *curve = qobject_cast<QCPCurve*>(pl)) {
                         curve->setData(plotData.first, plotData.second);
@@ -948,6 +1011,7 @@ void PlotManager::updatePlots(const QStringList& sparams, PlotType type)
                               graph_name, m_cascade, type, sparam);
                 if (pl) {
                     pl->setProperty("sparam_key", sparam);
+                    pl->setProperty("sparam_index", sparam_idx_to_plot);
                 }
                 if (type == PlotType::Smith)
                     if (QCPCurve *curve = qobject_cast<QCPCurve*>(pl))
@@ -1124,11 +1188,13 @@ void PlotManager::updatePlots(const QStringList& sparams, PlotType type)
     selectionChanged();
     updateTracers();
     m_plot->replot();
-
+    // The graphs hold full-span data again.
+    scheduleZoomRefinement();
 }
 
 void PlotManager::autoscale()
 {
+    restoreFullSpanData();
     if (!m_smithGridCurves.isEmpty()) {
         m_plot->xAxis->setRange(-1.05, 1.05);
         m_plot->yAxis->setRange(-1.05, 1.05);
@@ -2115,10 +2181,12 @@ void PlotManager::handleAxisRangeChanged(const QCPRange &newRange)
         return;
 
     AxisState &state = m_axisStates[m_currentPlotType];
-    if (axis->orientation() == Qt::Horizontal)
+    if (axis->orientation() == Qt::Horizontal) {
         state.xRange = newRange;
-    else
+        scheduleZoomRefinement();
+    } else {
         state.yRange = newRange;
+    }
 
     if (std::isfinite(state.xRange.lower) && std::isfinite(state.xRange.upper) &&
         std::isfinite(state.yRange.lower) && std::isfinite(state.yRange.upper) &&
@@ -2128,6 +2196,158 @@ void PlotManager::handleAxisRangeChanged(const QCPRange &newRange)
     }
 }
 
+void PlotManager::scheduleZoomRefinement()
+{
+    // Results still on their way belong to a range or data that is gone.
+    ++m_zoomGeneration;
+    m_zoomPool->clear();
+    if (m_currentPlotType == PlotType::Smith)
+        return;
+    m_zoomTimer->start();
+}
+
+void PlotManager::refineVisibleRange()
+{
+    const quint64 generation = ++m_zoomGeneration;
+    m_zoomPool->clear();
+
+    const PlotType type = m_currentPlotType;
+    if (type == PlotType::Smith)
+        return;
+
+    const QCPRange visible = m_plot->xAxis->range();
+    const bool logarithmic = m_plot->xAxis->scaleType() == QCPAxis::stLogarithmic;
+    const Network::TimeGateSettings gate = Network::timeGateSettings();
+    bool restored = false;
+
+    const auto startJob = [this, generation](QCPGraph *graph, Network *network,
+                                             std::function<QPair<QVector<double>, QVector<double>>(const Network &)> evaluate) {
+        // The job works on a snapshot so edits made meanwhile cannot race it.
+        std::shared_ptr<Network> snapshot(network->clone(), releaseSnapshot);
+        const QString name = graph->name();
+        m_zoomPool->start([this, generation, snapshot, name, evaluate] {
+            if (generation != m_zoomGeneration.load())
+                return;
+            const auto data = evaluate(*snapshot);
+            QMetaObject::invokeMethod(this, [this, generation, name, data] {
+                applyZoomedData(generation, name, data);
+            }, Qt::QueuedConnection);
+        });
+    };
+    const auto restoreFullSpan = [&restored](QCPGraph *graph, const QPair<QVector<double>, QVector<double>> &data) {
+        if (!graph->property("zoomed").toBool())
+            return;
+        graph->setData(data.first, data.second);
+        graph->setProperty("zoomed", false);
+        restored = true;
+    };
+
+    for (int i = 0; i < m_plot->graphCount(); ++i) {
+        QCPGraph *graph = m_plot->graph(i);
+        if (!graph || graph->property("math_plot").toBool())
+            continue;
+        auto *network = reinterpret_cast<Network*>(graph->property("network_ptr").value<quintptr>());
+        if (!network || (network != m_cascade && !m_networks.contains(network)))
+            continue;
+
+        // Every reflection's TDR is re-evaluated on the visible distances
+        // alone, at about two samples per pixel; gated traces keep the
+        // record the gate produced.
+        if (type == PlotType::TDR) {
+            bool ok = false;
+            const int index = graph->property("sparam_index").toInt(&ok);
+            if (!ok || index < 0)
+                continue;
+            const auto full = network->getPlotData(index, type);
+            const double extent = full.first.isEmpty() ? 0.0 : full.first.last();
+            const double lower = std::max(visible.lower, 0.0);
+            const double upper = std::min(visible.upper, extent);
+            if (gate.enabled || !(upper > lower) || (lower <= 0.0 && upper >= extent)) {
+                restoreFullSpan(graph, full);
+                continue;
+            }
+            const int points = std::max(256, 2 * m_plot->axisRect()->width());
+            startJob(graph, network, [index, lower, upper, points](const Network &snapshot) {
+                return snapshot.tdrOnWindow(index, lower, upper, points);
+            });
+            continue;
+        }
+
+        // Measured data has nothing between its points; only analytic
+        // networks gain detail from a narrower grid.
+        int points = 0;
+        if (auto *lumped = dynamic_cast<NetworkLumped*>(network))
+            points = lumped->pointCount();
+        else if (auto *cascade = dynamic_cast<NetworkCascade*>(network))
+            points = cascade->pointCount();
+        else
+            continue;
+
+        bool ok = false;
+        const int index = graph->property("sparam_index").toInt(&ok);
+        if (!ok || index < 0)
+            continue;
+
+        const double lower = std::max(visible.lower, network->fmin());
+        const double upper = std::min(visible.upper, network->fmax());
+        const bool fullSpan = lower <= network->fmin() && upper >= network->fmax();
+        // The gate works on the whole band, so gated reflections are left alone.
+        const int ports = network->portCount();
+        const bool gated = gate.enabled && ports > 0 && index % ports == index / ports;
+        if (fullSpan || !(upper > lower) || gated) {
+            if (graph->property("zoomed").toBool())
+                restoreFullSpan(graph, network->getPlotData(index, type));
+            continue;
+        }
+
+        const Eigen::VectorXd grid = NetworkCascade::sweepFrequencies(lower, upper, points, logarithmic);
+        startJob(graph, network, [index, type, grid](const Network &snapshot) {
+            return snapshot.plotDataOnGrid(index, type, grid);
+        });
+    }
+
+    if (restored) {
+        updateMathPlots();
+        updateTracers();
+        m_plot->replot(QCustomPlot::rpQueuedReplot);
+    }
+}
+
+void PlotManager::restoreFullSpanData()
+{
+    ++m_zoomGeneration;
+    m_zoomPool->clear();
+    m_zoomTimer->stop();
+
+    for (int i = 0; i < m_plot->graphCount(); ++i) {
+        QCPGraph *graph = m_plot->graph(i);
+        if (!graph || !graph->property("zoomed").toBool())
+            continue;
+        graph->setProperty("zoomed", false);
+        auto *network = reinterpret_cast<Network*>(graph->property("network_ptr").value<quintptr>());
+        if (!network || (network != m_cascade && !m_networks.contains(network)))
+            continue;
+        const auto data = network->getPlotData(graph->property("sparam_index").toInt(), m_currentPlotType);
+        graph->setData(data.first, data.second);
+    }
+    updateMathPlots();
+}
+
+void PlotManager::applyZoomedData(quint64 generation, const QString &graphName,
+                                  const QPair<QVector<double>, QVector<double>> &data)
+{
+    if (generation != m_zoomGeneration.load() || data.first.isEmpty())
+        return;
+    QCPGraph *graph = graphByName(graphName);
+    if (!graph)
+        return;
+    graph->setData(data.first, data.second, true);
+    graph->setProperty("zoomed", true);
+    updateMathPlots();
+    updateTracers();
+    m_plot->replot(QCustomPlot::rpQueuedReplot);
+}
+
 void PlotManager::handleBeforeReplot()
 {
     if (m_currentPlotType == PlotType::Smith)
@@ -11,6 +11,7 @@
 
 #include "network.h"
 #include "qcustomplot.h"
+#include <atomic>
 
 class QCustomPlot;
 class Network;
@@ -22,12 +23,15 @@ class QCPGraph;
 class QCPCurve;
 class QCPAbstractPlottable;
 class PlotSettingsDialog;
+class QThreadPool;
+class QTimer;
 
 class PlotManager : public QObject
 {
     Q_OBJECT
 public:
     explicit PlotManager(QCustomPlot* plot, QObject *parent = nullptr);
+    ~PlotManager();
 
     void setNetworks(const QList<Network*>& networks);
     void setCascade(NetworkCascade* cascade);
@@ -95,6 +99,14 @@ private:
     void storeAxisState(PlotType type);
     bool applyStoredAxisState(PlotType type);
     void enforceSmithAspectRatio();
+    // Lumped and cascade traces are re-evaluated over the visible band, and
+    // TDR traces over the visible distances, once the x range settles; the
+    // full-span data stays in PlotDataCache.
+    void scheduleZoomRefinement();
+    void refineVisibleRange();
+    void restoreFullSpanData();
+    void applyZoomedData(quint64 generation, const QString &graphName,
+                         const QPair<QVector<double>, QVector<double>> &data);
 
 
     QCustomPlot* m_plot;
@@ -131,6 +143,10 @@ private:
     Qt::PenStyle m_subGridPenStyle;
     QColor m_subGridColor;
 
+    QTimer *m_zoomTimer;
+    QThreadPool *m_zoomPool;
+    std::atomic<quint64> m_zoomGeneration;
+
     bool m_xTickAuto;
     double m_xTickSpacing;
     bool m_yTickAuto;
@@ -7,8 +7,11 @@
 #include <cmath>
 #include <complex>
 #include <limits>
+#include <memory>
+#include <mutex>
 #include <numeric>
 #include <optional>
+#include <unordered_map>
 #include <vector>
 
 namespace {
@@ -21,16 +24,152 @@ struct TransformContext
     Eigen::ArrayXd freqSorted;
     Eigen::ArrayXcd reflectionSorted;
     std::vector<int> permutation; // sorted index -> original index
-    Eigen::ArrayXd freqBins;
-    Eigen::ArrayXcd spectrumPositive;
-    std::vector<std::complex<double>> spectrumFull;
-    Eigen::ArrayXd impulse;
     double df = 0.0;
     std::size_t Nfft = 0;
+    std::size_t bins = 0; // Nfft / 2 + 1 non-negative frequency bins
+    std::size_t activeBins = 0; // bins up to the highest measured frequency; the rest are zero
     double dt = 0.0;
     double velocity = 0.0;
 };
 
+// An FFT plan with the scratch buffers transforms of length Nfft need.
+// Eigen's FFT caches its twiddle factors per length, so a reused object also
+// skips re-planning. Buffers are sized on first use, for a time record
+// (real transforms over the half spectrum: Nfft/2+1 bins in, Nfft samples
+// out, and back) or for a chirp-Z convolution (complex transforms).
+struct Workspace
+{
+    explicit Workspace(std::size_t length)
+        : Nfft(length)
+    {
+        fft.SetFlag(Eigen::FFT<double>::HalfSpectrum);
+    }
+
+    void reserveRecord()
+    {
+        const Eigen::Index samples = static_cast<Eigen::Index>(Nfft);
+        spectrum.resize(Nfft / 2 + 1);
+        impulse.resize(samples);
+        step.resize(samples);
+        window.resize(samples);
+    }
+
+    void reserveConvolution()
+    {
+        signal.resize(Nfft);
+        kernel.resize(Nfft);
+        product.resize(Nfft);
+    }
+
+    std::size_t bytes() const
+    {
+        const std::size_t complexCount = spectrum.size() + signal.size() + kernel.size() + product.size();
+        const std::size_t realCount = static_cast<std::size_t>(impulse.size() + step.size() + window.size());
+        return complexCount * sizeof(std::complex<double>) + realCount * sizeof(double);
+    }
+
+    std::size_t Nfft;
+    Eigen::FFT<double> fft;
+    std::vector<std::complex<double>> spectrum;
+    Eigen::ArrayXd impulse;
+    Eigen::ArrayXd step;
+    Eigen::ArrayXd window;
+    std::vector<std::complex<double>> signal;
+    std::vector<std::complex<double>> kernel; // spectrum of the chirp below
+    std::vector<std::complex<double>> product;
+    double kernelBeta = std::numeric_limits<double>::quiet_NaN();
+    Eigen::Index kernelLength = 0;
+    Eigen::Index kernelCount = 0;
+};
+
+// Idle workspaces by length. A few per length cover concurrent plotting
+// threads; anything beyond that is freed on release.
+class WorkspacePool
+{
+public:
+    static WorkspacePool& instance()
+    {
+        static WorkspacePool pool;
+        return pool;
+    }
+
+    std::unique_ptr<Workspace> acquire(std::size_t Nfft)
+    {
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            auto it = m_idle.find(Nfft);
+            if (it != m_idle.end() && !it->second.empty()) {
+                std::unique_ptr<Workspace> workspace = std::move(it->second.back());
+                it->second.pop_back();
+                --m_idleCount;
+                m_idleBytes -= workspace->bytes();
+                ++m_hits;
+                return workspace;
+            }
+            ++m_misses;
+        }
+        return std::make_unique<Workspace>(Nfft);
+    }
+
+    void release(std::unique_ptr<Workspace> workspace)
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        auto& idle = m_idle[workspace->Nfft];
+        if (idle.size() >= kMaxIdlePerLength)
+            return;
+        ++m_idleCount;
+        m_idleBytes += workspace->bytes();
+        idle.push_back(std::move(workspace));
+    }
+
+    TDRCalculator::WorkspaceStats stats() const
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        TDRCalculator::WorkspaceStats stats;
+        stats.hits = m_hits;
+        stats.misses = m_misses;
+        stats.idle = m_idleCount;
+        stats.bytes = m_idleBytes;
+        return stats;
+    }
+
+    void resetStats()
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_hits = 0;
+        m_misses = 0;
+    }
+
+private:
+    static constexpr std::size_t kMaxIdlePerLength = 8;
+
+    mutable std::mutex m_mutex;
+    std::unordered_map<std::size_t, std::vector<std::unique_ptr<Workspace>>> m_idle;
+    std::size_t m_idleCount = 0;
+    std::size_t m_idleBytes = 0;
+    quint64 m_hits = 0;
+    quint64 m_misses = 0;
+};
+
+// Borrows a workspace for the lifetime of one transform.
+class WorkspaceLease
+{
+public:
+    explicit WorkspaceLease(std::size_t Nfft)
+        : m_workspace(WorkspacePool::instance().acquire(Nfft))
+    {
+    }
+    ~WorkspaceLease() { WorkspacePool::instance().release(std::move(m_workspace)); }
+    WorkspaceLease(const WorkspaceLease&) = delete;
+    WorkspaceLease& operator=(const WorkspaceLease&) = delete;
+
+    Workspace& operator*() const { return *m_workspace; }
+    Workspace* operator->() const { return m_workspace.get(); }
+
+private:
+    std::unique_ptr<Workspace> m_workspace;
+};
+
 inline double safeEpsilon(double eps)
 {
     return (eps > 1.0) ? eps : 1.0;
@@ -52,13 +191,15 @@ inline std::size_t NextPow2(std::size_t n)
     return n + 1;
 }
 
-// Apply a cosine taper only at the high-frequency tail
-inline void ApplyHighEndCosineTaper(Eigen::ArrayXcd& oneSided, int edgeCount)
+// Apply a cosine taper only at the high-frequency tail of binCount bins;
+// oneSided may hold just the lowest of them.
+inline void ApplyHighEndCosineTaper(Eigen::Ref<Eigen::ArrayXcd> oneSided, int binCount, int edgeCount)
 {
-    const int n = static_cast<int>(oneSided.size());
+    const int n = binCount;
     if (n <= 2 || edgeCount <= 0 || edgeCount >= n) return;
 
-    for (int i = n - edgeCount; i < n; ++i) {
+    const int stored = std::min(n, static_cast<int>(oneSided.size()));
+    for (int i = n - edgeCount; i < stored; ++i) {
         const double x = double(i - (n - edgeCount)) / double(edgeCount - 1); // 0..1
         const double w = 0.5 * (1.0 + std::cos(kPi * x)); // 1 → 0
         oneSided(i) *= w;
@@ -107,24 +248,42 @@ std::optional<TransformContext> PrepareTransform(const Eigen::ArrayXd& frequency
     const std::size_t minimalNfft = static_cast<std::size_t>(2 * (m - 1));
     ctx.Nfft = NextPow2(minimalNfft);
     ctx.Nfft = std::max<std::size_t>(ctx.Nfft, (1u << 17));
-    const std::size_t nBins = ctx.Nfft / 2 + 1;
+    ctx.bins = ctx.Nfft / 2 + 1;
+
+    const double fmaxMeas = ctx.freqSorted(m - 1);
+    ctx.activeBins = 0;
+    while (ctx.activeBins < ctx.bins && !(ctx.df * double(ctx.activeBins) > fmaxMeas))
+        ++ctx.activeBins;
+
+    const double fmax = ctx.df * double(ctx.bins - 1);
+    const double fs = 2.0 * fmax;
+    ctx.dt = (fs > 0.0) ? (1.0 / fs) : 0.0;
+    const double erEff = safeEpsilon(params.effectivePermittivity);
+    ctx.velocity = kC0 / std::sqrt(erEff);
 
-    ctx.freqBins.resize(static_cast<int>(nBins));
-    for (std::size_t i = 0; i < nBins; ++i)
-        ctx.freqBins(static_cast<Eigen::Index>(i)) = ctx.df * double(i);
+    return ctx;
+}
+
+// Resamples the sorted reflection onto the lowest spectrumPositive.size()
+// FFT bins and band-limits it.
+void SynthesizeSpectrum(const TransformContext& ctx,
+                        const TDRCalculator::Parameters& params,
+                        Eigen::Ref<Eigen::ArrayXcd> spectrumPositive)
+{
+    const Eigen::Index m = ctx.freqSorted.size();
+    const std::size_t nBins = static_cast<std::size_t>(spectrumPositive.size());
 
-    ctx.spectrumPositive.resize(static_cast<int>(nBins));
     const double fmaxMeas = ctx.freqSorted(m - 1);
     for (std::size_t i = 0; i < nBins; ++i) {
-        const double fb = ctx.freqBins(static_cast<Eigen::Index>(i));
+        const double fb = ctx.df * double(i);
         if (fb > fmaxMeas) {
-            ctx.spectrumPositive(static_cast<Eigen::Index>(i)) = std::complex<double>(0.0, 0.0);
+            spectrumPositive(static_cast<Eigen::Index>(i)) = std::complex<double>(0.0, 0.0);
         } else {
             auto it = std::lower_bound(ctx.freqSorted.data(), ctx.freqSorted.data() + m, fb);
             if (it == ctx.freqSorted.data()) {
-                ctx.spectrumPositive(static_cast<Eigen::Index>(i)) = ctx.reflectionSorted(0);
+                spectrumPositive(static_cast<Eigen::Index>(i)) = ctx.reflectionSorted(0);
             } else if (it == ctx.freqSorted.data() + m) {
-                ctx.spectrumPositive(static_cast<Eigen::Index>(i)) = ctx.reflectionSorted(m - 1);
+                spectrumPositive(static_cast<Eigen::Index>(i)) = ctx.reflectionSorted(m - 1);
             } else {
                 const Eigen::Index hi = static_cast<Eigen::Index>(it - ctx.freqSorted.data());
                 const Eigen::Index lo = hi - 1;
@@ -133,7 +292,7 @@ std::optional<TransformContext> PrepareTransform(const Eigen::ArrayXd& frequency
                 const double t = (fb - f0) / (f1 - f0 + 1e-30);
                 const std::complex<double> y0 = ctx.reflectionSorted(lo);
                 const std::complex<double> y1 = ctx.reflectionSorted(hi);
-                ctx.spectrumPositive(static_cast<Eigen::Index>(i)) = y0 + (y1 - y0) * t;
+                spectrumPositive(static_cast<Eigen::Index>(i)) = y0 + (y1 - y0) * t;
             }
         }
     }
@@ -141,7 +300,7 @@ std::optional<TransformContext> PrepareTransform(const Eigen::ArrayXd& frequency
     if (params.risetime > 0.0 && params.filter != TDRCalculator::Parameters::FilterType::None) {
         const double fc = 0.35 / params.risetime;
         for (std::size_t i = 0; i < nBins; ++i) {
-            const double fcur = ctx.freqBins(static_cast<Eigen::Index>(i));
+            const double fcur = ctx.df * double(i);
             double H = 1.0;
             if (params.filter == TDRCalculator::Parameters::FilterType::Gaussian) {
                 H = std::exp(-std::pow(fcur / fc, 2.0));
@@ -157,47 +316,39 @@ std::optional<TransformContext> PrepareTransform(const Eigen::ArrayXd& frequency
                     H = 0.5 * (1.0 + std::cos(kPi * (fcur - f0) / (2.0 * roll * fc)));
                 }
             }
-            ctx.spectrumPositive(static_cast<Eigen::Index>(i)) *= H;
+            spectrumPositive(static_cast<Eigen::Index>(i)) *= H;
         }
     }
 
     {
-        const int edge = std::max<int>(1, int(0.10 * (nBins - 1)));
-        ApplyHighEndCosineTaper(ctx.spectrumPositive, edge);
+        const int edge = std::max<int>(1, int(0.10 * (ctx.bins - 1)));
+        ApplyHighEndCosineTaper(spectrumPositive, static_cast<int>(ctx.bins), edge);
     }
+}
 
-    ctx.spectrumFull.assign(ctx.Nfft, std::complex<double>(0.0, 0.0));
-    for (std::size_t i = 0; i < nBins; ++i)
-        ctx.spectrumFull[i] = ctx.spectrumPositive(static_cast<Eigen::Index>(i));
-    for (std::size_t i = 1; i < nBins; ++i)
-        ctx.spectrumFull[ctx.Nfft - i] = std::conj(ctx.spectrumPositive(static_cast<Eigen::Index>(i)));
-
-    Eigen::FFT<double> fft;
-    std::vector<std::complex<double>> timeCmplx(ctx.Nfft);
-    fft.inv(timeCmplx, ctx.spectrumFull);
-
-    ctx.impulse.resize(static_cast<int>(ctx.Nfft));
-    for (std::size_t i = 0; i < ctx.Nfft; ++i)
-        ctx.impulse(static_cast<Eigen::Index>(i)) = timeCmplx[i].real();
-
-    const double fmax = ctx.df * double(nBins - 1);
-    const double fs = 2.0 * fmax;
-    ctx.dt = (fs > 0.0) ? (1.0 / fs) : 0.0;
-    const double erEff = safeEpsilon(params.effectivePermittivity);
-    ctx.velocity = kC0 / std::sqrt(erEff);
+// The band-limited spectrum on every bin, and the real impulse response in
+// workspace.impulse.
+void SynthesizeImpulse(const TransformContext& ctx,
+                       const TDRCalculator::Parameters& params,
+                       Workspace& workspace)
+{
+    workspace.reserveRecord();
+    SynthesizeSpectrum(ctx, params,
+                       Eigen::Map<Eigen::ArrayXcd>(workspace.spectrum.data(), static_cast<Eigen::Index>(ctx.bins)));
 
-    return ctx;
+    // Complex-to-real inverse: the conjugate-symmetric upper half is implied,
+    // and only the real parts of the DC and Nyquist bins contribute.
+    workspace.fft.inv(workspace.impulse.data(), workspace.spectrum.data(), static_cast<Eigen::Index>(ctx.Nfft));
 }
 
-Eigen::ArrayXd ComputeStepResponse(const Eigen::ArrayXd& impulse)
+void ComputeStepResponse(const Eigen::ArrayXd& impulse, Eigen::ArrayXd& rho)
 {
-    Eigen::ArrayXd rho(impulse.size());
+    rho.resize(impulse.size());
     double acc = 0.0;
     for (Eigen::Index i = 0; i < impulse.size(); ++i) {
         acc += impulse(i);
         rho(i) = acc;
     }
-    return rho;
 }
 
 void BaselineCorrect(Eigen::ArrayXd& rho)
@@ -220,16 +371,16 @@ void ClampStep(Eigen::ArrayXd& rho)
     }
 }
 
-Eigen::ArrayXd StepToImpedance(const Eigen::ArrayXd& rho, double referenceImpedance)
+QVector<double> StepToImpedance(const Eigen::ArrayXd& rho, double referenceImpedance)
 {
-    Eigen::ArrayXd Z(rho.size());
+    QVector<double> Z(static_cast<int>(rho.size()));
     for (Eigen::Index i = 0; i < rho.size(); ++i) {
         const double g = rho(i);
         const double den = 1.0 - g;
         if (std::abs(den) < 1e-14) {
-            Z(i) = std::numeric_limits<double>::quiet_NaN();
+            Z[static_cast<int>(i)] = std::numeric_limits<double>::quiet_NaN();
         } else {
-            Z(i) = referenceImpedance * (1.0 + g) / den;
+            Z[static_cast<int>(i)] = referenceImpedance * (1.0 + g) / den;
         }
     }
     return Z;
@@ -246,7 +397,7 @@ QVector<double> DistanceVector(std::size_t Nfft, double dt, double velocity)
 }
 
 Eigen::ArrayXcd MapSpectrumToOriginal(const TransformContext& ctx,
-                                      const Eigen::ArrayXcd& positiveSpectrum)
+                                      const Eigen::Ref<const Eigen::ArrayXcd>& positiveSpectrum)
 {
     const Eigen::Index m = ctx.freqSorted.size();
     Eigen::ArrayXcd sortedValues(m);
@@ -287,12 +438,14 @@ Eigen::ArrayXcd MapSpectrumToOriginal(const TransformContext& ctx,
     return result;
 }
 
-Eigen::ArrayXd GateWindow(std::size_t size, double dt, double velocity,
-                          double startDistance, double stopDistance)
+// Fills `window` (already sized to the record) with the gate's weights.
+void GateWindow(double dt, double velocity, double startDistance, double stopDistance,
+                Eigen::ArrayXd& window)
 {
-    Eigen::ArrayXd window = Eigen::ArrayXd::Zero(static_cast<Eigen::Index>(size));
+    const std::size_t size = static_cast<std::size_t>(window.size());
+    window.setZero();
     if (size == 0 || !(dt > 0.0) || !(velocity > 0.0))
-        return window;
+        return;
 
     const double startDist = std::max(0.0, startDistance);
     const double stopDist = std::max(startDist, stopDistance);
@@ -311,13 +464,13 @@ Eigen::ArrayXd GateWindow(std::size_t size, double dt, double velocity,
 
     if (startIndex == 0 && stopIndex == last) {
         window.setOnes();
-        return window;
+        return;
     }
 
     const int width = stopIndex - startIndex + 1;
     if (width <= 1) {
         window(startIndex) = 1.0;
-        return window;
+        return;
     }
 
     const double alpha = 0.3;
@@ -337,8 +490,94 @@ Eigen::ArrayXd GateWindow(std::size_t size, double dt, double velocity,
         }
         window(startIndex + n) = weight;
     }
+}
+
+// sum_k x(k) e^{j k (alpha + m beta)} for m = 0..count-1, by Bluestein's
+// chirp-Z algorithm: with mk = (m^2 + k^2 - (m-k)^2) / 2 the sum becomes one
+// circular convolution with a chirp, of length >= x.size() + count - 1.
+Eigen::ArrayXcd ChirpZ(const Eigen::ArrayXcd& x, double alpha, double beta, Eigen::Index count)
+{
+    const Eigen::Index length = x.size();
+    WorkspaceLease workspace(NextPow2(static_cast<std::size_t>(length + count - 1)));
+    workspace->reserveConvolution();
+    const std::size_t size = workspace->Nfft;
+
+    Eigen::ArrayXcd chirp(std::max(length, count));
+    for (Eigen::Index k = 0; k < chirp.size(); ++k)
+        chirp(k) = std::polar(1.0, 0.5 * beta * double(k) * double(k));
+
+    std::vector<std::complex<double>>& signal = workspace->signal;
+    std::vector<std::complex<double>>& kernel = workspace->kernel;
+    std::vector<std::complex<double>>& product = workspace->product;
+    const Eigen::Index n = static_cast<Eigen::Index>(size);
+
+    // Traces sharing a window and band reuse the kernel's spectrum.
+    if (!(workspace->kernelBeta == beta) || workspace->kernelLength != length || workspace->kernelCount != count) {
+        std::fill(signal.begin(), signal.end(), std::complex<double>(0.0, 0.0));
+        for (Eigen::Index k = 0; k < count; ++k)
+            signal[static_cast<std::size_t>(k)] = std::conj(chirp(k));
+        for (Eigen::Index k = 1; k < length; ++k)
+            signal[size - static_cast<std::size_t>(k)] = std::conj(chirp(k));
+        workspace->fft.fwd(kernel.data(), signal.data(), n);
+        workspace->kernelBeta = beta;
+        workspace->kernelLength = length;
+        workspace->kernelCount = count;
+    }
+
+    std::fill(signal.begin(), signal.end(), std::complex<double>(0.0, 0.0));
+    for (Eigen::Index k = 0; k < length; ++k)
+        signal[static_cast<std::size_t>(k)] = x(k) * std::polar(1.0, alpha * double(k)) * chirp(k);
+    workspace->fft.fwd(product.data(), signal.data(), n);
+    for (std::size_t i = 0; i < size; ++i)
+        product[i] *= kernel[i];
+    workspace->fft.inv(signal.data(), product.data(), n);
+
+    Eigen::ArrayXcd result(count);
+    for (Eigen::Index m = 0; m < count; ++m)
+        result(m) = signal[static_cast<std::size_t>(m)] * chirp(m);
+    return result;
+}
 
-    return window;
+// The step response rho(n) = sum_{i<=n} h(i) of the record the C2R inverse
+// produces, at the (possibly fractional) samples n = first + m * step, with
+// BaselineCorrect() applied. With w_k = e^{j 2 pi k / Nfft} the geometric sum
+// gives
+//   Nfft rho(n) = Re X_0 (n+1) + S(0) - S(n+1),
+//   S(u) = sum_{k != 0} X_k / (1 - w_k) w_k^u,
+// so S only needs the active bins, through one chirp-Z transform, and the
+// baseline over the first samples has a closed form too.
+Eigen::ArrayXd StepResponseAt(const TransformContext& ctx, const Eigen::ArrayXcd& spectrum,
+                              double first, double step, Eigen::Index count)
+{
+    const double n = double(ctx.Nfft);
+    const Eigen::Index bins = spectrum.size();
+    const double baselineCount = double(std::min<std::size_t>(ctx.Nfft, 64));
+
+    // S(u) = 2 Re sum_{k>=1} y_k w_k^u over the conjugate-symmetric halves;
+    // the Nyquist bin is its own mirror, and C2R only sees its real part.
+    Eigen::ArrayXcd y = Eigen::ArrayXcd::Zero(bins);
+    std::complex<double> baselineSum = 0.0;
+    for (Eigen::Index k = 1; k < bins; ++k) {
+        const std::complex<double> w = std::polar(1.0, 2.0 * kPi * double(k) / n);
+        if (static_cast<std::size_t>(k) == ctx.Nfft / 2)
+            y(k) = 0.25 * spectrum(k).real();
+        else
+            y(k) = spectrum(k) / (1.0 - w);
+        // sum_{u=1}^{64} w^u, the baseline samples' share of S.
+        const std::complex<double> wb = std::polar(1.0, 2.0 * kPi * double(k) * baselineCount / n);
+        baselineSum += y(k) * w * (1.0 - wb) / (1.0 - w);
+    }
+    const double s0 = 2.0 * y.sum().real();
+    const double baseline = (spectrum(0).real() * (baselineCount + 1.0) / 2.0 + s0
+                             - 2.0 * baselineSum.real() / baselineCount) / n;
+
+    const Eigen::ArrayXcd s = ChirpZ(y, 2.0 * kPi * (first + 1.0) / n, 2.0 * kPi * step / n, count);
+    Eigen::ArrayXd rho(count);
+    for (Eigen::Index m = 0; m < count; ++m) {
+        const double u = first + 1.0 + step * double(m);
+        rho(m) = (spectrum(0).real() * u + s0 - 2.0 * s(m).real()) / n - baseline;
+    }
+    return rho;
 }
 
 } // namespace
@@ -353,15 +592,57 @@ TDRCalculator::Result TDRCalculator::compute(const Eigen::ArrayXd& frequencyHz,
     if (!ctxOpt)
         return result;
 
-    TransformContext& ctx = *ctxOpt;
+    const TransformContext& ctx = *ctxOpt;
+    WorkspaceLease workspace(ctx.Nfft);
+    SynthesizeImpulse(ctx, params, *workspace);
 
-    Eigen::ArrayXd rho = ComputeStepResponse(ctx.impulse);
+    Eigen::ArrayXd& rho = workspace->step;
+    ComputeStepResponse(workspace->impulse, rho);
     BaselineCorrect(rho);
     ClampStep(rho);
-    Eigen::ArrayXd impedance = StepToImpedance(rho, params.referenceImpedance);
 
     result.distance = DistanceVector(ctx.Nfft, ctx.dt, ctx.velocity);
-    result.impedance = QVector<double>(impedance.data(), impedance.data() + impedance.size());
+    result.impedance = StepToImpedance(rho, params.referenceImpedance);
+
+    return result;
+}
+
+TDRCalculator::Result TDRCalculator::computeWindow(const Eigen::ArrayXd& frequencyHz,
+                                                   const Eigen::ArrayXcd& reflection,
+                                                   const DistanceWindow& window,
+                                                   const Parameters& params) const
+{
+    Result result;
+    if (window.points < 2 || !(window.stopDistance > window.startDistance))
+        return result;
+
+    auto ctxOpt = PrepareTransform(frequencyHz, reflection, params);
+    if (!ctxOpt)
+        return result;
+
+    const TransformContext& ctx = *ctxOpt;
+    if (!(ctx.dt > 0.0) || ctx.activeBins == 0)
+        return result;
+
+    // Window ends in samples of the full record, clipped to it.
+    const double samplesPerMetre = 2.0 / (ctx.velocity * ctx.dt);
+    const double last = double(ctx.Nfft - 1);
+    const double first = std::clamp(window.startDistance * samplesPerMetre, 0.0, last);
+    const double stop = std::clamp(window.stopDistance * samplesPerMetre, 0.0, last);
+    if (!(stop > first))
+        return result;
+    const double step = (stop - first) / double(window.points - 1);
+
+    Eigen::ArrayXcd spectrum(static_cast<Eigen::Index>(ctx.activeBins));
+    SynthesizeSpectrum(ctx, params, spectrum);
+
+    Eigen::ArrayXd rho = StepResponseAt(ctx, spectrum, first, step, window.points);
+    ClampStep(rho);
+
+    result.distance.resize(window.points);
+    for (int i = 0; i < window.points; ++i)
+        result.distance[i] = (first + step * double(i)) / samplesPerMetre;
+    result.impedance = StepToImpedance(rho, params.referenceImpedance);
 
     return result;
 }
@@ -380,37 +661,38 @@ std::optional<TDRCalculator::GateResult> TDRCalculator::applyGate(const Eigen::A
     if (!ctxOpt)
         return std::nullopt;
 
-    TransformContext ctx = *ctxOpt;
-
-    Eigen::ArrayXd window = GateWindow(ctx.Nfft, ctx.dt, ctx.velocity,
-                                       gateStartDistance, gateStopDistance);
-    if (window.size() != ctx.impulse.size()) {
-        window.conservativeResize(ctx.impulse.size());
-    }
+    const TransformContext& ctx = *ctxOpt;
+    WorkspaceLease workspace(ctx.Nfft);
+    SynthesizeImpulse(ctx, gateParams, *workspace);
 
-    Eigen::ArrayXd gatedImpulse = ctx.impulse * window;
+    // The window buffer becomes the gated impulse.
+    Eigen::ArrayXd& gatedImpulse = workspace->window;
+    GateWindow(ctx.dt, ctx.velocity, gateStartDistance, gateStopDistance, gatedImpulse);
+    gatedImpulse *= workspace->impulse;
 
-    Eigen::ArrayXd rho = ComputeStepResponse(gatedImpulse);
+    Eigen::ArrayXd& rho = workspace->step;
+    ComputeStepResponse(gatedImpulse, rho);
     BaselineCorrect(rho);
     ClampStep(rho);
-    Eigen::ArrayXd impedance = StepToImpedance(rho, gateParams.referenceImpedance);
-
-    Eigen::FFT<double> fft;
-    std::vector<double> impulseVec(ctx.Nfft);
-    for (std::size_t i = 0; i < ctx.Nfft; ++i)
-        impulseVec[i] = gatedImpulse(static_cast<Eigen::Index>(i));
-
-    std::vector<std::complex<double>> specFull(ctx.Nfft);
-    fft.fwd(specFull, impulseVec);
 
-    Eigen::ArrayXcd positive(ctx.freqBins.size());
-    for (Eigen::Index i = 0; i < positive.size(); ++i)
-        positive(i) = specFull[static_cast<std::size_t>(i)];
+    // Real-to-complex forward: fills the ctx.bins non-negative bins only.
+    workspace->fft.fwd(workspace->spectrum.data(), gatedImpulse.data(), static_cast<Eigen::Index>(ctx.Nfft));
+    const Eigen::Map<const Eigen::ArrayXcd> positive(workspace->spectrum.data(), static_cast<Eigen::Index>(ctx.bins));
 
     GateResult result;
     result.gatedReflection = MapSpectrumToOriginal(ctx, positive);
     result.distance = DistanceVector(ctx.Nfft, ctx.dt, ctx.velocity);
-    result.impedance = QVector<double>(impedance.data(), impedance.data() + impedance.size());
+    result.impedance = StepToImpedance(rho, gateParams.referenceImpedance);
 
     return result;
 }
+
+TDRCalculator::WorkspaceStats TDRCalculator::workspaceStats()
+{
+    return WorkspacePool::instance().stats();
+}
+
+void TDRCalculator::resetWorkspaceStats()
+{
+    WorkspacePool::instance().resetStats();
+}
@@ -4,6 +4,7 @@
 #include <QVector>
 #include <Eigen/Dense>
 #include <complex>
+#include <cstddef>
 #include <optional>
 
 class TDRCalculator
@@ -54,12 +55,45 @@ public:
                    const Eigen::ArrayXcd& reflection,
                    const Parameters& params = Parameters()) const;
 
+    // A distance span sampled at `points` evenly spaced distances, both ends
+    // included.
+    struct DistanceWindow
+    {
+        double startDistance = 0.0;
+        double stopDistance = 0.0;
+        int points = 0;
+    };
+
+    // compute() only on `window`, clipped to the record compute() returns.
+    // The step response comes from a chirp-Z transform of the measured bins,
+    // so the cost follows the measurement and the window rather than the
+    // full record; at distances on compute()'s grid the two agree.
+    Result computeWindow(const Eigen::ArrayXd& frequencyHz,
+                         const Eigen::ArrayXcd& reflection,
+                         const DistanceWindow& window,
+                         const Parameters& params = Parameters()) const;
+
     std::optional<GateResult> applyGate(const Eigen::ArrayXd& frequencyHz,
                                         const Eigen::ArrayXcd& reflection,
                                         double gateStartDistance,
                                         double gateStopDistance,
                                         double epsilonR,
                                         const Parameters& params = Parameters()) const;
+
+    // The FFT plans and Nfft-sized scratch buffers behind compute() and
+    // applyGate() come from a process-wide pool keyed by transform length,
+    // so repeated transforms of the same length reuse them.
+    struct WorkspaceStats
+    {
+        quint64 hits = 0;
+        quint64 misses = 0;
+        std::size_t idle = 0;  // workspaces parked in the pool
+        std::size_t bytes = 0; // scratch memory held by idle workspaces
+
+        double hitRate() const { return hits + misses == 0 ? 0.0 : static_cast<double>(hits) / static_cast<double>(hits + misses); }
+    };
+    static WorkspaceStats workspaceStats();
+    static void resetWorkspaceStats();
 };
 
 #endif // TDRCALCULATOR_H
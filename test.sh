@@ -55,9 +55,18 @@ qmake6
 make -j"$(nproc)"
 
 ./parser_touchstone_tests
+./threadpool_tests
+./plotkernels_tests
+./cascadekernels_tests
+./adaptivesampler_tests
+./touchstone_cache_tests
+./touchstone_registry_tests
 ./tdrcalculator_tests
 QT_QPA_PLATFORM=offscreen ./gui_plot_tests
 ./networkcascade_tests
+./networkconnection_tests
+./networkparameters_tests
+./parametersweep_tests
 ./cascadeio_tests
 ./network_plot_style_tests
 QT_QPA_PLATFORM=offscreen ./parameter_style_dialog_tests
@@ -66,5 +75,6 @@ QT_QPA_PLATFORM=offscreen ./plotmanager_mathplot_tests
 QT_QPA_PLATFORM=offscreen ./plotmanager_tdr_marker_tests
 QT_QPA_PLATFORM=offscreen ./cascade_wheel_tests
 QT_QPA_PLATFORM=offscreen ./plotsettingsdialog_tests
+python3 tests/test_cli_load_errors.py
 
 run_regression_test
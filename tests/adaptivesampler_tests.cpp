@@ -0,0 +1,164 @@
+#include "adaptivesampler.h"
+
+#include <cassert>
+#include <cmath>
+#include <complex>
+#include <iostream>
+#include <limits>
+
+namespace {
+
+using Complex = std::complex<double>;
+
+constexpr double kCenter = 3.30001234e9;
+constexpr double kQ = 2e5;
+
+// Band-stop response of a high-Q series resonator: a notch 16.5 kHz wide.
+Eigen::MatrixXcd notch(const Eigen::VectorXd& freq, int* evaluated = nullptr)
+{
+    Eigen::MatrixXcd response(freq.size(), 1);
+    for (Eigen::Index i = 0; i < freq.size(); ++i) {
+        const double detune = freq(i) / kCenter - kCenter / freq(i);
+        const Complex x(0.0, kQ * detune);
+        response(i, 0) = x / (1.0 + x);
+    }
+    if (evaluated)
+        *evaluated += static_cast<int>(freq.size());
+    return response;
+}
+
+double deepestDb(const Eigen::MatrixXcd& response)
+{
+    return 20.0 * std::log10(response.cwiseAbs().minCoeff());
+}
+
+} // namespace
+
+void test_notch_found_with_few_points()
+{
+    AdaptiveSampler::Settings settings;
+    settings.maxPoints = 1001;
+    int evaluated = 0;
+    const AdaptiveSampler::Result result = AdaptiveSampler::sample(1e9, 6e9, settings,
+        [&](const Eigen::VectorXd& freq) { return notch(freq, &evaluated); });
+
+    assert(result.freq.size() <= settings.maxPoints);
+    assert(result.freq.size() == evaluated);
+    assert(result.response.rows() == result.freq.size());
+    assert(result.freq(0) == 1e9 && result.freq(result.freq.size() - 1) == 6e9);
+    for (Eigen::Index i = 1; i < result.freq.size(); ++i)
+        assert(result.freq(i) > result.freq(i - 1));
+    assert(result.rounds > 0);
+
+    // A uniform grid a hundred times denser still steps over the notch, which
+    // refinement resolves before the budget runs out.
+    const Eigen::VectorXd uniform = Eigen::VectorXd::LinSpaced(100001, 1e9, 6e9);
+    const double uniformDepth = deepestDb(notch(uniform));
+    const double adaptiveDepth = deepestDb(result.response);
+    assert(adaptiveDepth < -40.0);
+    assert(adaptiveDepth < uniformDepth - 20.0);
+    assert(result.freq.size() < 1001);
+
+    // Every sample is the response at its own frequency.
+    assert(result.response.isApprox(notch(result.freq)));
+}
+
+void test_smooth_response_stays_coarse()
+{
+    AdaptiveSampler::Settings settings;
+    settings.initialPoints = 33;
+    settings.maxPoints = 5000;
+    const AdaptiveSampler::Result result = AdaptiveSampler::sample(1e6, 1e9, settings, [](const Eigen::VectorXd& freq) {
+        Eigen::MatrixXcd response(freq.size(), 2);
+        response.col(0).setConstant(Complex(0.5, 0.0));
+        response.col(1) = (freq.array() * 1e-10).cast<Complex>();
+        return response;
+    });
+    // A constant and a straight line are already resolved after one pass.
+    assert(result.rounds == 1);
+    assert(result.freq.size() == 65);
+}
+
+void test_logarithmic_spacing_and_cap()
+{
+    AdaptiveSampler::Settings settings;
+    settings.initialPoints = 3;
+    settings.maxPoints = 50;
+    settings.logarithmic = true;
+    int calls = 0;
+    // A 100 ns delay turns a thousand times over the band; the cap stops it.
+    const AdaptiveSampler::Result result = AdaptiveSampler::sample(1e6, 1e10, settings, [&](const Eigen::VectorXd& freq) {
+        ++calls;
+        Eigen::MatrixXcd response(freq.size(), 1);
+        for (Eigen::Index i = 0; i < freq.size(); ++i)
+            response(i, 0) = std::polar(1.0, -2.0 * M_PI * freq(i) * 100e-9);
+        return response;
+    });
+    assert(result.freq.size() == 50);
+    assert(calls == result.rounds + 1);
+    // Midpoints are geometric, so the first pass adds 1e7 and 1e9.
+    assert(((result.freq.array() / 1e7 - 1.0).abs() < 1e-12).any());
+    assert(((result.freq.array() / 1e9 - 1.0).abs() < 1e-12).any());
+
+    // Failed evaluations return the starting sweep unchanged.
+    const AdaptiveSampler::Result failed = AdaptiveSampler::sample(1e6, 1e10, settings,
+        [](const Eigen::VectorXd&) { return Eigen::MatrixXcd(); });
+    assert(failed.freq.size() == 3 && std::abs(failed.freq(1) / 1e8 - 1.0) < 1e-12);
+    assert(failed.response.size() == 0);
+}
+
+void test_non_finite_samples_are_refined()
+{
+    AdaptiveSampler::Settings settings;
+    settings.initialPoints = 2;
+    settings.maxPoints = 80;
+    // Flat except for a pole right at the first midpoint.
+    const AdaptiveSampler::Result result = AdaptiveSampler::sample(1.0, 3.0, settings, [](const Eigen::VectorXd& freq) {
+        Eigen::MatrixXcd response(freq.size(), 1);
+        for (Eigen::Index i = 0; i < freq.size(); ++i)
+            response(i, 0) = freq(i) == 2.0 ? Complex(std::numeric_limits<double>::infinity(), 0.0) : Complex(0.5, 0.0);
+        return response;
+    });
+    assert(result.freq.size() == settings.maxPoints);
+    double below = 0.0;
+    double above = 4.0;
+    for (Eigen::Index i = 0; i < result.freq.size(); ++i) {
+        if (result.freq(i) < 2.0)
+            below = std::max(below, result.freq(i));
+        else if (result.freq(i) > 2.0)
+            above = std::min(above, result.freq(i));
+    }
+    assert(2.0 - below < 1e-4 && above - 2.0 < 1e-4);
+}
+
+void test_memo_reuses_until_version_changes()
+{
+    AdaptiveSampler::Memo memo;
+    AdaptiveSampler::Settings settings;
+    settings.maxPoints = 300;
+    int calls = 0;
+    const AdaptiveSampler::Evaluate evaluate = [&](const Eigen::VectorXd& freq) {
+        ++calls;
+        return notch(freq);
+    };
+    const auto first = memo.get(1, 1e9, 6e9, settings, evaluate);
+    const int callsAfterFirst = calls;
+    assert(memo.get(1, 1e9, 6e9, settings, evaluate) == first);
+    assert(calls == callsAfterFirst);
+    assert(memo.get(2, 1e9, 6e9, settings, evaluate) != first);
+    settings.tolerance = 1e-2;
+    const auto loose = memo.get(2, 1e9, 6e9, settings, evaluate);
+    assert(loose->freq.size() <= 300);
+    assert(calls > 2 * callsAfterFirst);
+}
+
+int main()
+{
+    test_notch_found_with_few_points();
+    test_smooth_response_stays_coarse();
+    test_logarithmic_spacing_and_cap();
+    test_non_finite_samples_are_refined();
+    test_memo_reuses_until_version_changes();
+    std::cout << "All adaptive sampler tests passed." << std::endl;
+    return 0;
+}
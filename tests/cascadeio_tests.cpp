@@ -1,9 +1,12 @@
 #include "cascadeio.h"
 #include "networkcascade.h"
 #include "networkfile.h"
+#include "networklumped.h"
+#include "parametersweep.h"
 #include "parser_touchstone.h"
 
 #include <QTemporaryDir>
+#include <QFile>
 #include <QFileInfo>
 
 #include <cassert>
@@ -74,6 +77,30 @@ int main()
         return 1;
     }
 
+    NetworkLumped series(NetworkLumped::NetworkType::R_series, {10.0});
+    cascade.addNetwork(&series);
+    const ParameterSweep::Result sweep = ParameterSweep::run(cascade, {{1, 0, 10.0, 40.0, 4, false}}, 1, freq);
+    QString sweepPath;
+    if (!saveSweepToFile(sweep, tempDir.path() + QStringLiteral("/sweep"), &sweepPath, &errorMessage)) {
+        std::cerr << errorMessage.toStdString() << std::endl;
+        return 1;
+    }
+
+    QFile sweepFile(sweepPath);
+    if (!sweepPath.endsWith(QStringLiteral(".csv")) || !sweepFile.open(QIODevice::ReadOnly)) {
+        std::cerr << "Expected the sweep to be saved as CSV" << std::endl;
+        return 1;
+    }
+    const QList<QByteArray> lines = sweepFile.readAll().trimmed().split('\n');
+    if (lines.size() != 1 + 4 * freq.size() || !lines.first().endsWith("frequency_hz,S21_re,S21_im,S21_db,S21_deg")) {
+        std::cerr << "Unexpected sweep file layout" << std::endl;
+        return 1;
+    }
+    if (lines.last().split(',').first().toDouble() != 40.0) {
+        std::cerr << "Expected the last block to hold the last swept value" << std::endl;
+        return 1;
+    }
+
     cascade.clearNetworks();
     return 0;
 }
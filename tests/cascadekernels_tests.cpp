@@ -0,0 +1,149 @@
+#include "cascadekernels.h"
+
+#include <cassert>
+#include <cmath>
+#include <complex>
+#include <iostream>
+#include <limits>
+#include <random>
+
+namespace {
+
+using CascadeKernels::Blocks;
+
+Eigen::Matrix2cd blockAt(const Blocks& blocks, Eigen::Index row)
+{
+    using namespace CascadeKernels;
+    Eigen::Matrix2cd block;
+    block << std::complex<double>(blocks.re(row, S11), blocks.im(row, S11)),
+             std::complex<double>(blocks.re(row, S12), blocks.im(row, S12)),
+             std::complex<double>(blocks.re(row, S21), blocks.im(row, S21)),
+             std::complex<double>(blocks.re(row, S22), blocks.im(row, S22));
+    return block;
+}
+
+Blocks random_blocks(Eigen::Index rows, unsigned seed)
+{
+    std::mt19937 rng(seed);
+    std::uniform_real_distribution<double> value(-0.9, 0.9);
+    Blocks blocks;
+    blocks.resize(rows);
+    for (Eigen::Index r = 0; r < rows; ++r) {
+        for (Eigen::Index c = 0; c < 4; ++c) {
+            blocks.re(r, c) = value(rng);
+            blocks.im(r, c) = value(rng);
+        }
+    }
+    return blocks;
+}
+
+bool close(const Eigen::Matrix2cd& a, const Eigen::Matrix2cd& b)
+{
+    for (Eigen::Index i = 0; i < 4; ++i) {
+        const std::complex<double> x = a(i);
+        const std::complex<double> y = b(i);
+        if (std::abs(x - y) > 1e-13 * (1.0 + std::abs(y)))
+            return false;
+    }
+    return true;
+}
+
+} // namespace
+
+void test_batched_matches_scalar()
+{
+    const Eigen::Index rows = 1000;
+    const Blocks left = random_blocks(rows, 1);
+    const Blocks right = random_blocks(rows, 2);
+    Blocks out;
+    out.resize(rows);
+    // Two calls cover a range that starts and ends inside a pass.
+    CascadeKernels::star(left, right, out, 0, 300);
+    CascadeKernels::star(left, right, out, 300, rows);
+    for (Eigen::Index r = 0; r < rows; ++r)
+        assert(close(blockAt(out, r), CascadeKernels::star(blockAt(left, r), blockAt(right, r))));
+}
+
+void test_regularization_matches_scalar()
+{
+    using namespace CascadeKernels;
+    // Denominators of magnitude offset, either side of the threshold.
+    const double offsets[] = {0.0, 1e-19, -5e-19, 9.99e-19, 1e-18, 1.01e-18, 2e-18, 1e-12, 1e-200};
+    const Eigen::Index rows = sizeof(offsets) / sizeof(offsets[0]);
+    Blocks left;
+    Blocks right;
+    left.resize(rows);
+    right.resize(rows);
+    left.re.setConstant(0.5);
+    left.im.setConstant(0.1);
+    right.re.setConstant(0.3);
+    right.im.setConstant(-0.2);
+    for (Eigen::Index r = 0; r < rows; ++r) {
+        left.re(r, S22) = 1.0;
+        left.im(r, S22) = 0.0;
+        right.re(r, S11) = 1.0;
+        right.im(r, S11) = offsets[r];
+    }
+
+    Blocks out;
+    out.resize(rows);
+    star(left, right, out, 0, rows);
+    for (Eigen::Index r = 0; r < rows; ++r) {
+        const Eigen::Matrix2cd expected = star(blockAt(left, r), blockAt(right, r));
+        assert(close(blockAt(out, r), expected));
+        assert(std::isfinite(out.re(r, S12)));
+    }
+}
+
+void test_extreme_denominators_match_scalar()
+{
+    using namespace CascadeKernels;
+    // S22(left) sets 1 - S22(left) * S11(right) over the whole double range.
+    const std::complex<double> s22[] = {{1e155, 0.0}, {-3e200, 2e199}, {0.0, 1e300}, {1e-17, 1e308},
+                                        {1.0 + 2e-18, 0.0}, {1.0, -5e-18}, {1.0 - 1e-160, 1e-160}};
+    const Eigen::Index rows = sizeof(s22) / sizeof(s22[0]);
+    Blocks left = random_blocks(rows, 5);
+    const Blocks right = random_blocks(rows, 6);
+    Blocks one = right;
+    for (Eigen::Index r = 0; r < rows; ++r) {
+        left.re(r, S22) = s22[r].real();
+        left.im(r, S22) = s22[r].imag();
+        one.re(r, S11) = 1.0;
+        one.im(r, S11) = 0.0;
+    }
+
+    Blocks out;
+    out.resize(rows);
+    const Blocks* operands[] = {&right, &one};
+    for (const Blocks* operand : operands) {
+        star(left, *operand, out, 0, rows);
+        for (Eigen::Index r = 0; r < rows; ++r) {
+            const Eigen::Matrix2cd expected = star(blockAt(left, r), blockAt(*operand, r));
+            assert(expected.allFinite());
+            assert(close(blockAt(out, r), expected));
+        }
+    }
+}
+
+void test_non_finite_inputs_propagate()
+{
+    using namespace CascadeKernels;
+    Blocks left = random_blocks(4, 3);
+    const Blocks right = random_blocks(4, 4);
+    left.re(2, S22) = std::numeric_limits<double>::quiet_NaN();
+    Blocks out;
+    out.resize(4);
+    star(left, right, out, 0, 4);
+    assert(std::isnan(out.re(2, S12)));
+    assert(std::isfinite(out.re(1, S12)));
+}
+
+int main()
+{
+    test_batched_matches_scalar();
+    test_regularization_matches_scalar();
+    test_extreme_denominators_match_scalar();
+    test_non_finite_inputs_propagate();
+    std::cout << "All cascade kernel tests passed." << std::endl;
+    return 0;
+}
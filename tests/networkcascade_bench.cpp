@@ -0,0 +1,219 @@
+// Scaling of NetworkCascade::sparameters over thread counts: a 20-stage
+// cascade of lumped sections evaluated on a dense grid, checked against the
+// single-threaded result at every thread count, followed by the cost of
+// re-evaluating after one stage is edited, the same for a 500-stage ladder, and
+// a single-threaded comparison of the batched star kernel with the per-point
+// Matrix2cd product, the closed-form lumped element kernels against the
+// per-point ABCD conversion, and a chain of four 9-ports joined four ports at
+// a time by NetworkConnection (run from the repository root for the fixture).
+// Usage: networkcascade_bench [points] [stages]
+#include "cascadekernels.h"
+#include "networkcascade.h"
+#include "networkconnection.h"
+#include "networkfile.h"
+#include "networklumped.h"
+#include "threadpool.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+#include <random>
+#include <memory>
+#include <vector>
+
+namespace {
+
+template <typename Fn>
+double best_of(int repeats, Fn&& fn) {
+    double best = 1e300;
+    for (int i = 0; i < repeats; ++i) {
+        const auto start = std::chrono::steady_clock::now();
+        fn();
+        const std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+        best = std::min(best, elapsed.count());
+    }
+    return best;
+}
+
+} // namespace
+
+int main(int argc, char* argv[]) {
+    const int points = argc > 1 ? std::atoi(argv[1]) : 100000;
+    const int stageCount = argc > 2 ? std::atoi(argv[2]) : 20;
+
+    std::vector<std::unique_ptr<NetworkLumped>> stages;
+    for (int i = 0; i < stageCount; ++i) {
+        switch (i % 4) {
+        case 0:
+            stages.push_back(std::make_unique<NetworkLumped>(NetworkLumped::NetworkType::TransmissionLine,
+                                                             std::initializer_list<double>{5.0 + i, 45.0 + i, 2.0}));
+            break;
+        case 1:
+            stages.push_back(std::make_unique<NetworkLumped>(NetworkLumped::NetworkType::C_shunt,
+                                                             std::initializer_list<double>{0.1 * i}));
+            break;
+        case 2:
+            stages.push_back(std::make_unique<NetworkLumped>(NetworkLumped::NetworkType::L_series,
+                                                             std::initializer_list<double>{0.2 * i, 0.5}));
+            break;
+        default:
+            stages.push_back(std::make_unique<NetworkLumped>(NetworkLumped::NetworkType::R_shunt,
+                                                             std::initializer_list<double>{1000.0 + i}));
+            break;
+        }
+    }
+
+    // A new cascade per run, so nothing is reused from the previous one.
+    auto evaluateCold = [&](const Eigen::VectorXd& freq) {
+        NetworkCascade cascade;
+        for (const auto& stage : stages)
+            cascade.addNetwork(stage.get());
+        return cascade.sparameters(freq);
+    };
+
+    const Eigen::VectorXd freq = Eigen::VectorXd::LinSpaced(points, 1e6, 40e9);
+    std::cout << "cascade: " << stageCount << " stages, " << points << " points" << std::endl;
+
+    NetworkCascade::setThreadCount(1);
+    Eigen::MatrixXcd reference;
+    const double serial_s = best_of(3, [&] { reference = evaluateCold(freq); });
+    std::cout << "1 thread: " << serial_s * 1e3 << " ms" << std::endl;
+
+    const unsigned max_threads = ThreadPool::global().threadCount();
+    for (unsigned threads = 2; threads <= max_threads; ++threads) {
+        NetworkCascade::setThreadCount(threads);
+        Eigen::MatrixXcd result;
+        const double parallel_s = best_of(3, [&] { result = evaluateCold(freq); });
+        const bool identical = (result.array() == reference.array()).all();
+        std::cout << threads << " threads: " << parallel_s * 1e3 << " ms, scaling "
+                  << serial_s / parallel_s << "x, " << (identical ? "identical" : "MISMATCH") << std::endl;
+        if (!identical)
+            return 1;
+    }
+
+    // Cascades keep their partial products only up to a memory budget, so the
+    // edit is measured on a grid small enough to stay cached.
+    NetworkCascade::setThreadCount(0);
+    const Eigen::VectorXd editFreq = Eigen::VectorXd::LinSpaced(std::min(points, 10000), 1e6, 40e9);
+    const double cold_s = best_of(3, [&] { reference = evaluateCold(editFreq); });
+    NetworkCascade cascade;
+    for (const auto& stage : stages)
+        cascade.addNetwork(stage.get());
+    cascade.sparameters(editFreq);
+    NetworkLumped* edited = stages[stages.size() / 2].get();
+    double value = edited->parameterValue(0);
+    Eigen::MatrixXcd incremental;
+    const double edit_s = best_of(3, [&] {
+        value *= 1.01;
+        edited->setParameterValue(0, value);
+        incremental = cascade.sparameters(editFreq);
+    });
+    const bool identical = (incremental.array() == evaluateCold(editFreq).array()).all();
+    std::cout << editFreq.size() << " points, full evaluation: " << cold_s * 1e3 << " ms, one stage edited: "
+              << edit_s * 1e3 << " ms, " << (identical ? "identical" : "MISMATCH") << std::endl;
+    if (!identical)
+        return 1;
+
+    // A 500-stage LC ladder on the GUI's default grid, evaluated from scratch
+    // and after one element is nudged as the mouse wheel does.
+    std::vector<std::unique_ptr<NetworkLumped>> ladder;
+    NetworkCascade ladderCascade;
+    for (int i = 0; i < 500; ++i) {
+        if (i % 2 == 0)
+            ladder.push_back(std::make_unique<NetworkLumped>(NetworkLumped::NetworkType::L_series,
+                                                             std::initializer_list<double>{0.5, 0.01}));
+        else
+            ladder.push_back(std::make_unique<NetworkLumped>(NetworkLumped::NetworkType::C_shunt,
+                                                             std::initializer_list<double>{0.2}));
+        ladderCascade.addNetwork(ladder.back().get());
+    }
+    const Eigen::VectorXd ladderFreq = Eigen::VectorXd::LinSpaced(2001, 1e6, 10e9);
+    const double ladder_s = best_of(1, [&] { ladderCascade.sparameters(ladderFreq); });
+    double inductance = 0.5;
+    const double ladder_edit_s = best_of(3, [&] {
+        inductance *= 1.01;
+        ladder[250]->setParameterValue(0, inductance);
+        ladderCascade.sparameters(ladderFreq);
+    });
+    std::cout << "500-stage ladder, " << ladderFreq.size() << " points: " << ladder_s * 1e3
+              << " ms, one element edited: " << ladder_edit_s * 1e3 << " ms" << std::endl;
+
+    std::mt19937 rng(1);
+    std::uniform_real_distribution<double> sample(-0.9, 0.9);
+    CascadeKernels::Blocks left;
+    CascadeKernels::Blocks right;
+    CascadeKernels::Blocks out;
+    left.resize(points);
+    right.resize(points);
+    out.resize(points);
+    for (Eigen::Index c = 0; c < 4; ++c) {
+        for (Eigen::Index r = 0; r < points; ++r) {
+            left.re(r, c) = sample(rng);
+            left.im(r, c) = sample(rng);
+            right.re(r, c) = sample(rng);
+            right.im(r, c) = sample(rng);
+        }
+    }
+    const Eigen::MatrixXcd leftPacked = left.re.matrix() + std::complex<double>(0.0, 1.0) * left.im.matrix();
+    const Eigen::MatrixXcd rightPacked = right.re.matrix() + std::complex<double>(0.0, 1.0) * right.im.matrix();
+    Eigen::MatrixXcd scalar(points, 4);
+    const double scalar_s = best_of(3, [&] {
+        for (Eigen::Index r = 0; r < points; ++r) {
+            Eigen::Matrix2cd a;
+            Eigen::Matrix2cd b;
+            a << leftPacked(r, 0), leftPacked(r, 2), leftPacked(r, 1), leftPacked(r, 3);
+            b << rightPacked(r, 0), rightPacked(r, 2), rightPacked(r, 1), rightPacked(r, 3);
+            const Eigen::Matrix2cd product = CascadeKernels::star(a, b);
+            scalar.row(r) << product(0, 0), product(1, 0), product(0, 1), product(1, 1);
+        }
+    });
+    const double batched_s = best_of(3, [&] { CascadeKernels::star(left, right, out, 0, points); });
+    const double difference = (scalar.real().array() - out.re).abs().maxCoeff();
+    std::cout << "star kernel, " << points << " points: scalar " << scalar_s * 1e3 << " ms, batched "
+              << batched_s * 1e3 << " ms, speedup " << scalar_s / batched_s << "x, max difference "
+              << difference << std::endl;
+
+    // Each lumped element type on the full grid: the per-point ABCD path the
+    // elements used to take against the closed-form kernels.
+    const std::vector<std::pair<NetworkLumped::NetworkType, QVector<double>>> elementTypes = {
+        {NetworkLumped::NetworkType::R_series, {25.0}},
+        {NetworkLumped::NetworkType::C_shunt, {0.5}},
+        {NetworkLumped::NetworkType::L_series, {2.0, 0.3}},
+        {NetworkLumped::NetworkType::TransmissionLine, {30.0, 60.0, 2.0}},
+        {NetworkLumped::NetworkType::TransmissionLineLossy, {30.0, 60.0, 2.0, 0.5, 0.2, 1e9}},
+        {NetworkLumped::NetworkType::RLC_series_shunt, {1.0, 2.0, 0.5}},
+        {NetworkLumped::NetworkType::RLC_parallel_series, {200.0, 3.0, 0.4}},
+    };
+    for (const auto& [type, values] : elementTypes) {
+        const NetworkLumped element(type, values);
+        Eigen::MatrixXcd perPoint(points, 4);
+        const double perPoint_s = best_of(3, [&] {
+            for (Eigen::Index r = 0; r < points; ++r) {
+                const Eigen::Vector4cd s = Network::abcd2s(element.abcdParameters(freq(r)));
+                perPoint.row(r) << s(0), s(2), s(1), s(3);
+            }
+        });
+        Eigen::MatrixXcd kernel;
+        const double kernel_s = best_of(3, [&] { kernel = element.sparameters(freq); });
+        std::cout << element.displayName().toStdString() << " kernel, " << points << " points: per point " << perPoint_s * 1e3
+                  << " ms, closed form " << kernel_s * 1e3 << " ms, speedup " << perPoint_s / kernel_s
+                  << "x, max difference " << (perPoint - kernel).cwiseAbs().maxCoeff() << std::endl;
+    }
+
+    NetworkFile ninePort(QStringLiteral("test/a (11).s9p"));
+    if (ninePort.portCount() != 9)
+        return 0;
+    NetworkConnection chain;
+    for (int n = 0; n < 4; ++n) {
+        chain.addNetwork(&ninePort);
+        for (int p = 1; n > 0 && p <= 4; ++p)
+            chain.connect(n - 1, 4 + p, n, p);
+    }
+    const Eigen::VectorXd chainFreq = Eigen::VectorXd::LinSpaced(10000, ninePort.fmin(), ninePort.fmax());
+    Eigen::MatrixXcd chained;
+    const double chain_s = best_of(3, [&] { chained = chain.sparameters(chainFreq); });
+    std::cout << "4 x s9p chain, " << chainFreq.size() << " points, " << chain.portCount() << " external ports: "
+              << chain_s * 1e3 << " ms" << std::endl;
+    return 0;
+}
@@ -1,11 +1,19 @@
+#include "cascadekernels.h"
 #include "networkcascade.h"
 #include "networkfile.h"
 #include "networklumped.h"
+#include "plotdatacache.h"
 #include <Eigen/Dense>
+#include <algorithm>
 #include <cassert>
 #include <complex>
+#include <cstdio>
+#include <fstream>
+#include <functional>
 #include <iostream>
+#include <memory>
 #include <cmath>
+#include <vector>
 
 void test_cascade_two_files()
 {
@@ -70,15 +78,16 @@ Eigen::ArrayXd unwrap_degrees(const QVector<double>& phase_deg)
 
     Eigen::ArrayXd phase_rad = Eigen::Map<const Eigen::ArrayXd>(phase_deg.constData(), phase_deg.size()) * (pi / 180.0);
     Eigen::ArrayXd unwrapped = phase_rad;
+    double offset = 0.0;
     for (int i = 1; i < unwrapped.size(); ++i) {
-        double diff = unwrapped(i) - unwrapped(i - 1);
-        if (diff > pi) {
-            for (int j = i; j < unwrapped.size(); ++j)
-                unwrapped(j) -= 2.0 * pi;
-        } else if (diff < -pi) {
-            for (int j = i; j < unwrapped.size(); ++j)
-                unwrapped(j) += 2.0 * pi;
-        }
+        // Jumps are judged on the wrapped samples, so steps of exactly pi do
+        // not depend on how the accumulated offset rounds.
+        double diff = phase_rad(i) - phase_rad(i - 1);
+        if (diff > pi)
+            offset -= 2.0 * pi;
+        else if (diff < -pi)
+            offset += 2.0 * pi;
+        unwrapped(i) = phase_rad(i) + offset;
     }
     return unwrapped * (180.0 / pi);
 }
@@ -156,16 +165,169 @@ void test_cascade_manual_range_persistence()
     assert(std::abs(freqs.last() - 5e6) < 1e-6);
 }
 
+void test_cascade_frequency_plans()
+{
+    NetworkFile first(QStringLiteral("test/a (1).s2p"));
+    NetworkFile second(QStringLiteral("test/a (2).s2p"));
+    NetworkCascade cascade;
+    cascade.setFrequencyRange(1e6, 1e9);
+    cascade.setPointCount(4);
+
+    cascade.setFrequencyPlan(NetworkCascade::FrequencyPlan::Logarithmic);
+    const Eigen::VectorXd log = cascade.frequencyVector();
+    assert(log.size() == 4);
+    assert(log(0) == 1e6 && log(3) == 1e9);
+    assert(std::abs(log(1) - 1e7) < 1e-3 && std::abs(log(2) - 1e8) < 1e-2);
+
+    // A single file's own grid is used as is, so it is not interpolated.
+    cascade.addNetwork(&first);
+    cascade.clearManualFrequencyRange();
+    cascade.setFrequencyPlan(NetworkCascade::FrequencyPlan::Native);
+    const QVector<double> native = first.frequencies();
+    const Eigen::VectorXd grid = cascade.frequencyVector();
+    assert(grid.size() == native.size());
+    for (int i = 0; i < native.size(); ++i)
+        assert(grid(i) == native.at(i));
+    assert(cascade.sparameters(grid).isApprox(first.sparameters(grid), 1e-15));
+    assert(cascade.getPlotData(1, PlotType::Magnitude).first.size() == native.size());
+
+    // Two grids are merged, and a manual range clips the union.
+    cascade.addNetwork(&second);
+    const Eigen::VectorXd merged = cascade.frequencyVector();
+    assert(merged.size() >= second.frequencies().size());
+    assert(merged.size() < native.size() + second.frequencies().size());
+    for (Eigen::Index i = 1; i < merged.size(); ++i)
+        assert(merged(i) > merged(i - 1));
+    cascade.setFrequencyRange(1e9, 2e9);
+    const Eigen::VectorXd clipped = cascade.frequencyVector();
+    assert(clipped.size() > 0 && clipped.size() < merged.size());
+    assert(clipped.minCoeff() >= 1e9 && clipped.maxCoeff() <= 2e9);
+
+    QVector<NetworkCascade::FrequencySegment> segments;
+    assert(NetworkCascade::parseFrequencySegments(QStringLiteral("1e6:1e9:11, 1e9:100e9:3:log"), segments));
+    assert(segments.size() == 2 && segments.at(1).logarithmic && !segments.at(0).logarithmic);
+    assert(!NetworkCascade::parseFrequencySegments(QStringLiteral("1e6:1e9"), segments));
+    assert(!NetworkCascade::parseFrequencySegments(QStringLiteral("1e9:1e6:11"), segments));
+    assert(!NetworkCascade::parseFrequencySegments(QStringLiteral("0:1e9:11:log"), segments));
+    assert(segments.size() == 2);
+    cascade.setFrequencySegments(segments);
+    cascade.setFrequencyPlan(NetworkCascade::FrequencyPlan::Segments);
+    const Eigen::VectorXd segmented = cascade.frequencyVector();
+    assert(segmented.size() == 13);     // the shared 1 GHz point once
+    assert(segmented(10) == 1e9 && std::abs(segmented(11) - 1e10) < 1e-3 && segmented(12) == 100e9);
+
+    std::unique_ptr<Network> copy(cascade.clone());
+    auto* copied = static_cast<NetworkCascade*>(copy.get());
+    assert(copied->frequencyPlan() == NetworkCascade::FrequencyPlan::Segments);
+    assert(copied->frequencySegments() == segments);
+    cascade.clearNetworks();
+}
+
+void test_adaptive_sampling_resolves_notch()
+{
+    // A 1 mOhm series RLC to ground notches S21 by 88 dB over some 100 kHz
+    // near 5.03 GHz.
+    NetworkLumped trap(NetworkLumped::NetworkType::RLC_series_shunt, {1e-3, 1.0, 1.0});
+    NetworkLumped line(NetworkLumped::NetworkType::TransmissionLine, {20.0, 50.0, 1.0});
+    NetworkCascade cascade;
+    cascade.addNetwork(&line);
+    cascade.addNetwork(&trap);
+    cascade.setFrequencyRange(1e9, 9e9);
+    cascade.setPointCount(1001);
+
+    auto deepest = [](const QVector<double>& db) { return *std::min_element(db.cbegin(), db.cend()); };
+    const auto uniform = cascade.getPlotData(1, PlotType::Magnitude);
+    cascade.setFrequencyPlan(NetworkCascade::FrequencyPlan::Adaptive);
+    const auto adaptive = cascade.getPlotData(1, PlotType::Magnitude);
+    assert(adaptive.first.size() <= 1001);
+    assert(deepest(adaptive.second) < -80.0);
+    assert(deepest(adaptive.second) < deepest(uniform.second) - 20.0);
+
+    // The grid is reused until a stage changes.
+    const Eigen::VectorXd grid = cascade.frequencyVector();
+    assert(grid.size() == adaptive.first.size());
+    assert(grid(0) == 1e9 && grid(grid.size() - 1) == 9e9);
+    assert(cascade.frequencies() == adaptive.first);
+    trap.setParameterValue(1, 2.0);
+    const Eigen::VectorXd edited = cascade.frequencyVector();
+    assert(edited.size() != grid.size() || edited != grid);
+
+    trap.setFmin(1e9);
+    trap.setFmax(9e9);
+    trap.setAdaptiveSampling(true);
+    const auto single = trap.getPlotData(1, PlotType::Magnitude);
+    assert(single.first.size() <= trap.pointCount());
+    assert(single.first == trap.frequencies());
+    assert(deepest(single.second) < -80.0);
+    std::unique_ptr<Network> copy(trap.clone());
+    assert(static_cast<NetworkLumped*>(copy.get())->adaptiveSampling());
+    cascade.clearNetworks();
+}
+
+void test_plot_data_on_zoomed_grid()
+{
+    NetworkLumped trap(NetworkLumped::NetworkType::RLC_series_shunt, {1e-3, 1.0, 1.0});
+    NetworkLumped line(NetworkLumped::NetworkType::TransmissionLine, {20.0, 50.0, 1.0});
+    NetworkCascade cascade;
+    cascade.addNetwork(&line);
+    cascade.addNetwork(&trap);
+    cascade.setFrequencyRange(1e9, 9e9);
+    cascade.setPointCount(1001);
+    const auto full = cascade.getPlotData(1, PlotType::Magnitude);
+
+    // The visible band at the configured density, from a snapshot.
+    const Eigen::VectorXd band = NetworkCascade::sweepFrequencies(5.02e9, 5.05e9, cascade.pointCount(), false);
+    std::unique_ptr<Network> snapshot(cascade.clone());
+    const auto zoomed = snapshot->plotDataOnGrid(1, PlotType::Magnitude, band);
+    assert(zoomed.first.size() == 1001);
+    assert(zoomed.first.first() == 5.02e9 && zoomed.first.last() == 5.05e9);
+    const Eigen::MatrixXcd expected = cascade.sparameters(band);
+    for (int i = 0; i < zoomed.second.size(); ++i)
+        assert(std::abs(zoomed.second.at(i) - 20.0 * std::log10(std::abs(expected(i, 1)))) < 1e-9);
+    const double deepest = *std::min_element(zoomed.second.cbegin(), zoomed.second.cend());
+    assert(deepest < *std::min_element(full.second.cbegin(), full.second.cend()) - 20.0);
+
+    assert(trap.plotDataOnGrid(7, PlotType::Magnitude, band).first.isEmpty());
+    assert(trap.plotDataOnGrid(0, PlotType::Phase, band).second.size() == 1001);
+    // The full-span data is still served by the cache.
+    assert(cascade.getPlotData(1, PlotType::Magnitude) == full);
+    cascade.clearNetworks();
+}
+
+void test_tdr_on_zoomed_window()
+{
+    NetworkLumped line(NetworkLumped::NetworkType::TransmissionLine, {30.0, 50.0, 1.0});
+    NetworkLumped load(NetworkLumped::NetworkType::R_shunt, {25.0});
+    NetworkCascade cascade;
+    cascade.addNetwork(&line);
+    cascade.addNetwork(&load);
+    cascade.setFrequencyRange(10e6, 10e9);
+    cascade.setPointCount(1000);
+    const auto full = cascade.getPlotData(0, PlotType::TDR);
+    assert(full.first.size() > 600);
+
+    std::unique_ptr<Network> snapshot(cascade.clone());
+    const auto zoomed = snapshot->tdrOnWindow(0, full.first.at(100), full.first.at(600), 501);
+    assert(zoomed.first.size() == 501);
+    for (int i = 0; i < zoomed.first.size(); ++i) {
+        assert(std::abs(zoomed.first.at(i) - full.first.at(100 + i)) < 1e-12);
+        assert(std::abs(zoomed.second.at(i) - full.second.at(100 + i)) < 1e-8);
+    }
+    assert(cascade.tdrOnWindow(1, 0.0, 0.1, 101).first.isEmpty());
+    cascade.clearNetworks();
+}
+
 void test_lumped_phase_unwrap_matches_manual()
 {
     NetworkLumped transmissionLine(NetworkLumped::NetworkType::TransmissionLine,
                                    {100.0, 50.0, 2.5});
 
+    // S21: a matched line's S11 is exactly zero and has no phase to unwrap.
     transmissionLine.setUnwrapPhase(false);
-    const auto wrapped = transmissionLine.getPlotData(0, PlotType::Phase);
+    const auto wrapped = transmissionLine.getPlotData(1, PlotType::Phase);
 
     transmissionLine.setUnwrapPhase(true);
-    const auto unwrapped = transmissionLine.getPlotData(0, PlotType::Phase);
+    const auto unwrapped = transmissionLine.getPlotData(1, PlotType::Phase);
 
     assert(unwrapped.second.size() == wrapped.second.size());
     Eigen::ArrayXd manual = unwrap_degrees(wrapped.second);
@@ -393,6 +555,445 @@ void test_cascade_phase_unwrap_matches_manual()
     assert(differenceFound);
 }
 
+void test_network_file_loads_on_demand()
+{
+    NetworkFile net(QStringLiteral("test/a (12).s6p"));
+    assert(!net.isLoaded());
+    assert(net.portCount() == 6);
+    assert(net.pointCount() > 0);
+    const double probedMin = net.fmin();
+    const double probedMax = net.fmax();
+
+    const QVector<double> freqs = net.frequencies();
+    assert(net.isLoaded());
+    assert(net.portCount() == 6);
+    assert(net.pointCount() == freqs.size());
+    assert(probedMin == *std::min_element(freqs.begin(), freqs.end()));
+    assert(probedMax == *std::max_element(freqs.begin(), freqs.end()));
+
+    assert(net.loadError().isEmpty());
+
+    NetworkFile missing(QStringLiteral("test/does_not_exist.s2p"));
+    assert(missing.isLoaded());
+    assert(missing.portCount() == 0);
+    assert(missing.frequencies().isEmpty());
+    assert(!missing.loadError().isEmpty());
+
+    // The header and both end rows probe fine; a middle row is cut short.
+    const QString broken = QStringLiteral("test/broken_body_tmp.s2p");
+    {
+        std::ofstream out(broken.toStdString(), std::ios::binary | std::ios::trunc);
+        out << "# GHZ S DB R 50\n"
+               "1 -30 10 -0.5 -20 -0.5 -20 -30 10\n"
+               "2 -30 10 -0.5\n"
+               "3 -30 10 -0.5 -20 -0.5 -20 -30 10\n";
+    }
+    NetworkFile truncated(broken);
+    assert(truncated.portCount() == 2);
+    assert(truncated.loadError().isEmpty());
+    truncated.load();
+    assert(!truncated.loadError().isEmpty());
+    assert(truncated.frequencies().isEmpty());
+    std::remove(broken.toStdString().c_str());
+}
+
+// Per-point magnitude/phase interpolation as NetworkFile did before plans.
+std::complex<double> reference_interpolation(const Eigen::VectorXd& freqs, const Eigen::VectorXcd& column, double f)
+{
+    const Eigen::Index last = freqs.size() - 1;
+    if (f <= freqs(0))
+        return column(0);
+    if (f >= freqs(last))
+        return column(last);
+    const double* it = std::lower_bound(freqs.data(), freqs.data() + freqs.size(), f);
+    const Eigen::Index upper = std::max<Eigen::Index>(it - freqs.data(), 1);
+    const Eigen::Index lower = upper - 1;
+    if (freqs(upper) == freqs(lower))
+        return column(lower);
+    double phase1 = std::arg(column(lower));
+    double phase2 = std::arg(column(upper));
+    if (phase2 - phase1 > M_PI)
+        phase2 -= 2 * M_PI;
+    else if (phase1 - phase2 > M_PI)
+        phase1 -= 2 * M_PI;
+    const double t = (f - freqs(lower)) / (freqs(upper) - freqs(lower));
+    const double mag1 = std::abs(column(lower));
+    const double mag2 = std::abs(column(upper));
+    return std::polar(mag1 + t * (mag2 - mag1), phase1 + t * (phase2 - phase1));
+}
+
+void test_network_file_interpolation_plans()
+{
+    NetworkFile net(QStringLiteral("test/a (12).s6p"));
+    const QVector<double> native = net.frequencies();
+    const Eigen::VectorXd freqs = Eigen::Map<const Eigen::VectorXd>(native.data(), native.size());
+    const Eigen::MatrixXcd samples = net.sparameters(freqs);
+    assert(samples.rows() == freqs.size());
+    assert(samples.cols() == 36);
+
+    const double span = freqs(freqs.size() - 1) - freqs(0);
+    Eigen::VectorXd dense = Eigen::VectorXd::LinSpaced(997, freqs(0) - 0.05 * span, freqs(freqs.size() - 1) + 0.05 * span);
+    Eigen::VectorXd shuffled = dense.reverse();
+    std::swap(shuffled(3), shuffled(500));
+    Eigen::VectorXd onSamples = freqs.segment(1, freqs.size() - 2);
+
+    for (const Eigen::VectorXd* grid : {&dense, &shuffled, &onSamples}) {
+        const Eigen::MatrixXcd planned = net.sparameters(*grid);
+        // A second call reuses the cached plan.
+        assert((net.sparameters(*grid).array() == planned.array()).all());
+        for (Eigen::Index col = 0; col < planned.cols(); ++col) {
+            const Eigen::VectorXcd column = samples.col(col);
+            for (Eigen::Index i = 0; i < grid->size(); ++i)
+                assert(planned(i, col) == reference_interpolation(freqs, column, (*grid)(i)));
+        }
+    }
+}
+
+void test_network_file_clones_share_data()
+{
+    NetworkFile net(QStringLiteral("test/a (1).s2p"));
+    NetworkFile duplicate(QStringLiteral("test/a (1).s2p"));
+    const QVector<double> freqs = net.frequencies();
+    assert(duplicate.frequencies() == freqs);
+
+    std::unique_ptr<Network> copy(net.clone());
+    auto* fileCopy = static_cast<NetworkFile*>(copy.get());
+    assert(fileCopy->isLoaded());
+    assert(fileCopy->frequencies() == freqs);
+    assert(fileCopy->portCount() == net.portCount());
+
+    const Eigen::VectorXd grid = Eigen::VectorXd::LinSpaced(5, freqs.front(), freqs.back());
+    assert(fileCopy->sparameters(grid).isApprox(net.sparameters(grid)));
+}
+
+void test_plot_data_cache()
+{
+    PlotDataCache& cache = PlotDataCache::instance();
+    cache.clear();
+
+    NetworkLumped lumped(NetworkLumped::NetworkType::R_series, {50.0});
+    lumped.setFmin(1e6);
+    lumped.setFmax(1e9);
+    lumped.setPointCount(101);
+    const auto first = lumped.getPlotData(1, PlotType::Magnitude);
+    assert(cache.stats().hits == 0);
+    assert(lumped.getPlotData(1, PlotType::Magnitude) == first);
+    assert(cache.stats().hits == 1);
+
+    // Another view of the same parameter reuses the cached column.
+    lumped.getPlotData(1, PlotType::Phase);
+    assert(cache.stats().hits == 2);
+
+    // Editing the network invalidates its entries.
+    lumped.setParameterValue(0, 100.0);
+    const auto edited = lumped.getPlotData(1, PlotType::Magnitude);
+    assert(edited.second != first.second);
+    assert(edited.second == lumped.getPlotData(1, PlotType::Magnitude).second);
+
+    // A cascade notices edits of its member networks.
+    NetworkLumped member(NetworkLumped::NetworkType::R_series, {50.0});
+    NetworkCascade cascade;
+    cascade.setFrequencyRange(1e6, 1e9);
+    cascade.setPointCount(101);
+    cascade.addNetwork(&member);
+    const auto before = cascade.getPlotData(1, PlotType::Magnitude);
+    member.setParameterValue(0, 100.0);
+    const auto after = cascade.getPlotData(1, PlotType::Magnitude);
+    assert(before.second != after.second);
+    cascade.clearNetworks();
+
+    // The budget is enforced by evicting the least recently used entries.
+    cache.setBudget(4096);
+    lumped.getPlotData(0, PlotType::Magnitude);
+    lumped.getPlotData(1, PlotType::Magnitude);
+    const PlotDataCache::Stats stats = cache.stats();
+    assert(stats.bytes <= 4096);
+    assert(stats.evictions > 0);
+    cache.setBudget(64 * 1024 * 1024);
+    cache.clear();
+}
+
+void test_cascade_parallel_matches_serial()
+{
+    NetworkFile file(QStringLiteral("test/a (1).s2p"));
+    NetworkLumped line(NetworkLumped::NetworkType::TransmissionLine, {50.0, 60.0, 2.0});
+    NetworkLumped shunt(NetworkLumped::NetworkType::C_shunt, {0.5e-12});
+    NetworkLumped inactive(NetworkLumped::NetworkType::R_series, {10.0});
+    inactive.setActive(false);
+
+    // Fresh cascades, so neither result comes from the other's cached products.
+    auto evaluate = [&](unsigned threads) {
+        NetworkCascade cascade;
+        cascade.addNetwork(&file);
+        for (int i = 0; i < 6; ++i) {
+            cascade.addNetwork(&line);
+            cascade.addNetwork(&shunt);
+        }
+        cascade.addNetwork(&inactive);
+        NetworkCascade::setThreadCount(threads);
+        // Several blocks, the last one partial.
+        return cascade.sparameters(Eigen::VectorXd::LinSpaced(5000, 1e6, 10e9));
+    };
+
+    const Eigen::MatrixXcd serial = evaluate(1);
+    const Eigen::MatrixXcd parallel = evaluate(0);
+    assert(serial.rows() == 5000 && serial.cols() == 4);
+    assert((serial.array() == parallel.array()).all());
+}
+
+void test_cascade_incremental_updates()
+{
+    // Lumped stages are evaluated in runs of at most 16, so 40 of them form
+    // three runs; stage misses count runs.
+    std::vector<std::unique_ptr<NetworkLumped>> stages;
+    for (int i = 0; i < 40; ++i) {
+        if (i % 2 == 0)
+            stages.push_back(std::make_unique<NetworkLumped>(NetworkLumped::NetworkType::TransmissionLine,
+                                                             QVector<double>{5.0 + i, 40.0 + i, 2.0}));
+        else
+            stages.push_back(std::make_unique<NetworkLumped>(NetworkLumped::NetworkType::C_shunt,
+                                                             QVector<double>{0.02 * i}));
+    }
+    const Eigen::VectorXd freq = Eigen::VectorXd::LinSpaced(301, 1e6, 20e9);
+
+    NetworkCascade cascade;
+    for (auto& stage : stages)
+        cascade.addNetwork(stage.get());
+
+    // The incremental result must equal evaluating the same stages from scratch.
+    auto matchesFresh = [&](const Eigen::MatrixXcd& result) {
+        NetworkCascade fresh;
+        for (int i = 0; i < cascade.getNetworks().size(); ++i)
+            fresh.addNetwork(cascade.getNetworks().at(i));
+        return (fresh.sparameters(freq).array() == result.array()).all();
+    };
+    auto missesOf = [](const std::function<void()>& step) {
+        const quint64 before = NetworkCascade::evaluationStats().stageMisses;
+        step();
+        return NetworkCascade::evaluationStats().stageMisses - before;
+    };
+
+    assert(missesOf([&] { cascade.sparameters(freq); }) == 3);
+    assert(missesOf([&] { assert(matchesFresh(cascade.sparameters(freq))); }) == 3);  // the fresh cascade's
+
+    Eigen::MatrixXcd result;
+    stages[20]->setParameterValue(0, 17.0);
+    assert(missesOf([&] { result = cascade.sparameters(freq); }) == 1);
+    assert(matchesFresh(result));
+
+    cascade.moveNetwork(1, 6);
+    assert(missesOf([&] { result = cascade.sparameters(freq); }) == 1);
+    assert(matchesFresh(result));
+
+    // Removing the last stage leaves the first two runs intact.
+    cascade.removeNetwork(39);
+    assert(missesOf([&] { result = cascade.sparameters(freq); }) == 1);
+    assert(matchesFresh(result));
+
+    NetworkLumped extra(NetworkLumped::NetworkType::R_series, {12.0});
+    cascade.insertNetwork(2, &extra);
+    assert(matchesFresh(cascade.sparameters(freq)));
+    cascade.removeNetwork(2);
+
+    // A new grid starts over.
+    assert(missesOf([&] { cascade.sparameters(Eigen::VectorXd::LinSpaced(11, 1e6, 1e9)); }) == 3);
+    cascade.clearNetworks();
+}
+
+void test_cascade_fused_lumped_runs()
+{
+    NetworkFile file(QStringLiteral("test/a (1).s2p"));
+    NetworkLumped line(NetworkLumped::NetworkType::TransmissionLineLossy, {30.0, 45.0, 3.0, 0.5, 0.2, 1e9});
+    NetworkLumped seriesL(NetworkLumped::NetworkType::L_series, {2.0, 0.3});
+    NetworkLumped shuntC(NetworkLumped::NetworkType::C_shunt, {0.4});
+    NetworkLumped shuntR(NetworkLumped::NetworkType::R_shunt, {200.0});
+    const std::vector<Network*> order = {&line, &seriesL, &shuntC, &file, &shuntR, &line, &seriesL, &shuntC};
+
+    NetworkCascade cascade;
+    for (Network* network : order)
+        cascade.addNetwork(network);
+    cascade.setNetworkPortSelection(6, 1, 2);  // reversed inside a run
+
+    // Reference: every stage star-combined on its own.
+    const Eigen::VectorXd freq = Eigen::VectorXd::LinSpaced(257, 1e6, 8e9);
+    std::vector<Eigen::MatrixXcd> responses;
+    for (Network* network : order)
+        responses.push_back(network->sparameters(freq));
+    const Eigen::MatrixXcd fused = cascade.sparameters(freq);
+    for (Eigen::Index row = 0; row < freq.size(); ++row) {
+        Eigen::Matrix2cd expected;
+        expected << 0.0, 1.0, 1.0, 0.0;
+        for (std::size_t k = 0; k < order.size(); ++k) {
+            const Eigen::MatrixXcd& r = responses[k];
+            Eigen::Matrix2cd stage;
+            if (k == 6)
+                stage << r(row, 3), r(row, 1), r(row, 2), r(row, 0);
+            else
+                stage << r(row, 0), r(row, 2), r(row, 1), r(row, 3);
+            expected = CascadeKernels::star(expected, stage);
+        }
+        assert(std::abs(fused(row, 0) - expected(0, 0)) < 1e-12);
+        assert(std::abs(fused(row, 1) - expected(1, 0)) < 1e-12);
+        assert(std::abs(fused(row, 2) - expected(0, 1)) < 1e-12);
+        assert(std::abs(fused(row, 3) - expected(1, 1)) < 1e-12);
+    }
+    cascade.clearNetworks();
+}
+
+void test_cascade_fused_series_capacitors_at_dc()
+{
+    // Neither stage has a finite chain matrix at 0 Hz.
+    NetworkLumped first(NetworkLumped::NetworkType::C_series, {1.0});
+    NetworkLumped second(NetworkLumped::NetworkType::C_series, {2.5});
+    NetworkCascade cascade;
+    cascade.addNetwork(&first);
+    cascade.addNetwork(&second);
+
+    const Eigen::VectorXd freq = Eigen::VectorXd::LinSpaced(11, 0.0, 1e9);
+    const Eigen::MatrixXcd a = first.sparameters(freq);
+    const Eigen::MatrixXcd b = second.sparameters(freq);
+    const Eigen::MatrixXcd fused = cascade.sparameters(freq);
+    assert(fused.allFinite());
+    assert(std::abs(fused(0, 0) - 1.0) < 1e-12);
+    assert(std::abs(fused(0, 1)) < 1e-12);
+    for (Eigen::Index row = 0; row < freq.size(); ++row) {
+        Eigen::Matrix2cd left, right;
+        left << a(row, 0), a(row, 2), a(row, 1), a(row, 3);
+        right << b(row, 0), b(row, 2), b(row, 1), b(row, 3);
+        const Eigen::Matrix2cd expected = CascadeKernels::star(left, right);
+        assert(std::abs(fused(row, 0) - expected(0, 0)) < 1e-12);
+        assert(std::abs(fused(row, 1) - expected(1, 0)) < 1e-12);
+        assert(std::abs(fused(row, 2) - expected(0, 1)) < 1e-12);
+        assert(std::abs(fused(row, 3) - expected(1, 1)) < 1e-12);
+    }
+    cascade.clearNetworks();
+}
+
+void test_cascade_fused_reversed_singular_stages()
+{
+    // The reversed stages' chain matrices have no usable determinant at 0 Hz.
+    NetworkLumped seriesL(NetworkLumped::NetworkType::L_series, {2.0, 0.3});
+    NetworkLumped seriesC(NetworkLumped::NetworkType::C_series, {1.0});
+    NetworkLumped shortR(NetworkLumped::NetworkType::R_shunt, {0.0});
+    const std::vector<Network*> order = {&seriesL, &seriesC, &shortR, &seriesL};
+    NetworkCascade cascade;
+    for (Network* network : order)
+        cascade.addNetwork(network);
+    cascade.setNetworkPortSelection(1, 1, 2);
+    cascade.setNetworkPortSelection(2, 1, 2);
+
+    const Eigen::VectorXd freq = Eigen::VectorXd::LinSpaced(9, 0.0, 2e9);
+    std::vector<Eigen::MatrixXcd> responses;
+    for (Network* network : order)
+        responses.push_back(network->sparameters(freq));
+    const Eigen::MatrixXcd fused = cascade.sparameters(freq);
+    assert(fused.allFinite());
+    for (Eigen::Index row = 0; row < freq.size(); ++row) {
+        Eigen::Matrix2cd expected;
+        expected << 0.0, 1.0, 1.0, 0.0;
+        for (std::size_t k = 0; k < order.size(); ++k) {
+            const Eigen::MatrixXcd& r = responses[k];
+            Eigen::Matrix2cd stage;
+            if (k == 1 || k == 2)
+                stage << r(row, 3), r(row, 1), r(row, 2), r(row, 0);
+            else
+                stage << r(row, 0), r(row, 2), r(row, 1), r(row, 3);
+            expected = CascadeKernels::star(expected, stage);
+        }
+        assert(std::abs(fused(row, 0) - expected(0, 0)) < 1e-12);
+        assert(std::abs(fused(row, 1) - expected(1, 0)) < 1e-12);
+        assert(std::abs(fused(row, 2) - expected(0, 1)) < 1e-12);
+        assert(std::abs(fused(row, 3) - expected(1, 1)) < 1e-12);
+    }
+    cascade.clearNetworks();
+}
+
+void test_cascade_memoizes_stages_per_grid()
+{
+    PlotDataCache::instance().clear();
+    NetworkLumped line(NetworkLumped::NetworkType::TransmissionLine, {50.0, 60.0, 2.0});
+    NetworkLumped shunt(NetworkLumped::NetworkType::C_shunt, {0.5e-12});
+    NetworkFile file(QStringLiteral("test/a (1).s2p"));
+    NetworkCascade cascade;
+    cascade.setFrequencyRange(1e6, 5e9);
+    cascade.setPointCount(201);
+    // The file keeps the lumped stages from fusing into one run.
+    cascade.addNetwork(&line);
+    cascade.addNetwork(&file);
+    cascade.addNetwork(&shunt);
+
+    NetworkCascade::resetEvaluationStats();
+    const Eigen::VectorXd plotGrid = Eigen::VectorXd::LinSpaced(201, 1e6, 5e9);
+    const Eigen::VectorXd otherGrid = Eigen::VectorXd::LinSpaced(64, 0.0, 5e9);
+    const Eigen::MatrixXcd first = cascade.sparameters(plotGrid);
+    cascade.sparameters(otherGrid);
+    assert((cascade.sparameters(plotGrid).array() == first.array()).all());
+
+    NetworkCascade::EvaluationStats stats = NetworkCascade::evaluationStats();
+    assert(stats.stageMisses == 6);
+    assert(stats.stageHits == 3);
+    assert(stats.resultHits == 1 && stats.resultMisses == 2);
+
+    // Plotting further parameters and views reuses the stages and the result.
+    cascade.getPlotData(0, PlotType::Magnitude);
+    cascade.getPlotData(1, PlotType::Magnitude);
+    cascade.getPlotData(1, PlotType::Phase);
+    stats = NetworkCascade::evaluationStats();
+    assert(stats.stageMisses == 6);
+    assert(stats.resultMisses == 2);
+
+    // An edit re-evaluates only the edited stage, on the grid being used.
+    shunt.setParameterValue(0, 1.0);
+    cascade.sparameters(plotGrid);
+    stats = NetworkCascade::evaluationStats();
+    assert(stats.stageMisses == 7);
+    assert(stats.resultMisses == 3);
+    cascade.clearNetworks();
+    PlotDataCache::instance().clear();
+}
+
+void test_lumped_kernels_match_abcd()
+{
+    using Type = NetworkLumped::NetworkType;
+    const std::vector<NetworkLumped*> elements = {
+        new NetworkLumped(Type::R_series, {25.0}),
+        new NetworkLumped(Type::R_shunt, {80.0}),
+        new NetworkLumped(Type::C_series, {1.5}),
+        new NetworkLumped(Type::C_shunt, {0.7}),
+        new NetworkLumped(Type::L_series, {3.0, 0.4}),
+        new NetworkLumped(Type::L_shunt, {12.0, 1.0}),
+        new NetworkLumped(Type::TransmissionLine, {40.0, 75.0, 3.5}),
+        new NetworkLumped(Type::TransmissionLineLossy, {40.0, 30.0, 2.2, 0.8, 0.3, 1e9}),
+        new NetworkLumped(Type::TransmissionLineLossy, {25.0, 0.0, 4.0, 0.5, 0.1, 0.0}),
+        new NetworkLumped(Type::RLC_series_shunt, {2.0, 1.5, 0.8}),
+        new NetworkLumped(Type::RLC_series_shunt, {5.0, 2.0, 0.0}),
+        new NetworkLumped(Type::RLC_parallel_series, {300.0, 4.0, 0.6}),
+    };
+    const Eigen::VectorXd freq = Eigen::VectorXd::LinSpaced(401, 1e6, 20e9);
+    for (NetworkLumped* element : elements) {
+        const Eigen::MatrixXcd s = element->sparameters(freq);
+        for (Eigen::Index row = 0; row < freq.size(); ++row) {
+            const Eigen::Vector4cd expected = Network::abcd2s(element->abcdParameters(freq(row)));
+            assert(std::abs(s(row, 0) - expected(0)) < 1e-12);
+            assert(std::abs(s(row, 1) - expected(2)) < 1e-12);
+            assert(std::abs(s(row, 2) - expected(1)) < 1e-12);
+            assert(std::abs(s(row, 3) - expected(3)) < 1e-12);
+        }
+        delete element;
+    }
+
+    // Limits where the ABCD form divides by zero.
+    auto at = [](NetworkLumped&& element, double f) { return element.sparameters(Eigen::VectorXd::Constant(1, f)); };
+    const Eigen::MatrixXcd openSeriesC = at(NetworkLumped(Type::C_series, {1.0}), 0.0);
+    assert(std::abs(openSeriesC(0, 0) - 1.0) < 1e-15 && std::abs(openSeriesC(0, 1)) < 1e-15);
+    const Eigen::MatrixXcd shortShuntR = at(NetworkLumped(Type::R_shunt, {0.0}), 1e9);
+    assert(std::abs(shortShuntR(0, 0) + 1.0) < 1e-15 && std::abs(shortShuntR(0, 1)) < 1e-15);
+    const Eigen::MatrixXcd dcSeriesShunt = at(NetworkLumped(Type::RLC_series_shunt, {1.0, 1.0, 1.0}), 0.0);
+    assert(std::abs(dcSeriesShunt(0, 0)) < 1e-15 && std::abs(dcSeriesShunt(0, 1) - 1.0) < 1e-15);
+    const Eigen::MatrixXcd dcParallel = at(NetworkLumped(Type::RLC_parallel_series, {50.0, 1.0, 1.0}), 0.0);
+    assert(std::abs(dcParallel(0, 0)) < 1e-15 && std::abs(dcParallel(0, 1) - 1.0) < 1e-15);
+}
+
 int main()
 {
     test_wrap_to_minus_pi_pi();
@@ -401,14 +1002,29 @@ int main()
     test_lumped_frequency_point_count();
     test_cascade_frequency_settings();
     test_cascade_manual_range_persistence();
+    test_cascade_frequency_plans();
+    test_adaptive_sampling_resolves_notch();
+    test_plot_data_on_zoomed_grid();
+    test_tdr_on_zoomed_window();
     test_lumped_phase_unwrap_matches_manual();
     test_transmission_line_group_delay();
     test_lumped_smith_matches_sparameters();
+    test_lumped_kernels_match_abcd();
     test_cascade_smith_matches_sparameters();
     test_cascade_group_delay_adds_line_lengths();
     test_cascade_phase_unwrap_matches_manual();
     test_cascade_multiport_port_selection();
     test_cascade_two_port_flip();
+    test_network_file_loads_on_demand();
+    test_network_file_interpolation_plans();
+    test_network_file_clones_share_data();
+    test_plot_data_cache();
+    test_cascade_parallel_matches_serial();
+    test_cascade_incremental_updates();
+    test_cascade_fused_lumped_runs();
+    test_cascade_fused_series_capacitors_at_dc();
+    test_cascade_fused_reversed_singular_stages();
+    test_cascade_memoizes_stages_per_grid();
     std::cout << "All NetworkCascade tests passed." << std::endl;
     return 0;
 }
@@ -0,0 +1,182 @@
+#include "networkcascade.h"
+#include "networkconnection.h"
+#include "networkfile.h"
+#include "networklumped.h"
+#include <Eigen/Dense>
+#include <cassert>
+#include <complex>
+#include <iostream>
+#include <memory>
+#include <vector>
+
+namespace {
+
+bool close(const Eigen::MatrixXcd& a, const Eigen::MatrixXcd& b, double tol)
+{
+    return a.rows() == b.rows() && a.cols() == b.cols() && ((a - b).cwiseAbs().array() <= tol).all();
+}
+
+} // namespace
+
+void test_chain_matches_cascade()
+{
+    NetworkFile first(QStringLiteral("test/a (1).s2p"));
+    NetworkFile last(QStringLiteral("test/a (2).s2p"));
+    std::vector<std::unique_ptr<NetworkLumped>> middle;
+    for (int i = 0; i < 5; ++i)
+        middle.push_back(std::make_unique<NetworkLumped>(NetworkLumped::NetworkType::TransmissionLine,
+                                                         QVector<double>{10.0 + i, 40.0 + 5 * i, 2.0}));
+    const Eigen::VectorXd freq = Eigen::VectorXd::LinSpaced(401, 1e6, 6e9);
+
+    // Two connections solve a fixed-size system, six a dynamic one.
+    for (int stages : {0, 5}) {
+        NetworkCascade cascade;
+        NetworkConnection connection;
+        cascade.addNetwork(&first);
+        connection.addNetwork(&first);
+        for (int i = 0; i < stages; ++i) {
+            cascade.addNetwork(middle[i].get());
+            connection.addNetwork(middle[i].get());
+            assert(connection.connect(i, 2, i + 1, 1));
+        }
+        cascade.addNetwork(&last);
+        connection.addNetwork(&last);
+        assert(connection.connect(stages, 2, stages + 1, 1));
+
+        assert(connection.portCount() == 2);
+        assert(close(connection.sparameters(freq), cascade.sparameters(freq), 1e-10));
+        cascade.clearNetworks();
+    }
+}
+
+void test_self_connection_equals_thru()
+{
+    NetworkFile sixPort(QStringLiteral("test/a (12).s6p"));
+    NetworkLumped thru(NetworkLumped::NetworkType::R_series, {0.0});
+    const Eigen::VectorXd freq = Eigen::VectorXd::LinSpaced(101, 10e6, 5e9);
+
+    NetworkConnection direct;
+    direct.addNetwork(&sixPort);
+    assert(direct.connect(0, 3, 0, 4));
+
+    NetworkConnection viaThru;
+    viaThru.addNetwork(&sixPort);
+    viaThru.addNetwork(&thru);
+    assert(viaThru.connect(0, 3, 1, 1));
+    assert(viaThru.connect(1, 2, 0, 4));
+
+    assert(direct.portCount() == 4);
+    assert(viaThru.portCount() == 4);
+    const Eigen::MatrixXcd expected = direct.sparameters(freq);
+    assert(expected.cols() == 16);
+    assert(close(viaThru.sparameters(freq), expected, 1e-10));
+}
+
+void test_unconnected_ports_stay_external()
+{
+    NetworkFile ninePort(QStringLiteral("test/a (11).s9p"));
+    NetworkLumped series(NetworkLumped::NetworkType::R_series, {25.0});
+    const Eigen::VectorXd freq = Eigen::VectorXd::LinSpaced(21, 10e6, 1e9);
+
+    NetworkConnection connection;
+    assert(connection.addNetwork(&ninePort) == 0);
+    assert(connection.addNetwork(&series) == 1);
+    assert(connection.portCount() == 11);
+
+    // Without connections the result is block diagonal.
+    const Eigen::MatrixXcd separate = connection.sparameters(freq);
+    const Eigen::MatrixXcd nine = ninePort.sparameters(freq);
+    const Eigen::MatrixXcd two = series.sparameters(freq);
+    assert(separate.cols() == 121);
+    assert(separate.col(0 * 11 + 4).isApprox(nine.col(0 * 9 + 4)));
+    assert(separate.col(9 * 11 + 10).isApprox(two.col(0 * 2 + 1)));
+    assert(separate.col(9 * 11 + 3).isZero());
+
+    assert(!connection.connect(0, 10, 1, 1));   // no port 10
+    assert(!connection.connect(1, 1, 1, 1));    // same port
+    assert(!connection.connect(2, 1, 0, 1));    // no network 2
+    assert(connection.connect(0, 9, 1, 1));
+    assert(!connection.connect(0, 8, 1, 1));    // already connected
+
+    const QVector<NetworkConnection::Port> ports = connection.externalPorts();
+    assert(ports.size() == 9);
+    assert(ports.first().network == 0 && ports.first().port == 1);
+    assert(ports.at(7).network == 0 && ports.at(7).port == 8);
+    assert(ports.last().network == 1 && ports.last().port == 2);
+    assert(connection.sparameters(freq).cols() == 81);
+}
+
+void test_cascade_port_connections()
+{
+    NetworkFile sixA(QStringLiteral("test/a (12).s6p"));
+    NetworkFile sixB(QStringLiteral("test/a (12).s6p"));
+    NetworkLumped series(NetworkLumped::NetworkType::R_series, {25.0});
+    const Eigen::VectorXd freq = Eigen::VectorXd::LinSpaced(51, 10e6, 5e9);
+
+    NetworkCascade cascade;
+    cascade.addNetwork(&sixA);
+    cascade.addNetwork(&series);
+    cascade.addNetwork(&sixB);
+    assert(cascade.portCount() == 2);
+
+    QVector<NetworkCascade::PortConnection> connections;
+    assert(NetworkCascade::parsePortConnections(QStringLiteral("1:5-2:1, 2:2-3:1,1:6-3:2"), connections));
+    assert(connections.size() == 3);
+    assert((connections.at(1) == NetworkCascade::PortConnection{1, 2, 2, 1}));
+    QVector<NetworkCascade::PortConnection> rejected;
+    assert(!NetworkCascade::parsePortConnections(QStringLiteral("1:5-2"), rejected));
+    assert(!NetworkCascade::parsePortConnections(QStringLiteral("0:1-2:1"), rejected));
+    assert(!NetworkCascade::parsePortConnections(QStringLiteral("1:x-2:1"), rejected));
+
+    assert(!cascade.setPortConnections({{0, 7, 1, 1}}));               // no port 7
+    assert(!cascade.setPortConnections({{0, 1, 3, 1}}));               // no stage 3
+    assert(!cascade.setPortConnections({{0, 1, 1, 1}, {2, 1, 1, 1}})); // port used twice
+    assert(cascade.portConnections().isEmpty());
+    assert(cascade.setPortConnections(connections));
+
+    NetworkConnection expected;
+    expected.addNetwork(&sixA);
+    expected.addNetwork(&series);
+    expected.addNetwork(&sixB);
+    assert(expected.connect(0, 5, 1, 1));
+    assert(expected.connect(1, 2, 2, 1));
+    assert(expected.connect(0, 6, 2, 2));
+    assert(cascade.portCount() == 8);
+    assert(close(cascade.sparameters(freq), expected.sparameters(freq), 1e-12));
+
+    std::unique_ptr<Network> copy(cascade.clone());
+    assert(copy->portCount() == 8);
+    assert(close(copy->sparameters(freq), expected.sparameters(freq), 1e-12));
+
+    // Connections follow their stages and go with a removed one.
+    cascade.moveNetwork(2, 0);
+    assert((cascade.portConnections().at(0) == NetworkCascade::PortConnection{1, 5, 2, 1}));
+    assert((cascade.portConnections().at(1) == NetworkCascade::PortConnection{2, 2, 0, 1}));
+    assert(cascade.portCount() == 8);
+    NetworkLumped shunt(NetworkLumped::NetworkType::R_shunt, {50.0});
+    cascade.insertNetwork(0, &shunt);
+    assert((cascade.portConnections().at(2) == NetworkCascade::PortConnection{2, 6, 1, 2}));
+    assert(cascade.portCount() == 10);
+    cascade.removeNetwork(3);
+    assert(cascade.portConnections().size() == 1);
+    assert((cascade.portConnections().at(0) == NetworkCascade::PortConnection{2, 6, 1, 2}));
+    assert(cascade.portCount() == 12);
+
+    // An inactive stage leaves the result along with its ports.
+    shunt.setActive(false);
+    assert(cascade.portCount() == 10);
+    shunt.setActive(true);
+
+    assert(cascade.setPortConnections({}));
+    assert(cascade.portCount() == 2);
+}
+
+int main()
+{
+    test_chain_matches_cascade();
+    test_self_connection_equals_thru();
+    test_unconnected_ports_stay_external();
+    test_cascade_port_connections();
+    std::cout << "All NetworkConnection tests passed." << std::endl;
+    return 0;
+}
@@ -0,0 +1,193 @@
+#include "cascadekernels.h"
+#include "network.h"
+#include "networklumped.h"
+#include "networkparameters.h"
+#include "plotdatacache.h"
+#include <Eigen/Dense>
+#include <cassert>
+#include <cmath>
+#include <complex>
+#include <iostream>
+#include <random>
+
+namespace {
+
+// Passive-looking random S-parameters: entries well inside the unit circle.
+Eigen::MatrixXcd randomS(int ports, Eigen::Index rows, unsigned seed)
+{
+    std::mt19937 rng(seed);
+    std::uniform_real_distribution<double> sample(-0.3, 0.3);
+    Eigen::MatrixXcd s(rows, static_cast<Eigen::Index>(ports) * ports);
+    for (Eigen::Index r = 0; r < s.rows(); ++r)
+        for (Eigen::Index c = 0; c < s.cols(); ++c)
+            s(r, c) = {sample(rng), sample(rng)};
+    return s;
+}
+
+Eigen::VectorXd references(int ports)
+{
+    Eigen::VectorXd z0(ports);
+    for (int p = 0; p < ports; ++p)
+        z0(p) = 25.0 + 12.5 * p;
+    return z0;
+}
+
+double maxDifference(const Eigen::MatrixXcd& a, const Eigen::MatrixXcd& b)
+{
+    assert(a.rows() == b.rows() && a.cols() == b.cols());
+    return (a - b).cwiseAbs().maxCoeff();
+}
+
+} // namespace
+
+void test_round_trips_for_fixed_and_dynamic_sizes()
+{
+    using namespace NetworkParameters;
+    // 600 rows span several pool blocks; 5 and 6 ports take the LU path.
+    for (int ports = 1; ports <= 6; ++ports) {
+        const Eigen::MatrixXcd s = randomS(ports, 600, 7u + ports);
+        const Eigen::VectorXd z0 = references(ports);
+        assert(portCount(s) == ports);
+
+        const Eigen::MatrixXcd z = sToZ(s, z0);
+        const Eigen::MatrixXcd y = sToY(s, z0);
+        assert(maxDifference(zToS(z, z0), s) < 1e-12);
+        assert(maxDifference(yToS(y, z0), s) < 1e-12);
+        assert(maxDifference(zToY(z), y) < 1e-12);
+        assert(maxDifference(yToZ(y), z) < 1e-9);
+
+        // Row by row against a plain Eigen evaluation.
+        const Eigen::Index row = 123;
+        Eigen::MatrixXcd sRow(ports, ports);
+        for (Eigen::Index c = 0; c < s.cols(); ++c)
+            sRow.data()[c] = s(row, c);
+        const Eigen::MatrixXcd identity = Eigen::MatrixXcd::Identity(ports, ports);
+        const Eigen::MatrixXd g = z0.cwiseSqrt().asDiagonal();
+        const Eigen::MatrixXcd expected = g * (identity + sRow) * (identity - sRow).inverse() * g;
+        for (Eigen::Index c = 0; c < s.cols(); ++c)
+            assert(std::abs(z(row, c) - expected.data()[c]) < 1e-9);
+
+        if (ports % 2 == 0) {
+            assert(maxDifference(tToS(sToT(s)), s) < 1e-12);
+            assert(maxDifference(abcdToS(sToAbcd(s, z0), z0), s) < 1e-12);
+            assert(maxDifference(convert(z, Kind::Z, Kind::ABCD, z0), sToAbcd(s, z0)) < 1e-9);
+        } else {
+            assert(sToT(s).size() == 0);
+            assert(sToAbcd(s, z0).size() == 0);
+        }
+    }
+}
+
+void test_two_port_matches_scalar_conversions()
+{
+    using namespace NetworkParameters;
+    const Eigen::MatrixXcd s = randomS(2, 50, 3u);
+    const Eigen::VectorXd z0 = Eigen::VectorXd::Constant(2, 50.0);
+    const Eigen::MatrixXcd abcd = sToAbcd(s, z0);
+    for (Eigen::Index r = 0; r < s.rows(); ++r) {
+        // Network::s2abcd takes (s11, s12, s21, s22); columns are S11, S21, S12, S22.
+        const Eigen::Matrix2cd expected = Network::s2abcd(s(r, 0), s(r, 2), s(r, 1), s(r, 3));
+        assert(std::abs(abcd(r, 0) - expected(0, 0)) < 1e-12);
+        assert(std::abs(abcd(r, 1) - expected(1, 0)) < 1e-12);
+        assert(std::abs(abcd(r, 2) - expected(0, 1)) < 1e-12);
+        assert(std::abs(abcd(r, 3) - expected(1, 1)) < 1e-12);
+    }
+
+    // Transfer matrices multiply where S-parameters star-combine.
+    const Eigen::MatrixXcd other = randomS(2, 50, 4u);
+    const Eigen::MatrixXcd t = sToT(s);
+    const Eigen::MatrixXcd tOther = sToT(other);
+    Eigen::MatrixXcd product(s.rows(), 4);
+    Eigen::MatrixXcd starred(s.rows(), 4);
+    for (Eigen::Index r = 0; r < s.rows(); ++r) {
+        Eigen::Matrix2cd a;
+        Eigen::Matrix2cd b;
+        a << t(r, 0), t(r, 2), t(r, 1), t(r, 3);
+        b << tOther(r, 0), tOther(r, 2), tOther(r, 1), tOther(r, 3);
+        const Eigen::Matrix2cd ab = a * b;
+        product.row(r) << ab(0, 0), ab(1, 0), ab(0, 1), ab(1, 1);
+
+        Eigen::Matrix2cd left;
+        Eigen::Matrix2cd right;
+        left << s(r, 0), s(r, 2), s(r, 1), s(r, 3);
+        right << other(r, 0), other(r, 2), other(r, 1), other(r, 3);
+        const Eigen::Matrix2cd combined = CascadeKernels::star(left, right);
+        starred.row(r) << combined(0, 0), combined(1, 0), combined(0, 1), combined(1, 1);
+    }
+    assert(maxDifference(tToS(product), starred) < 1e-12);
+}
+
+void test_renormalize_matches_impedance_route()
+{
+    using namespace NetworkParameters;
+    for (int ports : {1, 2, 3, 5}) {
+        const Eigen::MatrixXcd s = randomS(ports, 300, 11u + ports);
+        const Eigen::VectorXd from = references(ports);
+        const Eigen::VectorXd to = Eigen::VectorXd::Constant(ports, 75.0);
+        const Eigen::MatrixXcd renormalized = renormalize(s, from, to);
+        assert(maxDifference(renormalized, zToS(sToZ(s, from), to)) < 1e-12);
+        assert(maxDifference(renormalize(renormalized, to, from), s) < 1e-12);
+        assert(maxDifference(renormalize(s, from, from), s) < 1e-15);
+    }
+
+    // A matched 1-port at 50 Ohm seen from 75 Ohm.
+    Eigen::MatrixXcd matched = Eigen::MatrixXcd::Zero(1, 1);
+    const Eigen::MatrixXcd seen = renormalize(matched, Eigen::VectorXd::Constant(1, 50.0), Eigen::VectorXd::Constant(1, 75.0));
+    assert(std::abs(seen(0, 0) - std::complex<double>(-0.2, 0.0)) < 1e-15);
+}
+
+void test_malformed_input_is_rejected()
+{
+    using namespace NetworkParameters;
+    const Eigen::MatrixXcd notSquare = Eigen::MatrixXcd::Zero(4, 3);
+    assert(portCount(notSquare) == -1);
+    assert(sToZ(notSquare, Eigen::VectorXd::Constant(1, 50.0)).size() == 0);
+    const Eigen::MatrixXcd s = randomS(2, 4, 1u);
+    assert(sToZ(s, Eigen::VectorXd::Constant(3, 50.0)).size() == 0);
+    assert(renormalize(s, Eigen::VectorXd::Constant(2, 50.0), Eigen::VectorXd::Constant(1, 50.0)).size() == 0);
+}
+
+void test_plot_views_of_lumped_elements()
+{
+    PlotDataCache::instance().clear();
+    NetworkLumped shunt(NetworkLumped::NetworkType::R_shunt, {25.0});
+    NetworkLumped series(NetworkLumped::NetworkType::R_series, {40.0});
+
+    // A shunt resistor's Z has every entry equal to R; a series one's Y has
+    // +-1/R.
+    const auto impedance = shunt.getPlotData(1, PlotType::Impedance);
+    assert(!impedance.second.isEmpty());
+    for (double value : impedance.second)
+        assert(std::abs(value - 25.0) < 1e-9);
+    const auto admittance = series.getPlotData(1, PlotType::Admittance);
+    for (double value : admittance.second)
+        assert(std::abs(value - 1.0 / 40.0) < 1e-12);
+
+    // The renormalized view follows the reference, without stale cache hits.
+    const auto atDefault = shunt.getPlotData(0, PlotType::Renormalized);
+    const auto magnitude = shunt.getPlotData(0, PlotType::Magnitude);
+    assert(atDefault.second == magnitude.second);
+    Network::setRenormalizationImpedance(25.0);
+    const auto at25 = shunt.getPlotData(0, PlotType::Renormalized);
+    const Eigen::Vector4cd expected = Network::abcd2s(shunt.abcdParameters(1e9), 25.0);
+    assert(std::abs(at25.second.first() - 20.0 * std::log10(std::abs(expected(0)))) < 1e-9);
+    assert(at25.second.first() != atDefault.second.first());
+
+    // Zoomed re-evaluation takes the same route.
+    const Eigen::VectorXd grid = Eigen::VectorXd::LinSpaced(5, 1e9, 2e9);
+    const auto zoomed = shunt.plotDataOnGrid(0, PlotType::Renormalized, grid);
+    assert(std::abs(zoomed.second.first() - at25.second.first()) < 1e-9);
+    Network::setRenormalizationImpedance(50.0);
+    PlotDataCache::instance().clear();
+}
+
+int main()
+{
+    test_round_trips_for_fixed_and_dynamic_sizes();
+    test_two_port_matches_scalar_conversions();
+    test_renormalize_matches_impedance_route();
+    test_malformed_input_is_rejected();
+    test_plot_views_of_lumped_elements();
+    std::cout << "All NetworkParameters tests passed." << std::endl;
+    return 0;
+}
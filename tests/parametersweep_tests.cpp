@@ -0,0 +1,123 @@
+#include "networkcascade.h"
+#include "networkfile.h"
+#include "networklumped.h"
+#include "parametersweep.h"
+#include <Eigen/Dense>
+#include <atomic>
+#include <cassert>
+#include <iostream>
+
+namespace {
+
+// Sets the swept values on the original stages and evaluates the whole cascade.
+Eigen::RowVectorXcd direct(NetworkCascade& cascade, const QVector<ParameterSweep::Axis>& axes,
+                           const ParameterSweep::Result& result, Eigen::Index row, const Eigen::VectorXd& freq)
+{
+    const Eigen::Index n0 = result.values.at(0).size();
+    const Eigen::Index index[2] = {row % n0, row / n0};
+    for (int a = 0; a < axes.size(); ++a) {
+        auto* lumped = static_cast<NetworkLumped*>(cascade.getNetworks().at(axes.at(a).stage));
+        lumped->setParameterValue(axes.at(a).parameter, result.values.at(a)(index[a]));
+    }
+    return cascade.sparameters(freq).col(result.sParameter).transpose();
+}
+
+} // namespace
+
+void test_single_axis_matches_cascade()
+{
+    NetworkFile file(QStringLiteral("test/a (1).s2p"));
+    NetworkLumped series(NetworkLumped::NetworkType::C_series, {2.0});
+    NetworkLumped line(NetworkLumped::NetworkType::TransmissionLine, {15.0, 60.0, 2.0});
+    NetworkLumped shunt(NetworkLumped::NetworkType::L_shunt, {5.0, 0.5});
+    NetworkCascade cascade;
+    cascade.addNetwork(&file);
+    cascade.addNetwork(&series);
+    cascade.addNetwork(&line);
+    cascade.addNetwork(&shunt);
+    // A reversed swept stage keeps its orientation in the sweep.
+    cascade.setNetworkPortSelection(2, 1, 2);
+    const Eigen::VectorXd freq = Eigen::VectorXd::LinSpaced(301, 10e6, 6e9);
+
+    ParameterSweep::Axis axis;
+    axis.stage = 2;
+    axis.parameter = 1;
+    axis.start = 25.0;
+    axis.stop = 100.0;
+    axis.points = 7;
+    const ParameterSweep::Result result = ParameterSweep::run(cascade, {axis}, 1, freq);
+    assert(result.ok());
+    assert(result.response.rows() == 7 && result.response.cols() == freq.size());
+    assert(result.values.at(0)(0) == 25.0 && result.values.at(0)(6) == 100.0);
+    assert(result.labels.at(0).startsWith(QStringLiteral("3: ")));
+    // The original stages are left untouched.
+    assert(line.parameterValue(1) == 60.0);
+
+    for (Eigen::Index row = 0; row < result.response.rows(); ++row)
+        assert(result.response.row(row).isApprox(direct(cascade, {axis}, result, row, freq), 1e-10));
+}
+
+void test_two_axes_on_separate_and_shared_stages()
+{
+    NetworkFile first(QStringLiteral("test/a (1).s2p"));
+    NetworkFile last(QStringLiteral("test/a (2).s2p"));
+    NetworkLumped series(NetworkLumped::NetworkType::L_series, {3.0, 0.2});
+    NetworkLumped idle(NetworkLumped::NetworkType::R_series, {1e3});
+    NetworkLumped shunt(NetworkLumped::NetworkType::RLC_series_shunt, {0.5, 2.0, 1.5});
+    idle.setActive(false);
+    NetworkCascade cascade;
+    cascade.addNetwork(&first);
+    cascade.addNetwork(&series);
+    cascade.addNetwork(&idle);
+    cascade.addNetwork(&shunt);
+    cascade.addNetwork(&last);
+    const Eigen::VectorXd freq = Eigen::VectorXd::LinSpaced(201, 10e6, 6e9);
+
+    ParameterSweep::Axis inductance{1, 0, 1.0, 10.0, 4, true};
+    ParameterSweep::Axis capacitance{3, 2, 0.5, 3.0, 3, false};
+    const QVector<ParameterSweep::Axis> separate = {inductance, capacitance};
+    const ParameterSweep::Result result = ParameterSweep::run(cascade, separate, 0, freq, 2);
+    assert(result.ok());
+    assert(result.response.rows() == 12);
+    assert(std::abs(result.values.at(0)(1) / std::cbrt(10.0) - 1.0) < 1e-12);
+    for (Eigen::Index row = 0; row < result.response.rows(); ++row)
+        assert(result.response.row(row).isApprox(direct(cascade, separate, result, row, freq), 1e-10));
+
+    ParameterSweep::Axis inductanceShunt{3, 1, 1.0, 4.0, 5, false};
+    const QVector<ParameterSweep::Axis> shared = {capacitance, inductanceShunt};
+    const ParameterSweep::Result both = ParameterSweep::run(cascade, shared, 1, freq);
+    assert(both.ok() && both.response.rows() == 15);
+    for (Eigen::Index row = 0; row < both.response.rows(); ++row)
+        assert(both.response.row(row).isApprox(direct(cascade, shared, both, row, freq), 1e-10));
+}
+
+void test_invalid_requests_and_cancel()
+{
+    NetworkFile file(QStringLiteral("test/a (1).s2p"));
+    NetworkLumped series(NetworkLumped::NetworkType::R_series, {10.0});
+    NetworkCascade cascade;
+    cascade.addNetwork(&file);
+    cascade.addNetwork(&series);
+    const Eigen::VectorXd freq = Eigen::VectorXd::LinSpaced(11, 10e6, 1e9);
+
+    assert(!ParameterSweep::run(cascade, {}, 1, freq).ok());
+    assert(!ParameterSweep::run(cascade, {{0, 0, 1.0, 2.0, 3, false}}, 1, freq).ok());   // a file stage
+    assert(!ParameterSweep::run(cascade, {{1, 3, 1.0, 2.0, 3, false}}, 1, freq).ok());   // no such parameter
+    assert(!ParameterSweep::run(cascade, {{1, 0, 1.0, 2.0, 3, false}}, 4, freq).ok());
+    series.setActive(false);
+    assert(!ParameterSweep::run(cascade, {{1, 0, 1.0, 2.0, 3, false}}, 1, freq).ok());
+    series.setActive(true);
+
+    const std::atomic<bool> cancel{true};
+    const ParameterSweep::Result cancelled = ParameterSweep::run(cascade, {{1, 0, 1.0, 2.0, 3, false}}, 1, freq, 0, &cancel);
+    assert(!cancelled.ok() && cancelled.response.size() == 0);
+}
+
+int main()
+{
+    test_single_axis_matches_cascade();
+    test_two_axes_on_separate_and_shared_stages();
+    test_invalid_requests_and_cancel();
+    std::cout << "All ParameterSweep tests passed." << std::endl;
+    return 0;
+}
@@ -0,0 +1,138 @@
+// Throughput comparison of the stream parser and the memory-mapped parser,
+// followed by the scaling of the chunked parallel parse over thread counts and
+// cold (parse and write the cache entry) versus warm (read the entry) loads,
+// the cost of probing the file's header and extent, and the batched DB value
+// conversions against per-value ones.
+// Usage: parser_touchstone_bench [points] [ports]
+#include "parser_touchstone.h"
+#include "threadpool.h"
+#include "touchstone_cache.h"
+
+#include <chrono>
+#include <cmath>
+#include <complex>
+#include <cstdio>
+#include <cstdlib>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <string>
+#include <vector>
+
+namespace {
+
+constexpr double kDegToRad = 3.141592653589793238462643383279502884 / 180.0;
+constexpr double kRadToDeg = 180.0 / 3.141592653589793238462643383279502884;
+
+std::string write_synthetic_file(int points, int ports) {
+    const std::string path = (std::filesystem::temp_directory_path() /
+                              ("fsnpview_bench.s" + std::to_string(ports) + "p")).string();
+    std::ofstream out(path);
+    out << "! synthetic benchmark data\n# GHZ S DB R 50\n";
+    char buffer[64];
+    for (int k = 0; k < points; ++k) {
+        std::snprintf(buffer, sizeof(buffer), "%.9E", 0.01 + 40.0 * k / points);
+        out << buffer;
+        for (int v = 0; v < ports * ports; ++v) {
+            // Version 1 files wrap multiport rows after four pairs.
+            if (v > 0 && v % 4 == 0) {
+                out << '\n';
+            }
+            std::snprintf(buffer, sizeof(buffer), " %.9E %.9E", -20.0 - std::fmod(k * 0.37 + v, 30.0),
+                          std::fmod(k * 7.3 + v * 11.0, 360.0) - 180.0);
+            out << buffer;
+        }
+        out << '\n';
+    }
+    return path;
+}
+
+template <typename Fn>
+double best_of(int repeats, Fn&& fn) {
+    double best = 1e300;
+    for (int i = 0; i < repeats; ++i) {
+        const auto start = std::chrono::steady_clock::now();
+        fn();
+        const std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+        best = std::min(best, elapsed.count());
+    }
+    return best;
+}
+
+} // namespace
+
+int main(int argc, char* argv[]) {
+    const int points = argc > 1 ? std::atoi(argv[1]) : 100000;
+    const int ports = argc > 2 ? std::atoi(argv[2]) : 4;
+    const std::string path = write_synthetic_file(points, ports);
+    const double megabytes = static_cast<double>(std::filesystem::file_size(path)) / (1024.0 * 1024.0);
+
+    Eigen::Index rows = 0;
+    const double stream_s = best_of(3, [&] {
+        std::ifstream fin(path);
+        rows = ts::parse_touchstone_stream(fin, path, ports).freq.size();
+    });
+    ts::ParseOptions serial;
+    serial.threads = 1;
+    const double mapped_s = best_of(3, [&] { rows = ts::parse_touchstone(path, serial).freq.size(); });
+
+    std::cout << "file: " << path << " (" << megabytes << " MiB, " << rows << " points, " << ports << " ports)\n";
+    std::cout << "stream parser: " << stream_s << " s, " << megabytes / stream_s << " MiB/s\n";
+    std::cout << "mapped parser: " << mapped_s << " s, " << megabytes / mapped_s << " MiB/s\n";
+    std::cout << "speedup: " << stream_s / mapped_s << "x" << std::endl;
+
+    const unsigned max_threads = ThreadPool::global().threadCount();
+    for (unsigned threads = 2; threads <= max_threads; threads *= 2) {
+        ts::ParseOptions parallel;
+        parallel.threads = threads;
+        parallel.parallel_min_bytes = 0;
+        const double parallel_s = best_of(3, [&] { rows = ts::parse_touchstone(path, parallel).freq.size(); });
+        std::cout << "parallel parser, " << threads << " threads: " << parallel_s << " s, "
+                  << megabytes / parallel_s << " MiB/s, scaling " << mapped_s / parallel_s << "x" << std::endl;
+    }
+
+    const double probe_s = best_of(3, [&] { rows = static_cast<Eigen::Index>(ts::probe_touchstone(path).estimated_points); });
+    std::cout << "probe: " << probe_s * 1e6 << " us (" << rows << " points estimated)" << std::endl;
+
+    ts::ParseOptions cached;
+    cached.use_cache = true;
+    const std::string entry = ts::cache_path_for(path);
+    const double cold_s = best_of(3, [&] {
+        std::filesystem::remove(entry);
+        rows = ts::parse_touchstone(path, cached).freq.size();
+    });
+    const double warm_s = best_of(3, [&] { rows = ts::parse_touchstone(path, cached).freq.size(); });
+    std::cout << "cold cached load: " << cold_s << " s\n";
+    std::cout << "warm cached load: " << warm_s << " s, " << cold_s / warm_s << "x faster" << std::endl;
+
+    // The batched DB kernels against the per-value std::polar / std::pow and
+    // std::abs / std::log10 / std::arg conversions they replace.
+    const std::size_t values = static_cast<std::size_t>(points) * static_cast<std::size_t>(ports * ports);
+    std::vector<double> pairs(2 * values);
+    for (std::size_t i = 0; i < values; ++i) {
+        pairs[2 * i] = -20.0 - std::fmod(i * 0.37, 30.0);
+        pairs[2 * i + 1] = std::fmod(i * 7.3, 360.0) - 180.0;
+    }
+    std::vector<std::complex<double>> complex_values(values);
+    const double scalar_read_s = best_of(5, [&] {
+        for (std::size_t i = 0; i < values; ++i) {
+            complex_values[i] = std::polar(std::pow(10.0, pairs[2 * i] / 20.0), pairs[2 * i + 1] * kDegToRad);
+        }
+    });
+    const double batch_read_s = best_of(5, [&] { ts::pairs_to_complex(pairs.data(), values, "DB", complex_values.data()); });
+    const double scalar_write_s = best_of(5, [&] {
+        for (std::size_t i = 0; i < values; ++i) {
+            pairs[2 * i] = 20.0 * std::log10(std::abs(complex_values[i]));
+            pairs[2 * i + 1] = std::arg(complex_values[i]) * kRadToDeg;
+        }
+    });
+    const double batch_write_s = best_of(5, [&] { ts::complex_to_pairs(complex_values.data(), values, "DB", pairs.data()); });
+    std::cout << "DB to complex: per value " << scalar_read_s / values * 1e9 << " ns, batched "
+              << batch_read_s / values * 1e9 << " ns, " << scalar_read_s / batch_read_s << "x\n";
+    std::cout << "complex to DB: per value " << scalar_write_s / values * 1e9 << " ns, batched "
+              << batch_write_s / values * 1e9 << " ns, " << scalar_write_s / batch_write_s << "x" << std::endl;
+
+    std::filesystem::remove(entry);
+    std::filesystem::remove(path);
+    return 0;
+}
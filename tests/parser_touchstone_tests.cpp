@@ -1,8 +1,15 @@
 #include "parser_touchstone.h"
 #include <cassert>
 #include <cmath>
+#include <filesystem>
+#include <fstream>
 #include <iostream>
+#include <limits>
 #include <sstream>
+#include <stdexcept>
+#include <string>
+#include <utility>
+#include <vector>
 
 void test_basic_parse() {
     ts::TouchstoneData data = ts::parse_touchstone("test/a (1).s2p");
@@ -97,6 +104,368 @@ void test_multiport_files() {
     assert(data9.sparams.cols() == data9.ports * data9.ports);
 }
 
+namespace {
+
+void assert_identical(const ts::TouchstoneData& a, const ts::TouchstoneData& b) {
+    assert(a.ports == b.ports);
+    assert(a.parameter == b.parameter);
+    assert(a.format == b.format);
+    assert(a.freq_unit == b.freq_unit);
+    assert(a.R == b.R);
+    assert(a.freq.size() == b.freq.size());
+    assert(a.sparams.rows() == b.sparams.rows());
+    assert(a.sparams.cols() == b.sparams.cols());
+    assert((a.freq == b.freq).all());
+    assert((a.sparams == b.sparams).all());
+}
+
+std::string stream_error(const std::string& text, int ports) {
+    std::istringstream ss(text);
+    try {
+        ts::parse_touchstone_stream(ss, "<string>", ports);
+    } catch (const std::runtime_error& e) {
+        return e.what();
+    }
+    return {};
+}
+
+std::string buffer_error(const std::string& text, int ports, const ts::ParseOptions& options = ts::ParseOptions()) {
+    try {
+        ts::parse_touchstone_buffer(text.data(), text.size(), "<string>", ports, options);
+    } catch (const std::runtime_error& e) {
+        return e.what();
+    }
+    return {};
+}
+
+} // namespace
+
+void test_mapped_matches_stream() {
+    const char* files[] = {"test/a (1).s2p", "test/a (2).s2p", "test/a (11).s9p", "test/a (12).s6p",
+                           "test/tline_50_100_50_highres.s1p"};
+    for (const char* path : files) {
+        std::ifstream fin(path);
+        assert(fin);
+        const std::string name(path);
+        const int ports = name.back() == 'p' ? name[name.size() - 2] - '0' : 0;
+        ts::TouchstoneData streamed = ts::parse_touchstone_stream(fin, path, ports);
+        ts::TouchstoneData mapped = ts::parse_touchstone(path);
+        assert_identical(streamed, mapped);
+    }
+}
+
+void test_buffer_continuation_and_comments() {
+    const std::string text =
+        "! header comment\r\n"
+        "# MHz S MA R 75 ! trailing comment\r\n"
+        "1.0 0.5 10 0.25 20 ! first row, first line\r\n"
+        "+ 0.25 30 0.5 40\r\n"
+        "\r\n"
+        "+2.0 0.1 -10 0.2 -20\n"
+        "   0.3 -30 0.4 -40";
+    ts::TouchstoneData data = ts::parse_touchstone_buffer(text.data(), text.size(), "<string>", 2);
+    assert(data.ports == 2);
+    assert(data.R == 75.0);
+    assert(data.freq.size() == 2);
+    assert(data.freq[0] == 1.0e6);
+    assert(data.freq[1] == 2.0e6);
+
+    std::istringstream ss(text);
+    assert_identical(data, ts::parse_touchstone_stream(ss, "<string>", 2));
+}
+
+void test_buffer_errors_match_stream() {
+    const std::string cases[] = {
+        "# Hz S RI R 50\n1.0 0.0\n",
+        "# Hz S RI R 50\n1.0 0.0 0.0 2.0 0.0 0.0\n",
+        "# Hz S RI R 50\n1.0 0.0\n0.0 2.0 0.0\n",
+        "# Hz S RI R 50\n1.0 0.0 0.0 abc\n",
+        "# Hz S RI R 50\n1.0 1e999 0.0\n",
+        "# Hz S RI R 50\n1.0 0.0\n# GHz S RI R 50\n0.0\n",
+        "! only a comment\n",
+    };
+    for (const std::string& text : cases) {
+        const std::string expected = stream_error(text, 1);
+        assert(!expected.empty());
+        assert(buffer_error(text, 1) == expected);
+    }
+}
+
+ts::ParseOptions forced_parallel() {
+    ts::ParseOptions options;
+    options.threads = 4;
+    options.parallel_min_bytes = 0;
+    return options;
+}
+
+ts::ParseOptions forced_serial() {
+    ts::ParseOptions options;
+    options.threads = 1;
+    return options;
+}
+
+void test_parallel_matches_serial() {
+    const char* files[] = {"test/a (1).s2p", "test/a (11).s9p", "test/a (12).s6p", "test/tline_50_100_50_highres.s1p"};
+    for (const char* path : files) {
+        assert_identical(ts::parse_touchstone(path, forced_serial()), ts::parse_touchstone(path, forced_parallel()));
+    }
+
+    // Four-port rows wrap over four lines, so chunk boundaries land inside rows.
+    std::ostringstream text;
+    text << "! generated\n# GHZ S DB R 50\n";
+    for (int k = 0; k < 997; ++k) {
+        text << 0.001 * (k + 1);
+        for (int v = 0; v < 16; ++v) {
+            if (v > 0 && v % 4 == 0) {
+                text << (k % 3 == 0 ? "\n+ " : "\n");
+            }
+            text << ' ' << -0.01 * (k + v) << ' ' << (k * 7 + v * 13) % 360 - 180;
+        }
+        text << (k % 5 == 0 ? " ! row comment\n" : "\n");
+    }
+    const std::string generated = text.str();
+    const ts::TouchstoneData serial = ts::parse_touchstone_buffer(generated.data(), generated.size(), "<generated>", 4, forced_serial());
+    const ts::TouchstoneData parallel = ts::parse_touchstone_buffer(generated.data(), generated.size(), "<generated>", 4, forced_parallel());
+    assert(serial.freq.size() == 997);
+    assert_identical(serial, parallel);
+}
+
+void test_parallel_errors_match_stream() {
+    const std::string cases[] = {
+        "# Hz S RI R 50\n1.0 0.0\n",
+        "# Hz S RI R 50\n1.0 0.0 0.0\n2.0 0.0 0.0 3.0\n4.0 0.0 0.0\n",
+        "# Hz S RI R 50\n1.0 0.0\n0.0 2.0 0.0\n",
+        "# Hz S RI R 50\n1.0 0.0 0.0\n2.0 0.0\n! comment\n\n0.0 abc\n3.0 0.0 0.0 4.0\n",
+        "# Hz S RI R 50\n1.0 0.0 0.0\n2.0 0.0 0.0\n3.0 0.0\n",
+        "# Hz S RI R 50\n1.0 0.0\n# GHz S RI R 50\n0.0\n",
+        "! only a comment\n# Hz S RI R 50\n",
+    };
+    for (const std::string& text : cases) {
+        const std::string expected = stream_error(text, 1);
+        assert(!expected.empty());
+        assert(buffer_error(text, 1, forced_parallel()) == expected);
+    }
+}
+
+namespace {
+
+// Per-value conversions as the parser and writer performed them before the
+// batched kernels. The kernels' packet exp and sincos agree with these to a
+// few ULP; for DB, part of the difference is the reference's own rounding of
+// a / 20, which grows with |a|.
+constexpr double kDegToRad = 3.141592653589793238462643383279502884 / 180.0;
+constexpr double kRadToDeg = 180.0 / 3.141592653589793238462643383279502884;
+constexpr double kConversionUlps = 32.0;
+
+std::complex<double> reference_value(double a, double b, const std::string& format) {
+    if (format == "RI") {
+        return {a, b};
+    }
+    const double mag = format == "DB" ? std::pow(10.0, a / 20.0) : a;
+    return std::polar(mag, b * kDegToRad);
+}
+
+bool close_to(std::complex<double> value, std::complex<double> expected) {
+    return std::abs(value - expected) <= kConversionUlps * std::numeric_limits<double>::epsilon() * std::abs(expected);
+}
+
+bool close_to(double value, double expected, double scale) {
+    return std::abs(value - expected) <= kConversionUlps * std::numeric_limits<double>::epsilon() * scale;
+}
+
+} // namespace
+
+void test_conversion_matches_scalar() {
+    // Two-port rows; the format switches at a second options line mid-file.
+    const char* formats[] = {"DB", "MA", "RI"};
+    std::ostringstream text;
+    std::vector<std::pair<double, double>> pairs;
+    std::vector<std::string> row_formats;
+    for (int block = 0; block < 3; ++block) {
+        text << "# HZ S " << formats[block] << " R 50\n";
+        for (int k = 0; k < 300; ++k) {
+            text.precision(17);
+            text << 1.0e6 * (block * 300 + k + 1);
+            for (int v = 0; v < 4; ++v) {
+                const double a = block == 0 ? -0.137 * (k + v) - 1e-3 : 0.00731 * (k * 3 + v + 1);
+                const double b = std::fmod(k * 17.3 + v * 41.9, 360.0) - 180.0;
+                text << ' ' << a << ' ' << b;
+                pairs.emplace_back(a, b);
+            }
+            text << '\n';
+            row_formats.push_back(formats[block]);
+        }
+    }
+    const std::string body = text.str();
+
+    std::istringstream ss(body);
+    const ts::TouchstoneData results[] = {
+        ts::parse_touchstone_stream(ss, "<string>", 2),
+        ts::parse_touchstone_buffer(body.data(), body.size(), "<string>", 2, forced_serial()),
+        ts::parse_touchstone_buffer(body.data(), body.size(), "<string>", 2, forced_parallel()),
+    };
+    for (const ts::TouchstoneData& data : results) {
+        // Every parse path batches differently but converts each value alike.
+        assert_identical(data, results[0]);
+        assert(data.freq.size() == 900);
+        for (Eigen::Index r = 0; r < data.sparams.rows(); ++r) {
+            for (Eigen::Index c = 0; c < 4; ++c) {
+                const auto& pair = pairs[static_cast<std::size_t>(r * 4 + c)];
+                const std::string& format = row_formats[static_cast<std::size_t>(r)];
+                const std::complex<double> expected = reference_value(pair.first, pair.second, format);
+                if (format == "RI") {
+                    assert(data.sparams(r, c) == expected);
+                } else {
+                    assert(close_to(data.sparams(r, c), expected));
+                }
+            }
+        }
+    }
+
+    // The writer prints 16 significant digits; read them back and compare with
+    // the per-value conversion.
+    ts::TouchstoneData data = results[0];
+    for (const char* format : formats) {
+        data.format = format;
+        std::ostringstream written;
+        ts::write_touchstone_stream(data, written);
+
+        std::istringstream lines(written.str());
+        std::string header;
+        std::getline(lines, header);
+        assert(header == std::string("# HZ S ") + format + " R 50");
+        for (Eigen::Index r = 0; r < data.sparams.rows(); ++r) {
+            double freq = 0.0;
+            assert(lines >> freq);
+            assert(freq == data.freq[r]);
+            for (Eigen::Index c = 0; c < 4; ++c) {
+                double first = 0.0;
+                double second = 0.0;
+                assert(lines >> first >> second);
+                const std::complex<double> value = data.sparams(r, c);
+                if (std::string(format) == "RI") {
+                    assert(close_to(first, value.real(), std::abs(value)));
+                    assert(close_to(second, value.imag(), std::abs(value)));
+                } else {
+                    const double magnitude = std::abs(value);
+                    const double expected = std::string(format) == "DB" ? 20.0 * std::log10(magnitude) : magnitude;
+                    assert(close_to(first, expected, std::max(1.0, std::abs(expected))));
+                    assert(close_to(second, std::arg(value) * kRadToDeg, 180.0));
+                }
+            }
+        }
+    }
+}
+
+void test_conversion_kernel_edge_cases() {
+    // Quarter turns come out exact, where std::polar leaves ~1e-16 residues.
+    const double quarter_turns[] = {1, 0, 1, 90, 1, 180, 1, -90, 1, 270, 1, -540, 2, 450};
+    std::complex<double> values[7];
+    ts::pairs_to_complex(quarter_turns, 7, "MA", values);
+    const std::complex<double> expected_turns[] = {{1, 0}, {0, 1}, {-1, 0}, {0, -1}, {0, -1}, {-1, 0}, {0, 2}};
+    for (int i = 0; i < 7; ++i) {
+        assert(values[i] == expected_turns[i]);
+    }
+
+    // Angles too large to reduce, and non-finite ones, fall back to std::polar.
+    const double odd_angles[] = {-6.0, 1e13 + 7.0, 0.5, std::nan(""), 1.0, std::numeric_limits<double>::infinity()};
+    ts::pairs_to_complex(odd_angles, 3, "db", values);
+    assert(close_to(values[0], std::polar(std::pow(10.0, -6.0 / 20.0), (1e13 + 7.0) * kDegToRad)));
+    assert(std::isnan(values[1].real()) && std::isnan(values[1].imag()));
+    assert(std::isnan(values[2].real()) && std::isnan(values[2].imag()));
+
+    // Very small and large magnitudes keep finite dB values even though |s|^2
+    // leaves the double range; zero is -inf.
+    const std::complex<double> extremes[] = {{1e-200, 0.0}, {0.0, -1e200}, {0.0, 0.0}, {3e-160, 4e-160}};
+    double pairs[8];
+    ts::complex_to_pairs(extremes, 4, "DB", pairs);
+    assert(close_to(pairs[0], -4000.0, 4000.0));
+    assert(close_to(pairs[2], 4000.0, 4000.0));
+    assert(std::isinf(pairs[4]) && pairs[4] < 0);
+    assert(close_to(pairs[6], 20.0 * std::log10(5e-160), 3200.0));
+    assert(close_to(pairs[3], -90.0, 180.0));
+    ts::complex_to_pairs(extremes, 4, "MA", pairs);
+    assert(close_to(pairs[0], 1e-200, 1e-200));
+    assert(close_to(pairs[2], 1e200, 1e200));
+    assert(pairs[4] == 0.0);
+    assert(close_to(pairs[6], 5e-160, 5e-160));
+
+    bool threw = false;
+    try {
+        ts::pairs_to_complex(quarter_turns, 1, "XY", values);
+    } catch (const std::runtime_error&) {
+        threw = true;
+    }
+    assert(threw);
+}
+
+void test_probe_matches_parse() {
+    const char* files[] = {"test/a (1).s2p", "test/a (2).s2p", "test/a (11).s9p", "test/a (12).s6p",
+                           "test/tline_50_100_50_highres.s1p"};
+    for (const char* path : files) {
+        const ts::TouchstoneData data = ts::parse_touchstone(path);
+        const ts::TouchstoneProbe probe = ts::probe_touchstone(path);
+        assert(probe.ports == data.ports);
+        assert(probe.parameter == data.parameter);
+        assert(probe.format == data.format);
+        assert(probe.freq_unit == data.freq_unit);
+        assert(probe.R == data.R);
+        assert(probe.fmin == data.freq.minCoeff());
+        assert(probe.fmax == data.freq.maxCoeff());
+        const double points = static_cast<double>(data.freq.size());
+        assert(std::abs(static_cast<double>(probe.estimated_points) - points) <= 0.1 * points + 1);
+    }
+}
+
+void test_probe_layouts() {
+    const std::filesystem::path dir = std::filesystem::temp_directory_path();
+    const auto probe_text = [&](const std::string& name, const std::string& text) {
+        const std::string path = (dir / name).string();
+        {
+            std::ofstream out(path, std::ios::binary);
+            out << text;
+        }
+        const ts::TouchstoneProbe probe = ts::probe_touchstone(path);
+        std::filesystem::remove(path);
+        return probe;
+    };
+
+    // Wrapped four-port rows with fixed width, CRLF endings and no final newline.
+    std::ostringstream wrapped;
+    wrapped << "! header comment\r\n# MHZ S RI R 75\r\n";
+    for (int k = 0; k < 40; ++k) {
+        wrapped << (k == 0 ? "" : "\r\n") << 100 + k;
+        for (int v = 0; v < 16; ++v) {
+            wrapped << (v > 0 && v % 4 == 0 ? "\r\n+  " : " ") << "0.5 -0.5";
+        }
+    }
+    ts::TouchstoneProbe probe = probe_text("fsnpview_probe_wrapped.s4p", wrapped.str() + " ! trailing\r\n\r\n");
+    assert(probe.ports == 4);
+    assert(probe.format == "RI");
+    assert(probe.R == 75.0);
+    assert(probe.fmin == 100e6);
+    assert(probe.fmax == 139e6);
+    assert(probe.estimated_points == 40);
+
+    probe = probe_text("fsnpview_probe_single.s1p", "# HZ S MA R 50\n5 0.5 10");
+    assert(probe.fmin == 5.0 && probe.fmax == 5.0);
+    assert(probe.estimated_points == 1);
+
+    // Without an .sNp extension the port count is unknown and the file is parsed in full.
+    probe = probe_text("fsnpview_probe_noext.txt", "# GHZ S MA R 50\n3 0.5 10\n1 0.5 10\n2 0.5 10\n");
+    assert(probe.ports == 1);
+    assert(probe.fmin == 1e9 && probe.fmax == 3e9);
+    assert(probe.estimated_points == 3);
+
+    bool threw = false;
+    try {
+        ts::probe_touchstone((dir / "fsnpview_probe_missing.s2p").string());
+    } catch (const std::runtime_error&) {
+        threw = true;
+    }
+    assert(threw);
+}
+
 int main() {
     test_basic_parse();
     test_second_file();
@@ -104,6 +473,15 @@ int main() {
     test_write_roundtrip();
     test_write_invalid_dimensions();
     test_multiport_files();
+    test_mapped_matches_stream();
+    test_buffer_continuation_and_comments();
+    test_buffer_errors_match_stream();
+    test_parallel_matches_serial();
+    test_parallel_errors_match_stream();
+    test_conversion_matches_scalar();
+    test_conversion_kernel_edge_cases();
+    test_probe_matches_parse();
+    test_probe_layouts();
     std::cout << "All parser tests passed." << std::endl;
     return 0;
 }
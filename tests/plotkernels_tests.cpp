@@ -0,0 +1,177 @@
+#include "plotkernels.h"
+
+#include <cassert>
+#include <chrono>
+#include <cmath>
+#include <complex>
+#include <iostream>
+#include <limits>
+#include <random>
+
+namespace {
+
+constexpr double kPi = 3.14159265358979323846;
+
+// The quadratic unwrap the kernels replace: every jump shifts the whole tail.
+Eigen::ArrayXd reference_unwrap(const Eigen::ArrayXd& phase)
+{
+    Eigen::ArrayXd unwrapped = phase;
+    for (Eigen::Index i = 1; i < phase.size(); ++i) {
+        const double diff = unwrapped(i) - unwrapped(i - 1);
+        if (diff > kPi) {
+            for (Eigen::Index j = i; j < phase.size(); ++j)
+                unwrapped(j) -= 2 * kPi;
+        } else if (diff < -kPi) {
+            for (Eigen::Index j = i; j < phase.size(); ++j)
+                unwrapped(j) += 2 * kPi;
+        }
+    }
+    return unwrapped;
+}
+
+double reference_wrap(double value)
+{
+    if (!std::isfinite(value))
+        return value;
+    while (value < -kPi - 1e-12)
+        value += 2 * kPi;
+    while (value > kPi + 1e-12)
+        value -= 2 * kPi;
+    if (value >= kPi - 1e-12)
+        value -= 2 * kPi;
+    return value;
+}
+
+Eigen::ArrayXd reference_group_delay(const Eigen::ArrayXd& phase, const Eigen::ArrayXd& freq)
+{
+    const Eigen::Index count = phase.size();
+    Eigen::ArrayXd delay = Eigen::ArrayXd::Zero(count);
+    for (Eigen::Index i = 0; count > 1 && i < count; ++i) {
+        const Eigen::Index prev = i == 0 ? i : i - 1;
+        const Eigen::Index next = i == count - 1 ? i : i + 1;
+        const double df = freq(next) - freq(prev);
+        if (std::abs(df) >= std::numeric_limits<double>::epsilon())
+            delay(i) = -((phase(next) - phase(prev)) / df) / (2 * kPi);
+    }
+    return delay;
+}
+
+// A delay line with noise: the phase wraps thousands of times.
+Eigen::ArrayXcd noisy_line(Eigen::Index points, const Eigen::ArrayXd& freq)
+{
+    std::mt19937 rng(7);
+    std::normal_distribution<double> noise(0.0, 0.3);
+    Eigen::ArrayXcd sparam(points);
+    for (Eigen::Index i = 0; i < points; ++i)
+        sparam(i) = std::polar(0.2 + 0.7 * i / static_cast<double>(points), -2 * kPi * freq(i) * 2e-9 + noise(rng));
+    return sparam;
+}
+
+bool close(const Eigen::ArrayXd& a, const Eigen::ArrayXd& b, double tol)
+{
+    return a.size() == b.size() && ((a - b).abs() <= tol * (1.0 + b.abs())).all();
+}
+
+} // namespace
+
+void test_wrap_matches_loop()
+{
+    Eigen::ArrayXd values(9);
+    values << kPi, -kPi, kPi + 1e-10, -kPi - 1e-10, kPi - 1e-10, 7.5, -40.0, 1e4,
+        std::numeric_limits<double>::infinity();
+    const Eigen::ArrayXd wrapped = PlotKernels::wrapPhase(values);
+    for (Eigen::Index i = 0; i + 1 < values.size(); ++i)
+        assert(std::abs(wrapped(i) - reference_wrap(values(i))) < 1e-9);
+    assert(std::isinf(wrapped(values.size() - 1)));
+}
+
+void test_unwrap_matches_reference()
+{
+    const Eigen::Index points = 20000;
+    const Eigen::ArrayXd freq = Eigen::ArrayXd::LinSpaced(points, 1e6, 20e9);
+    const Eigen::ArrayXcd sparam = noisy_line(points, freq);
+    const Eigen::ArrayXd phase = sparam.arg();
+
+    assert(close(PlotKernels::unwrapPhase(phase), reference_unwrap(phase), 1e-12));
+    assert(close(PlotKernels::groupDelay(phase, freq), reference_group_delay(phase, freq), 1e-12));
+}
+
+void test_fused_views_match_separate_kernels()
+{
+    const Eigen::Index points = 4001;
+    Eigen::ArrayXd freq = Eigen::ArrayXd::LinSpaced(points, 1e6, 20e9);
+    freq(10) = freq(9); // repeated frequency: zero delay on both sides
+    const Eigen::ArrayXcd sparam = noisy_line(points, freq);
+
+    const unsigned all = PlotKernels::MagnitudeDb | PlotKernels::Vswr | PlotKernels::Phase | PlotKernels::GroupDelay;
+    for (bool unwrap : {false, true}) {
+        const PlotKernels::Views views = PlotKernels::computeViews(freq, sparam, all, unwrap);
+        Eigen::ArrayXd phase = PlotKernels::wrapPhase(Eigen::ArrayXd(sparam.arg()));
+        if (unwrap)
+            phase = reference_unwrap(phase);
+        assert(close(views.phase, phase, 1e-12));
+        assert(close(views.groupDelay, reference_group_delay(phase, freq), 1e-9));
+        assert(close(views.magnitudeDb, Eigen::ArrayXd(20 * sparam.abs().log10()), 1e-12));
+        assert(close(views.vswr, Eigen::ArrayXd((1 + sparam.abs()) / (1 - sparam.abs())), 1e-12));
+    }
+
+    const PlotKernels::Views delayOnly = PlotKernels::computeViews(freq, sparam, PlotKernels::GroupDelay, true);
+    assert(delayOnly.phase.size() == 0);
+    assert(delayOnly.magnitudeDb.size() == 0);
+    assert(delayOnly.groupDelay.size() == points);
+}
+
+void test_db_of_tiny_magnitudes()
+{
+    Eigen::ArrayXcd sparam(4);
+    sparam << std::complex<double>(1e-200, 0.0), std::complex<double>(0.0, 3e-170), 0.5, 0.0;
+    const Eigen::ArrayXd expected = 20 * sparam.abs().log10();
+    const Eigen::ArrayXd single = PlotKernels::magnitudeDb(sparam);
+    const Eigen::ArrayXd fused = PlotKernels::computeViews(Eigen::ArrayXd::LinSpaced(4, 1e6, 4e6), sparam,
+                                                           PlotKernels::MagnitudeDb, false).magnitudeDb;
+    for (const Eigen::ArrayXd& db : {single, fused}) {
+        assert(std::abs(db(0) + 4000.0) < 1e-9);
+        assert(close(db.head(3), expected.head(3), 1e-12));
+        assert(std::isinf(db(3)) && db(3) < 0);
+    }
+}
+
+void test_short_columns()
+{
+    const Eigen::ArrayXd freq = Eigen::ArrayXd::Constant(1, 1e9);
+    const Eigen::ArrayXcd sparam = Eigen::ArrayXcd::Constant(1, std::complex<double>(0.0, 0.5));
+    const PlotKernels::Views views = PlotKernels::computeViews(freq, sparam, PlotKernels::Phase | PlotKernels::GroupDelay, true);
+    assert(views.phase.size() == 1);
+    assert(views.groupDelay.size() == 1 && views.groupDelay(0) == 0.0);
+
+    const PlotKernels::Views empty = PlotKernels::computeViews(Eigen::ArrayXd(), Eigen::ArrayXcd(), PlotKernels::Phase, true);
+    assert(empty.phase.size() == 0);
+}
+
+void test_unwrap_is_linear_time()
+{
+    // Alternating jumps are the quadratic reference's worst case.
+    const Eigen::Index points = 400000;
+    Eigen::ArrayXd phase(points);
+    for (Eigen::Index i = 0; i < points; ++i)
+        phase(i) = (i % 2 == 0) ? 3.0 : -3.0;
+
+    const auto start = std::chrono::steady_clock::now();
+    const Eigen::ArrayXd unwrapped = PlotKernels::unwrapPhase(phase);
+    const double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    assert(unwrapped.size() == points);
+    assert(std::abs(unwrapped(1) - (-3.0 + 2 * kPi)) < 1e-12);
+    std::cout << "Unwrapped " << points << " points in " << seconds * 1e3 << " ms" << std::endl;
+}
+
+int main()
+{
+    test_wrap_matches_loop();
+    test_unwrap_matches_reference();
+    test_fused_views_match_separate_kernels();
+    test_db_of_tiny_magnitudes();
+    test_short_columns();
+    test_unwrap_is_linear_time();
+    std::cout << "All plot kernel tests passed." << std::endl;
+    return 0;
+}
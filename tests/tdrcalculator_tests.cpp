@@ -1,16 +1,134 @@
 #include "tdrcalculator.h"
 
 #include <Eigen/Dense>
+#include <unsupported/Eigen/FFT>
 #include <QtGlobal>
 #include <algorithm>
 #include <cassert>
 #include <cmath>
 #include <complex>
 #include <iostream>
+#include <thread>
+#include <vector>
 
 namespace
 {
 constexpr double kPi = 3.14159265358979323846;
+
+void delayedReflection(int sampleCount, Eigen::ArrayXd& frequency, Eigen::ArrayXcd& reflection)
+{
+    frequency = Eigen::ArrayXd::LinSpaced(sampleCount, 0.0, 10e6 * static_cast<double>(sampleCount - 1));
+    reflection.resize(sampleCount);
+    for (int i = 0; i < sampleCount; ++i)
+        reflection(i) = std::polar(0.5, -2.0 * kPi * frequency(i) * 10e-9);
+}
+
+// The transform as it was done with complex FFTs: the same resampling, filter
+// and taper, then a full conjugate-symmetric spectrum of Nfft bins through a
+// complex inverse FFT, keeping the real part. Expects sorted, uniformly spaced
+// frequencies.
+std::vector<std::complex<double>> referenceSpectrum(const Eigen::ArrayXd& frequency,
+                                                    const Eigen::ArrayXcd& reflection,
+                                                    const TDRCalculator::Parameters& params)
+{
+    const Eigen::Index m = frequency.size();
+    const double df = (frequency.tail(m - 1) - frequency.head(m - 1)).mean();
+    std::size_t nfft = 1;
+    while (nfft < static_cast<std::size_t>(2 * (m - 1)))
+        nfft <<= 1;
+    nfft = std::max<std::size_t>(nfft, 1u << 17);
+    const std::size_t bins = nfft / 2 + 1;
+
+    Eigen::ArrayXcd positive = Eigen::ArrayXcd::Zero(static_cast<Eigen::Index>(bins));
+    for (std::size_t i = 0; i < bins; ++i) {
+        const double fb = df * double(i);
+        if (fb > frequency(m - 1))
+            continue;
+        const double* it = std::lower_bound(frequency.data(), frequency.data() + m, fb);
+        const Eigen::Index hi = it - frequency.data();
+        if (hi == 0) {
+            positive(0) = reflection(0);
+        } else {
+            const double t = (fb - frequency(hi - 1)) / (frequency(hi) - frequency(hi - 1) + 1e-30);
+            positive(i) = reflection(hi - 1) + (reflection(hi) - reflection(hi - 1)) * t;
+        }
+    }
+
+    if (params.risetime > 0.0 && params.filter != TDRCalculator::Parameters::FilterType::None) {
+        const double fc = 0.35 / params.risetime;
+        const double roll = std::clamp(params.rolloff, 0.0, 1.0);
+        for (std::size_t i = 0; i < bins; ++i) {
+            const double f = df * double(i);
+            double h = 1.0;
+            if (params.filter == TDRCalculator::Parameters::FilterType::Gaussian)
+                h = std::exp(-std::pow(f / fc, 2.0));
+            else if (f >= (1.0 + roll) * fc)
+                h = 0.0;
+            else if (f > (1.0 - roll) * fc)
+                h = 0.5 * (1.0 + std::cos(kPi * (f - (1.0 - roll) * fc) / (2.0 * roll * fc)));
+            positive(i) *= h;
+        }
+    }
+
+    const int n = static_cast<int>(bins);
+    const int edge = std::max<int>(1, int(0.10 * (n - 1)));
+    for (int i = n - edge; i < n; ++i)
+        positive(i) *= 0.5 * (1.0 + std::cos(kPi * double(i - (n - edge)) / double(edge - 1)));
+
+    std::vector<std::complex<double>> full(nfft);
+    for (std::size_t i = 0; i < bins; ++i)
+        full[i] = positive(static_cast<Eigen::Index>(i));
+    for (std::size_t i = 1; i < bins; ++i)
+        full[nfft - i] = std::conj(positive(static_cast<Eigen::Index>(i)));
+    return full;
+}
+
+Eigen::ArrayXd referenceImpulse(const std::vector<std::complex<double>>& spectrum)
+{
+    Eigen::FFT<double> fft;
+    std::vector<std::complex<double>> time(spectrum.size());
+    fft.inv(time, spectrum);
+    Eigen::ArrayXd impulse(static_cast<Eigen::Index>(time.size()));
+    for (std::size_t i = 0; i < time.size(); ++i)
+        impulse(static_cast<Eigen::Index>(i)) = time[i].real();
+    return impulse;
+}
+
+QVector<double> referenceImpedance(const Eigen::ArrayXd& impulse, double z0)
+{
+    Eigen::ArrayXd rho(impulse.size());
+    double acc = 0.0;
+    for (Eigen::Index i = 0; i < impulse.size(); ++i)
+        rho(i) = acc += impulse(i);
+    rho -= rho.head(std::min<Eigen::Index>(rho.size(), 64)).mean();
+    rho = rho.min(0.999).max(-0.999);
+    QVector<double> impedance(static_cast<int>(rho.size()));
+    for (Eigen::Index i = 0; i < rho.size(); ++i)
+        impedance[static_cast<int>(i)] = z0 * (1.0 + rho(i)) / (1.0 - rho(i));
+    return impedance;
+}
+
+double maxDifference(const QVector<double>& a, const QVector<double>& b)
+{
+    assert(a.size() == b.size());
+    double worst = 0.0;
+    for (int i = 0; i < a.size(); ++i)
+        worst = std::max(worst, std::abs(a[i] - b[i]));
+    return worst;
+}
+
+// A few reflections at different delays, so the record has structure.
+void multiReflection(int sampleCount, double spacing, Eigen::ArrayXd& frequency, Eigen::ArrayXcd& reflection)
+{
+    frequency = Eigen::ArrayXd::LinSpaced(sampleCount, 0.0, spacing * static_cast<double>(sampleCount - 1));
+    reflection.resize(sampleCount);
+    for (int i = 0; i < sampleCount; ++i) {
+        const double f = frequency(i);
+        reflection(i) = std::polar(0.2, -2.0 * kPi * f * 0.4e-9)
+                        + std::polar(-0.15, -2.0 * kPi * f * 1.3e-9)
+                        + std::polar(0.1 / (1.0 + f * 1e-10), -2.0 * kPi * f * 2.7e-9);
+    }
+}
 }
 
 void test_step_response_has_plateau()
@@ -76,9 +194,185 @@ void test_step_response_has_plateau()
     std::cout << "TDR calculator step response test passed." << std::endl;
 }
 
+void test_workspaces_are_reused()
+{
+    Eigen::ArrayXd frequency;
+    Eigen::ArrayXcd reflection;
+    delayedReflection(1024, frequency, reflection);
+
+    TDRCalculator calculator;
+    TDRCalculator::Parameters params(50.0, 1.0, 299792458.0);
+    const auto first = calculator.compute(frequency, reflection, params);
+    TDRCalculator::resetWorkspaceStats();
+
+    // A warm pool serves every later transform of the same length, and a
+    // reused workspace leaves nothing behind from the previous trace.
+    const auto second = calculator.compute(frequency, reflection, params);
+    const auto gated = calculator.applyGate(frequency, reflection, 0.0, 2.0, 1.0, params);
+    const auto third = calculator.compute(frequency, reflection, params);
+    assert(gated);
+    assert(first.impedance == second.impedance);
+    assert(first.impedance == third.impedance);
+    assert(first.distance == third.distance);
+
+    const TDRCalculator::WorkspaceStats stats = TDRCalculator::workspaceStats();
+    assert(stats.hits == 3);
+    assert(stats.misses == 0);
+    assert(stats.idle >= 1);
+    assert(stats.bytes > 0);
+    assert(stats.hitRate() == 1.0);
+
+    // Longer sweeps need a longer record and get their own workspace.
+    Eigen::ArrayXd longFrequency;
+    Eigen::ArrayXcd longReflection;
+    delayedReflection(70000, longFrequency, longReflection);
+    const auto longer = calculator.compute(longFrequency, longReflection, params);
+    assert(longer.impedance.size() == 2 * first.impedance.size());
+    assert(TDRCalculator::workspaceStats().misses == 1);
+    std::cout << "TDR workspace reuse test passed." << std::endl;
+}
+
+void test_concurrent_transforms_match_serial()
+{
+    Eigen::ArrayXd frequency;
+    Eigen::ArrayXcd reflection;
+    delayedReflection(1024, frequency, reflection);
+
+    TDRCalculator calculator;
+    const auto expected = calculator.compute(frequency, reflection);
+    const auto expectedGate = calculator.applyGate(frequency, reflection, 0.5, 2.0, 2.0);
+    assert(expectedGate);
+
+    std::vector<std::thread> threads;
+    std::vector<int> matches(6, 0);
+    for (std::size_t t = 0; t < matches.size(); ++t) {
+        threads.emplace_back([&, t] {
+            for (int run = 0; run < 3; ++run) {
+                const auto result = calculator.compute(frequency, reflection);
+                const auto gate = calculator.applyGate(frequency, reflection, 0.5, 2.0, 2.0);
+                if (result.impedance == expected.impedance && gate
+                    && gate->impedance == expectedGate->impedance
+                    && (gate->gatedReflection == expectedGate->gatedReflection).all())
+                    ++matches[t];
+            }
+        });
+    }
+    for (std::thread& thread : threads)
+        thread.join();
+    for (int count : matches)
+        assert(count == 3);
+    std::cout << "TDR concurrent workspace test passed." << std::endl;
+}
+
+void test_real_transforms_match_complex_reference()
+{
+    using Filter = TDRCalculator::Parameters::FilterType;
+    TDRCalculator calculator;
+    // 70001 points need a record of 2^18 samples rather than the 2^17 floor.
+    for (int sampleCount : {401, 70001}) {
+        Eigen::ArrayXd frequency;
+        Eigen::ArrayXcd reflection;
+        multiReflection(sampleCount, 20e9 / sampleCount, frequency, reflection);
+        for (Filter filter : {Filter::None, Filter::Gaussian, Filter::RaisedCosine}) {
+            const TDRCalculator::Parameters params(50.0, 2.0, 299792458.0, 15e-12, filter, 0.4);
+            const Eigen::ArrayXd impulse = referenceImpulse(referenceSpectrum(frequency, reflection, params));
+            const auto result = calculator.compute(frequency, reflection, params);
+            assert(result.impedance.size() == impulse.size());
+            assert(maxDifference(result.impedance, referenceImpedance(impulse, 50.0)) < 1e-9);
+        }
+    }
+
+    // An all-pass gate reproduces the ungated trace, and its spectrum is the
+    // complex forward FFT of the reference impulse on the measured bins.
+    Eigen::ArrayXd frequency;
+    Eigen::ArrayXcd reflection;
+    multiReflection(801, 25e6, frequency, reflection);
+    const TDRCalculator::Parameters params(50.0, 1.0, 299792458.0);
+    const Eigen::ArrayXd impulse = referenceImpulse(referenceSpectrum(frequency, reflection, params));
+    const auto gated = calculator.applyGate(frequency, reflection, 0.0, 1e3, 1.0, params);
+    assert(gated);
+    assert(maxDifference(gated->impedance, referenceImpedance(impulse, 50.0)) < 1e-9);
+
+    Eigen::FFT<double> fft;
+    std::vector<double> samples(impulse.data(), impulse.data() + impulse.size());
+    std::vector<std::complex<double>> spectrum;
+    fft.fwd(spectrum, samples);
+    double worst = 0.0;
+    for (Eigen::Index i = 0; i < frequency.size(); ++i)
+        worst = std::max(worst, std::abs(gated->gatedReflection(i) - spectrum[static_cast<std::size_t>(i)]));
+    assert(worst < 1e-12);
+    std::cout << "TDR real-transform equivalence test passed." << std::endl;
+}
+
+void test_window_matches_full_record()
+{
+    using Filter = TDRCalculator::Parameters::FilterType;
+    TDRCalculator calculator;
+    // 65537 points fill every bin up to Nyquist.
+    for (int sampleCount : {801, 65537}) {
+        Eigen::ArrayXd frequency;
+        Eigen::ArrayXcd reflection;
+        multiReflection(sampleCount, 20e9 / (sampleCount - 1), frequency, reflection);
+        for (Filter filter : {Filter::Gaussian, Filter::None}) {
+            const TDRCalculator::Parameters params(50.0, 2.0, 299792458.0, 15e-12, filter);
+            const auto full = calculator.compute(frequency, reflection, params);
+
+            // On the record's own grid the window reproduces it.
+            TDRCalculator::DistanceWindow window;
+            window.startDistance = full.distance[300];
+            window.stopDistance = full.distance[1300];
+            window.points = 1001;
+            const auto zoomed = calculator.computeWindow(frequency, reflection, window, params);
+            assert(zoomed.distance.size() == 1001 && zoomed.impedance.size() == 1001);
+            for (int i = 0; i < zoomed.distance.size(); ++i) {
+                assert(std::abs(zoomed.distance[i] - full.distance[300 + i]) < 1e-12);
+                assert(std::abs(zoomed.impedance[i] - full.impedance[300 + i]) < 1e-8);
+            }
+
+            // Twice as dense: every other sample lies on the grid, the rest
+            // interpolate between their neighbours' range.
+            window.points = 2001;
+            const auto dense = calculator.computeWindow(frequency, reflection, window, params);
+            for (int i = 0; i < dense.impedance.size(); ++i) {
+                if (i % 2 == 0) {
+                    assert(std::abs(dense.impedance[i] - full.impedance[300 + i / 2]) < 1e-8);
+                } else {
+                    const double a = full.impedance[300 + i / 2];
+                    const double b = full.impedance[301 + i / 2];
+                    assert(dense.impedance[i] > std::min(a, b) - 1.0 && dense.impedance[i] < std::max(a, b) + 1.0);
+                }
+            }
+        }
+    }
+
+    // Windows are clipped to the record; empty ones give nothing.
+    Eigen::ArrayXd frequency;
+    Eigen::ArrayXcd reflection;
+    multiReflection(801, 25e6, frequency, reflection);
+    const auto full = calculator.compute(frequency, reflection);
+    TDRCalculator::DistanceWindow window;
+    window.startDistance = -1.0;
+    window.stopDistance = 1e3;
+    window.points = 11;
+    const auto clipped = calculator.computeWindow(frequency, reflection, window);
+    assert(clipped.distance.first() == 0.0);
+    assert(std::abs(clipped.distance.last() - full.distance.last()) < 1e-12);
+    assert(std::abs(clipped.impedance.last() - full.impedance.last()) < 1e-8);
+    window.points = 1;
+    assert(calculator.computeWindow(frequency, reflection, window).distance.isEmpty());
+    window.points = 11;
+    window.stopDistance = window.startDistance;
+    assert(calculator.computeWindow(frequency, reflection, window).distance.isEmpty());
+    std::cout << "TDR chirp-Z window test passed." << std::endl;
+}
+
 int main()
 {
     test_step_response_has_plateau();
+    test_workspaces_are_reused();
+    test_concurrent_transforms_match_serial();
+    test_real_transforms_match_complex_reference();
+    test_window_matches_full_record();
     return 0;
 }
 
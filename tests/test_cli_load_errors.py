@@ -0,0 +1,74 @@
+#!/usr/bin/env python3
+"""Check that fsnpview --nogui rejects Touchstone files whose body does not parse."""
+from __future__ import annotations
+
+import os
+import subprocess
+import sys
+import tempfile
+from pathlib import Path
+
+GOOD_ROW = "-30 10 -0.5 -20 -0.5 -20 -30 10"
+
+
+def resolve_fsnpview_binary(repo_root: Path) -> Path | None:
+    env_override = os.environ.get("FSNPVIEW_BINARY")
+    candidates = [Path(env_override)] if env_override else []
+    candidates += [repo_root / "fsnpview", repo_root / "fsnpview.exe"]
+    for candidate in candidates:
+        if not candidate.is_absolute():
+            candidate = repo_root / candidate
+        if candidate.is_file():
+            return candidate
+    return None
+
+
+def run(binary: Path, args: list[str], cwd: Path) -> subprocess.CompletedProcess[str]:
+    env = os.environ.copy()
+    env.setdefault("QT_QPA_PLATFORM", "offscreen")
+    return subprocess.run([str(binary), "--nogui", *args], cwd=cwd, env=env, capture_output=True, text=True)
+
+
+def main() -> int:
+    repo_root = Path(__file__).resolve().parents[1]
+    binary = resolve_fsnpview_binary(repo_root)
+    if binary is None:
+        print("fsnpview binary not found. Build the project and/or set FSNPVIEW_BINARY.", file=sys.stderr)
+        return 1
+
+    failures: list[str] = []
+    with tempfile.TemporaryDirectory() as scratch:
+        scratch_dir = Path(scratch)
+        good = scratch_dir / "good.s2p"
+        good.write_text(f"# GHZ S DB R 50\n1 {GOOD_ROW}\n2 {GOOD_ROW}\n3 {GOOD_ROW}\n")
+        # Header, first and last row probe fine; only the full parse sees the cut row.
+        broken = scratch_dir / "broken.s2p"
+        broken.write_text(f"# GHZ S DB R 50\n1 {GOOD_ROW}\n2 -30 10 -0.5\n3 {GOOD_ROW}\n")
+        saved = scratch_dir / "out.s2p"
+
+        result = run(binary, [str(good)], repo_root)
+        if result.returncode != 0 or "Loaded file" not in result.stdout:
+            failures.append(f"good file rejected: {result.stderr.strip()}")
+
+        result = run(binary, [str(broken)], repo_root)
+        if result.returncode == 0 or "Loaded file" in result.stdout or "Failed to load" not in result.stderr:
+            failures.append("broken file listed as loaded")
+
+        result = run(binary, ["--cascade", str(broken), "--save", str(saved)], repo_root)
+        if result.returncode == 0 or saved.exists() or "Failed to load" not in result.stderr:
+            failures.append("broken file accepted into the cascade")
+
+        result = run(binary, ["--cascade", str(good), str(good), "--save", str(saved)], repo_root)
+        if result.returncode != 0 or not saved.exists():
+            failures.append(f"cascade of good files failed: {result.stderr.strip()}")
+
+    for failure in failures:
+        print(f"ERROR: {failure}", file=sys.stderr)
+    if failures:
+        return 1
+    print("CLI load error tests passed.")
+    return 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())
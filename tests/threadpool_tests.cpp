@@ -0,0 +1,73 @@
+#include "threadpool.h"
+
+#include <atomic>
+#include <cassert>
+#include <iostream>
+#include <stdexcept>
+#include <vector>
+
+void test_parallel_for_visits_every_index()
+{
+    ThreadPool pool(4);
+    assert(pool.threadCount() == 4);
+
+    std::vector<int> hits(10000, 0);
+    pool.parallelFor(hits.size(), [&](std::size_t i) { hits[i] += 1; });
+    for (int hit : hits)
+        assert(hit == 1);
+}
+
+void test_parallel_for_respects_max_threads()
+{
+    ThreadPool pool(4);
+    std::atomic<int> active{0};
+    std::atomic<int> peak{0};
+    pool.parallelFor(64, [&](std::size_t) {
+        const int now = ++active;
+        int expected = peak.load();
+        while (now > expected && !peak.compare_exchange_weak(expected, now)) {
+        }
+        for (volatile int spin = 0; spin < 10000; ++spin) {
+        }
+        --active;
+    }, 2);
+    assert(peak.load() <= 2);
+}
+
+void test_parallel_for_rethrows()
+{
+    ThreadPool pool(3);
+    std::atomic<int> calls{0};
+    bool threw = false;
+    try {
+        pool.parallelFor(100, [&](std::size_t i) {
+            ++calls;
+            if (i == 42)
+                throw std::runtime_error("boom");
+        });
+    } catch (const std::runtime_error&) {
+        threw = true;
+    }
+    assert(threw);
+    assert(calls.load() == 100);
+}
+
+void test_nested_parallel_for()
+{
+    ThreadPool pool(2);
+    std::atomic<int> total{0};
+    pool.parallelFor(8, [&](std::size_t) {
+        pool.parallelFor(8, [&](std::size_t) { ++total; });
+    });
+    assert(total.load() == 64);
+}
+
+int main()
+{
+    test_parallel_for_visits_every_index();
+    test_parallel_for_respects_max_threads();
+    test_parallel_for_rethrows();
+    test_nested_parallel_for();
+    std::cout << "All ThreadPool tests passed." << std::endl;
+    return 0;
+}
@@ -0,0 +1,220 @@
+#include "touchstone_cache.h"
+#include "parser_touchstone.h"
+
+#include <cassert>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <iterator>
+#include <optional>
+#include <sstream>
+#include <string>
+
+#ifndef _WIN32
+#include <sys/wait.h>
+#include <unistd.h>
+#endif
+
+namespace fs = std::filesystem;
+
+namespace {
+
+fs::path scratch_directory()
+{
+    const fs::path dir = fs::temp_directory_path() / "fsnpview_cache_tests";
+    fs::remove_all(dir);
+    fs::create_directories(dir);
+    return dir;
+}
+
+void write_text(const fs::path& path, const std::string& text)
+{
+    std::ofstream out(path, std::ios::binary | std::ios::trunc);
+    out << text;
+}
+
+std::string two_port(double s11_db)
+{
+    std::ostringstream text;
+    text << "# GHZ S DB R 50\n";
+    for (int k = 1; k <= 20; ++k)
+        text << 0.1 * k << ' ' << s11_db << " 10 -0.5 -20 -0.5 -20 " << s11_db << " 10\n";
+    return text.str();
+}
+
+ts::ParseOptions cached(const std::string& cache_dir = std::string())
+{
+    ts::ParseOptions options;
+    options.use_cache = true;
+    options.cache_dir = cache_dir;
+    return options;
+}
+
+void assert_identical(const ts::TouchstoneData& a, const ts::TouchstoneData& b)
+{
+    assert(a.ports == b.ports);
+    assert(a.parameter == b.parameter);
+    assert(a.format == b.format);
+    assert(a.freq_unit == b.freq_unit);
+    assert(a.R == b.R);
+    assert(a.freq.size() == b.freq.size());
+    assert(a.sparams.rows() == b.sparams.rows());
+    assert(a.sparams.cols() == b.sparams.cols());
+    assert((a.freq == b.freq).all());
+    assert((a.sparams == b.sparams).all());
+}
+
+} // namespace
+
+void test_cached_load_matches_parse()
+{
+    const fs::path dir = scratch_directory();
+    const char* files[] = {"test/a (1).s2p", "test/a (11).s9p", "test/tline_50_100_50_highres.s1p"};
+    for (const char* source : files) {
+        const fs::path copy = dir / fs::path(source).filename();
+        fs::copy_file(source, copy);
+        const std::string path = copy.string();
+
+        const ts::TouchstoneData parsed = ts::parse_touchstone(path);
+        const ts::TouchstoneData cold = ts::parse_touchstone(path, cached());
+        assert(fs::exists(ts::cache_path_for(path)));
+        const ts::TouchstoneData warm = ts::parse_touchstone(path, cached());
+        assert_identical(parsed, cold);
+        assert_identical(parsed, warm);
+    }
+}
+
+void test_stale_entry_is_rebuilt()
+{
+    const fs::path dir = scratch_directory();
+    const std::string path = (dir / "dut.s2p").string();
+    write_text(path, two_port(-30.0));
+    ts::parse_touchstone(path, cached());
+
+    // Same size and a restored mtime: only the content hash tells them apart.
+    const fs::file_time_type mtime = fs::last_write_time(path);
+    write_text(path, two_port(-40.0));
+    fs::last_write_time(path, mtime);
+
+    const ts::TouchstoneData reloaded = ts::parse_touchstone(path, cached());
+    assert_identical(reloaded, ts::parse_touchstone(path));
+}
+
+void test_damaged_entry_is_ignored()
+{
+    const fs::path dir = scratch_directory();
+    const std::string path = (dir / "dut.s2p").string();
+    write_text(path, two_port(-30.0));
+    ts::parse_touchstone(path, cached());
+
+    const std::string entry = ts::cache_path_for(path);
+    fs::resize_file(entry, fs::file_size(entry) - 16);
+    assert_identical(ts::parse_touchstone(path, cached()), ts::parse_touchstone(path));
+
+    // The damaged entry was replaced by a complete one.
+    std::ifstream in(path, std::ios::binary);
+    const std::string contents((std::istreambuf_iterator<char>(in)), std::istreambuf_iterator<char>());
+    const std::optional<ts::CacheKey> key = ts::make_cache_key(path, contents.data(), contents.size());
+    assert(key);
+    assert(ts::cache_is_valid(entry, *key));
+}
+
+void test_cache_directory()
+{
+    const fs::path dir = scratch_directory();
+    fs::create_directories(dir / "a");
+    fs::create_directories(dir / "b");
+    write_text(dir / "a" / "dut.s2p", two_port(-30.0));
+    write_text(dir / "b" / "dut.s2p", two_port(-40.0));
+    const std::string cache_dir = (dir / "cache").string();
+
+    const std::string path_a = (dir / "a" / "dut.s2p").string();
+    const std::string path_b = (dir / "b" / "dut.s2p").string();
+    assert(ts::cache_path_for(path_a, cache_dir) != ts::cache_path_for(path_b, cache_dir));
+
+    ts::parse_touchstone(path_a, cached(cache_dir));
+    ts::parse_touchstone(path_b, cached(cache_dir));
+    assert(!fs::exists(path_a + ".fsnpcache"));
+    assert_identical(ts::parse_touchstone(path_a, cached(cache_dir)), ts::parse_touchstone(path_a));
+    assert_identical(ts::parse_touchstone(path_b, cached(cache_dir)), ts::parse_touchstone(path_b));
+}
+
+void test_warm_cache()
+{
+    const fs::path dir = scratch_directory();
+    fs::create_directories(dir / "nested");
+    write_text(dir / "one.s2p", two_port(-30.0));
+    write_text(dir / "nested" / "two.S2P", two_port(-40.0));
+    write_text(dir / "broken.s2p", "# GHZ S DB R 50\n1 2 3\n");
+    write_text(dir / "notes.txt", "not a network\n");
+    const std::string cache_dir = (dir / "cache").string();
+
+    ts::CacheWarmStats first = ts::warm_cache(dir.string(), cache_dir);
+    assert(first.files == 3);
+    assert(first.built == 2);
+    assert(first.up_to_date == 0);
+    assert(first.failed == 1);
+
+    ts::CacheWarmStats second = ts::warm_cache(dir.string(), cache_dir);
+    assert(second.files == 3);
+    assert(second.built == 0);
+    assert(second.up_to_date == 2);
+    assert(second.failed == 1);
+}
+
+#ifndef _WIN32
+void test_concurrent_writers()
+{
+    // Two processes rewriting one entry must never share a temporary file:
+    // each write succeeds and the surviving entry is complete.
+    const fs::path dir = scratch_directory();
+    const std::string path = (dir / "dut.s2p").string();
+    std::ostringstream text;
+    text << "# GHZ S DB R 50\n";
+    for (int k = 1; k <= 5000; ++k)
+        text << 0.001 * k << " -30 10 -0.5 -20 -0.5 -20 -30 10\n";
+    write_text(path, text.str());
+    const ts::TouchstoneData data = ts::parse_touchstone(path);
+    const std::string contents = text.str();
+    const std::optional<ts::CacheKey> key = ts::make_cache_key(path, contents.data(), contents.size());
+    assert(key);
+    const std::string entry = ts::cache_path_for(path);
+
+    auto write_many = [&] {
+        bool ok = true;
+        for (int i = 0; i < 400; ++i)
+            ok = ts::write_cache(entry, *key, data) && ok;
+        return ok;
+    };
+    const pid_t child = fork();
+    assert(child >= 0);
+    if (child == 0)
+        _exit(write_many() ? 0 : 1);
+    const bool parent_ok = write_many();
+    int status = 0;
+    waitpid(child, &status, 0);
+    assert(parent_ok);
+    assert(WIFEXITED(status) && WEXITSTATUS(status) == 0);
+
+    const std::optional<ts::TouchstoneData> cached_data = ts::read_cache(entry, *key);
+    assert(cached_data);
+    assert_identical(*cached_data, data);
+    for (const fs::directory_entry& item : fs::directory_iterator(dir))
+        assert(item.path().string().find(".tmp") == std::string::npos);
+}
+#endif
+
+int main()
+{
+    test_cached_load_matches_parse();
+    test_stale_entry_is_rebuilt();
+    test_damaged_entry_is_ignored();
+    test_cache_directory();
+    test_warm_cache();
+#ifndef _WIN32
+    test_concurrent_writers();
+#endif
+    fs::remove_all(fs::temp_directory_path() / "fsnpview_cache_tests");
+    std::cout << "All Touchstone cache tests passed." << std::endl;
+    return 0;
+}
@@ -0,0 +1,105 @@
+#include "touchstone_registry.h"
+
+#include <cassert>
+#include <chrono>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <memory>
+#include <string>
+
+namespace fs = std::filesystem;
+
+namespace {
+
+fs::path scratch_directory()
+{
+    const fs::path dir = fs::temp_directory_path() / "fsnpview_registry_tests";
+    fs::remove_all(dir);
+    fs::create_directories(dir);
+    return dir;
+}
+
+void write_text(const fs::path& path, const std::string& text)
+{
+    std::ofstream out(path, std::ios::binary | std::ios::trunc);
+    out << text;
+}
+
+} // namespace
+
+void test_duplicate_opens_share_data()
+{
+    ts::TouchstoneRegistry& registry = ts::TouchstoneRegistry::instance();
+    registry.clear();
+    const fs::path dir = scratch_directory();
+    fs::copy_file("test/a (1).s2p", dir / "dut.s2p");
+
+    const auto first = registry.load((dir / "dut.s2p").string());
+    // A different spelling of the same file resolves to the same entry.
+    const auto second = registry.load((dir / "." / "dut.s2p").string());
+    assert(first == second);
+
+    const ts::RegistryStats stats = registry.stats();
+    assert(stats.hits == 1);
+    assert(stats.misses == 1);
+    assert(stats.entries == 1);
+    assert(stats.bytes == first->freq.size() * sizeof(double) + first->sparams.size() * sizeof(std::complex<double>));
+    assert(stats.hit_rate() == 0.5);
+}
+
+void test_changed_file_is_reparsed()
+{
+    ts::TouchstoneRegistry& registry = ts::TouchstoneRegistry::instance();
+    registry.clear();
+    const fs::path dir = scratch_directory();
+    const std::string path = (dir / "dut.s1p").string();
+    write_text(path, "# GHZ S RI R 50\n1 0.1 0\n2 0.2 0\n");
+
+    const auto before = registry.load(path);
+    write_text(path, "# GHZ S RI R 50\n1 0.1 0\n2 0.2 0\n3 0.3 0\n");
+    fs::last_write_time(path, fs::last_write_time(path) + std::chrono::seconds(1));
+    const auto after = registry.load(path);
+    assert(before != after);
+    assert(before->freq.size() == 2);
+    assert(after->freq.size() == 3);
+    assert(registry.stats().misses == 2);
+}
+
+void test_released_data_is_dropped()
+{
+    ts::TouchstoneRegistry& registry = ts::TouchstoneRegistry::instance();
+    registry.clear();
+    auto data = registry.load("test/a (1).s2p");
+    std::weak_ptr<const ts::TouchstoneData> weak = data;
+    data.reset();
+    assert(weak.expired());
+    assert(registry.stats().entries == 0);
+    assert(registry.stats().bytes == 0);
+
+    registry.load("test/a (1).s2p");
+    assert(registry.stats().misses == 2);
+    assert(registry.stats().hits == 0);
+}
+
+void test_missing_file_throws()
+{
+    bool threw = false;
+    try {
+        ts::TouchstoneRegistry::instance().load("test/does_not_exist.s2p");
+    } catch (const std::exception&) {
+        threw = true;
+    }
+    assert(threw);
+}
+
+int main()
+{
+    test_duplicate_opens_share_data();
+    test_changed_file_is_reparsed();
+    test_released_data_is_dropped();
+    test_missing_file_throws();
+    fs::remove_all(fs::temp_directory_path() / "fsnpview_registry_tests");
+    std::cout << "All Touchstone registry tests passed." << std::endl;
+    return 0;
+}
@@ -0,0 +1,120 @@
+#include "threadpool.h"
+
+#include <algorithm>
+#include <atomic>
+#include <exception>
+#include <memory>
+
+namespace {
+
+struct LoopState
+{
+    std::function<void(std::size_t)> fn;
+    std::size_t count = 0;
+    std::atomic<std::size_t> next{0};
+    std::atomic<std::size_t> done{0};
+    std::mutex mutex;
+    std::condition_variable finished;
+    std::exception_ptr error;
+};
+
+void drain(const std::shared_ptr<LoopState>& state)
+{
+    for (;;) {
+        const std::size_t index = state->next.fetch_add(1);
+        if (index >= state->count)
+            return;
+        try {
+            state->fn(index);
+        } catch (...) {
+            std::lock_guard<std::mutex> lock(state->mutex);
+            if (!state->error)
+                state->error = std::current_exception();
+        }
+        if (state->done.fetch_add(1) + 1 == state->count) {
+            std::lock_guard<std::mutex> lock(state->mutex);
+            state->finished.notify_all();
+        }
+    }
+}
+
+} // namespace
+
+ThreadPool::ThreadPool(unsigned threadCount)
+    : m_stopping(false)
+{
+    if (threadCount == 0)
+        threadCount = std::max(1u, std::thread::hardware_concurrency());
+    for (unsigned i = 1; i < threadCount; ++i)
+        m_workers.emplace_back([this] { workerLoop(); });
+}
+
+ThreadPool::~ThreadPool()
+{
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_stopping = true;
+    }
+    m_condition.notify_all();
+    for (auto& worker : m_workers)
+        worker.join();
+}
+
+ThreadPool& ThreadPool::global()
+{
+    static ThreadPool pool;
+    return pool;
+}
+
+unsigned ThreadPool::threadCount() const
+{
+    return static_cast<unsigned>(m_workers.size()) + 1;
+}
+
+void ThreadPool::parallelFor(std::size_t count, const std::function<void(std::size_t)>& fn, unsigned maxThreads)
+{
+    if (count == 0)
+        return;
+
+    unsigned threads = maxThreads == 0 ? threadCount() : std::min(maxThreads, threadCount());
+    threads = static_cast<unsigned>(std::min<std::size_t>(threads, count));
+    if (threads <= 1) {
+        for (std::size_t i = 0; i < count; ++i)
+            fn(i);
+        return;
+    }
+
+    auto state = std::make_shared<LoopState>();
+    state->fn = fn;
+    state->count = count;
+
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        for (unsigned i = 1; i < threads; ++i)
+            m_tasks.emplace_back([state] { drain(state); });
+    }
+    m_condition.notify_all();
+
+    drain(state);
+
+    std::unique_lock<std::mutex> lock(state->mutex);
+    state->finished.wait(lock, [&] { return state->done.load() == state->count; });
+    if (state->error)
+        std::rethrow_exception(state->error);
+}
+
+void ThreadPool::workerLoop()
+{
+    for (;;) {
+        std::function<void()> task;
+        {
+            std::unique_lock<std::mutex> lock(m_mutex);
+            m_condition.wait(lock, [this] { return m_stopping || !m_tasks.empty(); });
+            if (m_stopping && m_tasks.empty())
+                return;
+            task = std::move(m_tasks.front());
+            m_tasks.pop_front();
+        }
+        task();
+    }
+}
@@ -0,0 +1,43 @@
+#ifndef THREADPOOL_H
+#define THREADPOOL_H
+
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// Fixed-size worker pool for data-parallel loops. The calling thread takes part
+// in every loop, so nested parallelFor calls from inside a task cannot deadlock.
+class ThreadPool
+{
+public:
+    explicit ThreadPool(unsigned threadCount = 0);
+    ~ThreadPool();
+
+    ThreadPool(const ThreadPool&) = delete;
+    ThreadPool& operator=(const ThreadPool&) = delete;
+
+    static ThreadPool& global();
+
+    // Number of threads that can work on a loop, including the caller.
+    unsigned threadCount() const;
+
+    // Runs fn(i) for every i in [0, count) and blocks until all calls returned.
+    // maxThreads limits the parallelism (0 = threadCount()). The first exception
+    // thrown by fn is rethrown on the calling thread once the loop has finished.
+    void parallelFor(std::size_t count, const std::function<void(std::size_t)>& fn, unsigned maxThreads = 0);
+
+private:
+    void workerLoop();
+
+    std::vector<std::thread> m_workers;
+    std::deque<std::function<void()>> m_tasks;
+    std::mutex m_mutex;
+    std::condition_variable m_condition;
+    bool m_stopping;
+};
+
+#endif // THREADPOOL_H
@@ -0,0 +1,320 @@
+#include "touchstone_cache.h"
+#include "mappedfile.h"
+
+#include <algorithm>
+#include <cctype>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <iomanip>
+#include <random>
+#include <sstream>
+#include <system_error>
+#include <type_traits>
+
+#ifdef _WIN32
+#include <process.h>
+#else
+#include <unistd.h>
+#endif
+
+namespace ts {
+
+namespace {
+
+namespace fs = std::filesystem;
+
+constexpr char kMagic[8] = {'F', 'S', 'N', 'P', 'C', 'A', 'C', 'H'};
+constexpr std::size_t kAlignment = 64;
+constexpr std::size_t kFieldSize = 8;
+
+struct CacheHeader {
+    char magic[8];
+    std::uint32_t version;
+    std::uint32_t header_size;
+    std::uint64_t source_size;
+    std::int64_t source_mtime;
+    std::uint64_t content_hash;
+    std::int32_t ports;
+    std::uint32_t path_length;
+    std::uint64_t rows;
+    std::uint64_t cols;
+    double R;
+    char parameter[kFieldSize];
+    char format[kFieldSize];
+    char freq_unit[kFieldSize];
+    std::uint64_t freq_offset;
+    std::uint64_t sparams_offset;
+    std::uint64_t total_size;
+    std::uint64_t reserved;
+};
+
+static_assert(std::is_trivially_copyable<CacheHeader>::value, "cache header is written as raw bytes");
+static_assert(sizeof(CacheHeader) == 128, "cache header layout changed; bump kCacheFormatVersion");
+
+std::uint64_t align_up(std::uint64_t value) {
+    return (value + kAlignment - 1) / kAlignment * kAlignment;
+}
+
+bool store_field(char (&field)[kFieldSize], const std::string& value) {
+    if (value.size() >= kFieldSize) {
+        return false;
+    }
+    std::memset(field, 0, kFieldSize);
+    std::memcpy(field, value.data(), value.size());
+    return true;
+}
+
+std::string load_field(const char (&field)[kFieldSize]) {
+    return std::string(field, std::find(field, field + kFieldSize, '\0'));
+}
+
+std::string absolute_path(const std::string& path) {
+    std::error_code ec;
+    const fs::path absolute = fs::absolute(path, ec);
+    return ec ? path : absolute.lexically_normal().string();
+}
+
+// Unique per writer: the PID separates processes warming the same directory,
+// the random suffix separates threads and reused PIDs.
+std::string temp_path_for(const std::string& cache_path) {
+#ifdef _WIN32
+    const long long pid = _getpid();
+#else
+    const long long pid = getpid();
+#endif
+    std::random_device entropy;
+    const std::uint64_t suffix = (static_cast<std::uint64_t>(entropy()) << 32) ^ entropy();
+    std::ostringstream name;
+    name << cache_path << ".tmp" << pid << '_' << std::hex << std::setw(16) << std::setfill('0') << suffix;
+    return name.str();
+}
+
+bool is_touchstone_file(const fs::path& path) {
+    std::string ext = path.extension().string();
+    std::transform(ext.begin(), ext.end(), ext.begin(), [](unsigned char c) { return static_cast<char>(std::tolower(c)); });
+    if (ext.size() < 4 || ext[1] != 's' || ext.back() != 'p') {
+        return false;
+    }
+    return std::all_of(ext.begin() + 2, ext.end() - 1, [](unsigned char c) { return std::isdigit(c) != 0; });
+}
+
+// Copies out the entry's header and checks its identity, version and array
+// extents against the mapping and `key`.
+bool read_header(const MappedFile& mapped, const CacheKey& key, CacheHeader& header) {
+    if (!mapped.is_open() || mapped.size() < sizeof(CacheHeader)) {
+        return false;
+    }
+    std::memcpy(&header, mapped.data(), sizeof(CacheHeader));
+    if (std::memcmp(header.magic, kMagic, sizeof(kMagic)) != 0 || header.version != kCacheFormatVersion ||
+        header.header_size != sizeof(CacheHeader) || header.total_size != mapped.size()) {
+        return false;
+    }
+    if (header.source_size != key.source_size || header.source_mtime != key.source_mtime ||
+        header.content_hash != key.content_hash) {
+        return false;
+    }
+    if (header.path_length != key.source_path.size() || sizeof(CacheHeader) + header.path_length > mapped.size() ||
+        std::memcmp(mapped.data() + sizeof(CacheHeader), key.source_path.data(), key.source_path.size()) != 0) {
+        return false;
+    }
+    if (header.ports <= 0 || header.cols != static_cast<std::uint64_t>(header.ports) * static_cast<std::uint64_t>(header.ports)) {
+        return false;
+    }
+    if (header.rows != 0 && header.cols > header.total_size / sizeof(std::complex<double>) / header.rows) {
+        return false;
+    }
+    const std::uint64_t freq_bytes = header.rows * sizeof(double);
+    const std::uint64_t sparams_bytes = header.rows * header.cols * sizeof(std::complex<double>);
+    if (header.freq_offset % kAlignment != 0 || header.sparams_offset % kAlignment != 0 ||
+        header.sparams_offset > header.total_size || header.freq_offset > header.sparams_offset ||
+        header.freq_offset < sizeof(CacheHeader) + header.path_length || header.freq_offset + freq_bytes > header.sparams_offset ||
+        header.sparams_offset + sparams_bytes > header.total_size) {
+        return false;
+    }
+    return true;
+}
+
+} // namespace
+
+std::uint64_t content_hash(const char* data, std::size_t size) {
+    // Word-at-a-time FNV-1a variant: cheap enough to run on every cached load.
+    constexpr std::uint64_t kPrime = 0x100000001b3ull;
+    std::uint64_t hash = 0xcbf29ce484222325ull ^ size;
+    std::size_t i = 0;
+    for (; i + sizeof(std::uint64_t) <= size; i += sizeof(std::uint64_t)) {
+        std::uint64_t word;
+        std::memcpy(&word, data + i, sizeof(word));
+        hash = (hash ^ word) * kPrime;
+        hash ^= hash >> 32;
+    }
+    for (; i < size; ++i) {
+        hash = (hash ^ static_cast<unsigned char>(data[i])) * kPrime;
+    }
+    return hash;
+}
+
+std::optional<CacheKey> make_cache_key(const std::string& source_path, const char* contents, std::size_t size) {
+    std::error_code ec;
+    const fs::file_time_type mtime = fs::last_write_time(source_path, ec);
+    if (ec) {
+        return std::nullopt;
+    }
+    CacheKey key;
+    key.source_path = absolute_path(source_path);
+    key.source_size = size;
+    key.source_mtime = static_cast<std::int64_t>(mtime.time_since_epoch().count());
+    key.content_hash = content_hash(contents, size);
+    return key;
+}
+
+std::string cache_path_for(const std::string& source_path, const std::string& cache_dir) {
+    if (cache_dir.empty()) {
+        return source_path + ".fsnpcache";
+    }
+    // Files with the same name in different directories must not share an entry.
+    const std::string absolute = absolute_path(source_path);
+    std::ostringstream name;
+    name << std::hex << std::setw(16) << std::setfill('0') << content_hash(absolute.data(), absolute.size()) << '_'
+         << fs::path(absolute).filename().string() << ".fsnpcache";
+    return (fs::path(cache_dir) / name.str()).string();
+}
+
+bool cache_is_valid(const std::string& cache_path, const CacheKey& key) {
+    MappedFile mapped;
+    mapped.open(cache_path);
+    CacheHeader header;
+    return read_header(mapped, key, header);
+}
+
+std::optional<TouchstoneData> read_cache(const std::string& cache_path, const CacheKey& key) {
+    MappedFile mapped;
+    mapped.open(cache_path);
+    CacheHeader header;
+    if (!read_header(mapped, key, header)) {
+        return std::nullopt;
+    }
+
+    TouchstoneData data;
+    data.ports = header.ports;
+    data.parameter = load_field(header.parameter);
+    data.format = load_field(header.format);
+    data.freq_unit = load_field(header.freq_unit);
+    data.R = header.R;
+
+    const Eigen::Index rows = static_cast<Eigen::Index>(header.rows);
+    const Eigen::Index cols = static_cast<Eigen::Index>(header.cols);
+    data.freq.resize(rows);
+    data.sparams.resize(rows, cols);
+    std::memcpy(data.freq.data(), mapped.data() + header.freq_offset, static_cast<std::size_t>(rows) * sizeof(double));
+    std::memcpy(data.sparams.data(), mapped.data() + header.sparams_offset,
+                static_cast<std::size_t>(rows * cols) * sizeof(std::complex<double>));
+    return data;
+}
+
+bool write_cache(const std::string& cache_path, const CacheKey& key, const TouchstoneData& data) {
+    if (data.ports <= 0 || data.sparams.cols() != static_cast<Eigen::Index>(data.ports) * data.ports ||
+        data.sparams.rows() != data.freq.size()) {
+        return false;
+    }
+
+    CacheHeader header{};
+    std::memcpy(header.magic, kMagic, sizeof(kMagic));
+    header.version = kCacheFormatVersion;
+    header.header_size = sizeof(CacheHeader);
+    header.source_size = key.source_size;
+    header.source_mtime = key.source_mtime;
+    header.content_hash = key.content_hash;
+    header.ports = data.ports;
+    header.path_length = static_cast<std::uint32_t>(key.source_path.size());
+    header.rows = static_cast<std::uint64_t>(data.freq.size());
+    header.cols = static_cast<std::uint64_t>(data.sparams.cols());
+    header.R = data.R;
+    if (!store_field(header.parameter, data.parameter) || !store_field(header.format, data.format) ||
+        !store_field(header.freq_unit, data.freq_unit)) {
+        return false;
+    }
+    const std::uint64_t freq_bytes = header.rows * sizeof(double);
+    const std::uint64_t sparams_bytes = header.rows * header.cols * sizeof(std::complex<double>);
+    header.freq_offset = align_up(sizeof(CacheHeader) + header.path_length);
+    header.sparams_offset = align_up(header.freq_offset + freq_bytes);
+    header.total_size = header.sparams_offset + sparams_bytes;
+
+    std::error_code ec;
+    const fs::path target(cache_path);
+    if (target.has_parent_path()) {
+        fs::create_directories(target.parent_path(), ec);
+    }
+    const std::string temp_path = temp_path_for(cache_path);
+    {
+        std::ofstream out(temp_path, std::ios::binary | std::ios::trunc);
+        if (!out) {
+            return false;
+        }
+        const char padding[kAlignment] = {};
+        out.write(reinterpret_cast<const char*>(&header), sizeof(header));
+        out.write(key.source_path.data(), static_cast<std::streamsize>(key.source_path.size()));
+        out.write(padding, static_cast<std::streamsize>(header.freq_offset - sizeof(header) - header.path_length));
+        out.write(reinterpret_cast<const char*>(data.freq.data()), static_cast<std::streamsize>(freq_bytes));
+        out.write(padding, static_cast<std::streamsize>(header.sparams_offset - header.freq_offset - freq_bytes));
+        out.write(reinterpret_cast<const char*>(data.sparams.data()), static_cast<std::streamsize>(sparams_bytes));
+        if (!out) {
+            out.close();
+            fs::remove(temp_path, ec);
+            return false;
+        }
+    }
+    fs::rename(temp_path, target, ec);
+    if (ec) {
+        fs::remove(temp_path, ec);
+        return false;
+    }
+    return true;
+}
+
+CacheWarmStats warm_cache(const std::string& directory, const std::string& cache_dir) {
+    CacheWarmStats stats;
+    ParseOptions options;
+    options.use_cache = true;
+    options.cache_dir = cache_dir;
+
+    std::error_code ec;
+    for (fs::recursive_directory_iterator it(directory, fs::directory_options::skip_permission_denied, ec), end;
+         !ec && it != end; it.increment(ec)) {
+        if (!it->is_regular_file(ec) || !is_touchstone_file(it->path())) {
+            continue;
+        }
+        const std::string path = it->path().string();
+        const std::string entry = cache_path_for(path, cache_dir);
+        ++stats.files;
+
+        MappedFile mapped;
+        std::optional<CacheKey> key;
+        if (mapped.open(path)) {
+            key = make_cache_key(path, mapped.data(), mapped.size());
+        }
+        if (!key) {
+            ++stats.failed;
+            continue;
+        }
+        if (cache_is_valid(entry, *key)) {
+            ++stats.up_to_date;
+            continue;
+        }
+        try {
+            parse_touchstone(path, options);
+        } catch (const std::exception&) {
+            ++stats.failed;
+            continue;
+        }
+        // parse_touchstone does not report cache write failures; check the entry.
+        if (cache_is_valid(entry, *key)) {
+            ++stats.built;
+        } else {
+            ++stats.failed;
+        }
+    }
+    return stats;
+}
+
+} // namespace ts
@@ -0,0 +1,58 @@
+#pragma once
+
+#include "parser_touchstone.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+#include <string>
+
+namespace ts {
+
+// Binary cache entries for parsed Touchstone files. An entry holds a fixed
+// header, the absolute source path, then the frequency vector and the
+// column-major S-parameter array at 64-byte aligned offsets, so the file can be
+// mapped and read without any parsing. Entries live next to the source as
+// "<file>.fsnpcache" or, when a cache directory is given, inside that directory.
+
+constexpr std::uint32_t kCacheFormatVersion = 1;
+
+// Identity of the source file an entry was built from. An entry is only used
+// when every field matches the file as it is now.
+struct CacheKey {
+    std::string source_path;
+    std::uint64_t source_size = 0;
+    std::int64_t source_mtime = 0;
+    std::uint64_t content_hash = 0;
+};
+
+std::uint64_t content_hash(const char* data, std::size_t size);
+
+// Builds the key for `source_path` whose current contents are `contents`.
+// Returns std::nullopt when the file's metadata cannot be read.
+std::optional<CacheKey> make_cache_key(const std::string& source_path, const char* contents, std::size_t size);
+
+std::string cache_path_for(const std::string& source_path, const std::string& cache_dir = std::string());
+
+// Checks the entry's header against `key` without reading the arrays.
+bool cache_is_valid(const std::string& cache_path, const CacheKey& key);
+
+// Returns the cached data, or std::nullopt when the entry is missing, stale,
+// from another format version, or damaged.
+std::optional<TouchstoneData> read_cache(const std::string& cache_path, const CacheKey& key);
+
+// Writes the entry through a temporary file and a rename so readers never see
+// a partial entry. Returns false if the entry could not be written.
+bool write_cache(const std::string& cache_path, const CacheKey& key, const TouchstoneData& data);
+
+struct CacheWarmStats {
+    std::size_t files = 0;
+    std::size_t built = 0;
+    std::size_t up_to_date = 0;
+    std::size_t failed = 0;
+};
+
+// Builds missing or stale entries for every Touchstone file below `directory`.
+CacheWarmStats warm_cache(const std::string& directory, const std::string& cache_dir = std::string());
+
+} // namespace ts
@@ -0,0 +1,96 @@
+#include "touchstone_registry.h"
+
+#include <complex>
+#include <filesystem>
+#include <system_error>
+
+namespace ts {
+
+namespace {
+
+namespace fs = std::filesystem;
+
+std::size_t data_bytes(const TouchstoneData& data) {
+    return static_cast<std::size_t>(data.freq.size()) * sizeof(double) +
+           static_cast<std::size_t>(data.sparams.size()) * sizeof(std::complex<double>);
+}
+
+} // namespace
+
+TouchstoneRegistry& TouchstoneRegistry::instance() {
+    static TouchstoneRegistry registry;
+    return registry;
+}
+
+std::shared_ptr<const TouchstoneData> TouchstoneRegistry::load(const std::string& path, const ParseOptions& options) {
+    std::error_code ec;
+    const fs::path canonical = fs::canonical(path, ec);
+    if (ec) {
+        // Unreadable paths are not shared; parse_touchstone reports the error.
+        return std::make_shared<const TouchstoneData>(parse_touchstone(path, options));
+    }
+    const std::string key = canonical.string();
+    const std::uintmax_t size = fs::file_size(canonical, ec);
+    const std::int64_t mtime = ec ? 0 : static_cast<std::int64_t>(fs::last_write_time(canonical, ec).time_since_epoch().count());
+
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        const auto it = m_entries.find(key);
+        if (!ec && it != m_entries.end() && it->second.mtime == mtime && it->second.size == size) {
+            if (std::shared_ptr<const TouchstoneData> shared = it->second.data.lock()) {
+                ++m_hits;
+                return shared;
+            }
+        }
+        ++m_misses;
+    }
+
+    // Parse outside the lock; two first opens of one file may both parse, and
+    // the later one replaces the entry.
+    std::shared_ptr<const TouchstoneData> parsed = std::make_shared<const TouchstoneData>(parse_touchstone(path, options));
+    if (ec) {
+        return parsed;
+    }
+
+    std::lock_guard<std::mutex> lock(m_mutex);
+    prune_locked();
+    Entry& entry = m_entries[key];
+    entry.mtime = mtime;
+    entry.size = size;
+    entry.bytes = data_bytes(*parsed);
+    entry.data = parsed;
+    return parsed;
+}
+
+RegistryStats TouchstoneRegistry::stats() const {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    RegistryStats stats;
+    stats.hits = m_hits;
+    stats.misses = m_misses;
+    for (const auto& item : m_entries) {
+        if (!item.second.data.expired()) {
+            ++stats.entries;
+            stats.bytes += item.second.bytes;
+        }
+    }
+    return stats;
+}
+
+void TouchstoneRegistry::clear() {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_entries.clear();
+    m_hits = 0;
+    m_misses = 0;
+}
+
+void TouchstoneRegistry::prune_locked() {
+    for (auto it = m_entries.begin(); it != m_entries.end();) {
+        if (it->second.data.expired()) {
+            it = m_entries.erase(it);
+        } else {
+            ++it;
+        }
+    }
+}
+
+} // namespace ts
@@ -0,0 +1,54 @@
+#pragma once
+
+#include "parser_touchstone.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+
+namespace ts {
+
+struct RegistryStats {
+    std::size_t hits = 0;
+    std::size_t misses = 0;
+    std::size_t entries = 0;
+    // Array storage of the entries that are still alive.
+    std::size_t bytes = 0;
+
+    double hit_rate() const { return hits + misses == 0 ? 0.0 : static_cast<double>(hits) / static_cast<double>(hits + misses); }
+};
+
+// Process-wide table of parsed files keyed by canonical path, mtime and size.
+// Every open of an unchanged file shares one immutable TouchstoneData; the
+// registry only holds weak references, so data is freed with its last user.
+class TouchstoneRegistry {
+public:
+    static TouchstoneRegistry& instance();
+
+    // Returns the shared data for `path`, parsing it when no live entry matches
+    // the file's current mtime and size. Throws like parse_touchstone.
+    std::shared_ptr<const TouchstoneData> load(const std::string& path, const ParseOptions& options = ParseOptions());
+
+    RegistryStats stats() const;
+    void clear();
+
+private:
+    struct Entry {
+        std::int64_t mtime = 0;
+        std::uintmax_t size = 0;
+        std::size_t bytes = 0;
+        std::weak_ptr<const TouchstoneData> data;
+    };
+
+    void prune_locked();
+
+    mutable std::mutex m_mutex;
+    std::unordered_map<std::string, Entry> m_entries;
+    std::size_t m_hits = 0;
+    std::size_t m_misses = 0;
+};
+
+} // namespace ts